@@ -0,0 +1,99 @@
+/**
+ * swr - a software rasterizer
+ *
+ * capture the calls to the public interface and replay them.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+#pragma once
+
+/* C++ headers. */
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace swr
+{
+
+/* forward declaration. */
+class program_base;
+
+namespace capture
+{
+
+/**
+ * Record the calls to the public interface into a binary file. This covers the buffer, texture and framebuffer
+ * management, occlusion queries, uploads, state changes, uniforms, draw calls and Present. Calls that only read
+ * data, like GetQueryResult, are not recorded.
+ *
+ * The stream starts with the calls that recreate the live buffers, textures, framebuffer objects, depth renderbuffers,
+ * queries and shaders, followed by the current states. The contents of the default framebuffer and of the depth
+ * renderbuffers are not recorded, and neither are draw calls that were issued before the capture started and are
+ * still waiting for Present. Shaders are recorded by the key they were registered with, since neither their code
+ * nor their data members can be serialized. A capture cannot be started between BeginPrimitives and EndPrimitives.
+ * A capture that is already in progress is ended first. Capturing is only available if the library is built with
+ * SWR_ENABLE_CAPTURE.
+ *
+ * \param path The file to write the calls to.
+ * \param frame_count The number of calls to Present after which the capture ends. 0 records until end_capture is called.
+ * \return Whether the capture was started.
+ */
+bool begin_capture(const char* path, uint32_t frame_count = 0);
+
+/**
+ * End the current capture and close the file.
+ *
+ * \return Whether the file was written successfully.
+ */
+bool end_capture();
+
+/** a loaded capture. */
+struct capture_data
+{
+    /** width of the default framebuffer the capture was recorded with. */
+    uint32_t width{0};
+
+    /** height of the default framebuffer the capture was recorded with. */
+    uint32_t height{0};
+
+    /** number of recorded calls to Present. */
+    uint32_t frame_count{0};
+
+    /** the recorded calls. */
+    std::vector<std::byte> commands;
+};
+
+/** return the shader to register for a recorded shader key, or nullptr if the shader is unknown. */
+using shader_resolver = std::function<const program_base*(const std::string& key)>;
+
+/**
+ * Load a capture from a file.
+ *
+ * \param path The capture file.
+ * \param data Receives the capture.
+ * \return Whether the file is a valid capture.
+ */
+bool load_capture(const char* path, capture_data& data);
+
+/**
+ * Replay a capture into the current context. Object ids are translated to the ids created by the replay, so the
+ * context should be a fresh one, with the default framebuffer of the recorded size. The shaders are looked up by the
+ * resolver and have to stay alive until the context is destroyed. The replay fails if the stream is malformed or
+ * contains out-of-range values, if it refers to an object id that was not created by the capture, if a shader cannot
+ * be resolved, or if a capture is in progress.
+ *
+ * \param data The capture.
+ * \param resolve_shader Shader lookup.
+ * \param on_present Called after each replayed call to Present with the frame index, e.g. for timing.
+ * \return Whether the whole capture was replayed.
+ */
+bool replay_capture(const capture_data& data, const shader_resolver& resolve_shader, const std::function<void(uint32_t)>& on_present = nullptr);
+
+} /* namespace capture */
+
+} /* namespace swr */
@@ -0,0 +1,75 @@
+/**
+ * swr - a software rasterizer
+ *
+ * debug output for analyzing the fragment processing cost.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+#pragma once
+
+/* C++ headers. */
+#include <cstdint>
+#include <vector>
+
+namespace swr
+{
+
+namespace debug
+{
+
+/** fragment counters of a single pixel. */
+struct fragment_counters
+{
+    /** fragments passed to the fragment shader. */
+    uint32_t shaded{0};
+
+    /** fragments failing the depth test. */
+    uint32_t depth_failed{0};
+
+    /** lanes of 2x2 blocks that were shaded without being written, i.e., helper lanes and lanes masked by the scissor test. */
+    uint32_t helper_lanes{0};
+};
+
+/** the counter shown by the false-color overlay. */
+enum class overlay_counter
+{
+    none,         /* no overlay. */
+    shaded,       /* fragment_counters::shaded. */
+    depth_failed, /* fragment_counters::depth_failed. */
+    helper_lanes  /* fragment_counters::helper_lanes. */
+};
+
+/**
+ * Enable or disable counting fragments per pixel of the default framebuffer. The counters are reset by each call to
+ * Present with pending draw calls, so that they describe the last frame. Fragments written to framebuffer objects are
+ * not counted. Disabled by default, since counting slows down fragment processing.
+ */
+void set_overdraw_counting(bool enable);
+
+/**
+ * Read the fragment counters of the last frame. The counters are stored in row-major order, with the same
+ * row order as the default color buffer.
+ *
+ * \param counters Receives width*height counters.
+ * \param width Receives the width of the default framebuffer.
+ * \param height Receives the height of the default framebuffer.
+ * \return Whether counting is enabled.
+ */
+bool get_overdraw_counters(std::vector<fragment_counters>& counters, uint32_t& width, uint32_t& height);
+
+/**
+ * Replace the colors of the default framebuffer by a false-color visualization of a counter after each call to Present.
+ * The colors range from black (no fragments) over blue, green and yellow to red (max_count fragments or more). The overlay
+ * is only drawn while counting is enabled.
+ *
+ * \param counter The counter to show, or overlay_counter::none to disable the overlay.
+ * \param max_count The count mapped to red.
+ */
+void set_overdraw_overlay(overlay_counter counter, uint32_t max_count = 8);
+
+} /* namespace debug */
+
+} /* namespace swr */
@@ -244,6 +244,15 @@ public:
         // TODO Also see https://www.khronos.org/opengl/wiki/Shader_Compilation for pre-linking setup.
     }
 
+    /**
+     * whether the fragment shader never modifies gl_FragDepth and never discards a fragment. such programs
+     * can be skipped entirely when all color channels are masked. the default is the conservative answer.
+     */
+    virtual bool is_depth_invariant() const
+    {
+        return false;
+    }
+
     /**
      * Vertex shader entry point.
      */
@@ -342,9 +351,10 @@ program_base* program<T>::create_fragment_shader_instance(
 /**
  * Register a new shader.
  * \param InShader Pointer to the shader.
+ * \param Key A stable name for the shader and its data, e.g. "gears.red.color_flat". Captures record the key, so that a replay can look up the same shader. May be nullptr.
  * \return On success, this returns the (positive) Id of the shader. If an error occured, the return value is 0.
  */
-uint32_t RegisterShader(const program_base* InShader);
+uint32_t RegisterShader(const program_base* InShader, const char* Key = nullptr);
 
 /**
  * Removes a shader from the graphics pipeline.
@@ -10,6 +10,11 @@
 
 #pragma once
 
+/* C++ headers. */
+#include <algorithm>
+#include <array>
+#include <vector>
+
 /** update counters/cycles if statistics are enabled. we intentionally use macros, so that the compiler doesn't generate an error when they is defined as empty and the argument do not exist. */
 #ifdef SWR_ENABLE_STATS
 #    define SWR_STATS_INCREMENT(ctr) \
@@ -41,6 +46,9 @@ struct fragment_data
     /** fragments processed. */
     uint64_t count{0};
 
+    /** 2x2 fragment blocks processed. */
+    uint64_t quads{0};
+
     /** fragments discarded by the alpha test */
     uint64_t discard_alpha{0};
 
@@ -66,6 +74,7 @@ struct fragment_data
     void reset_counters()
     {
         count = 0;
+        quads = 0;
         discard_alpha = 0;
         discard_depth = 0;
         discard_scissor = 0;
@@ -73,18 +82,101 @@ struct fragment_data
         blending = 0;
         cycles = 0;
     }
+
+    /** add the counters of another data set. */
+    fragment_data& operator+=(const fragment_data& other)
+    {
+        count += other.count;
+        quads += other.quads;
+        discard_alpha += other.discard_alpha;
+        discard_depth += other.discard_depth;
+        discard_scissor += other.discard_scissor;
+        discard_shader += other.discard_shader;
+        blending += other.blending;
+        cycles += other.cycles;
+        return *this;
+    }
 };
 
 /** read fragment benchmark data. */
 void get_fragment_data(fragment_data& data);
 
+/**
+ * CPU cycles spent in the pipeline stages (per frame). the cycles are summed up over all threads, so they may exceed
+ * the frame time when multi-threading is enabled. the cycles are only measured if DO_BENCHMARKING is defined.
+ */
+struct pipeline_data
+{
+    /** vertex shader invocations. */
+    uint64_t vertex_shading{0};
+
+    /** clipping. */
+    uint64_t clipping{0};
+
+    /** perspective divide and viewport transformation. */
+    uint64_t viewport_transform{0};
+
+    /** primitive assembly, including face culling. */
+    uint64_t assembly{0};
+
+    /** primitive setup and binning into tiles. */
+    uint64_t setup{0};
+
+    /** tile rasterization, without the fragment stages below. */
+    uint64_t rasterization{0};
+
+    /** attribute interpolation and fragment shader invocations. */
+    uint64_t fragment_shading{0};
+
+    /** depth test. */
+    uint64_t depth_test{0};
+
+    /** merging the fragment colors into the draw target. */
+    uint64_t merge{0};
+
+    /** default constructor. */
+    pipeline_data() = default;
+
+    /** reset counters to zero. */
+    void reset_counters()
+    {
+        vertex_shading = 0;
+        clipping = 0;
+        viewport_transform = 0;
+        assembly = 0;
+        setup = 0;
+        rasterization = 0;
+        fragment_shading = 0;
+        depth_test = 0;
+        merge = 0;
+    }
+
+    /** add the counters of another data set. */
+    pipeline_data& operator+=(const pipeline_data& other)
+    {
+        vertex_shading += other.vertex_shading;
+        clipping += other.clipping;
+        viewport_transform += other.viewport_transform;
+        assembly += other.assembly;
+        setup += other.setup;
+        rasterization += other.rasterization;
+        fragment_shading += other.fragment_shading;
+        depth_test += other.depth_test;
+        merge += other.merge;
+        return *this;
+    }
+};
+
+/** read pipeline benchmark data. */
+void get_pipeline_data(pipeline_data& data);
+
 /** rasterizer statistics. */
 struct rasterizer_data
 {
     /** number of available threads in thread pool. */
     uint32_t available_threads{0};
 
-    /** jobs (per frame). */
+    /** tile jobs (per frame). */
     uint32_t jobs{0};
 
     /** default constructor. */
@@ -100,6 +192,239 @@ struct rasterizer_data
 /** read rasterizer data. */
 void get_rasterizer_data(rasterizer_data& data);
 
+/** reasons for processing the tile cache. */
+enum class flush_cause
+{
+    cache_full,            /* a tile reached its primitive capacity. */
+    blending,              /* a primitive with blending enabled was drawn. */
+    depth_test_disabled,   /* a primitive without depth test was drawn. */
+    depth_func_change,     /* the depth function changed. */
+    primitive_type_change, /* the primitive type changed. */
+    visibility_shading,    /* the visibility buffers were completed for shading. */
+    visibility_full,       /* a tile's visibility buffer reached its triangle capacity and all visibility buffers were shaded. */
+    sequential,            /* a triangle was drawn by the sequential rasterizer, which processes the cache after each triangle. */
+    end_of_frame,          /* all primitives were drawn. */
+    count                  /* number of causes. */
+};
+
+/** number of buckets in tile_data::primitive_histogram. */
+constexpr std::size_t tile_histogram_buckets = 16;
+
+/** tile load balance and tile cache statistics (per frame). */
+struct tile_data
+{
+    /** number of tiles in x direction. */
+    uint32_t tiles_x{0};
+
+    /** number of tiles in y direction. */
+    uint32_t tiles_y{0};
+
+    /** primitives processed by each tile, in row-major order. triangles count once per tile they cover. */
+    std::vector<uint32_t> primitives;
+
+    /** CPU cycles spent processing each tile, including fragment processing, in row-major order. */
+    std::vector<uint64_t> cycles;
+
+    /**
+     * histogram of the per-tile primitive counts. bucket 0 counts the tiles without primitives, and bucket i>0 counts
+     * the tiles with [2^(i-1), 2^i) primitives. the last bucket also counts all tiles with more primitives.
+     */
+    std::array<uint32_t, tile_histogram_buckets> primitive_histogram{};
+
+    /** tile cache flushes processing at least one tile, indexed by flush_cause. */
+    std::array<uint32_t, static_cast<std::size_t>(flush_cause::count)> flushes{};
+
+    /** CPU cycles spent in draw_primitives, measured on the calling thread. */
+    uint64_t draw_cycles{0};
+
+    /**
+     * CPU cycles each thread of the thread pool spent executing rasterizer tasks. threads are listed in order of their first
+     * task and are kept for the lifetime of the context. empty if multi-threading is disabled.
+     */
+    std::vector<uint64_t> worker_busy_cycles;
+
+    /** draw_cycles minus worker_busy_cycles, for each thread of the thread pool. */
+    std::vector<uint64_t> worker_idle_cycles;
+
+    /** default constructor. */
+    tile_data() = default;
+
+    /** reset counters to zero. keeps the tile and thread counts. */
+    void reset_counters()
+    {
+        primitives.assign(primitives.size(), 0);
+        cycles.assign(cycles.size(), 0);
+        primitive_histogram.fill(0);
+        flushes.fill(0);
+        draw_cycles = 0;
+        worker_busy_cycles.assign(worker_busy_cycles.size(), 0);
+        worker_idle_cycles.assign(worker_idle_cycles.size(), 0);
+    }
+};
+
+/** read tile load balance data. */
+void get_tile_data(tile_data& data);
+
+/** memory categories. */
+enum class memory_category
+{
+    textures,       /* texture storage, including the mipmap chains. */
+    vertex_buffers, /* vertex, index and vertex attribute buffers, and the immediate mode buffers. */
+    render_objects, /* the draw list, i.e., the render objects with their copies of the render states and their vertex processing buffers. */
+    primitives,     /* assembled primitives and the rasterizer's primitive lists and bins. */
+    programs,       /* registered shaders and per-thread shader instances. */
+    tile_cache,     /* the tiles, including their shader instances, tile-local buffers and visibility buffers. */
+    framebuffers,   /* depth buffers, depth renderbuffers and framebuffer objects. externally supplied color buffers are not counted. */
+    count           /* number of categories. */
+};
+
+/** memory usage of a category, in bytes. the sizes are based on the containers' capacities. */
+struct memory_usage
+{
+    /** memory held when the data was read. */
+    uint64_t current{0};
+
+    /** largest size since the start of the last call to Present with pending draw calls. */
+    uint64_t frame_peak{0};
+
+    /** largest size since the context was created. */
+    uint64_t peak{0};
+
+    /** record a size. */
+    void sample(uint64_t bytes)
+    {
+        current = bytes;
+        frame_peak = std::max(frame_peak, bytes);
+        peak = std::max(peak, bytes);
+    }
+};
+
+/** memory usage of the library. */
+struct memory_data
+{
+    /** usage of each category, indexed by memory_category. */
+    std::array<memory_usage, static_cast<std::size_t>(memory_category::count)> categories{};
+
+    /** access a category. */
+    const memory_usage& operator[](memory_category category) const
+    {
+        return categories[static_cast<std::size_t>(category)];
+    }
+
+    /** sum of the current sizes of all categories. */
+    uint64_t get_current_total() const
+    {
+        uint64_t total = 0;
+        for(const auto& it: categories)
+        {
+            total += it.current;
+        }
+        return total;
+    }
+};
+
+/**
+ * read the memory usage of the current context. the current sizes are updated by this call. the peaks are sampled at the
+ * stages of Present, where the tile cache is measured each time before it is processed.
+ */
+void get_memory_data(memory_data& data);
+
+/**
+ * pipeline stages measured by the hardware counters. the counters are read when a task starts or ends, so the
+ * fragment stages are included in the tile processing stage.
+ */
+enum class hardware_stage
+{
+    vertex_processing,  /* vertex shading, clipping and viewport transformation. */
+    assembly,           /* primitive assembly. */
+    setup,              /* primitive setup and binning into tiles. */
+    tile_processing,    /* rasterization and fragment processing of a tile. */
+    visibility_shading, /* shading a tile's visibility buffer. */
+    resolve,            /* writing a tile's local buffers back to the default framebuffer. */
+    count               /* number of stages. */
+};
+
+/** hardware performance counters. counters that are not supported by the CPU or the kernel stay zero. */
+struct hardware_counters
+{
+    /** retired instructions. */
+    uint64_t instructions{0};
+
+    /** CPU cycles. */
+    uint64_t cycles{0};
+
+    /** L1 data cache read misses. */
+    uint64_t cache_misses{0};
+
+    /** mispredicted branches. */
+    uint64_t branch_misses{0};
+
+    /** last level cache read accesses. */
+    uint64_t llc_loads{0};
+
+    /** last level cache read misses. */
+    uint64_t llc_load_misses{0};
+
+    /** default constructor. */
+    hardware_counters() = default;
+
+    /** reset counters to zero. */
+    void reset_counters()
+    {
+        instructions = 0;
+        cycles = 0;
+        cache_misses = 0;
+        branch_misses = 0;
+        llc_loads = 0;
+        llc_load_misses = 0;
+    }
+
+    /** add the counters of another data set. */
+    hardware_counters& operator+=(const hardware_counters& other)
+    {
+        instructions += other.instructions;
+        cycles += other.cycles;
+        cache_misses += other.cache_misses;
+        branch_misses += other.branch_misses;
+        llc_loads += other.llc_loads;
+        llc_load_misses += other.llc_load_misses;
+        return *this;
+    }
+};
+
+/** hardware counters of a single thread. */
+struct thread_hardware_counters
+{
+    /** sequential thread id, in order of the first measurement. */
+    uint32_t thread_id{0};
+
+    /** counters of each stage, indexed by hardware_stage. */
+    std::array<hardware_counters, static_cast<std::size_t>(hardware_stage::count)> stages{};
+};
+
+/** hardware counter data (per frame). */
+struct hardware_data
+{
+    /** whether the counters could be opened. */
+    bool available{false};
+
+    /** counters of the threads that measured any stage. */
+    std::vector<thread_hardware_counters> threads;
+};
+
+/**
+ * Enable or disable hardware performance counters. The counters are read through perf_event_open, which is only available
+ * on Linux and may be restricted by /proc/sys/kernel/perf_event_paranoid. Each thread opens its counters on its first
+ * measurement. Only available if the library is built with SWR_ENABLE_PERF_COUNTERS.
+ *
+ * \param enable Whether to enable the counters.
+ * \return Whether the counters are enabled, i.e., false if they are unavailable or if enable is false.
+ */
+bool enable_hardware_counters(bool enable);
+
+/** read the hardware counters of the last frame. if tracing is enabled, the per-stage totals are also written to the trace as counter tracks. */
+void get_hardware_data(hardware_data& data);
+
 } /* namespace stats */
 
 } /* namespace swr */
\ No newline at end of file
@@ -226,6 +226,26 @@ typedef void* context_handle;
  */
 void Present();
 
+/**
+ * Enable or disable deferred shading through a visibility buffer for subsequent calls to Present. Disabled by default.
+ *
+ * If enabled, triangles drawn into the default framebuffer are first only rasterized, storing the visible triangle
+ * for each pixel. Afterwards, each visible pixel is shaded once. This applies to triangles without blending and color
+ * mask, whose shader neither writes depth nor discards fragments (see program_base::is_depth_invariant). All other
+ * primitives are shaded immediately.
+ */
+void SetVisibilityBuffer(bool enable);
+
+/**
+ * Enable or disable front-to-back sorting of opaque draws for subsequent calls to Present. Disabled by default.
+ *
+ * If enabled, consecutive draw calls with depth testing (using comparison_func::less or comparison_func::less_equal)
+ * and depth writes enabled, without blending and with the same draw target are reordered by the nearest viewport depth
+ * of their clipped vertices, so that occluded fragments are rejected early. All other draw calls, including the ones
+ * counted by an occlusion query, keep their submission order and separate the sorted runs. Fragments with equal depth from different draw calls may resolve differently.
+ */
+void SetDepthSorting(bool enable);
+
 /*
  * Depth buffering and testing.
  */
@@ -266,6 +286,13 @@ void SetClearDepth(float z);
  */
 void ClearDepthBuffer();
 
+/**
+ * Mark the default depth buffer's contents as not needed after the next call to Present.
+ * The depth values computed while drawing are then not written back to the depth buffer.
+ * The request is dropped by the next call to Present, even if nothing was drawn.
+ */
+void DiscardDepthBuffer();
+
 /*
  * Color buffer.
  */
@@ -355,6 +382,19 @@ polygon_mode GetPolygonMode();
  */
 void PolygonOffset(float factor, float units);
 
+/**
+ * Set the size of rasterized points, in pixels. Points are rasterized as screen-aligned squares, and the
+ * fragment shader receives the fragment's position inside the square in gl_PointCoord. If state::program_point_size
+ * is enabled, the size written by the vertex shader is used instead.
+ * See https://registry.khronos.org/OpenGL-Refpages/gl4/html/glPointSize.xhtml
+ *
+ * \param size The point size. Has to be positive. The initial value is 1.
+ */
+void SetPointSize(float size);
+
+/** Return the current point size. */
+float GetPointSize();
+
 /*
  * Texturing.
  */
@@ -542,6 +582,22 @@ blend_func GetSourceBlendFunc();
 /** Return the blend function for the destination. */
 blend_func GetDestinationBlendFunc();
 
+/*
+ * Color Write Mask.
+ */
+
+/**
+ * Enable or disable writing of the individual color channels. The initial values are all true.
+ *
+ * If all channels are masked and the active shader neither writes depth nor discards fragments
+ * (see program_base::is_depth_invariant), triangles are rasterized in a depth-only mode
+ * which skips fragment shading and color merging.
+ */
+void SetColorMask(bool red, bool green, bool blue, bool alpha);
+
+/** Return the color write mask. */
+void GetColorMask(bool& red, bool& green, bool& blue, bool& alpha);
+
 /*
  * Scissor Test.
  */
@@ -569,6 +625,7 @@ enum class state
     depth_test,          /** Depth testing. Initially enabled. */
     depth_write,         /** Depth writing. Initially enabled. */
     polygon_offset_fill, /** Apply polygon offset to filled primitives. Initially disabled. */
+    program_point_size,  /** Use the point size written to gl_PointSize by the vertex shader. Initially disabled. */
     scissor_test,        /** Scissor test. Initially disabled. */
     texture,             /** Texturing. Initially disabled. */
 };
@@ -662,13 +719,22 @@ enum class framebuffer_attachment
  */
 void FramebufferTexture(uint32_t id, framebuffer_attachment attachment, uint32_t attachment_id, uint32_t level);
 
+/** depth buffer formats. */
+enum class depth_format
+{
+    depth16 = 0, /** 16-bit unsigned normalized depth values. */
+    depth24 = 1, /** 24-bit unsigned normalized depth values, stored in 32 bits. */
+    depth32 = 2  /** 32-bit fixed-point depth values. */
+};
+
 /**
  * Generate a depth render buffer of (at least) the requested size.
  * \param width the width of the depth buffer.
  * \param height the height of the depth buffer.
+ * \param format the format of the stored depth values.
  * \return Returns the id of the created depth buffer, and 0 on failure.
  */
-uint32_t CreateDepthRenderbuffer(uint32_t width, uint32_t height);
+uint32_t CreateDepthRenderbuffer(uint32_t width, uint32_t height, depth_format format = depth_format::depth32);
 
 /**
  * Release a depth renderbuffer.
@@ -684,6 +750,53 @@ void ReleaseDepthRenderbuffer(uint32_t id);
  */
 void FramebufferRenderbuffer(uint32_t id, framebuffer_attachment attachment, uint32_t attachment_id);
 
+/*
+ * Occlusion queries.
+ */
+
+/** query targets. */
+enum class query_target
+{
+    samples_passed,    /** count the fragments passing the depth test. */
+    any_samples_passed /** whether any fragment passed the depth test. */
+};
+
+/**
+ * Create a query object.
+ * \return Returns a positive id of the newly created query object.
+ */
+uint32_t CreateQuery();
+
+/**
+ * Release a query object. An active query is ended. If draw calls counted by the query were not presented yet,
+ * the id is not reused before the next call to Present.
+ * \param id The id of the query object to be released.
+ */
+void ReleaseQuery(uint32_t id);
+
+/**
+ * Start counting the fragments of subsequent draw calls that pass the scissor test, the fragment shader and the depth test.
+ * Only one query can be active at a time. Fragments are counted when the draw calls are rasterized by Present.
+ * A query that was ended cannot be started again before its result is available.
+ * \param target The query target.
+ * \param id The id of the query object.
+ */
+void BeginQuery(query_target target, uint32_t id);
+
+/**
+ * End the active query of a target. The result becomes available after the next call to Present.
+ * \param target The query target.
+ */
+void EndQuery(query_target target);
+
+/**
+ * Read the result of an ended query. For query_target::any_samples_passed, the result is 0 or 1.
+ * \param id The id of the query object.
+ * \param result Receives the result if it is available.
+ * \return Whether the result is available.
+ */
+bool GetQueryResult(uint32_t id, uint64_t& result);
+
 /*
  * Render contexts.
  */
@@ -695,12 +808,25 @@ void FramebufferRenderbuffer(uint32_t id, framebuffer_attachment attachment, uin
  * \param Window A valid SDL window.
  * \param Renderer A valid SDL renderer.
  * \param thread_hint A hint to the rasterizer how many threads to use.
+ * \param default_depth_format The format of the default depth buffer.
  * \return A rendering context that may be used for software rasterization.
  */
-context_handle CreateSDLContext(SDL_Window* Window, SDL_Renderer* Renderer, uint32_t thread_hint = 0);
+context_handle CreateSDLContext(SDL_Window* Window, SDL_Renderer* Renderer, uint32_t thread_hint = 0, depth_format default_depth_format = depth_format::depth32);
+
+/**
+ * Create a rendering context without a window. The context owns its color buffer, which uses
+ * the pixel format pixel_format::argb8888. CopyDefaultColorBuffer has no effect for such a context.
+ *
+ * \param width The width of the default framebuffer.
+ * \param height The height of the default framebuffer.
+ * \param thread_hint A hint to the rasterizer how many threads to use.
+ * \param default_depth_format The format of the default depth buffer.
+ * \return A rendering context that may be used for software rasterization, or nullptr if the dimensions are invalid.
+ */
+context_handle CreateOffscreenContext(uint32_t width, uint32_t height, uint32_t thread_hint = 0, depth_format default_depth_format = depth_format::depth32);
 
 /**
- * Destroy a context created with CreateSDLContext. Frees all memory associated to the context
+ * Destroy a context created with CreateSDLContext or CreateOffscreenContext. Frees all memory associated to the context
  * (e.g. color buffers, depth buffers, texture memory).
  *
  * \param Context A context to destroy.
@@ -714,6 +840,15 @@ void DestroyContext(context_handle Context);
  */
 bool MakeContextCurrent(context_handle Context);
 
+/**
+ * Get the number of threads used by a context's rasterizer. This may differ from the thread hint
+ * passed when creating the context.
+ *
+ * \param Context A valid context.
+ * \return The number of rasterizer threads.
+ */
+uint32_t GetThreadCount(context_handle Context);
+
 /**
  * Copies the contents of the default color buffer of the context into the active window.
  * \param Context The context to use for color buffer copying.
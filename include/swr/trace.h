@@ -0,0 +1,43 @@
+/**
+ * swr - a software rasterizer
+ *
+ * record trace events of the graphics pipeline.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+#pragma once
+
+namespace swr
+{
+
+namespace trace
+{
+
+/**
+ * Record trace events for a range of frames and write them to a file in the Chrome trace event format, which can
+ * be viewed with chrome://tracing or Perfetto. The events cover the pipeline stages and the thread pool tasks,
+ * together with the executing thread, the tile index and the primitive count where applicable.
+ *
+ * Frames are counted by calls to Present with pending draw calls, where frame 0 is drawn by the next such call.
+ * A capture that is already in progress is discarded. Tracing is only available if the library is built with SWR_ENABLE_TRACING.
+ *
+ * \param path The file to write the events to, after the last frame is drawn.
+ * \param first_frame The first frame to record.
+ * \param frame_count The number of frames to record.
+ * \return Whether the capture was started.
+ */
+bool capture_frames(const char* path, uint32_t first_frame, uint32_t frame_count);
+
+/**
+ * Stop a capture before its last frame is drawn and write the events recorded so far.
+ *
+ * \return Whether the file was written.
+ */
+bool stop_capture();
+
+} /* namespace trace */
+
+} /* namespace swr */
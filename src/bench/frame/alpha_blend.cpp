@@ -0,0 +1,207 @@
+/**
+ * swr - a software rasterizer
+ *
+ * alpha blending scene, see src/demos/alpha_blend.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <cmath>
+#include <vector>
+
+/* software rasterizer headers. */
+#include "swr/swr.h"
+#include "swr/shaders.h"
+
+/* png loading. */
+#include "lodepng.h"
+
+#include "scene.h"
+
+/* the demo's shaders. these are put into their own namespace, since the demos reuse class names. */
+namespace alpha_blend
+{
+#include "../../demos/alpha_blend/shader.h"
+} /* namespace alpha_blend */
+
+namespace bench
+{
+
+/** a textured cube inside a larger, blended cube. */
+class alpha_blend_scene : public scene
+{
+    /** color shader */
+    alpha_blend::shader::color color_shader;
+
+    /** texture shader */
+    alpha_blend::shader::texture texture_shader;
+
+    /** color shader id. */
+    uint32_t color_shader_id{0};
+
+    /** texture shader id. */
+    uint32_t texture_shader_id{0};
+
+    /** projection matrix. */
+    ml::mat4x4 proj;
+
+    /** the cube's vertices. */
+    uint32_t cube_verts{0};
+
+    /** the cube's indices. */
+    uint32_t cube_indices{0};
+
+    /** vertex colors. */
+    uint32_t cube_colors{0};
+
+    /** texture coordinates. */
+    uint32_t cube_uvs{0};
+
+    /** texture. */
+    uint32_t cube_tex{0};
+
+    /** a rotation offset for the cube. */
+    float cube_rotation{0};
+
+    /** draw a cube with the given shader and attribute buffer at attribute slot 1. */
+    void draw_cube(uint32_t shader_id, uint32_t attribute_buffer, ml::vec3 pos, float scale, float angle)
+    {
+        ml::mat4x4 view = ml::matrices::translation(pos.x, pos.y, pos.z);
+        view *= ml::matrices::scaling(scale);
+        view *= ml::matrices::rotation_y(angle);
+        view *= ml::matrices::rotation_z(2 * angle);
+        view *= ml::matrices::rotation_x(3 * angle);
+
+        swr::BindShader(shader_id);
+
+        swr::EnableAttributeBuffer(cube_verts, 0);
+        swr::EnableAttributeBuffer(attribute_buffer, 1);
+
+        swr::BindUniform(0, proj);
+        swr::BindUniform(1, view);
+
+        swr::DrawIndexedElements(cube_indices, swr::vertex_buffer_mode::triangles);
+
+        swr::DisableAttributeBuffer(attribute_buffer);
+        swr::DisableAttributeBuffer(cube_verts);
+
+        swr::BindShader(0);
+    }
+
+public:
+    bool create(const scene_config& config) override
+    {
+        swr::SetState(swr::state::cull_face, true);
+        swr::SetState(swr::state::depth_test, true);
+        swr::SetBlendFunc(swr::blend_func::src_alpha, swr::blend_func::one_minus_src_alpha);
+
+        color_shader_id = swr::RegisterShader(&color_shader, "alpha_blend.color");
+        texture_shader_id = swr::RegisterShader(&texture_shader, "alpha_blend.texture");
+        if(!color_shader_id || !texture_shader_id)
+        {
+            return false;
+        }
+
+        proj = ml::matrices::perspective_projection(static_cast<float>(config.width) / static_cast<float>(config.height), static_cast<float>(M_PI) / 2, 1.f, 10.f);
+
+        // load cube.
+        std::vector<uint32_t> indices = {
+#define FACE_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube.geom"
+#undef FACE_LIST
+        };
+        cube_indices = swr::CreateIndexBuffer(indices);
+
+        std::vector<ml::vec4> vertices = {
+#define VERTEX_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube.geom"
+#undef VERTEX_LIST
+        };
+        cube_verts = swr::CreateAttributeBuffer(vertices);
+
+        std::vector<ml::vec4> colors = {
+#define COLOR_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube.geom"
+#undef COLOR_LIST
+        };
+        cube_colors = swr::CreateAttributeBuffer(colors);
+
+        std::vector<ml::vec4> uvs = {
+#define UV_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube.geom"
+#undef UV_LIST
+        };
+        cube_uvs = swr::CreateAttributeBuffer(uvs);
+
+        // cube texture.
+        std::vector<uint8_t> img_data;
+        uint32_t w = 0, h = 0;
+        if(lodepng::decode(img_data, w, h, config.texture_path + "/crate1/crate1_diffuse.png") != 0)
+        {
+            return false;
+        }
+        cube_tex = swr::CreateTexture();
+        swr::SetImage(cube_tex, 0, w, h, swr::pixel_format::rgba8888, img_data);
+        swr::SetTextureWrapMode(cube_tex, swr::wrap_mode::repeat, swr::wrap_mode::mirrored_repeat);
+
+        return true;
+    }
+
+    void destroy() override
+    {
+        if(cube_tex)
+        {
+            swr::ReleaseTexture(cube_tex);
+            cube_tex = 0;
+        }
+        if(cube_indices)
+        {
+            swr::DeleteAttributeBuffer(cube_uvs);
+            swr::DeleteAttributeBuffer(cube_colors);
+            swr::DeleteAttributeBuffer(cube_verts);
+            swr::DeleteIndexBuffer(cube_indices);
+
+            cube_uvs = 0;
+            cube_colors = 0;
+            cube_verts = 0;
+            cube_indices = 0;
+        }
+
+        if(texture_shader_id)
+        {
+            swr::UnregisterShader(texture_shader_id);
+            texture_shader_id = 0;
+        }
+        if(color_shader_id)
+        {
+            swr::UnregisterShader(color_shader_id);
+            color_shader_id = 0;
+        }
+    }
+
+    void draw(float delta_time) override
+    {
+        cube_rotation += 0.2f * delta_time;
+        if(cube_rotation > 2 * static_cast<float>(M_PI))
+        {
+            cube_rotation -= 2 * static_cast<float>(M_PI);
+        }
+
+        swr::BindTexture(swr::texture_target::texture_2d, cube_tex);
+        draw_cube(texture_shader_id, cube_uvs, ml::vec3{0, 0, -7}, 1.0f, cube_rotation);
+
+        swr::SetState(swr::state::blend, true);
+        draw_cube(color_shader_id, cube_colors, ml::vec3{0, 0, -7}, 2.0f, -cube_rotation);
+        swr::SetState(swr::state::blend, false);
+    }
+};
+
+std::unique_ptr<scene> make_alpha_blend_scene()
+{
+    return std::make_unique<alpha_blend_scene>();
+}
+
+} /* namespace bench */
@@ -0,0 +1,113 @@
+/**
+ * swr - a software rasterizer
+ *
+ * fill test scene, see src/demos/fill_test.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <cmath>
+#include <vector>
+
+/* software rasterizer headers. */
+#include "swr/swr.h"
+#include "swr/shaders.h"
+
+/* triangle mesh */
+#include "../../demos/common/mesh.h"
+
+#include "scene.h"
+
+/* the demo's shaders. these are put into their own namespace, since the demos reuse class names. */
+namespace fill_test
+{
+#include "../../demos/fill_test/shader.h"
+} /* namespace fill_test */
+
+namespace bench
+{
+
+/**
+ * a rotating, colored mesh covering the whole viewport. unlike the demo, the mesh is a regular
+ * tiling, so that the same geometry is drawn in every run.
+ */
+class fill_test_scene : public scene
+{
+    /** mesh shader */
+    fill_test::shader::mesh_color mesh_shader;
+
+    /** mesh shader id. */
+    uint32_t mesh_shader_id{0};
+
+    /** projection matrix. */
+    ml::mat4x4 proj;
+
+    /** a rotation offset for the mesh. */
+    float mesh_rotation{1.4802573};
+
+    /** the mesh. */
+    mesh::mesh example_mesh;
+
+public:
+    bool create(const scene_config& config) override
+    {
+        swr::SetState(swr::state::cull_face, true);
+        swr::SetState(swr::state::depth_test, true);
+
+        mesh_shader_id = swr::RegisterShader(&mesh_shader, "fill_test.mesh_color");
+        if(!mesh_shader_id)
+        {
+            return false;
+        }
+
+        proj = ml::matrices::perspective_projection(static_cast<float>(config.width) / static_cast<float>(config.height), static_cast<float>(M_PI) / 2, 1.f, 10.f);
+
+        example_mesh = mesh::generate_tiling_mesh(-8, 8, -8, 8, 20, 20, 0);
+        example_mesh.upload();
+
+        return true;
+    }
+
+    void destroy() override
+    {
+        example_mesh.unload();
+
+        if(mesh_shader_id)
+        {
+            swr::UnregisterShader(mesh_shader_id);
+            mesh_shader_id = 0;
+        }
+    }
+
+    void draw(float delta_time) override
+    {
+        mesh_rotation += 0.2f * delta_time;
+        if(mesh_rotation > 2 * static_cast<float>(M_PI))
+        {
+            mesh_rotation -= 2 * static_cast<float>(M_PI);
+        }
+
+        ml::mat4x4 view = ml::mat4x4::identity();
+        view *= ml::matrices::rotation_z(mesh_rotation);
+        view *= ml::matrices::translation(0, 0, -2);
+
+        swr::BindShader(mesh_shader_id);
+
+        swr::BindUniform(0, proj);
+        swr::BindUniform(1, view);
+
+        example_mesh.render();
+
+        swr::BindShader(0);
+    }
+};
+
+std::unique_ptr<scene> make_fill_test_scene()
+{
+    return std::make_unique<fill_test_scene>();
+}
+
+} /* namespace bench */
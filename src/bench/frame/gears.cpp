@@ -0,0 +1,112 @@
+/**
+ * swr - a software rasterizer
+ *
+ * gears scene, see src/demos/gears.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <cmath>
+#include <vector>
+
+/* software rasterizer headers. */
+#include "swr/swr.h"
+#include "swr/shaders.h"
+
+#include "scene.h"
+
+/* the demo's shaders and geometry. these are put into their own namespace, since the demos reuse class names. */
+namespace gears
+{
+#include "../../demos/gears/shader.h"
+#include "../../demos/gears/gear.h"
+} /* namespace gears */
+
+namespace bench
+{
+
+/** three rotating gears with flat and smooth shading. */
+class gears_scene : public scene
+{
+    /** light position. */
+    ml::vec4 light_pos{5.0f, 5.0f, 10.0f, 0.0f};
+
+    /** projection matrix. */
+    ml::mat4x4 proj;
+
+    /** the gears. */
+    gears::gear_object gear_objects[3];
+
+    /** view rotation. */
+    ml::vec3 view_rotation = {20.f, 30.f, 0.f};
+
+    /** a rotation offset for the gears. */
+    float gear_rotation{0};
+
+public:
+    bool create(const scene_config& config) override
+    {
+        swr::SetState(swr::state::cull_face, true);
+        swr::SetState(swr::state::depth_test, true);
+
+        proj = ml::matrices::perspective_projection(static_cast<float>(config.width) / static_cast<float>(config.height), static_cast<float>(M_PI) / 8, 5.f, 60.f);
+
+        gear_objects[0].make_gear(1.0, 4.0, 1.0, 20, 0.7, {0.8f, 0.1f, 0.0f, 1.0f}, "red");
+        gear_objects[1].make_gear(0.5, 2.0, 2.0, 10, 0.7, {0.0f, 0.8f, 0.2f, 1.0f}, "green");
+        gear_objects[2].make_gear(1.3, 2.0, 0.5, 10, 0.7, {0.2f, 0.2f, 1.0f, 1.0f}, "blue");
+
+        return true;
+    }
+
+    void destroy() override
+    {
+        gear_objects[0].release();
+        gear_objects[1].release();
+        gear_objects[2].release();
+    }
+
+    void draw(float delta_time) override
+    {
+        gear_rotation += delta_time;
+        if(gear_rotation >= 2 * static_cast<float>(M_PI))
+        {
+            gear_rotation -= 2 * static_cast<float>(M_PI);
+        }
+
+        swr::BindUniform(0, proj);
+
+        ml::mat4x4 view = ml::mat4x4::identity();
+        view *= ml::matrices::translation(0.f, 0.f, -40.f);
+
+        swr::BindUniform(2, view * light_pos);
+
+        view *= ml::matrices::rotation_x(ml::to_radians(view_rotation.x));
+        view *= ml::matrices::rotation_y(ml::to_radians(view_rotation.y));
+        view *= ml::matrices::rotation_z(ml::to_radians(view_rotation.z));
+
+        const ml::vec3 offsets[3] = {{-3.f, -2.f, 0.f}, {3.1f, -2.f, 0.f}, {-3.1f, 4.2f, 0.f}};
+        const float angles[3] = {gear_rotation, -2.f * gear_rotation - 9.f, -2.f * gear_rotation - 25.f};
+
+        for(int i = 0; i < 3; ++i)
+        {
+            ml::mat4x4 temp = view;
+            temp *= ml::matrices::translation(offsets[i].x, offsets[i].y, offsets[i].z);
+            temp *= ml::matrices::rotation_z(angles[i]);
+
+            swr::BindUniform(1, temp);
+            gear_objects[i].draw();
+        }
+
+        swr::BindShader(0);
+    }
+};
+
+std::unique_ptr<scene> make_gears_scene()
+{
+    return std::make_unique<gears_scene>();
+}
+
+} /* namespace bench */
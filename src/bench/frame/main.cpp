@@ -0,0 +1,413 @@
+/**
+ * swr - a software rasterizer
+ *
+ * headless frame benchmark. renders the demo scenes into an offscreen context for a set of
+ * thread counts and writes the frame time statistics as JSON.
+ *
+ * usage:
+ *   bench_frame [--scenes=gears,fill_test,...] [--width=640] [--height=480] [--frames=100]
+ *               [--warmup=10] [--threads=1,2,4] [--model=file.obj] [--texture_path=../textures]
+ *               [--output=file.json]
+ *
+ * the entries of --threads are passed to the context as thread hints, and the number of threads the
+ * context actually uses is reported next to them. the first entry of --threads is the baseline for
+ * the reported speedup. fragment counts are only available if the library is built with SWR_ENABLE_STATS.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* format library */
+#include "fmt/format.h"
+
+/* software rasterizer headers. */
+#include "swr/swr.h"
+#include "swr/stats.h"
+
+#include "scene.h"
+
+namespace bench
+{
+
+/** benchmark parameters. */
+struct options
+{
+    /** scenes to render. */
+    std::vector<std::string> scenes{"gears", "fill_test", "alpha_blend", "normal_map", "obj_viewer"};
+
+    /** thread counts, passed as thread_hint to the context. */
+    std::vector<uint32_t> threads;
+
+    /** measured frames per run. */
+    uint32_t frames{100};
+
+    /** frames rendered before measuring. */
+    uint32_t warmup{10};
+
+    /** output file. writes to stdout if empty. */
+    std::string output;
+
+    /** scene parameters. */
+    scene_config config;
+};
+
+/** results of rendering a scene with a given thread count. */
+struct run_result
+{
+    /** thread hint. */
+    uint32_t thread_hint{0};
+
+    /** number of threads used by the context. */
+    uint32_t threads{0};
+
+    /** frame times, in milliseconds. */
+    std::vector<double> frame_times;
+
+    /** total fragment count of all measured frames. */
+    uint64_t fragments{0};
+};
+
+/** split a comma-separated list. */
+static std::vector<std::string> split(const std::string& s)
+{
+    std::vector<std::string> items;
+
+    std::size_t begin = 0;
+    while(begin <= s.size())
+    {
+        auto end = s.find(',', begin);
+        if(end == std::string::npos)
+        {
+            end = s.size();
+        }
+
+        if(end > begin)
+        {
+            items.push_back(s.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+
+    return items;
+}
+
+/** parse the command line. returns false on unknown or malformed arguments. */
+static bool parse_arguments(int argc, char* argv[], options& opts)
+{
+    try
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            auto separator = arg.find('=');
+            if(arg.rfind("--", 0) != 0 || separator == std::string::npos)
+            {
+                return false;
+            }
+
+            std::string name = arg.substr(2, separator - 2);
+            std::string value = arg.substr(separator + 1);
+
+            if(name == "scenes")
+            {
+                opts.scenes = split(value);
+            }
+            else if(name == "threads")
+            {
+                opts.threads.clear();
+                for(auto& it: split(value))
+                {
+                    opts.threads.push_back(std::stoul(it));
+                }
+            }
+            else if(name == "width")
+            {
+                opts.config.width = std::stoi(value);
+            }
+            else if(name == "height")
+            {
+                opts.config.height = std::stoi(value);
+            }
+            else if(name == "frames")
+            {
+                opts.frames = std::stoul(value);
+            }
+            else if(name == "warmup")
+            {
+                opts.warmup = std::stoul(value);
+            }
+            else if(name == "model")
+            {
+                opts.config.model_file = value;
+            }
+            else if(name == "texture_path")
+            {
+                opts.config.texture_path = value;
+            }
+            else if(name == "output")
+            {
+                opts.output = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+    catch(std::exception&)
+    {
+        return false;
+    }
+
+    return opts.config.width > 0 && opts.config.height > 0 && opts.frames > 0;
+}
+
+/** default thread counts: powers of two up to the hardware concurrency. */
+static std::vector<uint32_t> default_thread_counts()
+{
+    std::vector<uint32_t> counts;
+
+    uint32_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for(uint32_t t = 1; t < max_threads; t *= 2)
+    {
+        counts.push_back(t);
+    }
+    counts.push_back(max_threads);
+
+    return counts;
+}
+
+/** create a scene by name. */
+static std::unique_ptr<scene> make_scene(const std::string& name)
+{
+    if(name == "gears")
+    {
+        return make_gears_scene();
+    }
+    if(name == "fill_test")
+    {
+        return make_fill_test_scene();
+    }
+    if(name == "alpha_blend")
+    {
+        return make_alpha_blend_scene();
+    }
+    if(name == "normal_map")
+    {
+        return make_normal_map_scene();
+    }
+    if(name == "obj_viewer")
+    {
+        return make_obj_viewer_scene();
+    }
+    return nullptr;
+}
+
+/** render a scene with the given thread hint. returns false if the context or the scene could not be created. */
+static bool run_scene(const std::string& name, uint32_t threads, const options& opts, run_result& result)
+{
+    auto context = swr::CreateOffscreenContext(opts.config.width, opts.config.height, threads);
+    if(!context)
+    {
+        return false;
+    }
+
+    if(!swr::MakeContextCurrent(context))
+    {
+        swr::DestroyContext(context);
+        return false;
+    }
+
+    swr::SetClearColor(0, 0, 0, 0);
+    swr::SetClearDepth(1.0f);
+    swr::SetViewport(0, 0, opts.config.width, opts.config.height);
+
+    auto s = make_scene(name);
+    bool created = s && s->create(opts.config);
+
+    if(created)
+    {
+        // advance the animation by a fixed time step, so that all runs render the same frames.
+        const float delta_time = 1.0f / 60.0f;
+
+        result.thread_hint = threads;
+        result.threads = swr::GetThreadCount(context);
+        result.frame_times.reserve(opts.frames);
+
+        for(uint32_t i = 0; i < opts.warmup + opts.frames; ++i)
+        {
+            auto frame_begin = std::chrono::steady_clock::now();
+
+            swr::ClearColorBuffer();
+            swr::ClearDepthBuffer();
+            s->draw(delta_time);
+            swr::Present();
+
+            auto frame_end = std::chrono::steady_clock::now();
+
+            if(i >= opts.warmup)
+            {
+                result.frame_times.push_back(std::chrono::duration<double, std::milli>(frame_end - frame_begin).count());
+
+#ifdef SWR_ENABLE_STATS
+                swr::stats::fragment_data frag_data;
+                swr::stats::get_fragment_data(frag_data);
+                result.fragments += frag_data.count;
+#endif
+            }
+        }
+    }
+
+    if(s)
+    {
+        s->destroy();
+    }
+
+    swr::MakeContextCurrent(nullptr);
+    swr::DestroyContext(context);
+
+    return created;
+}
+
+/** return the given percentile of sorted values, using the nearest rank. */
+static double percentile(const std::vector<double>& sorted_values, double p)
+{
+    if(sorted_values.empty())
+    {
+        return 0;
+    }
+
+    auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted_values.size()));
+    return sorted_values[std::clamp<std::size_t>(rank, 1, sorted_values.size()) - 1];
+}
+
+/** write the results of a scene as a JSON object. */
+static std::string format_scene(const std::string& name, const std::vector<run_result>& runs, const options& opts)
+{
+    const double pixels_per_frame = static_cast<double>(opts.config.width) * opts.config.height;
+
+    std::string runs_json;
+    double baseline_mean = 0;
+
+    for(const auto& it: runs)
+    {
+        auto sorted_times = it.frame_times;
+        std::sort(sorted_times.begin(), sorted_times.end());
+
+        double total_ms = 0;
+        for(auto t: sorted_times)
+        {
+            total_ms += t;
+        }
+        double mean = total_ms / sorted_times.size();
+
+        if(baseline_mean == 0)
+        {
+            baseline_mean = mean;
+        }
+
+#ifdef SWR_ENABLE_STATS
+        std::string fragments_per_second = fmt::format("{:.1f}", it.fragments / (total_ms * 1e-3));
+#else
+        std::string fragments_per_second = "null";
+#endif
+
+        runs_json += fmt::format(
+          R"({}{{"thread_hint":{},"threads":{},"mean_ms":{:.4f},"p50_ms":{:.4f},"p99_ms":{:.4f},"min_ms":{:.4f},"max_ms":{:.4f},"fps":{:.2f},"fragments_per_second":{},"pixels_per_second":{:.1f},"speedup":{:.3f}}})",
+          runs_json.empty() ? "" : ",",
+          it.thread_hint,
+          it.threads,
+          mean,
+          percentile(sorted_times, 50),
+          percentile(sorted_times, 99),
+          sorted_times.front(),
+          sorted_times.back(),
+          1000.0 / mean,
+          fragments_per_second,
+          pixels_per_frame * sorted_times.size() / (total_ms * 1e-3),
+          baseline_mean / mean);
+    }
+
+    return fmt::format(R"({{"name":"{}","runs":[{}]}})", name, runs_json);
+}
+
+} /* namespace bench */
+
+int main(int argc, char* argv[])
+{
+    bench::options opts;
+    if(!bench::parse_arguments(argc, argv, opts))
+    {
+        std::cerr << "usage: " << argv[0] << " [--scenes=a,b,...] [--width=w] [--height=h] [--frames=n] [--warmup=n] [--threads=t0,t1,...] [--model=file.obj] [--texture_path=path] [--output=file.json]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if(opts.threads.empty())
+    {
+        opts.threads = bench::default_thread_counts();
+    }
+
+    std::string scenes_json;
+    for(const auto& name: opts.scenes)
+    {
+        std::vector<bench::run_result> runs;
+
+        for(auto threads: opts.threads)
+        {
+            bench::run_result result;
+            if(!bench::run_scene(name, threads, opts, result))
+            {
+                std::cerr << fmt::format("skipping scene '{}': scene could not be created.", name) << std::endl;
+                runs.clear();
+                break;
+            }
+
+            runs.push_back(std::move(result));
+        }
+
+        if(!runs.empty())
+        {
+            scenes_json += fmt::format("{}\n    {}", scenes_json.empty() ? "" : ",", bench::format_scene(name, runs, opts));
+        }
+    }
+
+    std::string json = fmt::format(
+      "{{\n  \"width\":{},\n  \"height\":{},\n  \"frames\":{},\n  \"warmup\":{},\n  \"hardware_concurrency\":{},\n  \"scenes\":[{}\n  ]\n}}\n",
+      opts.config.width,
+      opts.config.height,
+      opts.frames,
+      opts.warmup,
+      std::thread::hardware_concurrency(),
+      scenes_json);
+
+    if(opts.output.empty())
+    {
+        std::cout << json;
+    }
+    else
+    {
+        std::ofstream out{opts.output};
+        out << json;
+        if(!out)
+        {
+            std::cerr << fmt::format("could not write '{}'.", opts.output) << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,220 @@
+/**
+ * swr - a software rasterizer
+ *
+ * normal mapping scene, see src/demos/normal_map.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <cmath>
+#include <vector>
+
+/* software rasterizer headers. */
+#include "swr/swr.h"
+#include "swr/shaders.h"
+
+/* png loading. */
+#include "lodepng.h"
+
+#include "scene.h"
+
+/* the demo's shaders. these are put into their own namespace, since the demos reuse class names. */
+namespace normal_map
+{
+#include "../../demos/normal_map/shader.h"
+} /* namespace normal_map */
+
+namespace bench
+{
+
+/** a rotating cube with a diffuse texture and a normal map, lit by a moving light. */
+class normal_map_scene : public scene
+{
+    /** normal mapping shader */
+    normal_map::shader::normal_mapping shader;
+
+    /** normal mapping shader id. */
+    uint32_t shader_id{0};
+
+    /** projection matrix. */
+    ml::mat4x4 proj;
+
+    /** the cube's indices. */
+    uint32_t cube_indices{0};
+
+    /** vertices, normals, tangents, bitangents and texture coordinates, in the order of the attribute slots. */
+    uint32_t cube_attributes[5] = {0, 0, 0, 0, 0};
+
+    /** texture. */
+    uint32_t cube_tex{0};
+
+    /** normal map. */
+    uint32_t cube_normal_map{0};
+
+    /** a rotation offset for the cube. */
+    float cube_rotation{0};
+
+    /** light position. */
+    ml::vec4 light_position{0, 0, 0, 1};
+
+    /** load a texture. returns 0 on failure. */
+    static uint32_t load_texture(const std::string& filename)
+    {
+        std::vector<uint8_t> img_data;
+        uint32_t w = 0, h = 0;
+        if(lodepng::decode(img_data, w, h, filename) != 0)
+        {
+            return 0;
+        }
+
+        uint32_t tex = swr::CreateTexture();
+        swr::SetImage(tex, 0, w, h, swr::pixel_format::rgba8888, img_data);
+        swr::SetTextureWrapMode(tex, swr::wrap_mode::repeat, swr::wrap_mode::mirrored_repeat);
+        return tex;
+    }
+
+public:
+    bool create(const scene_config& config) override
+    {
+        swr::SetState(swr::state::cull_face, true);
+        swr::SetState(swr::state::depth_test, true);
+
+        shader_id = swr::RegisterShader(&shader, "normal_map.normal_mapping");
+        if(!shader_id)
+        {
+            return false;
+        }
+
+        proj = ml::matrices::perspective_projection(static_cast<float>(config.width) / static_cast<float>(config.height), static_cast<float>(M_PI) / 2, 1.f, 10.f);
+
+        // load cube.
+        std::vector<uint32_t> indices = {
+#define FACE_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube_uniform_uv.geom"
+#undef FACE_LIST
+        };
+        cube_indices = swr::CreateIndexBuffer(indices);
+
+        std::vector<ml::vec4> vertices = {
+#define VERTEX_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube_uniform_uv.geom"
+#undef VERTEX_LIST
+        };
+        cube_attributes[0] = swr::CreateAttributeBuffer(vertices);
+
+        std::vector<ml::vec4> normals = {
+#define NORMAL_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube_uniform_uv.geom"
+#undef NORMAL_LIST
+        };
+        cube_attributes[1] = swr::CreateAttributeBuffer(normals);
+
+        std::vector<ml::vec4> tangents = {
+#define TANGENT_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube_uniform_uv.geom"
+#undef TANGENT_LIST
+        };
+        cube_attributes[2] = swr::CreateAttributeBuffer(tangents);
+
+        std::vector<ml::vec4> bitangents = {
+#define BITANGENT_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube_uniform_uv.geom"
+#undef BITANGENT_LIST
+        };
+        cube_attributes[3] = swr::CreateAttributeBuffer(bitangents);
+
+        std::vector<ml::vec4> uvs = {
+#define UV_LIST(...) __VA_ARGS__
+#include "../../demos/common/cube_uniform_uv.geom"
+#undef UV_LIST
+        };
+        cube_attributes[4] = swr::CreateAttributeBuffer(uvs);
+
+        cube_tex = load_texture(config.texture_path + "/stone/256/ft_stone01_c.png");
+        cube_normal_map = load_texture(config.texture_path + "/stone/256/ft_stone01_n.png");
+
+        return cube_tex != 0 && cube_normal_map != 0;
+    }
+
+    void destroy() override
+    {
+        if(cube_normal_map)
+        {
+            swr::ReleaseTexture(cube_normal_map);
+            cube_normal_map = 0;
+        }
+        if(cube_tex)
+        {
+            swr::ReleaseTexture(cube_tex);
+            cube_tex = 0;
+        }
+        if(cube_indices)
+        {
+            for(auto& it: cube_attributes)
+            {
+                swr::DeleteAttributeBuffer(it);
+                it = 0;
+            }
+            swr::DeleteIndexBuffer(cube_indices);
+            cube_indices = 0;
+        }
+
+        if(shader_id)
+        {
+            swr::UnregisterShader(shader_id);
+            shader_id = 0;
+        }
+    }
+
+    void draw(float delta_time) override
+    {
+        cube_rotation += 0.1f * delta_time;
+        if(cube_rotation > 2 * static_cast<float>(M_PI))
+        {
+            cube_rotation -= 2 * static_cast<float>(M_PI);
+        }
+        light_position = ml::vec4{4 * std::cos(4 * cube_rotation), 4 * std::sin(4 * cube_rotation), -1};
+
+        ml::mat4x4 view = ml::matrices::translation(0, 0, -6);
+        view *= ml::matrices::scaling(2.0f);
+        view *= ml::matrices::rotation_y(cube_rotation);
+        view *= ml::matrices::rotation_z(2 * cube_rotation);
+        view *= ml::matrices::rotation_x(3 * cube_rotation);
+
+        swr::BindShader(shader_id);
+
+        for(uint32_t i = 0; i < 5; ++i)
+        {
+            swr::EnableAttributeBuffer(cube_attributes[i], i);
+        }
+
+        swr::BindUniform(0, proj);
+        swr::BindUniform(1, view);
+        swr::BindUniform(2, light_position);
+
+        swr::ActiveTexture(swr::texture_0);
+        swr::BindTexture(swr::texture_target::texture_2d, cube_tex);
+
+        swr::ActiveTexture(swr::texture_1);
+        swr::BindTexture(swr::texture_target::texture_2d, cube_normal_map);
+
+        swr::DrawIndexedElements(cube_indices, swr::vertex_buffer_mode::triangles);
+
+        for(auto it: cube_attributes)
+        {
+            swr::DisableAttributeBuffer(it);
+        }
+
+        swr::BindShader(0);
+    }
+};
+
+std::unique_ptr<scene> make_normal_map_scene()
+{
+    return std::make_unique<normal_map_scene>();
+}
+
+} /* namespace bench */
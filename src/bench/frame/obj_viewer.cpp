@@ -0,0 +1,244 @@
+/**
+ * swr - a software rasterizer
+ *
+ * .obj model scene, see src/demos/obj_viewer.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/* software rasterizer headers. */
+#include "swr/swr.h"
+#include "swr/shaders.h"
+
+/* .obj loading. */
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+
+#include "scene.h"
+
+/* the demo's shaders. these are put into their own namespace, since the demos reuse class names. */
+namespace obj_viewer
+{
+#include "../../demos/obj_viewer/shader.h"
+} /* namespace obj_viewer */
+
+namespace bench
+{
+
+/**
+ * a model loaded from an .obj file, drawn with flat colors and a wireframe overlay, and viewed
+ * from a rotating camera. textures are not loaded, since the demo's shaders do not sample them.
+ */
+class obj_viewer_scene : public scene
+{
+    /** flat color shader. */
+    obj_viewer::shader::color_flat flat_shader;
+
+    /** wireframe shader. */
+    obj_viewer::shader::wireframe wireframe_shader;
+
+    /** flat color shader id. */
+    uint32_t flat_shader_id{0};
+
+    /** wireframe shader id. */
+    uint32_t wireframe_shader_id{0};
+
+    /** vertex buffer id. */
+    uint32_t vertex_buffer_id{0};
+
+    /** color buffer id. */
+    uint32_t color_buffer_id{0};
+
+    /** triangle count. */
+    std::size_t triangle_count{0};
+
+    /** projection matrix. */
+    ml::mat4x4 proj;
+
+    /** scale factor, so that the model fits into the unit cube. */
+    float scale_factor{1.0f};
+
+    /** center of the model's bounding box. */
+    ml::vec3 center;
+
+    /** camera rotation. */
+    float angle{0};
+
+    /** load the model and upload the vertex positions and colors. */
+    bool load_model(const std::string& filename)
+    {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+
+        auto separator_pos = filename.find_last_of("/\\");
+        std::string base_dir = (separator_pos != std::string::npos) ? filename.substr(0, separator_pos) : std::string{};
+
+        if(!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.c_str(), base_dir.c_str()))
+        {
+            return false;
+        }
+
+        std::vector<ml::vec4> vertices, colors;
+
+        ml::vec3 bmin{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+        ml::vec3 bmax{-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+
+        for(const auto& shape: shapes)
+        {
+            for(std::size_t f = 0; f + 2 < shape.mesh.indices.size(); f += 3)
+            {
+                ml::vec3 v[3];
+                for(int k = 0; k < 3; ++k)
+                {
+                    const auto index = shape.mesh.indices[f + k].vertex_index;
+                    v[k] = {attrib.vertices[3 * index], attrib.vertices[3 * index + 1], attrib.vertices[3 * index + 2]};
+
+                    for(int i = 0; i < 3; ++i)
+                    {
+                        bmin[i] = std::min(v[k][i], bmin[i]);
+                        bmax[i] = std::max(v[k][i], bmax[i]);
+                    }
+                }
+
+                // combine the face normal and the diffuse material color, as the demo does.
+                ml::vec3 diffuse{0.5f, 0.5f, 0.5f};
+                const auto material_id = shape.mesh.material_ids.empty() ? -1 : shape.mesh.material_ids[f / 3];
+                if(material_id >= 0 && static_cast<std::size_t>(material_id) < materials.size())
+                {
+                    diffuse = {materials[material_id].diffuse[0], materials[material_id].diffuse[1], materials[material_id].diffuse[2]};
+                }
+
+                ml::vec3 n = (v[1] - v[0]).cross_product(v[2] - v[0]);
+                if(n.length_squared() > 0)
+                {
+                    n.normalize();
+                }
+
+                ml::vec3 c = n * 0.2f + diffuse * 0.8f;
+                if(c.length_squared() > 0)
+                {
+                    c.normalize();
+                }
+
+                for(int k = 0; k < 3; ++k)
+                {
+                    vertices.emplace_back(v[k], 1.f);
+                    colors.push_back(ml::vec4(c, 0.f) * 0.5f + 0.5f);
+                }
+            }
+        }
+
+        if(vertices.empty())
+        {
+            return false;
+        }
+
+        triangle_count = vertices.size() / 3;
+        vertex_buffer_id = swr::CreateAttributeBuffer(vertices);
+        color_buffer_id = swr::CreateAttributeBuffer(colors);
+
+        float max_extent = 0.5f * std::max({bmax[0] - bmin[0], bmax[1] - bmin[1], bmax[2] - bmin[2]});
+        if(max_extent > 0)
+        {
+            scale_factor = 1.0f / max_extent;
+        }
+        center = (bmin + bmax) * 0.5f;
+
+        return true;
+    }
+
+public:
+    bool create(const scene_config& config) override
+    {
+        swr::SetState(swr::state::cull_face, true);
+        swr::SetState(swr::state::depth_test, true);
+
+        flat_shader_id = swr::RegisterShader(&flat_shader, "obj_viewer.color_flat");
+        wireframe_shader_id = swr::RegisterShader(&wireframe_shader, "obj_viewer.wireframe");
+        if(!flat_shader_id || !wireframe_shader_id)
+        {
+            return false;
+        }
+
+        proj = ml::matrices::perspective_projection(static_cast<float>(config.width) / static_cast<float>(config.height), static_cast<float>(M_PI) / 4, 0.01f, 100.f);
+
+        return !config.model_file.empty() && load_model(config.model_file);
+    }
+
+    void destroy() override
+    {
+        if(vertex_buffer_id)
+        {
+            swr::DeleteAttributeBuffer(color_buffer_id);
+            swr::DeleteAttributeBuffer(vertex_buffer_id);
+
+            color_buffer_id = 0;
+            vertex_buffer_id = 0;
+            triangle_count = 0;
+        }
+
+        if(wireframe_shader_id)
+        {
+            swr::UnregisterShader(wireframe_shader_id);
+            wireframe_shader_id = 0;
+        }
+        if(flat_shader_id)
+        {
+            swr::UnregisterShader(flat_shader_id);
+            flat_shader_id = 0;
+        }
+    }
+
+    void draw(float delta_time) override
+    {
+        angle += delta_time * 0.2f;
+
+        ml::mat4x4 view = ml::matrices::look_at(
+          {3 * std::sin(angle), 1, 3 * std::cos(angle)},
+          {0, 0, 0},
+          {0, 1, 0});
+        view *= ml::matrices::scaling(scale_factor);
+        view *= ml::matrices::translation(-center[0], -center[1], -center[2]);
+
+        // filled model.
+        swr::SetPolygonMode(swr::polygon_mode::fill);
+        swr::SetState(swr::state::polygon_offset_fill, true);
+        swr::PolygonOffset(1.0, 1.0);
+
+        swr::BindShader(flat_shader_id);
+        swr::BindUniform(0, proj);
+        swr::BindUniform(1, view);
+
+        swr::EnableAttributeBuffer(vertex_buffer_id, 0);
+        swr::EnableAttributeBuffer(color_buffer_id, 2);
+        swr::DrawElements(3 * triangle_count, swr::vertex_buffer_mode::triangles);
+        swr::DisableAttributeBuffer(color_buffer_id);
+
+        // wireframe.
+        swr::SetPolygonMode(swr::polygon_mode::line);
+        swr::SetState(swr::state::polygon_offset_fill, false);
+
+        swr::BindShader(wireframe_shader_id);
+        swr::DrawElements(3 * triangle_count, swr::vertex_buffer_mode::triangles);
+        swr::DisableAttributeBuffer(vertex_buffer_id);
+
+        swr::BindShader(0);
+    }
+};
+
+std::unique_ptr<scene> make_obj_viewer_scene()
+{
+    return std::make_unique<obj_viewer_scene>();
+}
+
+} /* namespace bench */
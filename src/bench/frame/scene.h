@@ -0,0 +1,67 @@
+/**
+ * swr - a software rasterizer
+ *
+ * scenes for the headless frame benchmark.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+#pragma once
+
+/* C++ headers. */
+#include <memory>
+#include <string>
+
+namespace bench
+{
+
+/** scene parameters. */
+struct scene_config
+{
+    /** viewport width. */
+    int width{640};
+
+    /** viewport height. */
+    int height{480};
+
+    /** directory containing the demo textures. */
+    std::string texture_path{"../textures"};
+
+    /** .obj file for the obj_viewer scene. */
+    std::string model_file;
+};
+
+/**
+ * a scene rendered by the benchmark. the scenes are created and drawn with the context made
+ * current by the benchmark, and draw the same frames as the corresponding demos, with the
+ * animation advanced by a fixed time step per frame.
+ */
+class scene
+{
+public:
+    /** virtual destructor. */
+    virtual ~scene() = default;
+
+    /** upload the scene's resources and set up the render states. returns false if a resource could not be loaded. */
+    virtual bool create(const scene_config& config) = 0;
+
+    /** free the scene's resources. */
+    virtual void destroy() = 0;
+
+    /** issue the draw calls for a frame. clearing the buffers and Present are handled by the caller. */
+    virtual void draw(float delta_time) = 0;
+};
+
+/*
+ * scene factories.
+ */
+
+std::unique_ptr<scene> make_gears_scene();
+std::unique_ptr<scene> make_fill_test_scene();
+std::unique_ptr<scene> make_alpha_blend_scene();
+std::unique_ptr<scene> make_normal_map_scene();
+std::unique_ptr<scene> make_obj_viewer_scene();
+
+} /* namespace bench */
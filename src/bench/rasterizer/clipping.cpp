@@ -0,0 +1,74 @@
+/**
+ * swr - a software rasterizer
+ *
+ * triangle clipping benchmarks.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* Google benchmark */
+#include <benchmark/benchmark.h>
+
+/* user headers. */
+#include "swr_internal.h"
+#include "clipping.h"
+
+/** number of triangles to clip. */
+constexpr std::uint32_t triangle_count = 4096;
+
+/**
+ * clip a triangle list in which the given percentage of triangles crosses the right clipping plane.
+ * the remaining triangles are inside the view frustum and are copied to the output unchanged.
+ */
+static void bench_clip_triangle_buffer(benchmark::State& state)
+{
+    const std::uint32_t crossing_percentage = state.range(0);
+
+    // render_object setup.
+    swr::impl::render_object obj;
+    obj.allocate_coords(triangle_count * 3);
+    obj.indices.reserve(triangle_count * 3);
+    for(std::uint32_t i = 0; i < triangle_count * 3; ++i)
+    {
+        obj.indices.push_back(i);
+    }
+    obj.vertex_flags.resize(triangle_count * 3);
+
+    swr::impl::program_info info;
+    obj.states.shader_info = &info;
+
+    for(std::uint32_t i = 0; i < triangle_count; ++i)
+    {
+        const float offset = static_cast<float>(i % 64) / 128.0f;
+        const bool crossing = (i % 100) < crossing_percentage;
+
+        obj.coords[i * 3] = ml::vec4{-0.5f + offset, -0.5f, 0.5f, 1.0f};
+        obj.coords[i * 3 + 1] = ml::vec4{crossing ? 1.5f : 0.5f, -0.5f + offset, 0.5f, 1.0f};
+        obj.coords[i * 3 + 2] = ml::vec4{-0.5f, 0.5f, 0.5f - offset, 1.0f};
+    }
+
+    // set the clipping markers the same way the vertex shading stage does.
+    for(std::uint32_t i = 0; i < triangle_count * 3; ++i)
+    {
+        if(obj.coords[i].x < -obj.coords[i].w || obj.coords[i].x > obj.coords[i].w
+           || obj.coords[i].y < -obj.coords[i].w || obj.coords[i].y > obj.coords[i].w
+           || obj.coords[i].z < -obj.coords[i].w || obj.coords[i].z > obj.coords[i].w
+           || obj.coords[i].w <= 0)
+        {
+            obj.vertex_flags[i] |= geom::vf_clip_discard;
+        }
+    }
+
+    swr::impl::vertex_buffer clipped_vertices;
+    for(auto _: state)
+    {
+        clipped_vertices.clear();
+        swr::impl::clip_triangle_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::triangle_list, clipped_vertices);
+        benchmark::DoNotOptimize(clipped_vertices.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * triangle_count);
+}
+BENCHMARK(bench_clip_triangle_buffer)->ArgName("crossing_percentage")->Arg(0)->Arg(10)->Arg(100);
@@ -0,0 +1,61 @@
+/**
+ * swr - a software rasterizer
+ *
+ * coverage mask benchmarks.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* Google benchmark */
+#include <benchmark/benchmark.h>
+
+/* user headers. */
+#include "swr_internal.h"
+
+/**
+ * step through the blocks of a square region, in the same order as the triangle setup does. the
+ * edge functions belong to the triangle (0,0), (size,0), (0,size), so that the region contains
+ * blocks outside, inside and on the edges of the triangle.
+ */
+static void bench_coverage_stepping(benchmark::State& state)
+{
+    const int size = state.range(0);
+    const int block_size = swr::impl::rasterizer_block_size;
+
+    // edge functions, evaluated at the top-left corner of the region.
+    const ml::fixed_24_8_t lambda0{0}, lambda1{0}, lambda2{size};
+    const ml::tvec2<ml::fixed_24_8_t> step0{0, 1}, step1{1, 0}, step2{-1, -1};
+
+    for(auto _: state)
+    {
+        geom::barycentric_coordinate_block row{
+          lambda0, step0,
+          lambda1, step1,
+          lambda2, step2};
+        row.setup(block_size, block_size);
+
+        int covered = 0;
+        for(int y = 0; y < size; y += block_size)
+        {
+            geom::barycentric_coordinate_block block = row;
+            for(int x = 0; x < size; x += block_size)
+            {
+                int mask = block.get_coverage_mask();
+                if(mask)
+                {
+                    covered += geom::reduce_coverage_mask(mask) == 0xf;
+                }
+                block.step_x(block_size);
+            }
+            row.step_y(block_size);
+        }
+
+        benchmark::DoNotOptimize(covered);
+    }
+
+    const auto blocks_per_side = (size + block_size - 1) / block_size;
+    state.SetItemsProcessed(state.iterations() * blocks_per_side * blocks_per_side);
+}
+BENCHMARK(bench_coverage_stepping)->Arg(16)->Arg(64)->Arg(256);
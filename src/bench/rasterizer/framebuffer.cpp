@@ -0,0 +1,98 @@
+/**
+ * swr - a software rasterizer
+ *
+ * depth test and color merging benchmarks.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <vector>
+
+/* Google benchmark */
+#include <benchmark/benchmark.h>
+
+/* user headers. */
+#include "swr_internal.h"
+
+/** framebuffer width and height. */
+constexpr int framebuffer_size = 256;
+
+/**
+ * run the depth test on all 4x4 blocks of the framebuffer. the new depth values alternate between
+ * passing and failing the test, so that the write masks are mixed. the passing values are written,
+ * and keep passing in later iterations.
+ */
+static void bench_depth_compare_write_block(benchmark::State& state)
+{
+    const auto format = static_cast<swr::depth_format>(state.range(0));
+
+    swr::impl::default_framebuffer fb;
+    fb.setup(framebuffer_size, framebuffer_size, 0, swr::pixel_format::argb8888, nullptr, format);
+    fb.clear_depth(0.5f);
+
+    float depth_value[16];
+    for(int k = 0; k < 16; ++k)
+    {
+        depth_value[k] = (k & 1) ? 0.25f : 0.75f;
+    }
+
+    for(auto _: state)
+    {
+        for(int y = 0; y < framebuffer_size; y += 4)
+        {
+            for(int x = 0; x < framebuffer_size; x += 4)
+            {
+                std::uint32_t write_mask = 0xffff;
+                fb.depth_compare_write_block(x, y, depth_value, swr::comparison_func::less_equal, true, write_mask);
+                benchmark::DoNotOptimize(write_mask);
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * framebuffer_size * framebuffer_size);
+}
+BENCHMARK(bench_depth_compare_write_block)
+  ->Arg(static_cast<int>(swr::depth_format::depth16))
+  ->Arg(static_cast<int>(swr::depth_format::depth24))
+  ->Arg(static_cast<int>(swr::depth_format::depth32));
+
+/** merge 2x2 blocks into all pixels of the color buffer, optionally with alpha blending. */
+static void bench_merge_color_block(benchmark::State& state)
+{
+    const bool do_blend = state.range(0) != 0;
+
+    std::vector<std::uint32_t> buffer(framebuffer_size * framebuffer_size, 0x80402010);
+
+    swr::impl::default_framebuffer fb;
+    fb.setup(framebuffer_size, framebuffer_size, framebuffer_size * sizeof(std::uint32_t), swr::pixel_format::argb8888, buffer.data());
+
+    swr::output_merger::blend_kernels kernels;
+    if(do_blend)
+    {
+        kernels.select(swr::blend_func::src_alpha, swr::blend_func::one_minus_src_alpha);
+    }
+
+    swr::impl::fragment_output_block frag{0xf};
+    frag.color[0] = {1.0f, 0.0f, 0.0f, 0.5f};
+    frag.color[1] = {0.0f, 1.0f, 0.0f, 0.5f};
+    frag.color[2] = {0.0f, 0.0f, 1.0f, 0.5f};
+    frag.color[3] = {1.0f, 1.0f, 1.0f, 0.5f};
+
+    for(auto _: state)
+    {
+        for(int y = 0; y < framebuffer_size; y += 2)
+        {
+            for(int x = 0; x < framebuffer_size; x += 2)
+            {
+                fb.merge_color_block(0, x, y, frag, do_blend, kernels, swr::output_merger::color_mask::all);
+            }
+        }
+    }
+
+    benchmark::DoNotOptimize(buffer.data());
+    state.SetItemsProcessed(state.iterations() * framebuffer_size * framebuffer_size);
+}
+BENCHMARK(bench_merge_color_block)->ArgName("blend")->Arg(0)->Arg(1);
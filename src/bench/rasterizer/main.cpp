@@ -0,0 +1,14 @@
+/**
+ * swr - a software rasterizer
+ *
+ * rasterizer kernel benchmarks. the benchmarks are registered in the other source files of this directory.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* Google benchmark */
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
@@ -0,0 +1,106 @@
+/**
+ * swr - a software rasterizer
+ *
+ * texture sampling benchmarks.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <vector>
+
+/* Google benchmark */
+#include <benchmark/benchmark.h>
+
+/* user headers. */
+#include "swr_internal.h"
+
+#include "libmorton/morton.h"
+
+/** texture width and height. */
+constexpr int texture_size = 256;
+
+/**
+ * sample every texel of a texture once, with the texture mapped one-to-one onto the pixels. the
+ * texture memory layout is chosen when the library is built (see SWR_USE_MORTON_CODES) and is
+ * reported in the benchmark label.
+ */
+static void bench_sampler_2d(benchmark::State& state)
+{
+    const auto filter = static_cast<swr::texture_filter>(state.range(0));
+
+    std::vector<std::uint8_t> data(texture_size * texture_size * sizeof(std::uint32_t));
+    for(std::size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<std::uint8_t>(i * 7);
+    }
+
+    swr::impl::texture_2d tex{1};
+    tex.set_data(0, texture_size, texture_size, swr::pixel_format::rgba8888, data);
+    tex.set_filter_mag(filter);
+    tex.set_filter_min(filter);
+
+    // one texel per pixel selects the magnification filter on the base level.
+    const float texel_size = 1.0f / static_cast<float>(texture_size);
+    const ml::vec4 dFdx{texel_size, 0, 0, 0}, dFdy{0, texel_size, 0, 0};
+
+    for(auto _: state)
+    {
+        ml::vec4 sum = ml::vec4::zero();
+        for(int y = 0; y < texture_size; ++y)
+        {
+            for(int x = 0; x < texture_size; ++x)
+            {
+                const swr::varying uv{{(x + 0.5f) * texel_size, (y + 0.5f) * texel_size, 0, 0}, dFdx, dFdy};
+                sum += tex.sampler->sample_at(uv);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+#ifdef SWR_USE_MORTON_CODES
+    state.SetLabel("morton");
+#else
+    state.SetLabel("linear");
+#endif
+    state.SetItemsProcessed(state.iterations() * texture_size * texture_size);
+}
+BENCHMARK(bench_sampler_2d)
+  ->Arg(static_cast<int>(swr::texture_filter::nearest))
+  ->Arg(static_cast<int>(swr::texture_filter::linear));
+
+/**
+ * fetch all texels of a texture in row order or in column order, addressing the texel memory either
+ * with Morton codes or linearly. this compares both texture layouts independently of the one the
+ * library is built with.
+ */
+static void bench_texel_fetch(benchmark::State& state)
+{
+    const bool use_morton = state.range(0) != 0;
+    const bool column_order = state.range(1) != 0;
+    const std::uint32_t size = state.range(2);
+
+    std::vector<ml::vec4> texels(size * size, ml::vec4{0.25f, 0.5f, 0.75f, 1.0f});
+
+    for(auto _: state)
+    {
+        ml::vec4 sum = ml::vec4::zero();
+        for(std::uint32_t i = 0; i < size; ++i)
+        {
+            for(std::uint32_t j = 0; j < size; ++j)
+            {
+                const std::uint32_t x = column_order ? i : j;
+                const std::uint32_t y = column_order ? j : i;
+                sum += texels[use_morton ? libmorton::morton2D_32_encode(x, y) : y * size + x];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(bench_texel_fetch)
+  ->ArgNames({"morton", "column_order", "size"})
+  ->ArgsProduct({{0, 1}, {0, 1}, {256, 2048}});
@@ -0,0 +1,197 @@
+/**
+ * swr - a software rasterizer
+ *
+ * triangle setup and rasterization benchmarks.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/* Google benchmark */
+#include <benchmark/benchmark.h>
+
+/* user headers. */
+#include "swr_internal.h"
+
+#include "rasterizer/sweep.h"
+
+/** framebuffer width and height. */
+constexpr int framebuffer_size = 512;
+
+/**
+ * a framebuffer together with a sequential rasterizer and the render states needed for drawing. the
+ * default program accepts all fragments and writes no varyings, so that the benchmarks measure the
+ * rasterizer and not the shader.
+ */
+struct rasterizer_setup
+{
+    /** color buffer memory. */
+    std::vector<std::uint32_t> color_buffer;
+
+    /** framebuffer. */
+    swr::impl::default_framebuffer framebuffer;
+
+#ifdef SWR_ENABLE_MULTI_THREADING
+    /** thread pool. it only has a single thread, so that the primitives are drawn sequentially. */
+    swr::impl::render_device_context::thread_pool_type thread_pool;
+#endif
+
+    /** default program. */
+    swr::program_base shader;
+
+    /** program information. */
+    swr::impl::program_info shader_info{&shader};
+
+    /** render states. */
+    swr::impl::render_states states;
+
+    /** the rasterizer. */
+    std::unique_ptr<rast::sweep_rasterizer> rasterizer;
+
+    /** set up the framebuffer and the rasterizer. */
+    rasterizer_setup()
+    : color_buffer(framebuffer_size * framebuffer_size)
+    {
+        framebuffer.setup(framebuffer_size, framebuffer_size, framebuffer_size * sizeof(std::uint32_t), swr::pixel_format::argb8888, color_buffer.data());
+
+        states.reset(&framebuffer);
+        states.set_viewport(0, 0, framebuffer_size, framebuffer_size);
+        states.set_scissor_box(0, framebuffer_size, 0, framebuffer_size);
+        states.shader_info = &shader_info;
+
+#ifdef SWR_ENABLE_MULTI_THREADING
+        thread_pool.reset(1);
+        rasterizer = std::make_unique<rast::sweep_rasterizer>(&thread_pool, &framebuffer);
+#else
+        rasterizer = std::make_unique<rast::sweep_rasterizer>(nullptr, &framebuffer);
+#endif
+    }
+};
+
+/** create a vertex in viewport coordinates. */
+static geom::vertex make_vertex(float x, float y)
+{
+    geom::vertex v;
+    v.coords = ml::vec4{x, y, 0.5f, 1.0f};
+    return v;
+}
+
+/**
+ * set up and draw right triangles with legs of length size (given in pixels) in a grid, so that the
+ * rasterizer sees many triangles of the same size. the triangles mostly consist of fully covered
+ * blocks for large sizes, and of partially covered blocks for small sizes.
+ */
+static void bench_draw_filled_triangle(benchmark::State& state)
+{
+    const int size = state.range(0);
+    const int per_side = std::max(1, framebuffer_size / size);
+
+    rasterizer_setup setup;
+
+    std::vector<geom::vertex> vertices;
+    vertices.reserve(per_side * per_side * 3);
+    for(int y = 0; y < per_side; ++y)
+    {
+        for(int x = 0; x < per_side; ++x)
+        {
+            const float left = static_cast<float>(x * size), top = static_cast<float>(y * size);
+            vertices.push_back(make_vertex(left, top));
+            vertices.push_back(make_vertex(left, top + size));
+            vertices.push_back(make_vertex(left + size, top));
+        }
+    }
+
+    std::vector<rast::primitive> primitives;
+    primitives.reserve(vertices.size() / 3);
+    for(std::size_t i = 0; i < vertices.size(); i += 3)
+    {
+        primitives.emplace_back(&setup.states, true, &vertices[i], &vertices[i + 1], &vertices[i + 2]);
+    }
+
+    for(auto _: state)
+    {
+        setup.rasterizer->add_primitives(primitives.data(), primitives.size());
+        setup.rasterizer->draw_primitives();
+    }
+
+    benchmark::DoNotOptimize(setup.color_buffer.data());
+    state.SetItemsProcessed(state.iterations() * primitives.size());
+}
+BENCHMARK(bench_draw_filled_triangle)->Arg(4)->Arg(32)->Arg(256);
+
+/**
+ * draw a block-aligned rectangle from two triangles, so that all blocks away from the diagonal are
+ * fully covered and processed without per-fragment coverage checks.
+ */
+static void bench_process_block(benchmark::State& state)
+{
+    const float size = static_cast<float>(state.range(0));
+
+    rasterizer_setup setup;
+
+    geom::vertex vertices[4] = {
+      make_vertex(0, 0), make_vertex(0, size),
+      make_vertex(size, 0), make_vertex(size, size)};
+    rast::primitive primitives[2] = {
+      {&setup.states, true, &vertices[0], &vertices[1], &vertices[2]},
+      {&setup.states, true, &vertices[2], &vertices[1], &vertices[3]}};
+
+    for(auto _: state)
+    {
+        setup.rasterizer->add_primitives(primitives, 2);
+        setup.rasterizer->draw_primitives();
+    }
+
+    benchmark::DoNotOptimize(setup.color_buffer.data());
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+BENCHMARK(bench_process_block)->Arg(64)->Arg(256)->Arg(512);
+
+/**
+ * draw slivers that are narrower than a block, so that every block is only partially covered and
+ * each fragment goes through the coverage checks. the slivers cover the same area as the
+ * rectangle of bench_process_block.
+ */
+static void bench_process_block_checked(benchmark::State& state)
+{
+    const int size = state.range(0);
+    const int width = swr::impl::rasterizer_block_size / 2;
+
+    rasterizer_setup setup;
+
+    std::vector<geom::vertex> vertices;
+    vertices.reserve((size / width) * 4);
+    for(int x = 0; x < size; x += width)
+    {
+        // offset the slivers by half their width, so that their edges never align with block boundaries.
+        const float left = static_cast<float>(x) + 0.5f * width, right = left + width;
+        vertices.push_back(make_vertex(left, 0));
+        vertices.push_back(make_vertex(left, size));
+        vertices.push_back(make_vertex(right, 0));
+        vertices.push_back(make_vertex(right, size));
+    }
+
+    std::vector<rast::primitive> primitives;
+    primitives.reserve(vertices.size() / 2);
+    for(std::size_t i = 0; i < vertices.size(); i += 4)
+    {
+        primitives.emplace_back(&setup.states, true, &vertices[i], &vertices[i + 1], &vertices[i + 2]);
+        primitives.emplace_back(&setup.states, true, &vertices[i + 2], &vertices[i + 1], &vertices[i + 3]);
+    }
+
+    for(auto _: state)
+    {
+        setup.rasterizer->add_primitives(primitives.data(), primitives.size());
+        setup.rasterizer->draw_primitives();
+    }
+
+    benchmark::DoNotOptimize(setup.color_buffer.data());
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(bench_process_block_checked)->Arg(64)->Arg(256)->Arg(480);
@@ -0,0 +1,364 @@
+/**
+ * swr - a software rasterizer
+ *
+ * replay a capture of API calls into an offscreen context as fast as possible, and write the
+ * frame time statistics as JSON.
+ *
+ * usage:
+ *   bench_replay --capture=file.swrc [--iterations=5] [--threads=0] [--output=file.json]
+ *
+ * shaders are resolved by the keys the demos register them with. applications with their own
+ * shaders have to provide a resolver through swr::capture::replay_capture instead.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* format library */
+#include "fmt/format.h"
+
+/* software rasterizer headers. */
+#include "swr/swr.h"
+#include "swr/shaders.h"
+#include "swr/capture.h"
+
+/* the demos' shaders. these are put into their own namespaces, since the demos reuse class names. */
+namespace alpha_blend
+{
+#include "../../demos/alpha_blend/shader.h"
+} /* namespace alpha_blend */
+
+namespace bitmap_font
+{
+#include "../../demos/bitmap_font/shader.h"
+} /* namespace bitmap_font */
+
+namespace blinn_phong
+{
+#include "../../demos/blinn_phong/shader.h"
+} /* namespace blinn_phong */
+
+namespace color
+{
+#include "../../demos/color/shader.h"
+} /* namespace color */
+
+namespace emitter
+{
+#include "../../demos/emitter/shader.h"
+} /* namespace emitter */
+
+namespace fill_test
+{
+#include "../../demos/fill_test/shader.h"
+} /* namespace fill_test */
+
+namespace gears
+{
+#include "../../demos/gears/shader.h"
+} /* namespace gears */
+
+namespace motion_blur
+{
+#include "../../demos/motion_blur/shader.h"
+} /* namespace motion_blur */
+
+namespace normal_map
+{
+#include "../../demos/normal_map/shader.h"
+} /* namespace normal_map */
+
+namespace obj_viewer
+{
+#include "../../demos/obj_viewer/shader.h"
+} /* namespace obj_viewer */
+
+namespace phong
+{
+#include "../../demos/phong/shader.h"
+} /* namespace phong */
+
+namespace scissor
+{
+#include "../../demos/scissor/shader.h"
+} /* namespace scissor */
+
+namespace textures
+{
+#include "../../demos/textures/shader.h"
+} /* namespace textures */
+
+namespace timings
+{
+#include "../../demos/timings/shader.h"
+} /* namespace timings */
+
+namespace replay
+{
+
+/** a shader known to the replay tool. */
+struct shader_entry
+{
+    /** the key the demo registers the shader with. */
+    std::string key;
+
+    /** shader instance. */
+    std::unique_ptr<swr::program_base> shader;
+};
+
+/** add a shader to the list. */
+template<typename T, typename... Args>
+static void add_shader(std::vector<shader_entry>& shaders, const char* key, Args&&... args)
+{
+    shaders.push_back({key, std::make_unique<T>(std::forward<Args>(args)...)});
+}
+
+/** create instances of all demo shaders, with the same parameters the demos use. */
+static std::vector<shader_entry> create_demo_shaders()
+{
+    std::vector<shader_entry> shaders;
+
+    add_shader<alpha_blend::shader::color>(shaders, "alpha_blend.color");
+    add_shader<alpha_blend::shader::texture>(shaders, "alpha_blend.texture");
+    add_shader<bitmap_font::shader::im_texture>(shaders, "bitmap_font.im_texture");
+    add_shader<bitmap_font::shader::color>(shaders, "bitmap_font.color");
+    add_shader<blinn_phong::shader::blinn_phong>(shaders, "blinn_phong.blinn_phong");
+    add_shader<color::shader::color>(shaders, "color.color");
+    add_shader<emitter::shader::normal_mapping>(shaders, "emitter.normal_mapping");
+    add_shader<fill_test::shader::mesh_color>(shaders, "fill_test.mesh_color");
+    add_shader<gears::shader::color_flat>(shaders, "gears.red.color_flat", ml::vec4{0.8f, 0.1f, 0.0f, 1.0f});
+    add_shader<gears::shader::color_smooth>(shaders, "gears.red.color_smooth", ml::vec4{0.8f, 0.1f, 0.0f, 1.0f});
+    add_shader<gears::shader::color_flat>(shaders, "gears.green.color_flat", ml::vec4{0.0f, 0.8f, 0.2f, 1.0f});
+    add_shader<gears::shader::color_smooth>(shaders, "gears.green.color_smooth", ml::vec4{0.0f, 0.8f, 0.2f, 1.0f});
+    add_shader<gears::shader::color_flat>(shaders, "gears.blue.color_flat", ml::vec4{0.2f, 0.2f, 1.0f, 1.0f});
+    add_shader<gears::shader::color_smooth>(shaders, "gears.blue.color_smooth", ml::vec4{0.2f, 0.2f, 1.0f, 1.0f});
+    add_shader<motion_blur::shader::normal_mapping>(shaders, "motion_blur.normal_mapping");
+    add_shader<motion_blur::shader::im_blend>(shaders, "motion_blur.im_blend");
+    add_shader<normal_map::shader::normal_mapping>(shaders, "normal_map.normal_mapping");
+    add_shader<obj_viewer::shader::color_flat>(shaders, "obj_viewer.color_flat");
+    add_shader<obj_viewer::shader::wireframe>(shaders, "obj_viewer.wireframe");
+    add_shader<phong::shader::phong>(shaders, "phong.phong");
+    add_shader<scissor::shader::phong>(shaders, "scissor.phong");
+    add_shader<textures::shader::texture>(shaders, "textures.texture");
+    add_shader<timings::shader::im_texture>(shaders, "timings.im_texture");
+    add_shader<timings::shader::color>(shaders, "timings.color");
+
+    return shaders;
+}
+
+/** benchmark parameters. */
+struct options
+{
+    /** capture file. */
+    std::string capture_file;
+
+    /** number of replays. */
+    uint32_t iterations{5};
+
+    /** thread hint for the context. */
+    uint32_t threads{0};
+
+    /** output file. writes to stdout if empty. */
+    std::string output;
+};
+
+/** parse the command line. returns false on unknown or malformed arguments. */
+static bool parse_arguments(int argc, char* argv[], options& opts)
+{
+    try
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            auto separator = arg.find('=');
+            if(arg.rfind("--", 0) != 0 || separator == std::string::npos)
+            {
+                return false;
+            }
+
+            std::string name = arg.substr(2, separator - 2);
+            std::string value = arg.substr(separator + 1);
+
+            if(name == "capture")
+            {
+                opts.capture_file = value;
+            }
+            else if(name == "iterations")
+            {
+                opts.iterations = std::stoul(value);
+            }
+            else if(name == "threads")
+            {
+                opts.threads = std::stoul(value);
+            }
+            else if(name == "output")
+            {
+                opts.output = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+    catch(std::exception&)
+    {
+        return false;
+    }
+
+    return !opts.capture_file.empty() && opts.iterations > 0;
+}
+
+/** return the given percentile of sorted values, using the nearest rank. */
+static double percentile(const std::vector<double>& sorted_values, double p)
+{
+    if(sorted_values.empty())
+    {
+        return 0;
+    }
+
+    auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted_values.size()));
+    return sorted_values[std::clamp<std::size_t>(rank, 1, sorted_values.size()) - 1];
+}
+
+} /* namespace replay */
+
+int main(int argc, char* argv[])
+{
+    replay::options opts;
+    if(!replay::parse_arguments(argc, argv, opts))
+    {
+        std::cerr << "usage: " << argv[0] << " --capture=file [--iterations=n] [--threads=t] [--output=file.json]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    swr::capture::capture_data capture;
+    if(!swr::capture::load_capture(opts.capture_file.c_str(), capture))
+    {
+        std::cerr << fmt::format("could not load capture '{}'.", opts.capture_file) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto shaders = replay::create_demo_shaders();
+    auto resolve_shader = [&shaders](const std::string& key) -> const swr::program_base*
+    {
+        for(const auto& it: shaders)
+        {
+            if(it.key == key)
+            {
+                return it.shader.get();
+            }
+        }
+
+        std::cerr << fmt::format("unknown shader '{}'.", key) << std::endl;
+        return nullptr;
+    };
+
+    // all frames of all iterations, in milliseconds.
+    std::vector<double> frame_times;
+    std::vector<double> replay_times;
+
+    // number of threads used by the contexts.
+    uint32_t thread_count = 0;
+
+    for(uint32_t i = 0; i < opts.iterations; ++i)
+    {
+        // each replay starts with a fresh context, so that the recorded object ids can be reproduced.
+        auto context = swr::CreateOffscreenContext(capture.width, capture.height, opts.threads);
+        if(!context || !swr::MakeContextCurrent(context))
+        {
+            std::cerr << "could not create context." << std::endl;
+            swr::DestroyContext(context);
+            return EXIT_FAILURE;
+        }
+
+        thread_count = swr::GetThreadCount(context);
+
+        auto replay_begin = std::chrono::steady_clock::now();
+        auto frame_begin = replay_begin;
+
+        bool result = swr::capture::replay_capture(
+          capture, resolve_shader,
+          [&frame_times, &frame_begin](uint32_t)
+          {
+              auto frame_end = std::chrono::steady_clock::now();
+              frame_times.push_back(std::chrono::duration<double, std::milli>(frame_end - frame_begin).count());
+              frame_begin = frame_end;
+          });
+
+        replay_times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - replay_begin).count());
+
+        swr::MakeContextCurrent(nullptr);
+        swr::DestroyContext(context);
+
+        if(!result)
+        {
+            std::cerr << fmt::format("replay of '{}' failed.", opts.capture_file) << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::sort(frame_times.begin(), frame_times.end());
+
+    double total_ms = 0;
+    for(auto t: frame_times)
+    {
+        total_ms += t;
+    }
+    double mean = frame_times.empty() ? 0 : total_ms / frame_times.size();
+
+    double replay_total_ms = 0;
+    for(auto t: replay_times)
+    {
+        replay_total_ms += t;
+    }
+
+    std::string json = fmt::format(
+      "{{\n  \"capture\":\"{}\",\n  \"width\":{},\n  \"height\":{},\n  \"frames\":{},\n  \"iterations\":{},\n  \"thread_hint\":{},\n  \"threads\":{},\n  \"hardware_concurrency\":{},\n"
+      "  \"mean_ms\":{:.4f},\n  \"p50_ms\":{:.4f},\n  \"p99_ms\":{:.4f},\n  \"min_ms\":{:.4f},\n  \"max_ms\":{:.4f},\n  \"mean_replay_ms\":{:.4f}\n}}\n",
+      opts.capture_file,
+      capture.width,
+      capture.height,
+      capture.frame_count,
+      opts.iterations,
+      opts.threads,
+      thread_count,
+      std::thread::hardware_concurrency(),
+      mean,
+      replay::percentile(frame_times, 50),
+      replay::percentile(frame_times, 99),
+      frame_times.empty() ? 0 : frame_times.front(),
+      frame_times.empty() ? 0 : frame_times.back(),
+      replay_total_ms / opts.iterations);
+
+    if(opts.output.empty())
+    {
+        std::cout << json;
+    }
+    else
+    {
+        std::ofstream out{opts.output};
+        out << json;
+        if(!out)
+        {
+            std::cerr << fmt::format("could not write '{}'.", opts.output) << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -117,13 +117,13 @@ public:
         swr::SetState(swr::state::depth_test, true);
         swr::SetBlendFunc(swr::blend_func::src_alpha, swr::blend_func::one_minus_src_alpha);
 
-        color_shader_id = swr::RegisterShader(&color_shader);
+        color_shader_id = swr::RegisterShader(&color_shader, "alpha_blend.color");
         if(!color_shader_id)
         {
             throw std::runtime_error("color shader registration failed");
         }
 
-        texture_shader_id = swr::RegisterShader(&texture_shader);
+        texture_shader_id = swr::RegisterShader(&texture_shader, "alpha_blend.texture");
         if(!texture_shader_id)
         {
             throw std::runtime_error("texture shader registration failed");
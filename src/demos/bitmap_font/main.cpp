@@ -179,13 +179,13 @@ public:
         swr::SetState(swr::state::cull_face, true);
         swr::SetState(swr::state::depth_test, true);
 
-        font_shader_id = swr::RegisterShader(&font_shader);
+        font_shader_id = swr::RegisterShader(&font_shader, "bitmap_font.im_texture");
         if(!font_shader_id)
         {
             throw std::runtime_error("font shader registration failed");
         }
 
-        cube_shader_id = swr::RegisterShader(&cube_shader);
+        cube_shader_id = swr::RegisterShader(&cube_shader, "bitmap_font.color");
         if(!cube_shader_id)
         {
             throw std::runtime_error("cube shader registration failed");
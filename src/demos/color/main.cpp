@@ -101,7 +101,7 @@ public:
         swr::SetState(swr::state::cull_face, true);
         swr::SetState(swr::state::depth_test, true);
 
-        shader_id = swr::RegisterShader(&shader);
+        shader_id = swr::RegisterShader(&shader, "color.color");
         if(!shader_id)
         {
             throw std::runtime_error("shader registration failed");
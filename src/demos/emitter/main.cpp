@@ -1,7 +1,7 @@
 /**
  * swr - a software rasterizer
  *
- * software renderer demonstration (simple particle system).
+ * software renderer demonstration (simple particle system). each particle is drawn as a point sprite.
  *
  * \author Felix Lubbe
  * \copyright Copyright (c) 2021
@@ -41,38 +41,23 @@ constexpr int max_particles = 256;
 /** demo window. */
 class demo_emitter : public swr_app::renderwindow
 {
-    /** normal mapping shader */
-    shader::normal_mapping shader;
+    /** point sprite shader */
+    shader::sprite shader;
 
-    /** normal mapping shader id. */
+    /** point sprite shader id. */
     uint32_t shader_id{0};
 
     /** projection matrix. */
     ml::mat4x4 proj;
 
-    /** the cube's vertices. */
-    uint32_t cube_verts{0};
-
-    /** the cube's indices. */
-    uint32_t cube_indices{0};
-
-    /** texture coordinates. */
-    uint32_t cube_uvs{0};
-
-    /** normals. */
-    uint32_t cube_normals{0};
-
-    /** tangents. */
-    uint32_t cube_tangents{0};
-
-    /** bitangents. */
-    uint32_t cube_bitangents{0};
-
     /** texture. */
-    uint32_t cube_tex{0};
+    uint32_t sprite_tex{0};
 
     /** normal map. */
-    uint32_t cube_normal_map{0};
+    uint32_t sprite_normal_map{0};
+
+    /** positions and scales of the active particles, updated each frame. */
+    std::vector<ml::vec4> sprites;
 
     /** particle system. */
     particles::particle_system particle_system;
@@ -129,10 +114,12 @@ public:
         swr::SetClearDepth(1.0f);
         swr::SetViewport(0, 0, width, height);
 
-        swr::SetState(swr::state::cull_face, true);
         swr::SetState(swr::state::depth_test, true);
 
-        shader_id = swr::RegisterShader(&shader);
+        // the sprite sizes are written by the vertex shader.
+        swr::SetState(swr::state::program_point_size, true);
+
+        shader_id = swr::RegisterShader(&shader, "emitter.sprite");
         if(!shader_id)
         {
             throw std::runtime_error("shader registration failed");
@@ -141,50 +128,7 @@ public:
         // set projection matrix.
         proj = ml::matrices::perspective_projection(static_cast<float>(width) / static_cast<float>(height), static_cast<float>(M_PI) / 2, 1.f, 10.f);
 
-        // load cube.
-        std::vector<uint32_t> indices = {
-#define FACE_LIST(...) __VA_ARGS__
-#include "../common/cube_uniform_uv.geom"
-#undef FACE_LIST
-        };
-        cube_indices = swr::CreateIndexBuffer(indices);
-
-        std::vector<ml::vec4> vertices = {
-#define VERTEX_LIST(...) __VA_ARGS__
-#include "../common/cube_uniform_uv.geom"
-#undef VERTEX_LIST
-        };
-        cube_verts = swr::CreateAttributeBuffer(vertices);
-
-        std::vector<ml::vec4> uvs = {
-#define UV_LIST(...) __VA_ARGS__
-#include "../common/cube_uniform_uv.geom"
-#undef UV_LIST
-        };
-        cube_uvs = swr::CreateAttributeBuffer(uvs);
-
-        std::vector<ml::vec4> normals = {
-#define NORMAL_LIST(...) __VA_ARGS__
-#include "../common/cube_uniform_uv.geom"
-#undef NORMAL_LIST
-        };
-        cube_normals = swr::CreateAttributeBuffer(normals);
-
-        std::vector<ml::vec4> tangents = {
-#define TANGENT_LIST(...) __VA_ARGS__
-#include "../common/cube_uniform_uv.geom"
-#undef TANGENT_LIST
-        };
-        cube_tangents = swr::CreateAttributeBuffer(tangents);
-
-        std::vector<ml::vec4> bitangents = {
-#define BITANGENT_LIST(...) __VA_ARGS__
-#include "../common/cube_uniform_uv.geom"
-#undef BITANGENT_LIST
-        };
-        cube_bitangents = swr::CreateAttributeBuffer(bitangents);
-
-        // cube texture.
+        // sprite texture.
         std::vector<uint8_t> img_data;
         uint32_t w = 0, h = 0;
         uint32_t ret = lodepng::decode(img_data, w, h, "../textures/stone/32/ft_stone01_c.png");
@@ -193,11 +137,11 @@ public:
             platform::logf("[!!] lodepng error: {}", lodepng_error_text(ret));
             return false;
         }
-        cube_tex = swr::CreateTexture();
-        swr::SetImage(cube_tex, 0, w, h, swr::pixel_format::rgba8888, img_data);
-        swr::SetTextureWrapMode(cube_tex, swr::wrap_mode::repeat, swr::wrap_mode::mirrored_repeat);
+        sprite_tex = swr::CreateTexture();
+        swr::SetImage(sprite_tex, 0, w, h, swr::pixel_format::rgba8888, img_data);
+        swr::SetTextureWrapMode(sprite_tex, swr::wrap_mode::clamp_to_edge, swr::wrap_mode::clamp_to_edge);
 
-        // cube normal map.
+        // sprite normal map.
         img_data.clear();
         ret = lodepng::decode(img_data, w, h, "../textures/stone/32/ft_stone01_n.png");
         if(ret != 0)
@@ -205,41 +149,30 @@ public:
             platform::logf("[!!] lodepng error: {}", lodepng_error_text(ret));
             return false;
         }
-        cube_normal_map = swr::CreateTexture();
-        swr::SetImage(cube_normal_map, 0, w, h, swr::pixel_format::rgba8888, img_data);
-        swr::SetTextureWrapMode(cube_normal_map, swr::wrap_mode::repeat, swr::wrap_mode::mirrored_repeat);
+        sprite_normal_map = swr::CreateTexture();
+        swr::SetImage(sprite_normal_map, 0, w, h, swr::pixel_format::rgba8888, img_data);
+        swr::SetTextureWrapMode(sprite_normal_map, swr::wrap_mode::clamp_to_edge, swr::wrap_mode::clamp_to_edge);
 
         // create particles.
         particle_system.delay_add(0.1f, max_particles);
+        sprites.reserve(max_particles);
 
         return true;
     }
 
     void destroy()
     {
-        if(cube_normal_map)
+        if(sprite_normal_map)
         {
-            swr::ReleaseTexture(cube_normal_map);
+            swr::ReleaseTexture(sprite_normal_map);
         }
-        if(cube_tex)
+        if(sprite_tex)
         {
-            swr::ReleaseTexture(cube_tex);
+            swr::ReleaseTexture(sprite_tex);
         }
-        swr::DeleteAttributeBuffer(cube_bitangents);
-        swr::DeleteAttributeBuffer(cube_tangents);
-        swr::DeleteAttributeBuffer(cube_normals);
-        swr::DeleteAttributeBuffer(cube_uvs);
-        swr::DeleteAttributeBuffer(cube_verts);
-        swr::DeleteIndexBuffer(cube_indices);
-
-        cube_normal_map = 0;
-        cube_tex = 0;
-        cube_bitangents = 0;
-        cube_tangents = 0;
-        cube_normals = 0;
-        cube_uvs = 0;
-        cube_verts = 0;
-        cube_indices = 0;
+
+        sprite_normal_map = 0;
+        sprite_tex = 0;
 
         if(shader_id)
         {
@@ -303,13 +236,7 @@ public:
          * render particles.
          */
         begin_render();
-        for(auto it: particle_system.get_particles())
-        {
-            if(it.is_active)
-            {
-                draw_cube(it.position.xyz(), it.rotation_axis.xyz(), it.rotation_offset, it.scale);
-            }
-        }
+        draw_particles();
         end_render();
 
         ++frame_count;
@@ -327,41 +254,49 @@ public:
         swr::CopyDefaultColorBuffer(context);
     }
 
-    void draw_cube(ml::vec3 pos, ml::vec3 axis, float angle, float scale)
+    void draw_particles()
     {
+        // each particle is a single vertex, with the particle's scale stored in the w coordinate.
+        sprites.clear();
+        for(const auto& it: particle_system.get_particles())
+        {
+            if(it.is_active)
+            {
+                sprites.emplace_back(it.position.xyz(), it.scale);
+            }
+        }
+
+        if(sprites.empty())
+        {
+            return;
+        }
+
         ml::mat4x4 view = ml::mat4x4::identity();
         view *= ml::matrices::rotation_x(M_PI_2);
         view *= ml::matrices::rotation_y(M_PI);
-        view *= ml::matrices::translation(pos.x, pos.y, pos.z);
-        view *= ml::matrices::scaling(scale);
-        view *= ml::matrices::rotation(axis, angle);
 
         swr::BindShader(shader_id);
 
-        swr::EnableAttributeBuffer(cube_verts, 0);
-        swr::EnableAttributeBuffer(cube_normals, 1);
-        swr::EnableAttributeBuffer(cube_tangents, 2);
-        swr::EnableAttributeBuffer(cube_bitangents, 3);
-        swr::EnableAttributeBuffer(cube_uvs, 4);
+        // the attributes are copied by the draw call.
+        uint32_t sprite_positions = swr::CreateAttributeBuffer(sprites);
+        swr::EnableAttributeBuffer(sprite_positions, 0);
 
         swr::BindUniform(0, proj);
         swr::BindUniform(1, view);
         swr::BindUniform(2, light_position);
+        swr::BindUniform(3, static_cast<float>(height));
 
         swr::ActiveTexture(swr::texture_0);
-        swr::BindTexture(swr::texture_target::texture_2d, cube_tex);
+        swr::BindTexture(swr::texture_target::texture_2d, sprite_tex);
 
         swr::ActiveTexture(swr::texture_1);
-        swr::BindTexture(swr::texture_target::texture_2d, cube_normal_map);
+        swr::BindTexture(swr::texture_target::texture_2d, sprite_normal_map);
 
-        // draw the buffer.
-        swr::DrawIndexedElements(cube_indices, swr::vertex_buffer_mode::triangles);
+        // draw the sprites.
+        swr::DrawElements(sprites.size(), swr::vertex_buffer_mode::points);
 
-        swr::DisableAttributeBuffer(cube_uvs);
-        swr::DisableAttributeBuffer(cube_bitangents);
-        swr::DisableAttributeBuffer(cube_tangents);
-        swr::DisableAttributeBuffer(cube_normals);
-        swr::DisableAttributeBuffer(cube_verts);
+        swr::DisableAttributeBuffer(sprite_positions);
+        swr::DeleteAttributeBuffer(sprite_positions);
 
         swr::BindShader(0);
     }
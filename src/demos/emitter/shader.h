@@ -1,28 +1,20 @@
 /**
  * swr - a software rasterizer
  *
- * Normal mapping shader.
+ * Point sprite shader. Draws a normal-mapped disc facing the camera for each point.
  *
  * vertex shader input:
- *   attribute 0: vertex position
- *   attribute 1: vertex normal
- *   attribute 2: vertex tangents
- *   attribute 3: vertex bitangents
- *   attribute 4: texture coordinates
+ *   attribute 0: particle position (xyz) and particle scale (w)
  *
  * varyings:
- *   location 0: texture coordinates
- *   location 1: vertex position in camera space
- *   location 2: normal w.r.t. camera space
- *   location 3: tangent w.r.t. camera space
- *   location 4: bitangent w.r.t. camera space
- *   location 5: eye direction in camera space
- *   location 6: light direction in camera space
+ *   location 0: light direction in camera space
+ *   location 1: inverse point size, i.e. the derivative of gl_PointCoord
  *
  * uniforms:
  *   location 0: projection matrix              [mat4x4]
  *   location 1: view matrix                    [mat4x4]
  *   location 2: light position in camera space [vec4]
+ *   location 3: viewport height                [float]
  *
  * samplers:
  *   location 0: diffuse texture
@@ -36,27 +28,18 @@
 namespace shader
 {
 
-class normal_mapping : public swr::program<normal_mapping>
+class sprite : public swr::program<sprite>
 {
     const ml::vec4 light_color{0.7, 1, 1, 1};
-    const ml::vec4 light_specular_color{0.25, 0.5, 0.75, 1};
-    const float light_power{5.0f};
-    const float shininess{5.f};
-
     const float ambient_diffuse_factor{0.5f};
 
 public:
     virtual void pre_link(boost::container::static_vector<swr::interpolation_qualifier, geom::limits::max::varyings>& iqs) const override
     {
-        // set interpolation qualifiers for all varyings.
+        // the varyings are constant across a sprite.
         iqs = {
-          swr::interpolation_qualifier::smooth,
-          swr::interpolation_qualifier::smooth,
-          swr::interpolation_qualifier::smooth,
-          swr::interpolation_qualifier::smooth,
-          swr::interpolation_qualifier::smooth,
-          swr::interpolation_qualifier::smooth,
-          swr::interpolation_qualifier::smooth};
+          swr::interpolation_qualifier::flat,
+          swr::interpolation_qualifier::flat};
     }
 
     void vertex_shader(
@@ -64,7 +47,7 @@ public:
       [[maybe_unused]] int gl_InstanceID,
       const ml::vec4* attribs,
       ml::vec4& gl_Position,
-      [[maybe_unused]] float& gl_PointSize,
+      float& gl_PointSize,
       [[maybe_unused]] float* gl_ClipDistance,
       ml::vec4* varyings) const override
     {
@@ -72,92 +55,61 @@ public:
         const ml::mat4x4 view = (*uniforms)[1].m4;
 
         const ml::vec3 light_position_cameraspace = (*uniforms)[2].v4.xyz();
+        const float viewport_height = (*uniforms)[3].f;
 
-        // Position of the vertex, in camera space.
-        const ml::vec3 position_cameraspace = (view * attribs[0]).xyz();
-
-        // vector pointing from vertex towards light.
-        const ml::vec3 light_direction_cameraspace = light_position_cameraspace - position_cameraspace;
-
-        const ml::vec4 normal_modelspace = attribs[1]; /* vertex normal */
-        const ml::vec3 normal_cameraspace = (view * normal_modelspace).xyz();
-
-        const ml::vec4 tangent_modelspace = attribs[2]; /* vertex tangent */
-        const ml::vec3 tangent_cameraspace = (view * tangent_modelspace).xyz();
+        // position of the particle, in camera space.
+        const ml::vec4 position_cameraspace = view * ml::vec4(attribs[0].xyz(), 1);
 
-        const ml::vec4 bitangent_modelspace = attribs[3]; /* vertex bitangent */
-        const ml::vec3 bitangent_cameraspace = (view * bitangent_modelspace).xyz();
+        // transform the particle's center.
+        gl_Position = proj * position_cameraspace;
 
-        // pass texture coordinates to fragment shader.
-        varyings[0] = attribs[4]; /* texture coordinates */
-        varyings[1] = ml::vec4(position_cameraspace, 0);
-        varyings[2] = ml::vec4(normal_cameraspace, 0);
-        varyings[3] = ml::vec4(tangent_cameraspace, 0);
-        varyings[4] = ml::vec4(bitangent_cameraspace, 0);
-        varyings[5] = ml::vec4(-position_cameraspace, 0); /* eye direction: vector from vertex pointing towards camera. */
-        varyings[6] = ml::vec4(light_direction_cameraspace, 0);
+        // with a field of view of 90 degrees, a particle of diameter 2*scale covers scale*viewport_height/w pixels.
+        gl_PointSize = std::max(attribs[0].w * viewport_height / gl_Position.w, 1.0f);
 
-        // transform vertex. this overwrites the vertex position.
-        gl_Position = proj * view * attribs[0];
+        varyings[0] = ml::vec4(light_position_cameraspace - position_cameraspace.xyz(), 0);
+        varyings[1] = ml::vec4{1.0f / gl_PointSize, 0, 0, 0};
     }
 
     swr::fragment_shader_result fragment_shader(
       [[maybe_unused]] const ml::vec4& gl_FragCoord,
       [[maybe_unused]] bool gl_FrontFacing,
-      [[maybe_unused]] const ml::vec2& gl_PointCoord,
+      const ml::vec2& gl_PointCoord,
       const boost::container::static_vector<swr::varying, geom::limits::max::varyings>& varyings,
       [[maybe_unused]] float& gl_FragDepth,
       ml::vec4& gl_FragColor) const override
     {
-        const swr::varying& tex_coords = varyings[0];
-        const ml::vec4 position = varyings[1];
-        const ml::vec4 normal = varyings[2];
-        const ml::vec4 tangent = varyings[3];
-        const ml::vec4 bitangent = varyings[4];
-        const ml::vec4 eye_direction = varyings[5];
-        const ml::vec4 light_direction = varyings[6];
-
-        const ml::vec4 light_position = (*uniforms)[2].v4;
+        // only draw a disc inside the sprite.
+        const float x = gl_PointCoord.x * 2 - 1;
+        const float y = gl_PointCoord.y * 2 - 1;
+        if(x * x + y * y > 1)
+        {
+            return swr::discard;
+        }
 
-        // distance to light.
-        float distance_squared = (light_position - position).xyz().length_squared();
-        float falloff = light_power / distance_squared;
+        // the texture coordinates advance by the inverse point size per pixel.
+        const float inv_point_size = varyings[1].value.x;
+        const swr::varying tex_coords{
+          ml::vec4{gl_PointCoord.x, gl_PointCoord.y, 0, 0},
+          ml::vec4{inv_point_size, 0, 0, 0},
+          ml::vec4{0, inv_point_size, 0, 0}};
 
-        // sample normal map.
+        // sample normal map. the sprite faces the camera and gl_PointCoord points downwards.
         const ml::vec3 material_normal = (samplers[1]->sample_at(tex_coords) * 2 - 1).xyz();
+        const ml::vec3 n = ml::vec3{material_normal.x, -material_normal.y, material_normal.z}.normalized();
 
-        // normal of the computed fragment, in camera space.
-        auto tbn = ml::mat4x4{tangent, bitangent, normal, ml::vec4::zero()}.transposed();
-        const ml::vec3 n = (tbn * ml::vec4{material_normal, 0.f}).xyz().normalized();
-        // Direction of the light (from the fragment to the light)
-        const ml::vec3 l = light_direction.xyz().normalized();
+        // direction of the light (from the fragment to the light).
+        const ml::vec3 l = varyings[0].value.xyz().normalized();
 
         float lambertian = boost::algorithm::clamp(ml::dot(n, l), 0.f, 1.f);
 
         // sample diffuse texture.
         auto material_diffuse_color = samplers[0]->sample_at(tex_coords);
 
-        // calculate diffuse color.
-        ml::vec4 diffuse_color = light_color * material_diffuse_color * lambertian;
-
-        // calculate ambient color.
-        ml::vec4 ambient_color = material_diffuse_color * ambient_diffuse_factor;
-
-        // specular color.
-        float specular = 0.0f;
-
-        if(lambertian > 0.0f)
-        {
-            auto reflect_dir = -(l - n * 2.f * ml::dot(l, n)); /* reflect vector w.r.t. normal */
-            auto specular_angle = ml::dot(reflect_dir, eye_direction.xyz().normalized());
-            specular = std::pow(boost::algorithm::clamp(specular_angle, 0.f, 1.f), shininess / 4.f);
-        }
-
-        gl_FragColor = ambient_color + (diffuse_color + light_specular_color * specular) * falloff;
+        gl_FragColor = material_diffuse_color * ambient_diffuse_factor + light_color * material_diffuse_color * lambertian;
 
         // accept fragment.
         return swr::accept;
     }
 };
 
-} /* namespace shader */
\ No newline at end of file
+} /* namespace shader */
@@ -98,7 +98,7 @@ public:
         swr::SetState(swr::state::cull_face, true);
         swr::SetState(swr::state::depth_test, true);
 
-        mesh_shader_id = swr::RegisterShader(&mesh_shader);
+        mesh_shader_id = swr::RegisterShader(&mesh_shader, "fill_test.mesh_color");
         if(!mesh_shader_id)
         {
             throw std::runtime_error("mesh shader registration failed");
@@ -26,419 +26,12 @@
 /* logging. */
 #include "../common/platform/platform.h"
 
+/* gear geometry. */
+#include "gear.h"
+
 /** demo title. */
 const auto demo_title = "Gears";
 
-/** collect a set of geometric data into a single object. */
-class drawable_object
-{
-    /** index buffer id. */
-    std::uint32_t index_buffer_id{0};
-
-    /** vertex buffer id. */
-    std::uint32_t vertex_buffer_id{0};
-
-    /** normal buffer id. */
-    std::uint32_t normal_buffer_id{0};
-
-    /** remember if we still store data. */
-    bool has_data{false};
-
-public:
-    /** default constructor. */
-    drawable_object() = default;
-
-    /** initialize the object at least with an index buffer id. */
-    drawable_object(std::uint32_t in_ib, std::uint32_t in_vb, std::uint32_t in_nb)
-    : index_buffer_id{in_ib}
-    , vertex_buffer_id{in_vb}
-    , normal_buffer_id{in_nb}
-    , has_data{true}
-    {
-    }
-
-    /** move data. */
-    drawable_object(drawable_object&& other)
-    : index_buffer_id{other.index_buffer_id}
-    , vertex_buffer_id{other.vertex_buffer_id}
-    , normal_buffer_id{other.normal_buffer_id}
-    , has_data{other.has_data}
-    {
-        other.has_data = false;
-    }
-
-    drawable_object(const drawable_object&) = default;
-    drawable_object& operator=(const drawable_object&) = default;
-
-    /** release all data. */
-    void release()
-    {
-        if(has_data)
-        {
-            swr::DeleteAttributeBuffer(normal_buffer_id);
-            swr::DeleteAttributeBuffer(vertex_buffer_id);
-            swr::DeleteIndexBuffer(index_buffer_id);
-
-            has_data = false;
-        }
-    }
-
-    /** draw the object. */
-    void draw() const
-    {
-        if(has_data)
-        {
-            swr::EnableAttributeBuffer(vertex_buffer_id, 0);
-            swr::EnableAttributeBuffer(normal_buffer_id, 1);
-            swr::DrawIndexedElements(index_buffer_id, swr::vertex_buffer_mode::triangles);
-            swr::DisableAttributeBuffer(normal_buffer_id);
-            swr::DisableAttributeBuffer(vertex_buffer_id);
-        }
-    }
-};
-
-/** the gear's inner cylinder has smooth shading enabled, so we divide the meshes (and also the shaders) accordingly. */
-struct gear_object
-{
-    /** outside of the gear. */
-    drawable_object outside;
-
-    /** inner cylinder of the gear. */
-    drawable_object cylinder;
-
-    /** flat shader for the outside. */
-    shader::color_flat flat_shader;
-
-    /** smooth shader for the cylinder. */
-    shader::color_smooth smooth_shader;
-
-    /** flat shader id. */
-    uint32_t flat_shader_id{0};
-
-    /** smooth shader id. */
-    uint32_t smooth_shader_id{0};
-
-    /** default constructor. */
-    gear_object() = default;
-
-    /** disable copying. */
-    gear_object(const gear_object&) = delete;
-    gear_object(gear_object&&) = delete;
-
-    gear_object& operator=(const gear_object& other) = delete;
-
-    /** release all data and unregister shaders. */
-    void release()
-    {
-        outside.release();
-        cylinder.release();
-
-        swr::UnregisterShader(flat_shader_id);
-        swr::UnregisterShader(smooth_shader_id);
-
-        flat_shader_id = 0;
-        smooth_shader_id = 0;
-    }
-
-    /** draw the gear. */
-    void draw() const
-    {
-        swr::BindShader(flat_shader_id);
-        outside.draw();
-
-        swr::BindShader(smooth_shader_id);
-        cylinder.draw();
-    }
-
-    /** create a gear and upload it to the graphics driver. the code here is adapted from glxgears.c. */
-    void make_gear(float inner_radius, float outer_radius, float width, int teeth, float tooth_depth, ml::vec4 color)
-    {
-        release();
-
-        float r0 = inner_radius;
-        float r1 = outer_radius - tooth_depth / 2.f;
-        float r2 = outer_radius + tooth_depth / 2.f;
-
-        float da = 2.f * static_cast<float>(M_PI / teeth) / 4.f;
-
-        std::vector<ml::vec4> vb;
-        std::vector<ml::vec4> nb;
-        std::vector<uint32_t> ib;
-
-        /* draw front face */
-        for(int i = 0; i <= teeth; ++i)
-        {
-            float angle = i * 2.f * static_cast<float>(M_PI) / static_cast<float>(teeth);
-            vb.emplace_back(r0 * std::cos(angle), r0 * std::sin(angle), width * 0.5f);
-            vb.emplace_back(r1 * std::cos(angle), r1 * std::sin(angle), width * 0.5f);
-
-            nb.emplace_back(0, 0, 1, 0);
-            nb.emplace_back(0, 0, 1, 0);
-
-            if(i != 0)
-            {
-                auto cur_idx = vb.size() - 1;
-                ib.push_back(cur_idx - 1);
-                ib.push_back(cur_idx - 3);
-                ib.push_back(cur_idx - 2);
-
-                ib.push_back(cur_idx - 1);
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx);
-            }
-
-            if(i < teeth)
-            {
-                vb.emplace_back(r0 * std::cos(angle), r0 * std::sin(angle), width * 0.5f);
-                vb.emplace_back(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), width * 0.5f);
-
-                nb.emplace_back(0, 0, 1, 0);
-                nb.emplace_back(0, 0, 1, 0);
-
-                auto cur_idx = vb.size() - 1;
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx - 1);
-                ib.push_back(cur_idx - 3);
-
-                ib.push_back(cur_idx - 1);
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx);
-            }
-        }
-
-        /* draw front sides of teeth */
-        da = 2.f * static_cast<float>(M_PI) / static_cast<float>(teeth) / 4.f;
-        for(int i = 0; i < teeth; ++i)
-        {
-            float angle = i * 2.f * static_cast<float>(M_PI) / static_cast<float>(teeth);
-
-            vb.emplace_back(r1 * std::cos(angle), r1 * std::sin(angle), width * 0.5f);
-            vb.emplace_back(r2 * std::cos(angle + da), r2 * std::sin(angle + da), width * 0.5f);
-            vb.emplace_back(r2 * std::cos(angle + 2 * da), r2 * std::sin(angle + 2 * da), width * 0.5f);
-            vb.emplace_back(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), width * 0.5f);
-
-            nb.emplace_back(0, 0, 1, 0);
-            nb.emplace_back(0, 0, 1, 0);
-            nb.emplace_back(0, 0, 1, 0);
-            nb.emplace_back(0, 0, 1, 0);
-
-            auto cur_idx = vb.size() - 1;
-            ib.push_back(cur_idx - 3);
-            ib.push_back(cur_idx - 2);
-            ib.push_back(cur_idx - 1);
-
-            ib.push_back(cur_idx - 3);
-            ib.push_back(cur_idx - 1);
-            ib.push_back(cur_idx);
-        }
-
-        /* draw back face */
-        for(int i = 0; i <= teeth; ++i)
-        {
-            float angle = i * 2.f * static_cast<float>(M_PI) / static_cast<float>(teeth);
-            vb.emplace_back(r1 * std::cos(angle), r1 * std::sin(angle), -width * 0.5f);
-            vb.emplace_back(r0 * std::cos(angle), r0 * std::sin(angle), -width * 0.5f);
-
-            nb.emplace_back(0, 0, -1, 0);
-            nb.emplace_back(0, 0, -1, 0);
-
-            if(i != 0)
-            {
-                auto cur_idx = vb.size() - 1;
-                ib.push_back(cur_idx - 3);
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx - 1);
-
-                ib.push_back(cur_idx - 1);
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx);
-            }
-
-            if(i < teeth)
-            {
-                vb.emplace_back(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), -width * 0.5f);
-                vb.emplace_back(r0 * std::cos(angle), r0 * std::sin(angle), -width * 0.5f);
-
-                nb.emplace_back(0, 0, -1, 0);
-                nb.emplace_back(0, 0, -1, 0);
-
-                auto cur_idx = vb.size() - 1;
-                ib.push_back(cur_idx - 3);
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx - 1);
-
-                ib.push_back(cur_idx - 1);
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx);
-            }
-        }
-
-        /* draw back sides of teeth */
-        da = 2.f * static_cast<float>(M_PI) / static_cast<float>(teeth) / 4.f;
-        for(int i = 0; i < teeth; ++i)
-        {
-            float angle = i * 2.f * static_cast<float>(M_PI) / static_cast<float>(teeth);
-
-            vb.emplace_back(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), -width * 0.5f);
-            vb.emplace_back(r2 * std::cos(angle + 2 * da), r2 * std::sin(angle + 2 * da), -width * 0.5f);
-            vb.emplace_back(r2 * std::cos(angle + da), r2 * std::sin(angle + da), -width * 0.5f);
-            vb.emplace_back(r1 * std::cos(angle), r1 * std::sin(angle), -width * 0.5f);
-
-            nb.emplace_back(0, 0, -1, 0);
-            nb.emplace_back(0, 0, -1, 0);
-            nb.emplace_back(0, 0, -1, 0);
-            nb.emplace_back(0, 0, -1, 0);
-
-            auto cur_idx = vb.size() - 1;
-            ib.push_back(cur_idx - 3);
-            ib.push_back(cur_idx - 2);
-            ib.push_back(cur_idx - 1);
-
-            ib.push_back(cur_idx - 3);
-            ib.push_back(cur_idx - 1);
-            ib.push_back(cur_idx);
-        }
-
-        /* draw outward faces of teeth */
-        for(int i = 0; i < teeth; ++i)
-        {
-            float angle = i * 2.f * static_cast<float>(M_PI) / static_cast<float>(teeth);
-
-            vb.emplace_back(r1 * std::cos(angle), r1 * std::sin(angle), width * 0.5f);
-            vb.emplace_back(r1 * std::cos(angle), r1 * std::sin(angle), -width * 0.5f);
-
-            ml::vec4 uv{
-              r2 * std::sin(angle + da) - r1 * std::sin(angle),
-              -r2 * std::cos(angle + da) + r1 * std::cos(angle),
-              0, 0};
-            nb.emplace_back(uv.normalized());
-            nb.emplace_back(uv.normalized());
-
-            if(i != 0)
-            {
-                auto cur_idx = vb.size() - 1;
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx - 1);
-                ib.push_back(cur_idx - 3);
-
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx);
-                ib.push_back(cur_idx - 1);
-            }
-
-            vb.emplace_back(r2 * std::cos(angle + da), r2 * std::sin(angle + da), width * 0.5f);
-            vb.emplace_back(r2 * std::cos(angle + da), r2 * std::sin(angle + da), -width * 0.5f);
-
-            nb.emplace_back(std::cos(angle), std::sin(angle), 0, 0);
-            nb.emplace_back(std::cos(angle), std::sin(angle), 0, 0);
-
-            auto cur_idx = vb.size() - 1;
-            ib.push_back(cur_idx - 2);
-            ib.push_back(cur_idx - 1);
-            ib.push_back(cur_idx - 3);
-
-            ib.push_back(cur_idx - 2);
-            ib.push_back(cur_idx);
-            ib.push_back(cur_idx - 1);
-
-            vb.emplace_back(r2 * std::cos(angle + 2 * da), r2 * std::sin(angle + 2 * da), width * 0.5f);
-            vb.emplace_back(r2 * std::cos(angle + 2 * da), r2 * std::sin(angle + 2 * da), -width * 0.5f);
-
-            uv = ml::vec4{
-              r1 * std::sin(angle + 3 * da) - r2 * std::sin(angle + 2 * da),
-              -r1 * std::cos(angle + 3 * da) + r2 * std::cos(angle + 2 * da),
-              0, 0};
-            nb.emplace_back(uv.normalized());
-            nb.emplace_back(uv.normalized());
-
-            cur_idx = vb.size() - 1;
-            ib.push_back(cur_idx - 3);
-            ib.push_back(cur_idx - 2);
-            ib.push_back(cur_idx - 1);
-
-            ib.push_back(cur_idx - 2);
-            ib.push_back(cur_idx);
-            ib.push_back(cur_idx - 1);
-
-            vb.emplace_back(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), width * 0.5f);
-            vb.emplace_back(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), -width * 0.5f);
-
-            nb.emplace_back(std::cos(angle), std::sin(angle), 0, 0);
-            nb.emplace_back(std::cos(angle), std::sin(angle), 0, 0);
-
-            cur_idx = vb.size() - 1;
-            ib.push_back(cur_idx - 2);
-            ib.push_back(cur_idx - 1);
-            ib.push_back(cur_idx - 3);
-
-            ib.push_back(cur_idx - 2);
-            ib.push_back(cur_idx);
-            ib.push_back(cur_idx - 1);
-        }
-
-        vb.emplace_back(r1 * std::cos(0.f), r1 * std::sin(0.f), width * 0.5f);
-        vb.emplace_back(r1 * std::cos(0.f), r1 * std::sin(0.f), -width * 0.5f);
-
-        nb.emplace_back(std::cos(0.f), std::sin(0.f), 0, 0);
-        nb.emplace_back(std::cos(0.f), std::sin(0.f), 0, 0);
-
-        auto cur_idx = vb.size() - 1;
-        ib.push_back(cur_idx - 2);
-        ib.push_back(cur_idx - 1);
-        ib.push_back(cur_idx - 3);
-
-        ib.push_back(cur_idx - 2);
-        ib.push_back(cur_idx);
-        ib.push_back(cur_idx - 1);
-
-        /* create outside of the gear. */
-        outside = {swr::CreateIndexBuffer(ib), swr::CreateAttributeBuffer(vb), swr::CreateAttributeBuffer(nb)};
-
-        /* clear buffers for the inner cylinder. */
-        vb.clear();
-        nb.clear();
-        ib.clear();
-
-        /* draw inside radius cylinder */
-        for(int i = 0; i <= teeth; i++)
-        {
-            float angle = i * 2.f * static_cast<float>(M_PI) / static_cast<float>(teeth);
-            vb.emplace_back(r0 * std::cos(angle), r0 * std::sin(angle), -width * 0.5f);
-            vb.emplace_back(r0 * std::cos(angle), r0 * std::sin(angle), width * 0.5f);
-
-            nb.emplace_back(-std::cos(angle), -std::sin(angle), 0, 0);
-            nb.emplace_back(-std::cos(angle), -std::sin(angle), 0, 0);
-
-            if(i != 0)
-            {
-                auto cur_idx = vb.size() - 1;
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx - 1);
-                ib.push_back(cur_idx - 3);
-
-                ib.push_back(cur_idx - 2);
-                ib.push_back(cur_idx);
-                ib.push_back(cur_idx - 1);
-            }
-        }
-
-        /* create inner cylinder. */
-        cylinder = {swr::CreateIndexBuffer(ib), swr::CreateAttributeBuffer(vb), swr::CreateAttributeBuffer(nb)};
-
-        /* create shaders. */
-        smooth_shader = {color};
-        flat_shader = {color};
-
-        flat_shader_id = swr::RegisterShader(&flat_shader);
-        smooth_shader_id = swr::RegisterShader(&smooth_shader);
-
-        if(!flat_shader_id || !smooth_shader_id)
-        {
-            throw std::runtime_error("gear_object: shader registration failed.");
-        }
-    }
-};
-
 /** demo window. */
 class demo_gears : public swr_app::renderwindow
 {
@@ -505,13 +98,20 @@ public:
         swr::SetState(swr::state::cull_face, true);
         swr::SetState(swr::state::depth_test, true);
 
+        // the gears' shaders are depth-invariant, so they can be shaded through the visibility buffer.
+        if(swr_app::application::get_instance().get_argument("--visibility_buffer", 0) != 0)
+        {
+            platform::logf("using the visibility buffer");
+            swr::SetVisibilityBuffer(true);
+        }
+
         // set projection matrix.
         proj = ml::matrices::perspective_projection(static_cast<float>(width) / static_cast<float>(height), static_cast<float>(M_PI) / 8, 5.f, 60.f);
 
         // create gears.
-        gears[0].make_gear(1.0, 4.0, 1.0, 20, 0.7, {0.8f, 0.1f, 0.0f, 1.0f});
-        gears[1].make_gear(0.5, 2.0, 2.0, 10, 0.7, {0.0f, 0.8f, 0.2f, 1.0f});
-        gears[2].make_gear(1.3, 2.0, 0.5, 10, 0.7, {0.2f, 0.2f, 1.0f, 1.0f});
+        gears[0].make_gear(1.0, 4.0, 1.0, 20, 0.7, {0.8f, 0.1f, 0.0f, 1.0f}, "red");
+        gears[1].make_gear(0.5, 2.0, 2.0, 10, 0.7, {0.0f, 0.8f, 0.2f, 1.0f}, "green");
+        gears[2].make_gear(1.3, 2.0, 0.5, 10, 0.7, {0.2f, 0.2f, 1.0f, 1.0f}, "blue");
 
         return true;
     }
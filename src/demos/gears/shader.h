@@ -47,6 +47,12 @@ public:
           swr::interpolation_qualifier::flat};
     }
 
+    /** the fragment shader neither writes depth nor discards, so the gears can be shaded through the visibility buffer. */
+    virtual bool is_depth_invariant() const override
+    {
+        return true;
+    }
+
     void vertex_shader(
       [[maybe_unused]] int gl_VertexID,
       [[maybe_unused]] int gl_InstanceID,
@@ -108,6 +114,12 @@ public:
         };
     }
 
+    /** the fragment shader neither writes depth nor discards. */
+    virtual bool is_depth_invariant() const override
+    {
+        return true;
+    }
+
     void vertex_shader(
       [[maybe_unused]] int gl_VertexID,
       [[maybe_unused]] int gl_InstanceID,
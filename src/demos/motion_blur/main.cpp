@@ -147,13 +147,13 @@ public:
         swr::SetState(swr::state::cull_face, true);
         swr::SetState(swr::state::depth_test, true);
 
-        shader_id = swr::RegisterShader(&shader);
+        shader_id = swr::RegisterShader(&shader, "motion_blur.normal_mapping");
         if(!shader_id)
         {
             throw std::runtime_error("shader registration failed");
         }
 
-        blend_shader_id = swr::RegisterShader(&blend_shader);
+        blend_shader_id = swr::RegisterShader(&blend_shader, "motion_blur.im_blend");
         if(!blend_shader_id)
         {
             throw std::runtime_error("blend_shader registration failed");
@@ -822,8 +822,8 @@ public:
         int cmd_show_wireframe = swr_app::application::get_instance().get_argument("--wireframe", 1);
         show_wireframe = cmd_show_wireframe == 1;
 
-        flat_shader_id = swr::RegisterShader(&flat_shader);
-        wireframe_shader_id = swr::RegisterShader(&wireframe_shader);
+        flat_shader_id = swr::RegisterShader(&flat_shader, "obj_viewer.color_flat");
+        wireframe_shader_id = swr::RegisterShader(&wireframe_shader, "obj_viewer.wireframe");
 
         // set projection matrix.
         proj = ml::matrices::perspective_projection(static_cast<float>(width) / static_cast<float>(height), static_cast<float>(M_PI) / 4, 0.01f, 100.f);
@@ -113,7 +113,7 @@ public:
         swr::SetState(swr::state::cull_face, true);
         swr::SetState(swr::state::depth_test, true);
 
-        shader_id = swr::RegisterShader(&shader);
+        shader_id = swr::RegisterShader(&shader, "phong.phong");
         if(!shader_id)
         {
             throw std::runtime_error("shader registration failed");
@@ -114,7 +114,7 @@ public:
 
         swr::SetScissorBox(120, 120, 400, 240);
 
-        shader_id = swr::RegisterShader(&shader);
+        shader_id = swr::RegisterShader(&shader, "scissor.phong");
         if(!shader_id)
         {
             throw std::runtime_error("shader registration failed");
@@ -9,7 +9,9 @@
  */
 
 /* C++ headers */
+#include <algorithm>
 #include <chrono>
+#include <numeric>
 
 /* boost */
 #include <boost/container/static_vector.hpp>
@@ -189,13 +191,13 @@ public:
         swr::SetState(swr::state::cull_face, true);
         swr::SetState(swr::state::depth_test, true);
 
-        font_shader_id = swr::RegisterShader(&font_shader);
+        font_shader_id = swr::RegisterShader(&font_shader, "timings.im_texture");
         if(!font_shader_id)
         {
             throw std::runtime_error("font shader registration failed");
         }
 
-        cube_shader_id = swr::RegisterShader(&cube_shader);
+        cube_shader_id = swr::RegisterShader(&cube_shader, "timings.color");
         if(!cube_shader_id)
         {
             throw std::runtime_error("cube shader registration failed");
@@ -420,6 +422,41 @@ public:
         h += temp;
         str = fmt::format("jobs:  {:4}", rast_data.jobs);
         font_rend.draw_string(font::renderer::string_alignment::right, str, 0 /* ignored */, h);
+
+        /*
+         * tile cache stats.
+         */
+        swr::stats::tile_data tile_data;
+        swr::stats::get_tile_data(tile_data);
+
+        uint32_t flushes = std::accumulate(tile_data.flushes.begin(), tile_data.flushes.end(), 0u);
+        uint32_t max_primitives = tile_data.primitives.empty() ? 0 : *std::max_element(tile_data.primitives.begin(), tile_data.primitives.end());
+
+        font.get_string_dimensions(str, w, temp);
+        h += temp;
+        str = fmt::format("flushes:  {:4}", flushes);
+        font_rend.draw_string(font::renderer::string_alignment::right, str, 0 /* ignored */, h);
+
+        font.get_string_dimensions(str, w, temp);
+        h += temp;
+        str = fmt::format("tile max:  {:4}", max_primitives);
+        font_rend.draw_string(font::renderer::string_alignment::right, str, 0 /* ignored */, h);
+
+        /*
+         * memory stats.
+         */
+        swr::stats::memory_data memory_data;
+        swr::stats::get_memory_data(memory_data);
+
+        font.get_string_dimensions(str, w, temp);
+        h += temp;
+        str = fmt::format("memory:  {:6} kb", memory_data.get_current_total() / 1024);
+        font_rend.draw_string(font::renderer::string_alignment::right, str, 0 /* ignored */, h);
+
+        font.get_string_dimensions(str, w, temp);
+        h += temp;
+        str = fmt::format("tile cache:  {:6} kb", memory_data[swr::stats::memory_category::tile_cache].frame_peak / 1024);
+        font_rend.draw_string(font::renderer::string_alignment::right, str, 0 /* ignored */, h);
 #endif /* SWR_ENABLE_STATS */
     }
 
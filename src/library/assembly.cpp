@@ -154,7 +154,37 @@ static bool face_cull_polygon(swr::cull_face_direction cull_mode, swr::front_fac
     return false;
 }
 
+std::size_t render_device_context::get_max_primitive_count(const render_states* states, vertex_buffer_mode mode, const vertex_buffer& vb)
+{
+    if(mode == vertex_buffer_mode::points
+       || states->poly_mode == polygon_mode::point)
+    {
+        return vb.size();
+    }
+    else if(mode == vertex_buffer_mode::lines)
+    {
+        return vb.size() / 2;
+    }
+    else if(mode == vertex_buffer_mode::triangles)
+    {
+        // for polygon_mode::line, each polygon produces as many lines as it has vertices.
+        return (states->poly_mode == polygon_mode::line) ? vb.size() : vb.size() / 3;
+    }
+
+    return 0;
+}
+
 void render_device_context::assemble_primitives(const render_states* states, vertex_buffer_mode mode, vertex_buffer& vb)
+{
+    assembled_primitives.resize(get_max_primitive_count(states, mode, vb));
+
+    rast::primitive_range range{assembled_primitives.data(), assembled_primitives.size()};
+    assemble_primitives(states, mode, vb, range);
+
+    rasterizer->add_primitives(range.data, range.size);
+}
+
+void render_device_context::assemble_primitives(const render_states* states, vertex_buffer_mode mode, vertex_buffer& vb, rast::primitive_range& out)
 {
     // choose drawing mode.
     if(mode == vertex_buffer_mode::points
@@ -163,7 +193,7 @@ void render_device_context::assemble_primitives(const render_states* states, ver
         /* draw a list of points */
         for(auto& vertex_it: vb)
         {
-            rasterizer->add_point(states, &vertex_it);
+            out.add(states, &vertex_it);
         }
     }
     else if(mode == vertex_buffer_mode::lines)
@@ -172,7 +202,7 @@ void render_device_context::assemble_primitives(const render_states* states, ver
         std::size_t size = vb.size() & ~1;
         for(std::size_t i = 0; i < size; i += 2)
         {
-            rasterizer->add_line(states, &vb[i], &vb[i + 1]);
+            out.add(states, &vb[i], &vb[i + 1]);
         }
     }
     else if(mode == vertex_buffer_mode::triangles)
@@ -220,13 +250,13 @@ void render_device_context::assemble_primitives(const render_states* states, ver
                 {
                     auto* cur_vertex = &vb[i];
 
-                    // Add the current line to the rasterizer.
-                    rasterizer->add_line(states, prev_vertex, cur_vertex);
+                    // Add the current line to the output.
+                    out.add(states, prev_vertex, cur_vertex);
 
                     prev_vertex = cur_vertex;
                 }
                 // close the strip.
-                rasterizer->add_line(states, prev_vertex, first_vertex);
+                out.add(states, prev_vertex, first_vertex);
             }
         }
         else if(states->poly_mode == polygon_mode::fill)
@@ -246,7 +276,7 @@ void render_device_context::assemble_primitives(const render_states* states, ver
                     continue;
                 }
 
-                rasterizer->add_triangle(states, orient == cull_face_direction::front, &v1, &v2, &v3);
+                out.add(states, orient == cull_face_direction::front, &v1, &v2, &v3);
             }
         }
         else
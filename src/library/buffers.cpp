@@ -27,19 +27,24 @@ uint32_t CreateVertexBuffer(const std::vector<ml::vec4>& vb)
     {
         impl::global_context->vertex_buffers[i].push_back(it);
     }
+    SWR_CAPTURE(impl::capture::opcode::create_vertex_buffer, static_cast<uint32_t>(i), vb);
     return i;
 }
 
 uint32_t CreateIndexBuffer(const std::vector<uint32_t>& ib)
 {
     ASSERT_INTERNAL_CONTEXT;
-    return impl::global_context->index_buffers.push(ib);
+    uint32_t id = impl::global_context->index_buffers.push(ib);
+    SWR_CAPTURE(impl::capture::opcode::create_index_buffer, id, ib);
+    return id;
 }
 
 uint32_t CreateAttributeBuffer(const std::vector<ml::vec4>& attribs)
 {
     ASSERT_INTERNAL_CONTEXT;
-    return impl::global_context->vertex_attribute_buffers.push(attribs);
+    uint32_t id = impl::global_context->vertex_attribute_buffers.push(attribs);
+    SWR_CAPTURE(impl::capture::opcode::create_attribute_buffer, id, attribs);
+    return id;
 }
 
 template<typename T>
@@ -59,18 +64,21 @@ static void delete_buffer(uint32_t id, utils::slot_map<T>& buffers, error& last_
 void DeleteVertexBuffer(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::delete_vertex_buffer, id);
     delete_buffer(id, impl::global_context->vertex_buffers, impl::global_context->last_error);
 }
 
 void DeleteIndexBuffer(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::delete_index_buffer, id);
     delete_buffer(id, impl::global_context->index_buffers, impl::global_context->last_error);
 }
 
 void DeleteAttributeBuffer(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::delete_attribute_buffer, id);
 
     if(id < impl::global_context->vertex_attribute_buffers.size())
     {
@@ -86,6 +94,7 @@ void DeleteAttributeBuffer(uint32_t id)
 void EnableAttributeBuffer(uint32_t id, uint32_t slot)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::enable_attribute_buffer, id, slot);
     impl::render_device_context* context = impl::global_context;
 
     // check if id and slot are valid.
@@ -109,6 +118,7 @@ void EnableAttributeBuffer(uint32_t id, uint32_t slot)
 void DisableAttributeBuffer(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::disable_attribute_buffer, id);
     impl::render_device_context* context = impl::global_context;
 
     // check that BufferId is valid.
@@ -0,0 +1,1315 @@
+/**
+ * swr - a software rasterizer
+ *
+ * API call capture and replay.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <unordered_map>
+
+/* user headers. */
+#include "swr_internal.h"
+
+#include "swr/capture.h"
+
+namespace swr
+{
+
+namespace impl
+{
+
+namespace capture
+{
+
+#ifdef SWR_ENABLE_CAPTURE
+
+/** offset of the frame count inside the header, following the magic, the version, the width and the height. */
+constexpr std::size_t frame_count_offset = sizeof(file_magic) + 3 * sizeof(std::uint32_t);
+
+recorder global_recorder;
+
+bool recorder::begin(const char* path, std::uint32_t width, std::uint32_t height, std::uint32_t in_frame_count)
+{
+    if(active)
+    {
+        end();
+    }
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if(!out)
+    {
+        return false;
+    }
+
+    out.write(file_magic, sizeof(file_magic));
+    write(file_version);
+    write(width);
+    write(height);
+    write(std::uint32_t{0}); /* frame count, written when the capture ends. */
+
+    frame_count = in_frame_count;
+    frames = 0;
+    active = static_cast<bool>(out);
+
+    return active;
+}
+
+bool recorder::end()
+{
+    if(!active)
+    {
+        return false;
+    }
+
+    active = false;
+
+    out.seekp(frame_count_offset);
+    write(frames);
+    out.close();
+
+    return !out.fail();
+}
+
+void recorder::present()
+{
+    if(!is_active())
+    {
+        return;
+    }
+
+    record(opcode::present);
+
+    ++frames;
+    if(frame_count != 0 && frames >= frame_count)
+    {
+        end();
+    }
+}
+
+/*
+ * context snapshot.
+ */
+
+/** record the objects of a context, using the context's ids. the replay maps them to its own ids. */
+static void record_objects(recorder& out, render_device_context* context)
+{
+    // buffers.
+    for(std::size_t slot = 0; slot < context->vertex_buffers.size(); ++slot)
+    {
+        if(!context->vertex_buffers.is_free(slot))
+        {
+            std::vector<ml::vec4> coords;
+            coords.reserve(context->vertex_buffers[slot].size());
+            for(const auto& it: context->vertex_buffers[slot])
+            {
+                coords.push_back(it.coords);
+            }
+            out.record(opcode::create_vertex_buffer, static_cast<std::uint32_t>(slot), coords);
+        }
+    }
+    for(std::size_t slot = 0; slot < context->index_buffers.size(); ++slot)
+    {
+        if(!context->index_buffers.is_free(slot))
+        {
+            out.record(opcode::create_index_buffer, static_cast<std::uint32_t>(slot), context->index_buffers[slot]);
+        }
+    }
+    for(std::size_t slot = 0; slot < context->vertex_attribute_buffers.size(); ++slot)
+    {
+        if(!context->vertex_attribute_buffers.is_free(slot))
+        {
+            out.record(opcode::create_attribute_buffer, static_cast<std::uint32_t>(slot), context->vertex_attribute_buffers[slot].data);
+        }
+    }
+
+    // shaders. the default shader is created with the context.
+    for(std::size_t slot = 0; slot < context->programs.size(); ++slot)
+    {
+        if(!context->programs.is_free(slot) && context->programs[slot].shader != context->default_shader.get())
+        {
+            out.record(opcode::register_shader, static_cast<std::uint32_t>(slot), context->programs[slot].key);
+        }
+    }
+
+    // textures. the default texture is created with the context. setting the wrap mode binds the texture
+    // to the active unit, so that the filters can be set. the bindings are restored with the states.
+    out.record(opcode::active_texture, std::uint32_t{0});
+    for(std::size_t slot = 0; slot < context->texture_2d_storage.size(); ++slot)
+    {
+        const auto* texture = context->texture_2d_storage[slot].get();
+        if(!texture || texture == context->default_texture_2d || context->texture_2d_storage.is_free(slot))
+        {
+            continue;
+        }
+
+        out.record(opcode::create_texture, texture->id);
+        if(texture->width > 0 && texture->height > 0 && !texture->data.data_ptrs.empty())
+        {
+            // the base level and the mipmaps are stored in one block of 1.5*width*height texels.
+            const std::size_t texel_count = texture->width * texture->height + ((texture->width * texture->height) >> 1);
+            const ml::vec4* texels = texture->data.data_ptrs[0];
+            out.record(opcode::texture_data, texture->id,
+                       static_cast<std::uint64_t>(texture->width), static_cast<std::uint64_t>(texture->height),
+                       std::vector<ml::vec4>{texels, texels + texel_count});
+        }
+        out.record(opcode::set_texture_wrap_mode, texture->id, texture->sampler->get_wrap_s(), texture->sampler->get_wrap_t());
+        out.record(opcode::set_texture_min_filter, texture->sampler->get_filter_min());
+        out.record(opcode::set_texture_mag_filter, texture->sampler->get_filter_mag());
+    }
+
+    // framebuffer objects. the contents of the depth renderbuffers are not recorded.
+    for(std::size_t slot = 0; slot < context->depth_attachments.size(); ++slot)
+    {
+        if(!context->depth_attachments.is_free(slot))
+        {
+            const auto& renderbuffer = context->depth_attachments[slot];
+            out.record(opcode::create_depth_renderbuffer, static_cast<std::uint32_t>(slot),
+                       static_cast<std::uint32_t>(renderbuffer.info.width), static_cast<std::uint32_t>(renderbuffer.info.height),
+                       renderbuffer.format);
+        }
+    }
+    for(std::size_t slot = 0; slot < context->framebuffer_objects.size(); ++slot)
+    {
+        if(context->framebuffer_objects.is_free(slot))
+        {
+            continue;
+        }
+
+        // framebuffer object ids start at 1, since 0 is the default framebuffer.
+        const auto& fbo = context->framebuffer_objects[slot];
+        const auto id = static_cast<std::uint32_t>(slot + 1);
+        out.record(opcode::create_framebuffer_object, id);
+
+        for(std::size_t index = 0; index < max_color_attachments; ++index)
+        {
+            if(const auto* attachment = fbo.get_color_attachment(index))
+            {
+                out.record(opcode::framebuffer_texture, id, static_cast<framebuffer_attachment>(index), attachment->tex_id, attachment->level);
+            }
+        }
+
+        if(const auto* depth = fbo.get_depth_attachment())
+        {
+            for(std::size_t renderbuffer = 0; renderbuffer < context->depth_attachments.size(); ++renderbuffer)
+            {
+                if(&context->depth_attachments[renderbuffer] == depth)
+                {
+                    out.record(opcode::framebuffer_renderbuffer, id, framebuffer_attachment::depth_attachment, static_cast<std::uint32_t>(renderbuffer));
+                    break;
+                }
+            }
+        }
+    }
+
+    // queries. query ids start at 1. released queries are freed once their draw calls are rasterized.
+    for(std::size_t slot = 0; slot < context->queries.size(); ++slot)
+    {
+        if(!context->queries.is_free(slot) && context->queries[slot].state != query_state::released)
+        {
+            out.record(opcode::create_query, static_cast<std::uint32_t>(slot + 1));
+        }
+    }
+}
+
+/** record the calls restoring the current states of a context. */
+static void record_states(recorder& out, render_device_context* context)
+{
+    const auto& states = context->states;
+
+    for(std::size_t slot = 0; slot < context->active_vabs.size(); ++slot)
+    {
+        if(context->active_vabs[slot] >= 0)
+        {
+            out.record(opcode::enable_attribute_buffer, static_cast<std::uint32_t>(context->active_vabs[slot]), static_cast<std::uint32_t>(slot));
+        }
+    }
+
+    out.record(opcode::set_clear_color, states.clear_color.x, states.clear_color.y, states.clear_color.z, states.clear_color.w);
+    out.record(opcode::set_clear_depth, states.clear_depth);
+    out.record(opcode::set_viewport, states.x, states.y, states.width, states.height);
+    out.record(opcode::depth_range, states.z_near, states.z_far);
+    out.record(opcode::set_scissor_box,
+               states.scissor_box.x_min, states.scissor_box.y_min,
+               states.scissor_box.x_max - states.scissor_box.x_min, states.scissor_box.y_max - states.scissor_box.y_min);
+
+    out.record(opcode::set_state, state::blend, states.blending_enabled);
+    out.record(opcode::set_state, state::cull_face, states.culling_enabled);
+    out.record(opcode::set_state, state::depth_test, states.depth_test_enabled);
+    out.record(opcode::set_state, state::depth_write, states.write_depth);
+    out.record(opcode::set_state, state::polygon_offset_fill, states.polygon_offset_fill_enabled);
+    out.record(opcode::set_state, state::program_point_size, states.program_point_size_enabled);
+    out.record(opcode::set_state, state::scissor_test, states.scissor_test_enabled);
+
+    out.record(opcode::set_depth_test, states.depth_func);
+    out.record(opcode::set_front_face, states.front_face);
+    out.record(opcode::set_cull_mode, states.cull_mode);
+    out.record(opcode::set_polygon_mode, states.poly_mode);
+    out.record(opcode::polygon_offset, states.polygon_offset_factor, states.polygon_offset_units);
+    out.record(opcode::set_point_size, states.point_size);
+    out.record(opcode::set_blend_func, states.blend_src, states.blend_dst);
+    out.record(opcode::set_color_mask,
+               (states.color_mask & output_merger::color_mask::red) != 0,
+               (states.color_mask & output_merger::color_mask::green) != 0,
+               (states.color_mask & output_merger::color_mask::blue) != 0,
+               (states.color_mask & output_merger::color_mask::alpha) != 0);
+
+    for(std::uint32_t unit = 0; unit < states.texture_2d_units.size(); ++unit)
+    {
+        if(states.texture_2d_units[unit] != nullptr)
+        {
+            out.record(opcode::active_texture, unit);
+            out.record(opcode::bind_texture, texture_target::texture_2d, states.texture_2d_units[unit]->id);
+        }
+    }
+    out.record(opcode::active_texture, states.texture_2d_active_unit);
+
+    for(std::size_t slot = 0; slot < context->programs.size(); ++slot)
+    {
+        if(&context->programs[slot] == states.shader_info)
+        {
+            out.record(opcode::bind_shader, static_cast<std::uint32_t>(slot));
+            break;
+        }
+    }
+
+    // the uniform types are not stored. the matrix covers the storage of all types.
+    for(std::uint32_t location = 0; location < states.uniforms.size(); ++location)
+    {
+        out.record(opcode::bind_uniform_mat4x4, location, states.uniforms[location].m4);
+    }
+
+    for(std::size_t slot = 0; slot < context->framebuffer_objects.size(); ++slot)
+    {
+        if(states.draw_target == &context->framebuffer_objects[slot])
+        {
+            out.record(opcode::bind_framebuffer_object, framebuffer_target::draw, static_cast<std::uint32_t>(slot + 1));
+            break;
+        }
+    }
+
+    if(states.active_query != 0)
+    {
+        out.record(opcode::begin_query, context->queries[states.active_query - 1].target, states.active_query);
+    }
+
+    out.record(opcode::set_visibility_buffer, context->rasterizer->visibility_buffer);
+    out.record(opcode::set_depth_sorting, context->sort_opaque_objects);
+
+    out.record(opcode::set_color, context->im_color.x, context->im_color.y, context->im_color.z, context->im_color.w);
+    out.record(opcode::set_tex_coord, context->im_tex_coord.x, context->im_tex_coord.y);
+}
+
+void record_snapshot(render_device_context* context)
+{
+    if(!global_recorder.is_active())
+    {
+        return;
+    }
+
+    record_objects(global_recorder, context);
+    record_states(global_recorder, context);
+}
+
+#endif /* SWR_ENABLE_CAPTURE */
+
+/*
+ * the largest values of the enumerations read from a capture, selected by the argument's type. the values of each
+ * enumeration start at zero and are contiguous.
+ */
+
+constexpr opcode get_max_value(opcode)
+{
+    return opcode::end_query;
+}
+
+constexpr vertex_buffer_mode get_max_value(vertex_buffer_mode)
+{
+    return vertex_buffer_mode::polygon;
+}
+
+constexpr comparison_func get_max_value(comparison_func)
+{
+    return comparison_func::greater_equal;
+}
+
+constexpr front_face_orientation get_max_value(front_face_orientation)
+{
+    return front_face_orientation::ccw;
+}
+
+constexpr cull_face_direction get_max_value(cull_face_direction)
+{
+    return cull_face_direction::front_and_back;
+}
+
+constexpr polygon_mode get_max_value(polygon_mode)
+{
+    return polygon_mode::fill;
+}
+
+constexpr texture_target get_max_value(texture_target)
+{
+    return texture_target::texture_2d;
+}
+
+constexpr pixel_format get_max_value(pixel_format)
+{
+    return pixel_format::bgra8888;
+}
+
+constexpr wrap_mode get_max_value(wrap_mode)
+{
+    return wrap_mode::clamp_to_edge;
+}
+
+constexpr texture_filter get_max_value(texture_filter)
+{
+    return texture_filter::linear;
+}
+
+constexpr blend_func get_max_value(blend_func)
+{
+    return blend_func::one_minus_src_alpha;
+}
+
+constexpr state get_max_value(state)
+{
+    return state::texture;
+}
+
+constexpr framebuffer_target get_max_value(framebuffer_target)
+{
+    return framebuffer_target::draw_read;
+}
+
+constexpr framebuffer_attachment get_max_value(framebuffer_attachment)
+{
+    return framebuffer_attachment::depth_attachment;
+}
+
+constexpr depth_format get_max_value(depth_format)
+{
+    return depth_format::depth32;
+}
+
+constexpr query_target get_max_value(query_target)
+{
+    return query_target::any_samples_passed;
+}
+
+/** reads the recorded calls. all reads are bounds-checked and enumerations are range-checked, so that malformed captures are detected. */
+class reader
+{
+    /** current read position. */
+    const std::byte* ptr;
+
+    /** end of the data. */
+    const std::byte* end;
+
+public:
+    /** constructor. */
+    reader(const std::vector<std::byte>& data)
+    : ptr{data.data()}
+    , end{data.data() + data.size()}
+    {
+    }
+
+    /** whether all data was read. */
+    bool at_end() const
+    {
+        return ptr == end;
+    }
+
+    /** read a value. */
+    template<typename T>
+    bool read(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be read");
+        if(static_cast<std::size_t>(end - ptr) < sizeof(T))
+        {
+            return false;
+        }
+
+        // only the bytes 0 and 1 are valid booleans.
+        if constexpr(std::is_same_v<T, bool>)
+        {
+            const auto byte = std::to_integer<std::uint8_t>(*ptr);
+            if(byte > 1)
+            {
+                return false;
+            }
+        }
+
+        std::memcpy(&value, ptr, sizeof(T));
+
+        // negative values are converted to large unsigned values and are rejected, too.
+        if constexpr(std::is_enum_v<T>)
+        {
+            using unsigned_type = std::make_unsigned_t<std::underlying_type_t<T>>;
+            if(static_cast<unsigned_type>(value) > static_cast<unsigned_type>(get_max_value(T{})))
+            {
+                return false;
+            }
+        }
+
+        ptr += sizeof(T);
+        return true;
+    }
+
+    /** read a buffer. */
+    template<typename T>
+    bool read(std::vector<T>& buffer)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be read");
+
+        std::uint64_t size{0};
+        if(!read(size) || size > static_cast<std::size_t>(end - ptr) / sizeof(T))
+        {
+            return false;
+        }
+
+        buffer.resize(size);
+        std::memcpy(buffer.data(), ptr, size * sizeof(T));
+        ptr += size * sizeof(T);
+        return true;
+    }
+
+    /** read a string. */
+    bool read(std::string& s)
+    {
+        std::uint32_t length{0};
+        if(!read(length) || length > static_cast<std::size_t>(end - ptr))
+        {
+            return false;
+        }
+
+        s.assign(reinterpret_cast<const char*>(ptr), length);
+        ptr += length;
+        return true;
+    }
+
+    /** read a call's arguments. */
+    template<typename... Args>
+    bool read_args(Args&... args)
+    {
+        return (read(args) && ...);
+    }
+};
+
+/**
+ * translates the object ids of a capture to the ids created by the replay. only the ids of objects created by the
+ * capture and of the objects created with the context are known.
+ */
+class id_map
+{
+    /** recorded id to replayed id. */
+    std::unordered_map<std::uint32_t, std::uint32_t> ids;
+
+public:
+    /** constructor. takes the ids of the objects created with the context, which are the same for all contexts. */
+    id_map(std::initializer_list<std::uint32_t> default_ids = {})
+    {
+        for(auto id: default_ids)
+        {
+            ids[id] = id;
+        }
+    }
+
+    /** associate a recorded id to a replayed id. */
+    void set(std::uint32_t recorded_id, std::uint32_t id)
+    {
+        ids[recorded_id] = id;
+    }
+
+    /** get the replayed id. returns false if the id is unknown. */
+    bool get(std::uint32_t recorded_id, std::uint32_t& id) const
+    {
+        auto it = ids.find(recorded_id);
+        if(it == ids.end())
+        {
+            return false;
+        }
+
+        id = it->second;
+        return true;
+    }
+};
+
+/** replay the recorded calls. */
+static bool replay(const swr::capture::capture_data& data, const swr::capture::shader_resolver& resolve_shader, const std::function<void(uint32_t)>& on_present)
+{
+    reader in{data.commands};
+
+    // the default shader, the default texture and the default framebuffer are created with the context.
+    id_map vertex_buffers, index_buffers, attribute_buffers, depth_renderbuffers, queries;
+    id_map shaders{0}, textures{static_cast<std::uint32_t>(default_tex_id)}, framebuffer_objects{0};
+    std::uint32_t frame{0};
+
+    // scratch buffers, reused across calls.
+    std::vector<ml::vec4> vec4_data;
+    std::vector<std::uint32_t> index_data;
+    std::vector<std::uint8_t> image_data;
+    std::string shader_key;
+
+    while(!in.at_end())
+    {
+        opcode op;
+        if(!in.read(op))
+        {
+            return false;
+        }
+
+        std::uint32_t id{0}, other_id{0}, level{0};
+        std::uint64_t x{0}, y{0}, width{0}, height{0};
+        vertex_buffer_mode mode{vertex_buffer_mode::points};
+
+        switch(op)
+        {
+        case opcode::create_vertex_buffer:
+            if(!in.read_args(id, vec4_data))
+            {
+                return false;
+            }
+            vertex_buffers.set(id, CreateVertexBuffer(vec4_data));
+            break;
+
+        case opcode::create_index_buffer:
+            if(!in.read_args(id, index_data))
+            {
+                return false;
+            }
+            index_buffers.set(id, CreateIndexBuffer(index_data));
+            break;
+
+        case opcode::create_attribute_buffer:
+            if(!in.read_args(id, vec4_data))
+            {
+                return false;
+            }
+            attribute_buffers.set(id, CreateAttributeBuffer(vec4_data));
+            break;
+
+        case opcode::delete_vertex_buffer:
+            if(!in.read(id) || !vertex_buffers.get(id, id))
+            {
+                return false;
+            }
+            DeleteVertexBuffer(id);
+            break;
+
+        case opcode::delete_index_buffer:
+            if(!in.read(id) || !index_buffers.get(id, id))
+            {
+                return false;
+            }
+            DeleteIndexBuffer(id);
+            break;
+
+        case opcode::delete_attribute_buffer:
+            if(!in.read(id) || !attribute_buffers.get(id, id))
+            {
+                return false;
+            }
+            DeleteAttributeBuffer(id);
+            break;
+
+        case opcode::enable_attribute_buffer:
+            if(!in.read_args(id, other_id) || !attribute_buffers.get(id, id))
+            {
+                return false;
+            }
+            EnableAttributeBuffer(id, other_id);
+            break;
+
+        case opcode::disable_attribute_buffer:
+            if(!in.read(id) || !attribute_buffers.get(id, id))
+            {
+                return false;
+            }
+            DisableAttributeBuffer(id);
+            break;
+
+        case opcode::draw_elements:
+            if(!in.read_args(x, mode))
+            {
+                return false;
+            }
+            DrawElements(x, mode);
+            break;
+
+        case opcode::draw_indexed_elements:
+            if(!in.read_args(id, mode) || !index_buffers.get(id, id))
+            {
+                return false;
+            }
+            DrawIndexedElements(id, mode);
+            break;
+
+        case opcode::register_shader:
+        {
+            if(!in.read_args(id, shader_key))
+            {
+                return false;
+            }
+
+            const program_base* shader = resolve_shader ? resolve_shader(shader_key) : nullptr;
+            if(shader == nullptr)
+            {
+                return false;
+            }
+            shaders.set(id, RegisterShader(shader, shader_key.c_str()));
+        }
+        break;
+
+        case opcode::unregister_shader:
+            if(!in.read(id) || !shaders.get(id, id))
+            {
+                return false;
+            }
+            UnregisterShader(id);
+            break;
+
+        case opcode::bind_shader:
+            if(!in.read(id) || !shaders.get(id, id))
+            {
+                return false;
+            }
+            BindShader(id);
+            break;
+
+        case opcode::bind_uniform_int:
+        {
+            int value;
+            if(!in.read_args(id, value))
+            {
+                return false;
+            }
+            BindUniform(id, value);
+        }
+        break;
+
+        case opcode::bind_uniform_float:
+        {
+            float value;
+            if(!in.read_args(id, value))
+            {
+                return false;
+            }
+            BindUniform(id, value);
+        }
+        break;
+
+        case opcode::bind_uniform_mat4x4:
+        {
+            ml::mat4x4 value;
+            if(!in.read_args(id, value))
+            {
+                return false;
+            }
+            BindUniform(id, value);
+        }
+        break;
+
+        case opcode::bind_uniform_vec4:
+        {
+            ml::vec4 value;
+            if(!in.read_args(id, value))
+            {
+                return false;
+            }
+            BindUniform(id, value);
+        }
+        break;
+
+        case opcode::begin_primitives:
+            if(!in.read(mode))
+            {
+                return false;
+            }
+            BeginPrimitives(mode);
+            break;
+
+        case opcode::end_primitives:
+            EndPrimitives();
+            break;
+
+        case opcode::set_color:
+        {
+            float r, g, b, a;
+            if(!in.read_args(r, g, b, a))
+            {
+                return false;
+            }
+            SetColor(r, g, b, a);
+        }
+        break;
+
+        case opcode::set_tex_coord:
+        {
+            float u, v;
+            if(!in.read_args(u, v))
+            {
+                return false;
+            }
+            SetTexCoord(u, v);
+        }
+        break;
+
+        case opcode::insert_vertex:
+        {
+            float vx, vy, vz, vw;
+            if(!in.read_args(vx, vy, vz, vw))
+            {
+                return false;
+            }
+            InsertVertex(vx, vy, vz, vw);
+        }
+        break;
+
+        case opcode::present:
+            Present();
+            if(on_present)
+            {
+                on_present(frame);
+            }
+            ++frame;
+            break;
+
+        case opcode::set_visibility_buffer:
+        {
+            bool enable;
+            if(!in.read(enable))
+            {
+                return false;
+            }
+            SetVisibilityBuffer(enable);
+        }
+        break;
+
+        case opcode::set_depth_sorting:
+        {
+            bool enable;
+            if(!in.read(enable))
+            {
+                return false;
+            }
+            SetDepthSorting(enable);
+        }
+        break;
+
+        case opcode::set_depth_test:
+        {
+            comparison_func func;
+            if(!in.read(func))
+            {
+                return false;
+            }
+            SetDepthTest(func);
+        }
+        break;
+
+        case opcode::set_clear_depth:
+        {
+            float z;
+            if(!in.read(z))
+            {
+                return false;
+            }
+            SetClearDepth(z);
+        }
+        break;
+
+        case opcode::clear_depth_buffer:
+            ClearDepthBuffer();
+            break;
+
+        case opcode::discard_depth_buffer:
+            DiscardDepthBuffer();
+            break;
+
+        case opcode::set_clear_color:
+        {
+            float r, g, b, a;
+            if(!in.read_args(r, g, b, a))
+            {
+                return false;
+            }
+            SetClearColor(r, g, b, a);
+        }
+        break;
+
+        case opcode::clear_color_buffer:
+            ClearColorBuffer();
+            break;
+
+        case opcode::set_front_face:
+        {
+            front_face_orientation ffo;
+            if(!in.read(ffo))
+            {
+                return false;
+            }
+            SetFrontFace(ffo);
+        }
+        break;
+
+        case opcode::set_cull_mode:
+        {
+            cull_face_direction cfd;
+            if(!in.read(cfd))
+            {
+                return false;
+            }
+            SetCullMode(cfd);
+        }
+        break;
+
+        case opcode::set_polygon_mode:
+        {
+            polygon_mode pm;
+            if(!in.read(pm))
+            {
+                return false;
+            }
+            SetPolygonMode(pm);
+        }
+        break;
+
+        case opcode::polygon_offset:
+        {
+            float factor, units;
+            if(!in.read_args(factor, units))
+            {
+                return false;
+            }
+            PolygonOffset(factor, units);
+        }
+        break;
+
+        case opcode::set_point_size:
+        {
+            float size;
+            if(!in.read(size))
+            {
+                return false;
+            }
+            SetPointSize(size);
+        }
+        break;
+
+        case opcode::create_texture:
+            if(!in.read(id))
+            {
+                return false;
+            }
+            textures.set(id, CreateTexture());
+            break;
+
+        case opcode::release_texture:
+            if(!in.read(id) || !textures.get(id, id))
+            {
+                return false;
+            }
+            ReleaseTexture(id);
+            break;
+
+        case opcode::active_texture:
+            if(!in.read(id))
+            {
+                return false;
+            }
+            ActiveTexture(id);
+            break;
+
+        case opcode::bind_texture:
+        {
+            texture_target target;
+            if(!in.read_args(target, id) || !textures.get(id, id))
+            {
+                return false;
+            }
+            BindTexture(target, id);
+        }
+        break;
+
+        case opcode::allocate_image:
+            if(!in.read_args(id, width, height) || !textures.get(id, id))
+            {
+                return false;
+            }
+            AllocateImage(id, width, height);
+            break;
+
+        case opcode::set_image:
+        {
+            pixel_format format;
+            if(!in.read_args(id, level, width, height, format, image_data) || !textures.get(id, id))
+            {
+                return false;
+            }
+            SetImage(id, level, width, height, format, image_data);
+        }
+        break;
+
+        case opcode::texture_data:
+        {
+            if(!in.read_args(id, width, height, vec4_data) || !textures.get(id, id))
+            {
+                return false;
+            }
+
+            // restore all mipmap levels. see record_objects.
+            AllocateImage(id, width, height);
+
+            auto& storage = global_context->texture_2d_storage;
+            if(id >= storage.size() || !storage[id] || storage[id]->data.data_ptrs.empty()
+               || vec4_data.size() != width * height + ((width * height) >> 1))
+            {
+                return false;
+            }
+            std::copy(vec4_data.begin(), vec4_data.end(), storage[id]->data.data_ptrs[0]);
+        }
+        break;
+
+        case opcode::set_sub_image:
+        {
+            pixel_format format;
+            if(!in.read_args(id, level, x, y, width, height, format, image_data) || !textures.get(id, id))
+            {
+                return false;
+            }
+            SetSubImage(id, level, x, y, width, height, format, image_data);
+        }
+        break;
+
+        case opcode::set_texture_wrap_mode:
+        {
+            wrap_mode s, t;
+            if(!in.read_args(id, s, t) || !textures.get(id, id))
+            {
+                return false;
+            }
+            SetTextureWrapMode(id, s, t);
+        }
+        break;
+
+        case opcode::set_texture_min_filter:
+        {
+            texture_filter filter;
+            if(!in.read(filter))
+            {
+                return false;
+            }
+            SetTextureMinificationFilter(filter);
+        }
+        break;
+
+        case opcode::set_texture_mag_filter:
+        {
+            texture_filter filter;
+            if(!in.read(filter))
+            {
+                return false;
+            }
+            SetTextureMagnificationFilter(filter);
+        }
+        break;
+
+        case opcode::set_blend_func:
+        {
+            blend_func sfactor, dfactor;
+            if(!in.read_args(sfactor, dfactor))
+            {
+                return false;
+            }
+            SetBlendFunc(sfactor, dfactor);
+        }
+        break;
+
+        case opcode::set_color_mask:
+        {
+            bool red, green, blue, alpha;
+            if(!in.read_args(red, green, blue, alpha))
+            {
+                return false;
+            }
+            SetColorMask(red, green, blue, alpha);
+        }
+        break;
+
+        case opcode::set_scissor_box:
+        {
+            int sx, sy, sw, sh;
+            if(!in.read_args(sx, sy, sw, sh))
+            {
+                return false;
+            }
+            SetScissorBox(sx, sy, sw, sh);
+        }
+        break;
+
+        case opcode::set_state:
+        {
+            state s;
+            bool enable;
+            if(!in.read_args(s, enable))
+            {
+                return false;
+            }
+            SetState(s, enable);
+        }
+        break;
+
+        case opcode::set_viewport:
+        {
+            int vx, vy;
+            unsigned int vw, vh;
+            if(!in.read_args(vx, vy, vw, vh))
+            {
+                return false;
+            }
+            SetViewport(vx, vy, vw, vh);
+        }
+        break;
+
+        case opcode::depth_range:
+        {
+            float z_near, z_far;
+            if(!in.read_args(z_near, z_far))
+            {
+                return false;
+            }
+            DepthRange(z_near, z_far);
+        }
+        break;
+
+        case opcode::create_framebuffer_object:
+            if(!in.read(id))
+            {
+                return false;
+            }
+            framebuffer_objects.set(id, CreateFramebufferObject());
+            break;
+
+        case opcode::release_framebuffer_object:
+            if(!in.read(id) || !framebuffer_objects.get(id, id))
+            {
+                return false;
+            }
+            ReleaseFramebufferObject(id);
+            break;
+
+        case opcode::bind_framebuffer_object:
+        {
+            framebuffer_target target;
+            if(!in.read_args(target, id) || !framebuffer_objects.get(id, id))
+            {
+                return false;
+            }
+            BindFramebufferObject(target, id);
+        }
+        break;
+
+        case opcode::framebuffer_texture:
+        {
+            framebuffer_attachment attachment;
+            if(!in.read_args(id, attachment, other_id, level) || !framebuffer_objects.get(id, id) || !textures.get(other_id, other_id))
+            {
+                return false;
+            }
+            FramebufferTexture(id, attachment, other_id, level);
+        }
+        break;
+
+        case opcode::create_depth_renderbuffer:
+        {
+            std::uint32_t w, h;
+            depth_format format;
+            if(!in.read_args(id, w, h, format))
+            {
+                return false;
+            }
+            depth_renderbuffers.set(id, CreateDepthRenderbuffer(w, h, format));
+        }
+        break;
+
+        case opcode::release_depth_renderbuffer:
+            if(!in.read(id) || !depth_renderbuffers.get(id, id))
+            {
+                return false;
+            }
+            ReleaseDepthRenderbuffer(id);
+            break;
+
+        case opcode::framebuffer_renderbuffer:
+        {
+            framebuffer_attachment attachment;
+            if(!in.read_args(id, attachment, other_id) || !framebuffer_objects.get(id, id) || !depth_renderbuffers.get(other_id, other_id))
+            {
+                return false;
+            }
+            FramebufferRenderbuffer(id, attachment, other_id);
+        }
+        break;
+
+        case opcode::create_query:
+            if(!in.read(id))
+            {
+                return false;
+            }
+            queries.set(id, CreateQuery());
+            break;
+
+        case opcode::release_query:
+            if(!in.read(id) || !queries.get(id, id))
+            {
+                return false;
+            }
+            ReleaseQuery(id);
+            break;
+
+        case opcode::begin_query:
+        {
+            query_target target;
+            if(!in.read_args(target, id) || !queries.get(id, id))
+            {
+                return false;
+            }
+            BeginQuery(target, id);
+        }
+        break;
+
+        case opcode::end_query:
+        {
+            query_target target;
+            if(!in.read(target))
+            {
+                return false;
+            }
+            EndQuery(target);
+        }
+        break;
+
+        default:
+            // unknown opcode.
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} /* namespace capture */
+
+} /* namespace impl */
+
+/*
+ * capture interface.
+ */
+
+namespace capture
+{
+
+bool begin_capture([[maybe_unused]] const char* path, [[maybe_unused]] uint32_t frame_count)
+{
+#ifdef SWR_ENABLE_CAPTURE
+    if(path == nullptr || impl::global_context == nullptr)
+    {
+        return false;
+    }
+
+    // the calls of an incomplete primitive declaration cannot be recorded.
+    if(impl::global_context->im_declaring_primitives)
+    {
+        return false;
+    }
+
+    const auto& info = impl::global_context->framebuffer.color_buffer.info;
+    if(!impl::capture::global_recorder.begin(path, info.width, info.height, frame_count))
+    {
+        return false;
+    }
+
+    impl::capture::record_snapshot(impl::global_context);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool end_capture()
+{
+#ifdef SWR_ENABLE_CAPTURE
+    return impl::capture::global_recorder.end();
+#else
+    return false;
+#endif
+}
+
+bool load_capture(const char* path, capture_data& data)
+{
+    if(path == nullptr)
+    {
+        return false;
+    }
+
+    std::ifstream in{path, std::ios::binary};
+    if(!in)
+    {
+        return false;
+    }
+
+    char magic[sizeof(impl::capture::file_magic)];
+    std::uint32_t version{0};
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&data.width), sizeof(data.width));
+    in.read(reinterpret_cast<char*>(&data.height), sizeof(data.height));
+    in.read(reinterpret_cast<char*>(&data.frame_count), sizeof(data.frame_count));
+
+    if(!in
+       || std::memcmp(magic, impl::capture::file_magic, sizeof(magic)) != 0
+       || version != impl::capture::file_version)
+    {
+        return false;
+    }
+
+    // read the remaining file.
+    std::vector<char> commands{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    data.commands.resize(commands.size());
+    std::memcpy(data.commands.data(), commands.data(), commands.size());
+
+    return true;
+}
+
+bool replay_capture(const capture_data& data, const shader_resolver& resolve_shader, const std::function<void(uint32_t)>& on_present)
+{
+    if(impl::global_context == nullptr)
+    {
+        return false;
+    }
+
+#ifdef SWR_ENABLE_CAPTURE
+    // the replayed calls would be recorded again.
+    if(impl::capture::global_recorder.is_active())
+    {
+        return false;
+    }
+#endif
+
+    return impl::capture::replay(data, resolve_shader, on_present);
+}
+
+} /* namespace capture */
+
+} /* namespace swr */
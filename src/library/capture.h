@@ -0,0 +1,239 @@
+/**
+ * swr - a software rasterizer
+ *
+ * API call capture. the calls are serialized as an opcode followed by the call's arguments,
+ * in the order they appear in the public interface. the file starts with a header holding
+ * the size of the default framebuffer and the number of recorded frames.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+#pragma once
+
+/** record an API call if a capture is in progress. the first argument is the opcode, the remaining ones are the call's arguments. */
+#ifdef SWR_ENABLE_CAPTURE
+#    define SWR_CAPTURE(...)                                             \
+        do                                                               \
+        {                                                                \
+            if(swr::impl::capture::global_recorder.is_active())          \
+            {                                                            \
+                swr::impl::capture::global_recorder.record(__VA_ARGS__); \
+            }                                                            \
+        } while(0)
+#    define SWR_CAPTURE_SUSPEND() swr::impl::capture::suspend_scope capture_suspend_scope
+#else
+#    define SWR_CAPTURE(...)
+#    define SWR_CAPTURE_SUSPEND()
+#endif
+
+/* C++ headers. */
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace swr
+{
+
+namespace impl
+{
+
+/* forward declaration. */
+class render_device_context;
+
+namespace capture
+{
+
+/** file identifier. */
+constexpr char file_magic[4] = {'S', 'W', 'R', 'C'};
+
+/** file format version. version 2 records shader keys instead of type names. */
+constexpr std::uint32_t file_version{2};
+
+/** recorded calls. new opcodes have to be appended, so that older captures stay readable. */
+enum class opcode : std::uint8_t
+{
+    create_vertex_buffer,
+    create_index_buffer,
+    create_attribute_buffer,
+    delete_vertex_buffer,
+    delete_index_buffer,
+    delete_attribute_buffer,
+    enable_attribute_buffer,
+    disable_attribute_buffer,
+    draw_elements,
+    draw_indexed_elements,
+    register_shader,
+    unregister_shader,
+    bind_shader,
+    bind_uniform_int,
+    bind_uniform_float,
+    bind_uniform_mat4x4,
+    bind_uniform_vec4,
+    begin_primitives,
+    end_primitives,
+    set_color,
+    set_tex_coord,
+    insert_vertex,
+    present,
+    set_visibility_buffer,
+    set_depth_sorting,
+    set_depth_test,
+    set_clear_depth,
+    clear_depth_buffer,
+    discard_depth_buffer,
+    set_clear_color,
+    clear_color_buffer,
+    set_front_face,
+    set_cull_mode,
+    set_polygon_mode,
+    polygon_offset,
+    set_point_size,
+    create_texture,
+    release_texture,
+    active_texture,
+    bind_texture,
+    allocate_image,
+    set_image,
+    set_sub_image,
+    set_texture_wrap_mode,
+    set_texture_min_filter,
+    set_texture_mag_filter,
+    set_blend_func,
+    set_color_mask,
+    set_scissor_box,
+    set_state,
+    set_viewport,
+    depth_range,
+    create_framebuffer_object,
+    release_framebuffer_object,
+    bind_framebuffer_object,
+    framebuffer_texture,
+    create_depth_renderbuffer,
+    release_depth_renderbuffer,
+    framebuffer_renderbuffer,
+    texture_data,
+    create_query,
+    release_query,
+    begin_query,
+    end_query
+};
+
+#ifdef SWR_ENABLE_CAPTURE
+
+/** API call recorder. calls are recorded on the thread owning the current context. */
+class recorder
+{
+    /** output file. */
+    std::ofstream out;
+
+    /** whether a capture is in progress. */
+    bool active{false};
+
+    /** nesting level of suspend_scope. calls made by the library itself are not recorded. */
+    std::uint32_t suspended{0};
+
+    /** number of frames to record, or 0 to record until the capture is ended. */
+    std::uint32_t frame_count{0};
+
+    /** frames recorded so far. */
+    std::uint32_t frames{0};
+
+    /** write a value. */
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be written");
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /** write the size and the contents of a buffer. */
+    template<typename T>
+    void write(const std::vector<T>& buffer)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be written");
+        write(static_cast<std::uint64_t>(buffer.size()));
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(T));
+    }
+
+    /** write the length and the characters of a string. */
+    void write(const std::string& s)
+    {
+        write(static_cast<std::uint32_t>(s.size()));
+        out.write(s.data(), s.size());
+    }
+
+public:
+    /** whether calls are recorded. */
+    bool is_active() const
+    {
+        return active && suspended == 0;
+    }
+
+    /** start a capture. the size of the default framebuffer is written to the header. */
+    bool begin(const char* path, std::uint32_t width, std::uint32_t height, std::uint32_t in_frame_count);
+
+    /** end the capture and write the frame count to the header. */
+    bool end();
+
+    /** record a call. */
+    template<typename... Args>
+    void record(opcode op, const Args&... args)
+    {
+        write(op);
+        (write(args), ...);
+    }
+
+    /** record a call to Present. ends the capture after the requested number of frames. */
+    void present();
+
+    /** suspend recording. */
+    void suspend()
+    {
+        ++suspended;
+    }
+
+    /** resume recording. */
+    void resume()
+    {
+        --suspended;
+    }
+};
+
+/** global recorder. */
+extern recorder global_recorder;
+
+/** record the calls recreating the objects and the states of a context. called when a capture begins. */
+void record_snapshot(render_device_context* context);
+
+/** suspend recording for the lifetime of the object, e.g. while an API function calls other API functions. */
+class suspend_scope
+{
+public:
+    /** suspend recording. */
+    suspend_scope()
+    {
+        global_recorder.suspend();
+    }
+
+    /** resume recording. */
+    ~suspend_scope()
+    {
+        global_recorder.resume();
+    }
+
+    /** no copies. */
+    suspend_scope(const suspend_scope&) = delete;
+    suspend_scope& operator=(const suspend_scope&) = delete;
+};
+
+#endif /* SWR_ENABLE_CAPTURE */
+
+} /* namespace capture */
+
+} /* namespace impl */
+
+} /* namespace swr */
@@ -224,6 +224,44 @@ static void clip_vertex_buffer_on_plane(const vertex_buffer& in_vb, const clip_a
     }
 }
 
+/**
+ * Copy the points referenced by the index range [index_begin, index_end) which are not marked for discarding
+ * into out_vb. the vertices are appended to out_vb.
+ */
+void clip_point_buffer(const render_object& obj, std::size_t index_begin, std::size_t index_end, vertex_buffer& out_vb)
+{
+    // TODO temporary.
+    geom::vertex v;
+    v.attribs.reserve(obj.attrib_count);
+    v.varyings.reserve(obj.states.shader_info->varying_count);
+
+    out_vb.reserve(out_vb.size() + (index_end - index_begin));
+
+    // copy the correct points.
+    for(std::size_t index_it = index_begin; index_it < index_end; ++index_it)
+    {
+        const auto i = obj.indices[index_it];
+        if(!(obj.vertex_flags[i] & geom::vf_clip_discard))
+        {
+            v.attribs.clear();
+            for(std::size_t j = 0; j < obj.attrib_count; ++j)
+            {
+                v.attribs.emplace_back(obj.attribs[i * obj.attrib_count + j]);
+            }
+            v.coords = obj.coords[i];
+            v.flags = obj.vertex_flags[i];
+            v.point_size = obj.point_sizes[i];
+            v.varyings.clear();
+            for(std::size_t j = 0; j < obj.states.shader_info->varying_count; ++j)
+            {
+                v.varyings.emplace_back(obj.varyings[i * obj.states.shader_info->varying_count + j]);
+            }
+
+            out_vb.emplace_back(v);
+        }
+    }
+}
+
 /**
  * Clip a line against the w plane.
  *
@@ -286,8 +324,10 @@ static void clip_line_on_w_plane(const vertex_buffer& in_line, vertex_buffer& ou
  * Clip a vertex buffer/index buffer pair against the view frustum. the index buffer/vertex buffer pair is assumed
  * to contain a line list, i.e., if i is divisible by 2, then in_ib[i] and in_ib[i+1] need to be indices into in_vb
  * forming a line.
+ *
+ * only the lines inside the index range [index_begin, index_end) are clipped, and the output is appended to out_vb.
  */
-void clip_line_buffer(render_object& obj, clip_output output_type)
+void clip_line_buffer(const render_object& obj, std::size_t index_begin, std::size_t index_end, clip_output output_type, vertex_buffer& out_vb)
 {
     vertex_buffer clipped_line{2};
     vertex_buffer temp_line{2};
@@ -300,14 +340,13 @@ void clip_line_buffer(render_object& obj, clip_output output_type)
      *  iii) Copy all temporary lines to the output vertex buffer.
      */
 
-    obj.clipped_vertices.clear();
-    obj.clipped_vertices.reserve(obj.coord_count);
+    out_vb.reserve(out_vb.size() + (index_end - index_begin));
 
     // TODO temporary
     geom::vertex v;
     v.varyings.reserve(obj.states.shader_info->varying_count);
 
-    for(size_t index_it = 0; index_it < obj.indices.size(); index_it += 2)
+    for(size_t index_it = index_begin; index_it + 1 < index_end; index_it += 2)
     {
         const std::uint32_t indices[2] = {
           obj.indices[index_it],
@@ -349,12 +388,12 @@ void clip_line_buffer(render_object& obj, clip_output output_type)
             if(output_type == point_list)
             {
                 // write a list of points.
-                obj.clipped_vertices.insert(std::end(obj.clipped_vertices), std::begin(clipped_line), std::end(clipped_line));
+                out_vb.insert(std::end(out_vb), std::begin(clipped_line), std::end(clipped_line));
             }
             else if(output_type == line_list)
             {
                 // store vertex list.
-                obj.clipped_vertices.insert(std::end(obj.clipped_vertices), std::begin(clipped_line), std::end(clipped_line));
+                out_vb.insert(std::end(out_vb), std::begin(clipped_line), std::end(clipped_line));
             }
         }
         else
@@ -377,7 +416,7 @@ void clip_line_buffer(render_object& obj, clip_output output_type)
 
                     v.flags = obj.vertex_flags[indices[i]];
 
-                    obj.clipped_vertices.push_back(v);
+                    out_vb.push_back(v);
                 }
             }
             else if(output_type == line_list)
@@ -397,7 +436,7 @@ void clip_line_buffer(render_object& obj, clip_output output_type)
 
                     v.flags = obj.vertex_flags[indices[i]];
 
-                    obj.clipped_vertices.push_back(v);
+                    out_vb.push_back(v);
                 }
             }
         }
@@ -468,8 +507,10 @@ static void clip_triangle_on_w_plane(const vertex_buffer& in_triangle, vertex_bu
  * Clip a vertex buffer/index buffer pair against the view frustum. the index buffer/vertex buffer pair is assumed
  * to contain a triangle list, i.e., if i is divisible by 3, then in_ib[i], in_ib[i+1] and in_ib[i+2] need to
  * be indices into in_vb forming a triangle.
+ *
+ * only the triangles inside the index range [index_begin, index_end) are clipped, and the output is appended to out_vb.
  */
-void clip_triangle_buffer(render_object& obj, clip_output output_type)
+void clip_triangle_buffer(const render_object& obj, std::size_t index_begin, std::size_t index_end, clip_output output_type, vertex_buffer& out_vb)
 {
     /*
      * temporary buffers.
@@ -490,14 +531,13 @@ void clip_triangle_buffer(render_object& obj, clip_output output_type)
      *  iii) Copy all temporary triangles to the output vertex buffer.
      */
 
-    obj.clipped_vertices.clear();
-    obj.clipped_vertices.reserve(obj.coord_count);
+    out_vb.reserve(out_vb.size() + (index_end - index_begin));
 
     // TODO temporary
     geom::vertex v;
     v.varyings.reserve(obj.states.shader_info->varying_count);
 
-    for(size_t index_it = 0; index_it < obj.indices.size(); index_it += 3)
+    for(size_t index_it = index_begin; index_it + 2 < index_end; index_it += 3)
     {
         const std::uint32_t indices[3] = {
           obj.indices[index_it],
@@ -541,15 +581,15 @@ void clip_triangle_buffer(render_object& obj, clip_output output_type)
             if(output_type == point_list)
             {
                 // write a list of points.
-                obj.clipped_vertices.insert(std::end(obj.clipped_vertices), std::begin(clipped_triangle), std::end(clipped_triangle));
+                out_vb.insert(std::end(out_vb), std::begin(clipped_triangle), std::end(clipped_triangle));
             }
             else if(output_type == line_list
                     && clipped_triangle.size() >= 2)
             {
                 // store vertex list. mark last vertex of the line,
                 // so that the polygons can all be reconstructed.
-                obj.clipped_vertices.insert(std::end(obj.clipped_vertices), std::begin(clipped_triangle), std::end(clipped_triangle));
-                obj.clipped_vertices.back().flags |= geom::vf_line_strip_end;
+                out_vb.insert(std::end(out_vb), std::begin(clipped_triangle), std::end(clipped_triangle));
+                out_vb.back().flags |= geom::vf_line_strip_end;
             }
             else if(output_type == triangle_list && clipped_triangle.size() >= 3)
             {
@@ -563,9 +603,9 @@ void clip_triangle_buffer(render_object& obj, clip_output output_type)
                 {
                     const geom::vertex* current = &clipped_triangle[i];
 
-                    obj.clipped_vertices.push_back(center);
-                    obj.clipped_vertices.push_back(*previous);
-                    obj.clipped_vertices.push_back(*current);
+                    out_vb.push_back(center);
+                    out_vb.push_back(*previous);
+                    out_vb.push_back(*current);
 
                     previous = current;
                 }
@@ -589,7 +629,7 @@ void clip_triangle_buffer(render_object& obj, clip_output output_type)
 
                     v.flags = obj.vertex_flags[indices[i]];
 
-                    obj.clipped_vertices.push_back(v);
+                    out_vb.push_back(v);
                 }
             }
             else if(output_type == line_list)
@@ -608,11 +648,11 @@ void clip_triangle_buffer(render_object& obj, clip_output output_type)
 
                     v.flags = obj.vertex_flags[indices[i]];
 
-                    obj.clipped_vertices.push_back(v);
+                    out_vb.push_back(v);
                 }
 
                 // mark last index as end of line strip.
-                obj.clipped_vertices.back().flags |= geom::vf_line_strip_end;
+                out_vb.back().flags |= geom::vf_line_strip_end;
             }
             else if(output_type == triangle_list)
             {
@@ -630,7 +670,7 @@ void clip_triangle_buffer(render_object& obj, clip_output output_type)
 
                     v.flags = obj.vertex_flags[indices[i]];
 
-                    obj.clipped_vertices.push_back(v);
+                    out_vb.push_back(v);
                 }
             }
         }
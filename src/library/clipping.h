@@ -22,19 +22,31 @@ enum clip_output
     triangle_list /* a list of triangles */
 };
 
+/**
+ * Copy the points referenced by the index range [index_begin, index_end) which are not marked for discarding
+ * into out_vb. the vertices are appended to out_vb.
+ */
+void clip_point_buffer(const render_object& obj, std::size_t index_begin, std::size_t index_end, vertex_buffer& out_vb);
+
 /**
  * Clip a vertex buffer/index buffer pair against the view frustum. the index buffer/vertex buffer pair is assumed
  * to contain a line list, i.e., if i is divisible by 2, then in_ib[i] and in_ib[i+1] need to be indices into in_vb
  * forming a line.
+ *
+ * only the lines inside the index range [index_begin, index_end) are clipped, and the output is appended to out_vb.
+ * index_begin has to be divisible by 2.
  */
-void clip_line_buffer(render_object& obj, clip_output output_type);
+void clip_line_buffer(const render_object& obj, std::size_t index_begin, std::size_t index_end, clip_output output_type, vertex_buffer& out_vb);
 
 /**
  * Clip a vertex buffer/index buffer pair against the view frustum. the index buffer/vertex buffer pair is assumed
  * to contain a triangle list, i.e., if i is divisible by 3, then in_ib[i], in_ib[i+1] and in_ib[i+2] need to
  * be indices into in_vb forming a triangle.
+ *
+ * only the triangles inside the index range [index_begin, index_end) are clipped, and the output is appended to out_vb.
+ * index_begin has to be divisible by 3.
  */
-void clip_triangle_buffer(render_object& obj, clip_output output_type);
+void clip_triangle_buffer(const render_object& obj, std::size_t index_begin, std::size_t index_end, clip_output output_type, vertex_buffer& out_vb);
 
 } /* namespace impl */
 
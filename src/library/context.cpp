@@ -30,11 +30,58 @@ thread_local render_device_context* global_context = nullptr;
  * render context implementation.
  */
 
+void render_device_context::initialize()
+{
+    // create default texture.
+    create_default_texture(this);
+
+#ifdef SWR_ENABLE_MULTI_THREADING
+    // create thread pool
+    // we don't use more threads than reported by std::thread::hardware_concurrence and default to half of it.
+    if(thread_pool_size == 0 || thread_pool_size > std::thread::hardware_concurrency())
+    {
+        thread_pool_size = (std::thread::hardware_concurrency() > 1) ? (std::thread::hardware_concurrency() / 2) : 1;
+    }
+    thread_pool.reset(thread_pool_size);
+
+    try
+    {
+        rasterizer = std::make_unique<rast::sweep_rasterizer>(&thread_pool, &framebuffer);
+    }
+    catch(std::bad_alloc& e)
+    {
+        throw std::runtime_error(fmt::format("render_device_context: bad_alloc on allocating sweep_rasterizer: {}", e.what()));
+    }
+#else
+    try
+    {
+        rasterizer = std::make_unique<rast::sweep_rasterizer>(nullptr, &framebuffer);
+    }
+    catch(std::bad_alloc& e)
+    {
+        throw std::runtime_error(fmt::format("render_device_context: bad_alloc on allocating sweep_rasterizer: {}", e.what()));
+    }
+#endif
+
+    // create default shader. this needs to happen after the thread pool
+    // is set up, since we create one shader per thread.
+    create_default_shader(this);
+}
+
 void render_device_context::shutdown()
 {
     // empty command list.
     render_object_list.clear();
 
+    // primitive assembly.
+    assembled_primitives.clear();
+    assembled_primitives.shrink_to_fit();
+
+#ifdef SWR_ENABLE_MULTI_THREADING
+    assembly_ranges.clear();
+    assembly_ranges.shrink_to_fit();
+#endif /* SWR_ENABLE_MULTI_THREADING */
+
     /*
      * Clean up all slot maps.
      */
@@ -46,6 +93,10 @@ void render_device_context::shutdown()
     depth_attachments.clear();
     depth_attachments.shrink_to_fit();
 
+    // occlusion queries.
+    queries.clear();
+    queries.shrink_to_fit();
+
     // delete all geometry data.
     vertex_buffers.clear();
     vertex_buffers.shrink_to_fit();
@@ -174,40 +225,8 @@ void sdl_render_context::initialize(SDL_Window* window, SDL_Renderer* renderer,
     // write dimensions for the blitting rectangle.
     sdl_viewport_dimensions = {0, 0, width, height};
 
-    // create default texture.
-    create_default_texture(this);
-
-#ifdef SWR_ENABLE_MULTI_THREADING
-    // create thread pool
-    // we don't use more threads than reported by std::thread::hardware_concurrence and default to half of it.
-    if(thread_pool_size == 0 || thread_pool_size > std::thread::hardware_concurrency())
-    {
-        thread_pool_size = (std::thread::hardware_concurrency() > 1) ? (std::thread::hardware_concurrency() / 2) : 1;
-    }
-    thread_pool.reset(thread_pool_size);
-
-    try
-    {
-        rasterizer = std::make_unique<rast::sweep_rasterizer>(&thread_pool, &framebuffer);
-    }
-    catch(std::bad_alloc& e)
-    {
-        throw std::runtime_error(fmt::format("sdl_render_context: bad_alloc on allocating sweep_rasterizer: {}", e.what()));
-    }
-#else
-    try
-    {
-        rasterizer = std::make_unique<rast::sweep_rasterizer>(nullptr, &framebuffer);
-    }
-    catch(std::bad_alloc& e)
-    {
-        throw std::runtime_error(fmt::format("sdl_render_context: bad_alloc on allocating sweep_rasterizer: {}", e.what()));
-    }
-#endif
-
-    // create default shader. this needs to happen after the thread pool
-    // is set up, since we create one shader per thread.
-    create_default_shader(this);
+    // create the rasterizer and the default objects.
+    render_device_context::initialize();
 }
 
 void sdl_render_context::shutdown()
@@ -257,7 +276,7 @@ void sdl_render_context::update_buffers(int width, int height)
         return;
     }
 
-    framebuffer.setup(width, height, 0, swr_pixel_format, nullptr);
+    framebuffer.setup(width, height, 0, swr_pixel_format, nullptr, default_depth_format);
 }
 
 void sdl_render_context::copy_default_color_buffer()
@@ -297,13 +316,56 @@ void sdl_render_context::unlock()
     }
 }
 
+/*
+ * offscreen render context implementation.
+ */
+
+void offscreen_render_context::initialize(int width, int height)
+{
+    if(width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // reset states to default values.
+    states.reset(&framebuffer);
+
+    // set viewport dimensions.
+    states.set_viewport(0, 0, width, height);
+
+    // set scissor box.
+    states.set_scissor_box(0, width, 0, height);
+
+    // create buffers. the color buffer stays attached for the lifetime of the context.
+    color_buffer_data.resize(width * height);
+    framebuffer.setup(width, height, width * sizeof(std::uint32_t), pixel_format::argb8888, color_buffer_data.data(), default_depth_format);
+
+    // create the rasterizer and the default objects.
+    render_device_context::initialize();
+}
+
+void offscreen_render_context::shutdown()
+{
+    framebuffer.reset();
+
+    color_buffer_data.clear();
+    color_buffer_data.shrink_to_fit();
+
+    render_device_context::shutdown();
+}
+
+bool offscreen_render_context::lock()
+{
+    return framebuffer.is_color_attached();
+}
+
 } /* namespace impl */
 
 /*
  * context interface.
  */
 
-context_handle CreateSDLContext(SDL_Window* window, SDL_Renderer* renderer, uint32_t thread_hint)
+context_handle CreateSDLContext(SDL_Window* window, SDL_Renderer* renderer, uint32_t thread_hint, depth_format default_depth_format)
 {
     if(!window || !renderer)
     {
@@ -312,11 +374,23 @@ context_handle CreateSDLContext(SDL_Window* window, SDL_Renderer* renderer, uint
 
     int width = 0, height = 0;
     SDL_GetWindowSize(window, &width, &height);
-    auto* context = new impl::sdl_render_context(thread_hint);
+    auto* context = new impl::sdl_render_context(thread_hint, default_depth_format);
     context->initialize(window, renderer, width, height);
     return context;
 }
 
+context_handle CreateOffscreenContext(uint32_t width, uint32_t height, uint32_t thread_hint, depth_format default_depth_format)
+{
+    if(width == 0 || height == 0)
+    {
+        return nullptr;
+    }
+
+    auto* context = new impl::offscreen_render_context(thread_hint, default_depth_format);
+    context->initialize(width, height);
+    return context;
+}
+
 void DestroyContext(context_handle context)
 {
     if(context)
@@ -351,12 +425,26 @@ bool MakeContextCurrent(context_handle context)
     return impl::global_context->lock();
 }
 
+uint32_t GetThreadCount([[maybe_unused]] context_handle context)
+{
+    assert(context);
+
+#ifdef SWR_ENABLE_MULTI_THREADING
+    return static_cast<impl::render_device_context*>(context)->thread_pool_size;
+#else
+    return 1;
+#endif
+}
+
 void CopyDefaultColorBuffer(context_handle context)
 {
     assert(context);
 
     swr::impl::render_device_context* internal_context = static_cast<swr::impl::render_device_context*>(context);
 
+    // fill the tiles that were cleared but not drawn to.
+    internal_context->framebuffer.materialize_color_clears();
+
     internal_context->unlock();
     internal_context->copy_default_color_buffer();
 
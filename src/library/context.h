@@ -25,7 +25,8 @@ enum
 {
     none = 0,
     prelinked = 1,
-    linked = 2
+    linked = 2,
+    depth_invariant = 4 /* the fragment shader neither writes depth nor discards fragments. */
 };
 } /* namespace program_flags */
 
@@ -50,6 +51,9 @@ struct program_info
     /** (pointer to) the graphics program/shader. */
     const program_base* shader{nullptr};
 
+    /** the key the shader was registered with. recorded by captures. */
+    std::string key;
+
     /** shader size. */
     std::size_t program_size;
 
@@ -90,6 +94,40 @@ struct program_info
     {
         return (flags & program_flags::linked) != 0;
     }
+
+    bool is_depth_invariant() const
+    {
+        return (flags & program_flags::depth_invariant) != 0;
+    }
+};
+
+/** occlusion query states. */
+enum class query_state
+{
+    idle,      /** the query was created, but not started. */
+    active,    /** BeginQuery was called without a matching EndQuery. */
+    ended,     /** the query was ended, and its draw calls wait for Present. */
+    available, /** the result is available. */
+    released   /** the query was released while its draw calls wait for Present. the slot is freed by Present. */
+};
+
+/** occlusion query. */
+struct query_object
+{
+    /** the target the query was started for. */
+    query_target target{query_target::samples_passed};
+
+    /** current state. */
+    query_state state{query_state::idle};
+
+    /** fragments passing the depth test, counted so far. */
+    std::uint64_t samples{0};
+
+    /** return the query result. */
+    std::uint64_t get_result() const
+    {
+        return (target == query_target::any_samples_passed) ? (samples != 0 ? 1 : 0) : samples;
+    }
 };
 
 /*
@@ -156,6 +194,13 @@ public:
     /** depth renderbuffers. */
     utils::slot_map<attachment_depth> depth_attachments;
 
+    /*
+     * occlusion queries.
+     */
+
+    /** query objects. the active query is stored in the render states. */
+    utils::slot_map<query_object> queries;
+
     /*
      * context states.
      */
@@ -177,6 +222,9 @@ public:
     /** list of render commands to be processed. points into objects. */
     std::list<render_object> render_object_list;
 
+    /** whether runs of opaque render objects are sorted front-to-back before primitive assembly. */
+    bool sort_opaque_objects{false};
+
     /** vertex buffers. */
     utils::slot_map<vertex_buffer> vertex_buffers;
 
@@ -202,6 +250,12 @@ public:
 
     /** render object with their associated program instances, to avoid reallocations. */
     std::vector<std::pair<swr::impl::render_object*, impl::vertex_shader_instance_container>> program_instances;
+
+    /** shading states of the vertices of render objects with non-sequential indices, to avoid reallocations. */
+    std::unique_ptr<std::atomic<std::uint32_t>[]> vertex_states;
+
+    /** number of allocated vertex states. */
+    std::size_t vertex_state_capacity{0};
 #endif /* SWR_ENDABLE_MULTI_THREADING */
 
     /** default shader. */
@@ -282,6 +336,15 @@ public:
 
     /** rasterizer info and collected data. */
     stats::rasterizer_data stats_rast;
+
+    /** cycles spent in the pipeline stages. */
+    stats::pipeline_data stats_pipeline;
+
+    /** tile load balance and tile cache statistics. */
+    stats::tile_data stats_tiles;
+
+    /** memory usage of the context. */
+    stats::memory_data stats_memory;
 #endif
 
     /*
@@ -331,6 +394,17 @@ public:
      * primitive assembly.
      */
 
+    /** storage for assembled primitives, before they are passed to the rasterizer. */
+    std::vector<rast::primitive> assembled_primitives;
+
+#ifdef SWR_ENABLE_MULTI_THREADING
+    /** ranges inside assembled_primitives, one for each non-empty clipped vertex buffer. */
+    std::vector<rast::primitive_range> assembly_ranges;
+#endif /* SWR_ENABLE_MULTI_THREADING */
+
+    /** return an upper bound for the number of primitives assembled from a given vertex buffer. */
+    static std::size_t get_max_primitive_count(const render_states* states, vertex_buffer_mode mode, const vertex_buffer& vb);
+
     /**
      * Assemble the base primitives from a given vertex buffer. The base primitives are stored in the rasterizer.
      * Face culling takes place at this stage.
@@ -339,10 +413,20 @@ public:
      */
     void assemble_primitives(const render_states* states, vertex_buffer_mode mode, vertex_buffer& vb);
 
+    /**
+     * Assemble the base primitives from a given vertex buffer into a preallocated range, which needs to
+     * hold at least get_max_primitive_count primitives. Does not modify the context, so that multiple
+     * vertex buffers can be assembled concurrently.
+     */
+    static void assemble_primitives(const render_states* states, vertex_buffer_mode mode, vertex_buffer& vb, rast::primitive_range& out);
+
     /*
      * render_device_context interface.
      */
 
+    /** create the default texture, the thread pool, the rasterizer and the default shader. the default framebuffer has to be set up before. */
+    void initialize();
+
     /** free all resources. */
     virtual void shutdown();
 
@@ -379,12 +463,16 @@ protected:
     /** associated SDL window. */
     SDL_Window* sdl_window{nullptr};
 
+    /** format of the default depth buffer. */
+    depth_format default_depth_format{depth_format::depth32};
+
     /** return the window's pixel format, converted to swr::pixel_format. if out_sdl_pixel_format is non-null, the SDL pixel format will be written into it. */
     swr::pixel_format get_window_pixel_format(Uint32* out_sdl_pixel_format = nullptr) const;
 
 public:
     /** default constructor. */
-    sdl_render_context([[maybe_unused]] uint32_t thread_hint)
+    sdl_render_context([[maybe_unused]] uint32_t thread_hint, depth_format in_default_depth_format)
+    : default_depth_format{in_default_depth_format}
     {
 #ifdef SWR_ENABLE_MULTI_THREADING
         if(thread_hint > 0)
@@ -420,6 +508,50 @@ public:
     void update_buffers(int width, int height);
 };
 
+/** a render device context drawing into memory owned by the context, without an associated window. */
+class offscreen_render_context : public render_device_context
+{
+protected:
+    /** color buffer memory. */
+    std::vector<std::uint32_t> color_buffer_data;
+
+    /** format of the default depth buffer. */
+    depth_format default_depth_format{depth_format::depth32};
+
+public:
+    /** default constructor. */
+    offscreen_render_context([[maybe_unused]] uint32_t thread_hint, depth_format in_default_depth_format)
+    : default_depth_format{in_default_depth_format}
+    {
+#ifdef SWR_ENABLE_MULTI_THREADING
+        if(thread_hint > 0)
+        {
+            thread_pool_size = thread_hint;
+        }
+#endif
+    }
+
+    /** destructor. */
+    ~offscreen_render_context()
+    {
+        shutdown();
+    }
+
+    /*
+     * render_device_context interface.
+     */
+
+    void shutdown() override;
+    bool lock() override;
+
+    /*
+     * offscreen_render_context interface.
+     */
+
+    /** initialize the context and create the buffers with the given width and height. */
+    void initialize(int width, int height);
+};
+
 /*
  * global render contexts.
  */
@@ -444,6 +576,24 @@ void create_default_texture(render_device_context* context);
 /** create a default shader in the supplied context which outputs empty fragments. */
 void create_default_shader(render_device_context* context);
 
+/*
+ * occlusion query helpers.
+ */
+
+/** add the fragments counted by the rasterizer to the queries, and make the results of ended queries available. */
+void update_queries(render_device_context* context);
+
+#ifdef SWR_ENABLE_STATS
+
+/*
+ * memory accounting.
+ */
+
+/** record the current memory usage of all categories. */
+void sample_memory_usage(render_device_context* context);
+
+#endif /* SWR_ENABLE_STATS */
+
 } /* namespace impl */
 
 } /* namespace swr */
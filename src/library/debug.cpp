@@ -0,0 +1,66 @@
+/**
+ * swr - a software rasterizer
+ *
+ * debug output for analyzing the fragment processing cost.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* user headers. */
+#include "swr_internal.h"
+
+#include "swr/debug.h"
+
+namespace swr
+{
+namespace debug
+{
+
+void set_overdraw_counting(bool enable)
+{
+    ASSERT_INTERNAL_CONTEXT;
+
+    auto& rasterizer = impl::global_context->rasterizer;
+    if(enable)
+    {
+        // the counters are sized to the framebuffer. they are reset again by each call to draw_primitives.
+        const auto& properties = impl::global_context->framebuffer.properties;
+        rasterizer->overdraw_counters.assign(properties.width * properties.height, {});
+    }
+    else
+    {
+        rasterizer->overdraw_counters.clear();
+        rasterizer->overdraw_counters.shrink_to_fit();
+    }
+}
+
+bool get_overdraw_counters(std::vector<fragment_counters>& counters, uint32_t& width, uint32_t& height)
+{
+    ASSERT_INTERNAL_CONTEXT;
+
+    const auto& rasterizer = impl::global_context->rasterizer;
+    if(rasterizer->overdraw_counters.empty())
+    {
+        return false;
+    }
+
+    const auto& properties = impl::global_context->framebuffer.properties;
+    width = properties.width;
+    height = properties.height;
+    counters = rasterizer->overdraw_counters;
+
+    return true;
+}
+
+void set_overdraw_overlay(overlay_counter counter, uint32_t max_count)
+{
+    ASSERT_INTERNAL_CONTEXT;
+
+    impl::global_context->rasterizer->overdraw_overlay = counter;
+    impl::global_context->rasterizer->overdraw_overlay_max = max_count;
+}
+
+} /* namespace debug */
+} /* namespace swr */
@@ -21,6 +21,7 @@ namespace swr
 void DrawElements(std::size_t vertex_count, vertex_buffer_mode mode)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::draw_elements, static_cast<std::uint64_t>(vertex_count), mode);
 
     auto* context = impl::global_context;
     if(context->im_declaring_primitives)
@@ -36,6 +37,7 @@ void DrawElements(std::size_t vertex_count, vertex_buffer_mode mode)
 void DrawIndexedElements(uint32_t index_buffer_id, vertex_buffer_mode mode)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::draw_indexed_elements, index_buffer_id, mode);
 
     auto* context = impl::global_context;
     if(context->im_declaring_primitives)
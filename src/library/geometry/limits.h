@@ -31,6 +31,9 @@ constexpr int uniform_locations = 1024;
 /** texture units. */
 constexpr int texture_units = 80;
 
+/** Maximal point size, in pixels. */
+constexpr float point_size = 64.0f;
+
 } /* namespace max */
 
 } /* namespace limits */
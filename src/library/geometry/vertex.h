@@ -53,6 +53,9 @@ struct vertex
     /** vertex flags. */
     uint32_t flags{vf_none};
 
+    /** point size in pixels. only used when rasterizing points. */
+    float point_size{1.0f};
+
     /* default constructor. */
     vertex() = default;
 
@@ -32,6 +32,7 @@ static void clear_immediate_mode_buffers(impl::render_device_context* context)
 void BeginPrimitives(vertex_buffer_mode mode)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::begin_primitives, mode);
     auto context = impl::global_context;
 
     if(context->im_declaring_primitives)
@@ -51,6 +52,11 @@ void BeginPrimitives(vertex_buffer_mode mode)
 void EndPrimitives()
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::end_primitives);
+
+    // the temporary buffers are created through the API, which is not recorded.
+    SWR_CAPTURE_SUSPEND();
+
     auto* context = impl::global_context;
 
     if(!context->im_declaring_primitives)
@@ -144,18 +150,21 @@ void EndPrimitives()
 void SetColor(float r, float g, float b, float a)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_color, r, g, b, a);
     impl::global_context->im_color = ml::clamp_to_unit_interval({r, g, b, a});
 }
 
 void SetTexCoord(float u, float v)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_tex_coord, u, v);
     impl::global_context->im_tex_coord = {u, v, 0.f, 0.f};
 }
 
 void InsertVertex(float x, float y, float z, float w)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::insert_vertex, x, y, z, w);
     auto* context = impl::global_context;
 
     const size_t buffer_size = context->im_vertex_buf.size();
@@ -0,0 +1,174 @@
+/**
+ * swr - a software rasterizer
+ *
+ * memory usage accounting. the sizes are computed from the containers' capacities, so that memory which is
+ * kept for reuse is counted, while the allocators' overhead is not.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* user headers. */
+#include "swr_internal.h"
+
+namespace swr
+{
+
+namespace impl
+{
+
+#ifdef SWR_ENABLE_STATS
+
+/** bytes held by the texture storage. */
+static std::size_t get_texture_memory(const render_device_context* context)
+{
+    std::size_t bytes = context->texture_2d_storage.data.capacity() * sizeof(std::unique_ptr<texture_2d>);
+    for(const auto& it: context->texture_2d_storage.data)
+    {
+        if(it)
+        {
+            bytes += sizeof(texture_2d)
+                     + it->data.buffer.capacity() * sizeof(ml::vec4)
+                     + it->data.data_ptrs.capacity() * sizeof(ml::vec4*);
+        }
+    }
+    return bytes;
+}
+
+/** bytes held by the vertex, index and vertex attribute buffers, and by the immediate mode buffers. */
+static std::size_t get_vertex_buffer_memory(const render_device_context* context)
+{
+    std::size_t bytes = context->vertex_buffers.data.capacity() * sizeof(vertex_buffer)
+                        + context->index_buffers.data.capacity() * sizeof(index_buffer)
+                        + context->vertex_attribute_buffers.data.capacity() * sizeof(vertex_attribute_buffer);
+
+    // freed slots are not destructed and still hold their data.
+    for(const auto& it: context->vertex_buffers.data)
+    {
+        bytes += it.capacity() * sizeof(geom::vertex);
+    }
+    for(const auto& it: context->index_buffers.data)
+    {
+        bytes += it.capacity() * sizeof(uint32_t);
+    }
+    for(const auto& it: context->vertex_attribute_buffers.data)
+    {
+        bytes += it.data.capacity() * sizeof(ml::vec4);
+    }
+
+    bytes += (context->im_vertex_buf.capacity() + context->im_color_buf.capacity()
+              + context->im_tex_coord_buf.capacity() + context->im_normal_buf.capacity())
+             * sizeof(ml::vec4);
+
+#    ifdef SWR_ENABLE_MULTI_THREADING
+    bytes += context->vertex_state_capacity * sizeof(std::atomic<std::uint32_t>);
+#    endif
+
+    return bytes;
+}
+
+/** bytes held by the draw list. */
+static std::size_t get_render_object_memory(const render_device_context* context)
+{
+    std::size_t bytes = 0;
+    for(const auto& it: context->render_object_list)
+    {
+        bytes += it.get_memory_usage();
+    }
+    return bytes;
+}
+
+/** bytes held by the assembled primitives and the rasterizer's primitive lists. */
+static std::size_t get_primitive_memory(const render_device_context* context)
+{
+    std::size_t bytes = context->assembled_primitives.capacity() * sizeof(rast::primitive);
+#    ifdef SWR_ENABLE_MULTI_THREADING
+    bytes += context->assembly_ranges.capacity() * sizeof(rast::primitive_range);
+#    endif
+    if(context->rasterizer)
+    {
+        bytes += context->rasterizer->get_memory_usage(stats::memory_category::primitives);
+    }
+    return bytes;
+}
+
+/** bytes held by the program list and the shader instances. */
+static std::size_t get_program_memory(const render_device_context* context)
+{
+    std::size_t bytes = context->programs.data.capacity() * sizeof(program_info);
+#    ifdef SWR_ENABLE_MULTI_THREADING
+    bytes += context->program_storage.capacity()
+             + context->program_instances.capacity() * sizeof(decltype(context->program_instances)::value_type);
+#    else
+    for(const auto& it: context->programs.data)
+    {
+        bytes += it.storage.capacity();
+    }
+#    endif
+    return bytes;
+}
+
+/** bytes held by the tile cache. */
+static std::size_t get_tile_cache_memory(const render_device_context* context)
+{
+    return context->rasterizer ? context->rasterizer->get_memory_usage(stats::memory_category::tile_cache) : 0;
+}
+
+/** bytes held by the depth buffers and the framebuffer objects. the color buffer of the default framebuffer is supplied externally. */
+static std::size_t get_framebuffer_memory(const render_device_context* context)
+{
+    std::size_t bytes = context->framebuffer.depth_buffer.data.capacity() * sizeof(std::uint32_t)
+                        + context->framebuffer.color_clear_pending.capacity()
+                        + context->framebuffer.depth_clear_pending.capacity()
+                        + context->depth_attachments.data.capacity() * sizeof(attachment_depth);
+
+    // the attached textures are counted with the textures.
+    for(const auto& it: context->framebuffer_objects.data)
+    {
+        bytes += it.get_memory_usage();
+    }
+    for(const auto& it: context->depth_attachments.data)
+    {
+        bytes += it.data.capacity() * sizeof(std::uint32_t);
+    }
+
+    return bytes;
+}
+
+void sample_memory_usage(render_device_context* context)
+{
+    auto& categories = context->stats_memory.categories;
+
+    categories[static_cast<std::size_t>(stats::memory_category::textures)].sample(get_texture_memory(context));
+    categories[static_cast<std::size_t>(stats::memory_category::vertex_buffers)].sample(get_vertex_buffer_memory(context));
+    categories[static_cast<std::size_t>(stats::memory_category::render_objects)].sample(get_render_object_memory(context));
+    categories[static_cast<std::size_t>(stats::memory_category::primitives)].sample(get_primitive_memory(context));
+    categories[static_cast<std::size_t>(stats::memory_category::programs)].sample(get_program_memory(context));
+    categories[static_cast<std::size_t>(stats::memory_category::tile_cache)].sample(get_tile_cache_memory(context));
+    categories[static_cast<std::size_t>(stats::memory_category::framebuffers)].sample(get_framebuffer_memory(context));
+}
+
+#endif /* SWR_ENABLE_STATS */
+
+} /* namespace impl */
+
+/*
+ * memory usage interface.
+ */
+
+namespace stats
+{
+
+void get_memory_data([[maybe_unused]] memory_data& data)
+{
+    ASSERT_INTERNAL_CONTEXT;
+#ifdef SWR_ENABLE_STATS
+    impl::sample_memory_usage(impl::global_context);
+    data = impl::global_context->stats_memory;
+#endif
+}
+
+} /* namespace stats */
+
+} /* namespace swr */
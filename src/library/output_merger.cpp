@@ -1,14 +1,19 @@
 /**
  * swr - a software rasterizer
  *
- * rasterizer output merging (currently only blending for the default framebuffer).
- * the functions here operate in the pixel format of the output buffer.
+ * rasterizer output merging (currently only blending).
+ * the blend kernels operate in the pixel format of the output buffer.
  *
  * \author Felix Lubbe
  * \copyright Copyright (c) 2021
  * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
  */
 
+/* C++ headers. */
+#include <algorithm>
+#include <array>
+#include <utility>
+
 /* user headers. */
 #include "swr_internal.h"
 
@@ -18,269 +23,278 @@ namespace swr
 namespace output_merger
 {
 
-namespace argb8888
+/** number of blend functions. */
+constexpr std::size_t blend_func_count = static_cast<std::size_t>(blend_func::one_minus_src_alpha) + 1;
+
+/** byte offset of the alpha channel inside a pixel of a named pixel format. */
+template<pixel_format F>
+constexpr int alpha_byte()
 {
+    static_assert(F == pixel_format::argb8888 || F == pixel_format::bgra8888 || F == pixel_format::rgba8888, "unsupported pixel format");
+    return (F == pixel_format::argb8888) ? 3 : 0;
+}
 
 /*
- * Fast alpha blending functions.
+ * blending of 8-bit pixels.
  *
- * Note: This is a approximation to accurate alpha blending, since the fast blending functions divide by 256 instead of 255
+ * the result is computed as src*f_src + dest*f_dst, where the factors are in [0,255]
+ * and the products are divided by 255 with correct rounding.
  */
 
-/** A fast approximation to alpha blending. */
-static uint32_t approx_srcalpha_oneminussrcalpha(const uint32_t src, const uint32_t dest)
+#ifndef SWR_USE_SIMD
+
+/** multiply a channel by a factor in [0,255] and divide by 255. */
+static uint32_t mul_div255(uint32_t c, uint32_t f)
 {
-    // extract alpha value
-    uint32_t a = src >> 24;
+    uint32_t x = c * f + 128;
+    return (x + (x >> 8)) >> 8;
+}
 
-    // if source pixel is transparent, just return the destination pixel.
-    if(a == 0)
+/** scalar blend factor for one channel. */
+template<blend_func B>
+static uint32_t blend_factor(uint32_t src_channel, uint32_t src_alpha)
+{
+    if constexpr(B == blend_func::zero)
     {
-        return dest;
+        return 0;
     }
-    // if source pixel is opaque, return source.
-    if(a == 0xff)
+    else if constexpr(B == blend_func::one)
     {
-        return src;
+        return 255;
+    }
+    else if constexpr(B == blend_func::src_alpha)
+    {
+        return src_alpha;
+    }
+    else if constexpr(B == blend_func::src_color)
+    {
+        return src_channel;
+    }
+    else
+    {
+        static_assert(B == blend_func::one_minus_src_alpha, "unknown blend function");
+        return 255 - src_alpha;
     }
-
-    // alpha blend the source and the background colors
-    uint32_t rb = (((src & 0x00ff00ff) * a) + ((dest & 0x00ff00ff) * (0xff - a))) & 0xff00ff00;
-    uint32_t g = (((src & 0x0000ff00) * a) + ((dest & 0x0000ff00) * (0xff - a))) & 0x00ff0000;
-    a = ((((src & 0xff000000) >> 8) * a + ((dest & 0xff000000) >> 8) * (0xff - a)) & 0x00ff0000) << 8;
-
-    return a | ((rb | g) >> 8);
 }
 
-} /* namespace argb8888 */
+#else
 
-namespace xxxx8888
+/** multiply 16-bit channels by factors in [0,255] and divide by 255. */
+static __m128i mul_div255(__m128i c, __m128i f)
 {
+    // all intermediate values fit into unsigned 16-bit integers.
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(c, f), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
 
-/** multiply source and destination in components. */
-static uint32_t approx_zero_dstsrccolor(const uint32_t src, const uint32_t dest)
+/** broadcast the alpha channel of two pixels with 16-bit channels to all of their channels. */
+template<pixel_format F>
+static __m128i broadcast_alpha(__m128i src)
 {
-    uint32_t c1 = (((src & 0x000000ff) * (dest & 0x000000ff)) >> 8) & 0x000000ff;
-    uint32_t c2 = (((src & 0x0000ff00) >> 8) * ((dest & 0x0000ff00) >> 8)) & 0x0000ff00;
-    uint32_t c3 = (((src & 0x00ff0000) >> 16) * ((dest & 0x00ff0000) >> 16) << 8) & 0x00ff0000;
-    uint32_t c4 = (((src & 0xff000000) >> 24) * ((dest & 0xff000000) >> 24) << 16) & 0xff000000;
-
-    return c1 | c2 | c3 | c4;
+    constexpr char lo = 2 * alpha_byte<F>();
+    constexpr char hi = lo + 1;
+    return _mm_shuffle_epi8(src, _mm_setr_epi8(lo, hi, lo, hi, lo, hi, lo, hi, lo + 8, hi + 8, lo + 8, hi + 8, lo + 8, hi + 8, lo + 8, hi + 8));
 }
 
-} /* namespace xxxx8888 */
-
-/*
- * blending.
- */
-
-uint32_t blend(const pixel_format_converter& pf_conv, blend_func blend_src, blend_func blend_dst, const uint32_t src, const uint32_t dest)
+/** multiply 16-bit channels of two pixels by a blend factor. */
+template<pixel_format F, blend_func B>
+static __m128i blend_term(__m128i c, __m128i src)
 {
-    // first check for blending modes that do not depend on the pixel format.
-    if(blend_src == blend_func::one
-       && blend_dst == blend_func::zero)
+    if constexpr(B == blend_func::zero)
     {
-        return src;
+        return _mm_setzero_si128();
     }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::one)
+    else if constexpr(B == blend_func::one)
     {
-        return dest;
+        return c;
     }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::zero)
+    else if constexpr(B == blend_func::src_alpha)
     {
-        return 0;
+        return mul_div255(c, broadcast_alpha<F>(src));
     }
-
-    // depending on the pixel format, perform the blending operation.
-    if(pf_conv.get_name() == pixel_format::argb8888)
+    else if constexpr(B == blend_func::src_color)
     {
-        if(blend_src == blend_func::src_alpha
-           && blend_dst == blend_func::one_minus_src_alpha)
-        {
-            return argb8888::approx_srcalpha_oneminussrcalpha(src, dest);
-        }
-        else if(blend_src == blend_func::zero
-                && blend_dst == blend_func::src_color)
-        {
-            return xxxx8888::approx_zero_dstsrccolor(src, dest);
-        }
-        else
-        {
-            // TODO unimplemented.
-            impl::global_context->last_error = error::unimplemented;
-        }
+        return mul_div255(c, src);
     }
     else
     {
-        // TODO unimplemented.
-        impl::global_context->last_error = error::unimplemented;
+        static_assert(B == blend_func::one_minus_src_alpha, "unknown blend function");
+        return mul_div255(c, _mm_sub_epi16(_mm_set1_epi16(255), broadcast_alpha<F>(src)));
     }
-
-    return src;
 }
 
-void blend_block(const pixel_format_converter& pf_conv, blend_func blend_src, blend_func blend_dst, const uint32_t src[4], const uint32_t dest[4], uint32_t out[4])
+/** blend two pixels with 16-bit channels. */
+template<pixel_format F, blend_func S, blend_func D>
+static __m128i blend_pixels(__m128i src, __m128i dest)
 {
-    // first check for blending modes that do not depend on the pixel format.
-    if(blend_src == blend_func::one
-       && blend_dst == blend_func::zero)
+    if constexpr(S == blend_func::zero)
     {
-        out[0] = src[0];
-        out[1] = src[1];
-        out[2] = src[2];
-        out[3] = src[3];
-        return;
+        return blend_term<F, D>(dest, src);
     }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::one)
+    else if constexpr(D == blend_func::zero)
     {
-        out[0] = dest[0];
-        out[1] = dest[1];
-        out[2] = dest[2];
-        out[3] = dest[3];
-        return;
+        return blend_term<F, S>(src, src);
     }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::zero)
+    else
     {
-        out[0] = 0;
-        out[1] = 0;
-        out[2] = 0;
-        out[3] = 0;
-        return;
+        return _mm_adds_epu16(blend_term<F, S>(src, src), blend_term<F, D>(dest, src));
     }
+}
+
+#endif /* SWR_USE_SIMD */
+
+/** blend a 2x2 block of pixels of a named pixel format. */
+template<pixel_format F, blend_func S, blend_func D>
+static void blend_pixel_block(const uint32_t src[4], const uint32_t dest[4], uint32_t out[4])
+{
+#ifdef SWR_USE_SIMD
+    const __m128i zero = _mm_setzero_si128();
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest));
+
+    // widen the channels to 16 bits and blend two pixels at a time.
+    __m128i lo = blend_pixels<F, S, D>(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+    __m128i hi = blend_pixels<F, S, D>(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
 
-    // depending on the pixel format, perform the blending operation.
-    if(pf_conv.get_name() == pixel_format::argb8888)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(lo, hi));
+#else
+    for(int i = 0; i < 4; ++i)
     {
-        if(blend_src == blend_func::src_alpha
-           && blend_dst == blend_func::one_minus_src_alpha)
-        {
-            out[0] = argb8888::approx_srcalpha_oneminussrcalpha(src[0], dest[0]);
-            out[1] = argb8888::approx_srcalpha_oneminussrcalpha(src[1], dest[1]);
-            out[2] = argb8888::approx_srcalpha_oneminussrcalpha(src[2], dest[2]);
-            out[3] = argb8888::approx_srcalpha_oneminussrcalpha(src[3], dest[3]);
-            return;
-        }
-        else if(blend_src == blend_func::zero
-                && blend_dst == blend_func::src_color)
-        {
-            out[0] = xxxx8888::approx_zero_dstsrccolor(src[0], dest[0]);
-            out[1] = xxxx8888::approx_zero_dstsrccolor(src[1], dest[1]);
-            out[2] = xxxx8888::approx_zero_dstsrccolor(src[2], dest[2]);
-            out[3] = xxxx8888::approx_zero_dstsrccolor(src[3], dest[3]);
-            return;
-        }
-        else
+        const uint32_t src_alpha = (src[i] >> (8 * alpha_byte<F>())) & 0xff;
+
+        uint32_t result = 0;
+        for(int k = 0; k < 32; k += 8)
         {
-            // TODO unimplemented.
-            impl::global_context->last_error = error::unimplemented;
+            const uint32_t s = (src[i] >> k) & 0xff;
+            const uint32_t d = (dest[i] >> k) & 0xff;
+            const uint32_t c = mul_div255(s, blend_factor<S>(s, src_alpha)) + mul_div255(d, blend_factor<D>(s, src_alpha));
+            result |= std::min(c, 255u) << k;
         }
+        out[i] = result;
     }
-    else
-    {
-        // TODO unimplemented.
-        impl::global_context->last_error = error::unimplemented;
-    }
-
-    // return src as default.
-    out[0] = src[0];
-    out[1] = src[1];
-    out[2] = src[2];
-    out[3] = src[3];
+#endif /* SWR_USE_SIMD */
 }
 
-ml::vec4 blend(blend_func blend_src, blend_func blend_dst, const ml::vec4& src, const ml::vec4& dest)
+/*
+ * blending of floating-point colors.
+ */
+
+#ifdef SWR_USE_SIMD
+
+/** multiply a color by a blend factor. */
+template<blend_func B>
+static __m128 blend_term(__m128 c, __m128 src)
 {
-    if(blend_src == blend_func::one
-       && blend_dst == blend_func::zero)
+    if constexpr(B == blend_func::zero)
     {
-        return dest;
+        return _mm_setzero_ps();
     }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::one)
+    else if constexpr(B == blend_func::one)
     {
-        return src;
-    }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::zero)
-    {
-        return ml::vec4::zero();
+        return c;
     }
-    else if(blend_src == blend_func::src_alpha
-            && blend_dst == blend_func::one_minus_src_alpha)
+    else if constexpr(B == blend_func::src_alpha)
     {
-        return ml::lerp(src.a, dest, src);
+        return _mm_mul_ps(c, _mm_shuffle_ps(src, src, _MM_SHUFFLE(3, 3, 3, 3)));
     }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::src_color)
+    else if constexpr(B == blend_func::src_color)
     {
-        return src * dest;
+        return _mm_mul_ps(c, src);
     }
     else
     {
-        // TODO unimplemented.
-        impl::global_context->last_error = error::unimplemented;
+        static_assert(B == blend_func::one_minus_src_alpha, "unknown blend function");
+        return _mm_mul_ps(c, _mm_sub_ps(_mm_set_ps1(1.0f), _mm_shuffle_ps(src, src, _MM_SHUFFLE(3, 3, 3, 3))));
     }
-
-    return src;
 }
 
-void blend_block(blend_func blend_src, blend_func blend_dst, const ml::vec4 src[4], const ml::vec4 dest[4], ml::vec4 out[4])
+#else
+
+/** multiply a color by a blend factor. */
+template<blend_func B>
+static ml::vec4 blend_term(const ml::vec4& c, const ml::vec4& src)
 {
-    auto copy_to_out = [&out](const ml::vec4 from[4])
-    {
-        out[0] = from[0];
-        out[1] = from[1];
-        out[2] = from[2];
-        out[3] = from[3];
-    };
-
-    if(blend_src == blend_func::one
-       && blend_dst == blend_func::zero)
-    {
-        copy_to_out(dest);
-    }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::one)
+    if constexpr(B == blend_func::zero)
     {
-        copy_to_out(src);
+        return ml::vec4::zero();
     }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::zero)
+    else if constexpr(B == blend_func::one)
     {
-        out[0] = ml::vec4::zero();
-        out[1] = ml::vec4::zero();
-        out[2] = ml::vec4::zero();
-        out[3] = ml::vec4::zero();
+        return c;
     }
-    else if(blend_src == blend_func::src_alpha
-            && blend_dst == blend_func::one_minus_src_alpha)
+    else if constexpr(B == blend_func::src_alpha)
     {
-        out[0] = ml::lerp(src[0].a, dest[0], src[0]);
-        out[1] = ml::lerp(src[1].a, dest[1], src[1]);
-        out[2] = ml::lerp(src[2].a, dest[2], src[2]);
-        out[3] = ml::lerp(src[3].a, dest[3], src[3]);
+        return c * src.a;
     }
-    else if(blend_src == blend_func::zero
-            && blend_dst == blend_func::src_color)
+    else if constexpr(B == blend_func::src_color)
     {
-        out[0] = src[0] * dest[0];
-        out[1] = src[1] * dest[1];
-        out[2] = src[2] * dest[2];
-        out[3] = src[3] * dest[3];
+        return c * src;
     }
     else
     {
-        // TODO unimplemented.
-        impl::global_context->last_error = error::unimplemented;
+        static_assert(B == blend_func::one_minus_src_alpha, "unknown blend function");
+        return c * (1.0f - src.a);
+    }
+}
 
-        copy_to_out(src);
+#endif /* SWR_USE_SIMD */
+
+/** blend a 2x2 block of colors. */
+template<blend_func S, blend_func D>
+static void blend_color_block(const ml::vec4 src[4], const ml::vec4 dest[4], ml::vec4 out[4])
+{
+    for(int i = 0; i < 4; ++i)
+    {
+#ifdef SWR_USE_SIMD
+        __m128 s = _mm_loadu_ps(reinterpret_cast<const float*>(&src[i].data));
+        __m128 d = _mm_loadu_ps(reinterpret_cast<const float*>(&dest[i].data));
+        _mm_storeu_ps(reinterpret_cast<float*>(&out[i].data), _mm_add_ps(blend_term<S>(s, s), blend_term<D>(d, s)));
+#else
+        out[i] = blend_term<S>(src[i], src[i]) + blend_term<D>(dest[i], src[i]);
+#endif /* SWR_USE_SIMD */
     }
 }
 
+/*
+ * kernel tables, indexed by blend_src * blend_func_count + blend_dst.
+ */
+
+template<pixel_format F, std::size_t... I>
+constexpr std::array<pixel_blend_func, sizeof...(I)> make_pixel_kernel_table(std::index_sequence<I...>)
+{
+    return {{&blend_pixel_block<F, static_cast<blend_func>(I / blend_func_count), static_cast<blend_func>(I % blend_func_count)>...}};
+}
+
+template<std::size_t... I>
+constexpr std::array<color_blend_func, sizeof...(I)> make_color_kernel_table(std::index_sequence<I...>)
+{
+    return {{&blend_color_block<static_cast<blend_func>(I / blend_func_count), static_cast<blend_func>(I % blend_func_count)>...}};
+}
+
+using kernel_index_sequence = std::make_index_sequence<blend_func_count * blend_func_count>;
+
+static constexpr auto rgba8888_kernels = make_pixel_kernel_table<pixel_format::rgba8888>(kernel_index_sequence{});
+static constexpr auto argb8888_kernels = make_pixel_kernel_table<pixel_format::argb8888>(kernel_index_sequence{});
+static constexpr auto bgra8888_kernels = make_pixel_kernel_table<pixel_format::bgra8888>(kernel_index_sequence{});
+static constexpr auto color_kernels = make_color_kernel_table(kernel_index_sequence{});
+
+/*
+ * kernel selection.
+ */
+
+void blend_kernels::select(blend_func blend_src, blend_func blend_dst)
+{
+    const std::size_t index = static_cast<std::size_t>(blend_src) * blend_func_count + static_cast<std::size_t>(blend_dst);
+    assert(index < color_kernels.size());
+
+    pixels[static_cast<std::size_t>(pixel_format::unsupported)] = nullptr;
+    pixels[static_cast<std::size_t>(pixel_format::rgba8888)] = rgba8888_kernels[index];
+    pixels[static_cast<std::size_t>(pixel_format::argb8888)] = argb8888_kernels[index];
+    pixels[static_cast<std::size_t>(pixel_format::bgra8888)] = bgra8888_kernels[index];
+
+    colors = color_kernels[index];
+}
+
 } /* namespace output_merger */
 
 } /* namespace swr */
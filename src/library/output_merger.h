@@ -1,8 +1,8 @@
 /**
  * swr - a software rasterizer
  *
- * rasterizer output merging (currently only blending for the default framebuffer).
- * the functions here operate in the pixel format of the output buffer.
+ * rasterizer output merging (currently only blending).
+ * the blend kernels operate in the pixel format of the output buffer.
  *
  * \author Felix Lubbe
  * \copyright Copyright (c) 2021
@@ -15,17 +15,72 @@ namespace swr
 namespace output_merger
 {
 
-/** apply blending on pixels. */
-uint32_t blend(const pixel_format_converter& pf_conv, blend_func blend_src, blend_func blend_dst, const uint32_t src, const uint32_t dest);
+/** color channel write masks. */
+namespace color_mask
+{
+enum : std::uint32_t
+{
+    none = 0,
+    red = 1,
+    green = 2,
+    blue = 4,
+    alpha = 8,
+    all = red | green | blue | alpha
+};
+} /* namespace color_mask */
+
+/** blend a 2x2 block of pixels of a named pixel format. src, dest and out do not need to be aligned. */
+using pixel_blend_func = void (*)(const uint32_t src[4], const uint32_t dest[4], uint32_t out[4]);
+
+/** blend a 2x2 block of colors. */
+using color_blend_func = void (*)(const ml::vec4 src[4], const ml::vec4 dest[4], ml::vec4 out[4]);
+
+/** blend kernels for a pair of blend functions. these are selected when the blend functions change. */
+struct blend_kernels
+{
+    /** kernels for 8-bit color buffers, indexed by pixel format. there is no kernel for pixel_format::unsupported. */
+    pixel_blend_func pixels[4]{nullptr, nullptr, nullptr, nullptr};
+
+    /** kernel for floating-point color attachments. */
+    color_blend_func colors{nullptr};
 
-/** apply blending on a 2x2 block of pixels. when compiling with SIMD/SSE enabled, assumes that src, dest and out are aligned on 16-byte boundaries. */
-void blend_block(const pixel_format_converter& pf_conv, blend_func blend_src, blend_func blend_dst, const uint32_t src[4], const uint32_t dest[4], uint32_t out[4]);
+    /** default constructor. selects the kernels for (one, zero). */
+    blend_kernels()
+    {
+        select(blend_func::one, blend_func::zero);
+    }
 
-/** apply blending on colors. */
-ml::vec4 blend(blend_func blend_src, blend_func blend_dst, const ml::vec4& src, const ml::vec4& dest);
+    /** select the kernels for the blend function pair (blend_src, blend_dst). */
+    void select(blend_func blend_src, blend_func blend_dst);
+
+    /** get the kernel for a pixel format. returns nullptr for pixel_format::unsupported. */
+    pixel_blend_func get_pixel_kernel(pixel_format format) const
+    {
+        return pixels[static_cast<std::size_t>(format)];
+    }
+};
+
+/** apply blending on a single pixel. */
+inline uint32_t blend(pixel_blend_func kernel, const uint32_t src, const uint32_t dest)
+{
+    const uint32_t src_block[4] = {src, src, src, src};
+    const uint32_t dest_block[4] = {dest, dest, dest, dest};
+    uint32_t out[4];
+
+    kernel(src_block, dest_block, out);
+    return out[0];
+}
+
+/** apply blending on a single color. */
+inline ml::vec4 blend(color_blend_func kernel, const ml::vec4& src, const ml::vec4& dest)
+{
+    const ml::vec4 src_block[4] = {src, src, src, src};
+    const ml::vec4 dest_block[4] = {dest, dest, dest, dest};
+    ml::vec4 out[4];
 
-/** apply blending on a 2x2 block of colors. */
-void blend_block(blend_func blend_src, blend_func blend_dst, const ml::vec4 src[4], const ml::vec4 dest[4], ml::vec4 out[4]);
+    kernel(src_block, dest_block, out);
+    return out[0];
+}
 
 } /* namespace output_merger */
 
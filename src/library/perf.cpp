@@ -0,0 +1,329 @@
+/**
+ * swr - a software rasterizer
+ *
+ * hardware performance counters using perf_event_open.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <algorithm>
+
+/* user headers. */
+#include "swr_internal.h"
+
+#ifdef SWR_ENABLE_PERF_COUNTERS
+
+/* system headers. */
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif /* SWR_ENABLE_PERF_COUNTERS */
+
+namespace swr
+{
+
+#ifdef SWR_ENABLE_PERF_COUNTERS
+
+namespace impl
+{
+
+namespace perf
+{
+
+registry global_counters;
+
+/** a hardware counter and the field it is reported in. */
+struct counter_desc
+{
+    /** perf event type. */
+    std::uint32_t type;
+
+    /** perf event config. */
+    std::uint64_t config;
+
+    /** the field of swr::stats::hardware_counters holding the count. */
+    std::uint64_t swr::stats::hardware_counters::*field;
+
+    /** name used for the trace export. */
+    const char* name;
+};
+
+/** build the config of a cache event. */
+constexpr std::uint64_t cache_event(std::uint64_t cache, std::uint64_t op, std::uint64_t result)
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+/** the hardware counters, in the order of counter_values. the first counter that can be opened leads the group. */
+static const counter_desc counter_descs[counter_count] = {
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, &swr::stats::hardware_counters::instructions, "instructions"},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, &swr::stats::hardware_counters::cycles, "cycles"},
+  {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), &swr::stats::hardware_counters::cache_misses, "cache misses"},
+  {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, &swr::stats::hardware_counters::branch_misses, "branch misses"},
+  {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS), &swr::stats::hardware_counters::llc_loads, "llc loads"},
+  {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), &swr::stats::hardware_counters::llc_load_misses, "llc load misses"}};
+
+/** stage names used for the trace export, in the order of swr::stats::hardware_stage. */
+static const char* stage_names[stage_count] = {
+  "vertex processing",
+  "assembly",
+  "setup",
+  "tile processing",
+  "visibility shading",
+  "resolve"};
+
+/** open a counter for the calling thread on any CPU. returns the file descriptor, or -1 on failure. */
+static int open_counter(const counter_desc& desc, int group_fd)
+{
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = desc.type;
+    attr.config = desc.config;
+    attr.disabled = (group_fd == -1) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+/*
+ * thread counters.
+ */
+
+bool thread_counters::open()
+{
+    close();
+
+    // counters that cannot be opened are skipped, so that unsupported events do not disable the others.
+    for(std::size_t i = 0; i < counter_count; ++i)
+    {
+        int fd = open_counter(counter_descs[i], fds.empty() ? -1 : fds[0]);
+        if(fd != -1)
+        {
+            fds.push_back(fd);
+            counters.push_back(i);
+        }
+    }
+
+    if(fds.empty())
+    {
+        return false;
+    }
+
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void thread_counters::close()
+{
+    // close the group members before the leader.
+    for(auto it = fds.rbegin(); it != fds.rend(); ++it)
+    {
+        ::close(*it);
+    }
+
+    fds.clear();
+    counters.clear();
+}
+
+bool thread_counters::read(counter_values& values) const
+{
+    // with PERF_FORMAT_GROUP, the leader returns the member count followed by the values in the order the members were opened.
+    std::uint64_t buffer[1 + counter_count];
+    if(::read(fds[0], buffer, sizeof(buffer)) < static_cast<ssize_t>(sizeof(std::uint64_t) * (1 + counters.size())))
+    {
+        return false;
+    }
+
+    values.fill(0);
+    for(std::size_t i = 0; i < counters.size(); ++i)
+    {
+        values[counters[i]] = buffer[1 + i];
+    }
+    return true;
+}
+
+int thread_counters::switch_stage(int next_stage)
+{
+    counter_values values;
+    if(!read(values))
+    {
+        // keep the last values, so that the counts are attributed to the next stage read successfully.
+        std::swap(stage, next_stage);
+        return next_stage;
+    }
+
+    if(stage >= 0)
+    {
+        for(std::size_t i = 0; i < counter_count; ++i)
+        {
+            stages[stage].*(counter_descs[i].field) += values[i] - last[i];
+        }
+    }
+
+    last = values;
+    std::swap(stage, next_stage);
+    return next_stage;
+}
+
+/*
+ * registry.
+ */
+
+/** releases the counters of a thread when it exits. */
+struct thread_handle
+{
+    /** the thread's counters. */
+    thread_counters* counters{nullptr};
+
+    /** release the counters. */
+    ~thread_handle()
+    {
+        if(counters)
+        {
+            global_counters.release_thread_counters(counters);
+        }
+    }
+};
+
+registry::~registry()
+{
+    for(auto& it: threads)
+    {
+        it->close();
+    }
+}
+
+thread_counters* registry::get_thread_counters()
+{
+    // the counters are looked up once per thread. afterwards, they are read without locking.
+    thread_local thread_handle handle;
+    if(handle.counters == nullptr)
+    {
+        std::scoped_lock lock{mutex};
+
+        handle.counters = threads.emplace_back(std::make_unique<thread_counters>()).get();
+        handle.counters->thread_id = next_thread_id++;
+        handle.counters->open();
+    }
+    return handle.counters;
+}
+
+void registry::release_thread_counters(thread_counters* counters)
+{
+    std::scoped_lock lock{mutex};
+
+    counters->close();
+    counters->exited = true;
+}
+
+bool registry::enable(bool enable)
+{
+    // the calling thread checks whether the counters are available.
+    enabled = enable && get_thread_counters()->is_open();
+    if(!enabled)
+    {
+        frame_data = {};
+    }
+    return enabled;
+}
+
+void registry::collect()
+{
+    if(!enabled)
+    {
+        return;
+    }
+
+    std::scoped_lock lock{mutex};
+
+    frame_data.available = false;
+    frame_data.threads.clear();
+
+    for(auto& it: threads)
+    {
+        frame_data.available |= it->is_open();
+
+        bool measured = false;
+        for(const auto& stage: it->stages)
+        {
+            measured |= stage.instructions != 0 || stage.cycles != 0 || stage.cache_misses != 0
+                        || stage.branch_misses != 0 || stage.llc_loads != 0 || stage.llc_load_misses != 0;
+        }
+
+        if(measured)
+        {
+            frame_data.threads.push_back({it->thread_id, it->stages});
+        }
+
+        for(auto& stage: it->stages)
+        {
+            stage.reset_counters();
+        }
+    }
+
+    // the counts of exited threads were reported above.
+    threads.erase(std::remove_if(threads.begin(), threads.end(), [](const auto& it) -> bool
+                                 { return it->exited; }),
+                  threads.end());
+
+#    ifdef SWR_ENABLE_TRACING
+    // write the per-stage totals of each counter as a counter track.
+    for(std::size_t i = 0; i < counter_count; ++i)
+    {
+        std::vector<std::pair<const char*, std::uint64_t>> values;
+        for(std::size_t s = 0; s < stage_count; ++s)
+        {
+            std::uint64_t total = 0;
+            for(const auto& it: frame_data.threads)
+            {
+                total += it.stages[s].*(counter_descs[i].field);
+            }
+            values.emplace_back(stage_names[s], total);
+        }
+        impl::trace::global_tracer.add_counters(counter_descs[i].name, std::move(values));
+    }
+#    endif
+}
+
+} /* namespace perf */
+
+} /* namespace impl */
+
+#endif /* SWR_ENABLE_PERF_COUNTERS */
+
+/*
+ * hardware counter interface.
+ */
+
+namespace stats
+{
+
+bool enable_hardware_counters([[maybe_unused]] bool enable)
+{
+#ifdef SWR_ENABLE_PERF_COUNTERS
+    return impl::perf::global_counters.enable(enable);
+#else
+    return false;
+#endif
+}
+
+void get_hardware_data([[maybe_unused]] hardware_data& data)
+{
+#ifdef SWR_ENABLE_PERF_COUNTERS
+    data = impl::perf::global_counters.frame_data;
+#else
+    data = {};
+#endif
+}
+
+} /* namespace stats */
+
+} /* namespace swr */
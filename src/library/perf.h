@@ -0,0 +1,182 @@
+/**
+ * swr - a software rasterizer
+ *
+ * hardware performance counters. each thread opens its own counter group, which only counts events of
+ * that thread. the counts are accumulated per thread and stage, so that measuring needs no synchronization.
+ * the accumulated counts are only read between frames, when the thread pool is idle.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+#pragma once
+
+/* perf_event_open is only available on Linux. */
+#if defined(SWR_ENABLE_PERF_COUNTERS) && !defined(__linux__)
+#    undef SWR_ENABLE_PERF_COUNTERS
+#endif
+
+/** attribute the hardware counters of the remaining scope to a stage if hardware counters are enabled. */
+#ifdef SWR_ENABLE_PERF_COUNTERS
+#    define SWR_PERF_CONCAT_IMPL(a, b) a##b
+#    define SWR_PERF_CONCAT(a, b)      SWR_PERF_CONCAT_IMPL(a, b)
+#    define SWR_PERF_SCOPE(stage)      swr::impl::perf::scope SWR_PERF_CONCAT(perf_scope_, __LINE__)(swr::stats::hardware_stage::stage)
+#else
+#    define SWR_PERF_SCOPE(stage)
+#endif
+
+#ifdef SWR_ENABLE_PERF_COUNTERS
+
+/* C++ headers. */
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace swr
+{
+
+namespace impl
+{
+
+namespace perf
+{
+
+/** number of hardware counters per thread. */
+constexpr std::size_t counter_count = 6;
+
+/** number of measured stages. */
+constexpr std::size_t stage_count = static_cast<std::size_t>(swr::stats::hardware_stage::count);
+
+/** counter values, in the order of swr::stats::hardware_counters. */
+using counter_values = std::array<std::uint64_t, counter_count>;
+
+/** the counters of a single thread. */
+struct thread_counters
+{
+    /** sequential thread id, in order of the first measurement. */
+    std::uint32_t thread_id{0};
+
+    /** file descriptors of the counter group. the first one is the group leader. empty if no counter could be opened. */
+    std::vector<int> fds;
+
+    /** the counter index of each group member. */
+    std::vector<std::size_t> counters;
+
+    /** whether the thread exited. its counts are reported once more and then discarded. */
+    bool exited{false};
+
+    /** the stage the counts are currently attributed to, or -1 if none. */
+    int stage{-1};
+
+    /** counter values at the last stage switch. */
+    counter_values last{};
+
+    /** accumulated counts of each stage. */
+    std::array<swr::stats::hardware_counters, stage_count> stages{};
+
+    /** open the counter group for the calling thread. returns whether at least one counter was opened. */
+    bool open();
+
+    /** close the counter group. */
+    void close();
+
+    /** whether at least one counter is open. */
+    bool is_open() const
+    {
+        return !fds.empty();
+    }
+
+    /** read the current counter values. */
+    bool read(counter_values& values) const;
+
+    /** attribute the counts since the last switch to the current stage and make another stage current. returns the previous stage. */
+    int switch_stage(int next_stage);
+};
+
+/** per-thread counters and the data of the last frame. */
+struct registry
+{
+    /** whether counters are read. only modified between frames. */
+    bool enabled{false};
+
+    /** protects the thread list. */
+    std::mutex mutex;
+
+    /** per-thread counters. the counters are kept alive, since threads hold pointers to them. */
+    std::vector<std::unique_ptr<thread_counters>> threads;
+
+    /** next thread id. */
+    std::uint32_t next_thread_id{0};
+
+    /** the data of the last frame. */
+    swr::stats::hardware_data frame_data;
+
+    /** destructor. closes all counters. */
+    ~registry();
+
+    /** get the calling thread's counters, opening them on first use. */
+    thread_counters* get_thread_counters();
+
+    /** mark the counters of an exiting thread. */
+    void release_thread_counters(thread_counters* counters);
+
+    /** enable or disable the counters. returns whether the counters are enabled. */
+    bool enable(bool enable);
+
+    /** move the accumulated counts into the frame data and write them to the trace. */
+    void collect();
+};
+
+/** global counter registry. */
+extern registry global_counters;
+
+/** attribute the hardware counters to a stage for the lifetime of the object. nested scopes pause the enclosing stage. */
+class scope
+{
+    /** the thread's counters, or nullptr if the counters are disabled or unavailable. */
+    thread_counters* counters{nullptr};
+
+    /** the stage to restore when the scope ends. */
+    int previous_stage{-1};
+
+public:
+    /** start attributing the counts to a stage. */
+    scope(swr::stats::hardware_stage stage)
+    {
+        if(global_counters.enabled)
+        {
+            counters = global_counters.get_thread_counters();
+            if(counters && counters->is_open())
+            {
+                previous_stage = counters->switch_stage(static_cast<int>(stage));
+            }
+            else
+            {
+                counters = nullptr;
+            }
+        }
+    }
+
+    /** attribute the counts to the stage and restore the enclosing stage. */
+    ~scope()
+    {
+        if(counters)
+        {
+            counters->switch_stage(previous_stage);
+        }
+    }
+
+    /** no copies. */
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+};
+
+} /* namespace perf */
+
+} /* namespace impl */
+
+} /* namespace swr */
+
+#endif /* SWR_ENABLE_PERF_COUNTERS */
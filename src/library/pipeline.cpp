@@ -10,6 +10,11 @@
  * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
  */
 
+/* C++ headers. */
+#include <atomic>
+#include <limits>
+#include <thread>
+
 /* user headers. */
 #include "swr_internal.h"
 #include "clipping.h"
@@ -21,6 +26,18 @@ namespace swr
  * rendering pipeline.
  */
 
+/** return the size of a point, depending on the render states and the size written by the vertex shader. */
+static float get_point_size(const impl::render_states& states, float gl_PointSize)
+{
+    if(!states.program_point_size_enabled)
+    {
+        return states.point_size;
+    }
+
+    // the point size is clamped to the supported range. non-positive sizes are clamped to 1.
+    return boost::algorithm::clamp(gl_PointSize, 1.0f, geom::limits::max::point_size);
+}
+
 #ifndef SWR_ENABLE_MULTI_THREADING
 
 /*
@@ -40,13 +57,15 @@ static bool invoke_vertex_shader_and_clip_preprocess(impl::vertex_shader_instanc
 
     for(std::size_t i = 0; i < obj.coord_count; ++i)
     {
-        float gl_PointSize{0}; /* currently unused */
+        float gl_PointSize{obj.states.point_size};
         shader_instance.get()->vertex_shader(
           0 /* gl_VertexID */, 0 /* gl_InstanceID */,
           &obj.attribs[i * obj.attrib_count], obj.coords[i],
           gl_PointSize, nullptr /* gl_ClipDistance */,
           &obj.varyings[i * shader_instance.get_varying_count()]);
 
+        obj.point_sizes[i] = get_point_size(obj.states, gl_PointSize);
+
         /*
          * Set clipping markers for this vertex. A visible vertex has to satisfy the relations
          *
@@ -73,9 +92,12 @@ static bool invoke_vertex_shader_and_clip_preprocess(impl::vertex_shader_instanc
 
 /**
  * Transform from homogeneous clip space to viewport coordinates.
+ *
+ * \return The smallest viewport depth of the transformed vertices.
  */
-static void transform_to_viewport_coords(impl::vertex_buffer& vb, float x, float y, float width, float height, float z_near, float z_far)
+static float transform_to_viewport_coords(impl::vertex_buffer& vb, float x, float y, float width, float height, float z_near, float z_far)
 {
+    float min_depth = std::numeric_limits<float>::infinity();
     for(auto& vertex_it: vb)
     {
         // calculate the normalized device coordinates.
@@ -94,12 +116,23 @@ static void transform_to_viewport_coords(impl::vertex_buffer& vb, float x, float
 
         // Then, store the viewport coordinates.
         vertex_it.coords = {viewport_x, viewport_y, viewport_z, vertex_it.coords.w};
+        min_depth = std::min(min_depth, viewport_z);
     }
+
+    return min_depth;
 }
 
 static void process_vertices(swr::impl::render_object& obj)
 {
+    SWR_TRACE_SCOPE("vertex processing", -1, obj.indices.size());
+    SWR_PERF_SCOPE(vertex_processing);
+
     obj.clipped_vertices.clear();
+    obj.clipped_min_depth.clear();
+
+#ifdef SWR_ENABLE_STATS
+    obj.stats_pipeline.assign(1, {});
+#endif
 
     if(obj.coord_count == 0 || obj.indices.size() == 0)
     {
@@ -114,7 +147,10 @@ static void process_vertices(swr::impl::render_object& obj)
      * The shaders take the view coordinates as inputs and output the homogeneous clip coordinates.
      * The clip preprecessing sets a marker for each vertex outside the view frustum.
      */
+    SWR_STATS_CLOCK(obj.stats_pipeline[0].vertex_shading);
     bool discard_buffer = invoke_vertex_shader_and_clip_preprocess(shader_instance, obj);
+    SWR_STATS_UNCLOCK(obj.stats_pipeline[0].vertex_shading);
+
     if(discard_buffer)
     {
         return;
@@ -132,55 +168,44 @@ static void process_vertices(swr::impl::render_object& obj)
      *
      * Clipping pre-assembles the primitives, i.e. it creates triangles.
      */
+    SWR_STATS_CLOCK(obj.stats_pipeline[0].clipping);
+
+    auto& clipped_vertices = obj.clipped_vertices.emplace_back();
     if(obj.mode == vertex_buffer_mode::points || obj.states.poly_mode == polygon_mode::point)
     {
         // copy the correct points.
-        for(const auto& i: obj.indices)
-        {
-            if(!(obj.vertex_flags[i] & geom::vf_clip_discard))
-            {
-                // TODO temporary.
-                geom::vertex v;
-                v.attribs.reserve(obj.attrib_count);
-                for(std::size_t j = 0; j < obj.attrib_count; ++j)
-                {
-                    v.attribs.emplace_back(obj.attribs[i * obj.attrib_count + j]);
-                }
-                v.coords = obj.coords[i];
-                v.flags = obj.vertex_flags[i];
-                v.varyings.reserve(obj.states.shader_info->varying_count);
-                for(std::size_t j = 0; j < obj.states.shader_info->varying_count; ++j)
-                {
-                    v.varyings.emplace_back(obj.varyings[i * obj.states.shader_info->varying_count + j]);
-                }
-
-                obj.clipped_vertices.emplace_back(v);
-            }
-        }
+        clip_point_buffer(obj, 0, obj.indices.size(), clipped_vertices);
     }
     else if(obj.mode == vertex_buffer_mode::lines)
     {
-        clip_line_buffer(obj, impl::line_list);
+        clip_line_buffer(obj, 0, obj.indices.size(), impl::line_list, clipped_vertices);
     }
     else if(obj.mode == vertex_buffer_mode::triangles && obj.states.poly_mode == polygon_mode::line)
     {
-        clip_triangle_buffer(obj, impl::line_list);
+        clip_triangle_buffer(obj, 0, obj.indices.size(), impl::line_list, clipped_vertices);
     }
     else if(obj.states.poly_mode == polygon_mode::fill)
     {
         /* here we necessarily have list_it.Mode == triangles */
-        clip_triangle_buffer(obj, impl::triangle_list);
+        clip_triangle_buffer(obj, 0, obj.indices.size(), impl::triangle_list, clipped_vertices);
     }
 
+    SWR_STATS_UNCLOCK(obj.stats_pipeline[0].clipping);
+
     // skip the rest of the pipeline if no clipped vertices were produced.
-    if(obj.clipped_vertices.size() != 0)
+    auto& min_depth = obj.clipped_min_depth.emplace_back(std::numeric_limits<float>::infinity());
+    if(clipped_vertices.size() != 0)
     {
+        SWR_STATS_CLOCK(obj.stats_pipeline[0].viewport_transform);
+
         // perspective divide and viewport transformation.
-        transform_to_viewport_coords(
-          obj.clipped_vertices,
+        min_depth = transform_to_viewport_coords(
+          clipped_vertices,
           obj.states.x, obj.states.y,
           obj.states.width, obj.states.height,
           obj.states.z_near, obj.states.z_far);
+
+        SWR_STATS_UNCLOCK(obj.stats_pipeline[0].viewport_transform);
     }
 }
 
@@ -196,115 +221,169 @@ namespace mt
 
 constexpr std::size_t min_tasks_per_thread = 4;
 
-static void vertex_shader_task(impl::render_object* obj, std::size_t offset, std::size_t end, impl::vertex_shader_instance_container* shader_instance)
+/** invoke the vertex shader on a single vertex and set its clipping markers. */
+static void shade_vertex(impl::render_object* obj, std::size_t i, impl::vertex_shader_instance_container* shader_instance)
 {
-    for(std::size_t i = offset; i < end; ++i)
+    float gl_PointSize{obj->states.point_size};
+    shader_instance->get()->vertex_shader(
+      0 /* gl_VertexID */, 0 /* gl_InstanceID */,
+      &obj->attribs[i * obj->attrib_count], obj->coords[i],
+      gl_PointSize, nullptr /* gl_ClipDistance */,
+      &obj->varyings[i * shader_instance->get_varying_count()]);
+
+    obj->point_sizes[i] = get_point_size(obj->states, gl_PointSize);
+
+    /*
+     * Set clipping markers for this vertex. A visible vertex has to satisfy the relations
+     *
+     *    -w <= x <= w
+     *    -w <= y <= w
+     *    -w <= z <= w
+     *      0 < w.
+     */
+    if(obj->coords[i].x < -obj->coords[i].w || obj->coords[i].x > obj->coords[i].w
+       || obj->coords[i].y < -obj->coords[i].w || obj->coords[i].y > obj->coords[i].w
+       || obj->coords[i].z < -obj->coords[i].w || obj->coords[i].z > obj->coords[i].w
+       || obj->coords[i].w <= 0)
     {
-        float gl_PointSize{0}; /* currently unused */
-        shader_instance->get()->vertex_shader(
-          0 /* gl_VertexID */, 0 /* gl_InstanceID */,
-          &obj->attribs[i * obj->attrib_count], obj->coords[i],
-          gl_PointSize, nullptr /* gl_ClipDistance */,
-          &obj->varyings[i * shader_instance->get_varying_count()]);
+        obj->vertex_flags[i] |= geom::vf_clip_discard;
+    }
+}
 
-        /*
-         * Set clipping markers for this vertex. A visible vertex has to satisfy the relations
-         *
-         *    -w <= x <= w
-         *    -w <= y <= w
-         *    -w <= z <= w
-         *      0 < w.
-         */
-        if(obj->coords[i].x < -obj->coords[i].w || obj->coords[i].x > obj->coords[i].w
-           || obj->coords[i].y < -obj->coords[i].w || obj->coords[i].y > obj->coords[i].w
-           || obj->coords[i].z < -obj->coords[i].w || obj->coords[i].z > obj->coords[i].w
-           || obj->coords[i].w <= 0)
-        {
-            obj->vertex_flags[i] |= geom::vf_clip_discard;
-        }
+static void vertex_shader_task(impl::render_object* obj, std::size_t offset, std::size_t end, impl::vertex_shader_instance_container* shader_instance, [[maybe_unused]] std::size_t chunk)
+{
+    SWR_TRACE_SCOPE("vertex shader", -1, end - offset);
+    SWR_PERF_SCOPE(vertex_processing);
+    SWR_STATS_CLOCK(obj->stats_pipeline[chunk].vertex_shading);
+
+    for(std::size_t i = offset; i < end; ++i)
+    {
+        shade_vertex(obj, i, shader_instance);
     }
+
+    SWR_STATS_UNCLOCK(obj->stats_pipeline[chunk].vertex_shading);
 }
 
-static void invoke_vertex_shader_and_clip_preprocess(impl::sdl_render_context::thread_pool_type& thread_pool, impl::vertex_shader_instance_container& shader_instance, impl::render_object& obj)
+/** shading states of the vertices of render objects with non-sequential indices. */
+enum vertex_state : std::uint32_t
 {
-    auto thread_count = thread_pool.get_thread_count();
-    std::size_t thread_vertex_count = std::max(min_tasks_per_thread, obj.coord_count / thread_count);
+    vertex_unshaded = 0,
+    vertex_shading = 1,
+    vertex_shaded = 2
+};
 
-    // allocate varyings.
-    obj.allocate_varyings(shader_instance.get_varying_count());
+/**
+ * @brief Invoke the vertex shader on the vertices referenced by an index range. Vertices shared with other ranges are
+ * shaded only once, by the first task claiming them, and the other tasks wait until the outputs are written.
+ *
+ * Since shading a vertex never waits on other tasks, a waiting task always waits on a running one.
+ */
+static void indexed_vertex_shader_task(impl::render_object* obj, std::size_t index_begin, std::size_t index_end, impl::vertex_shader_instance_container* shader_instance, std::atomic<std::uint32_t>* vertex_states, [[maybe_unused]] std::size_t chunk)
+{
+    SWR_TRACE_SCOPE("vertex shader", -1, index_end - index_begin);
+    SWR_PERF_SCOPE(vertex_processing);
+    SWR_STATS_CLOCK(obj->stats_pipeline[chunk].vertex_shading);
 
-    // push shader tasks to thread pool.
-    std::size_t offset = 0;
-    for(; offset < obj.coord_count - thread_vertex_count; offset += thread_vertex_count)
+    // shade all unclaimed vertices first, so that the other tasks are likely done when we wait for them.
+    bool needs_wait = false;
+    for(std::size_t i = index_begin; i < index_end; ++i)
     {
-        thread_pool.push_immediate_task(vertex_shader_task, &obj, offset, offset + thread_vertex_count, &shader_instance);
+        const auto index = obj->indices[i];
+        std::uint32_t expected = vertex_unshaded;
+        if(vertex_states[index].compare_exchange_strong(expected, vertex_shading, std::memory_order_acquire, std::memory_order_acquire))
+        {
+            shade_vertex(obj, index, shader_instance);
+            vertex_states[index].store(vertex_shaded, std::memory_order_release);
+        }
+        else
+        {
+            needs_wait |= (expected != vertex_shaded);
+        }
     }
 
-    if(offset < obj.coord_count)
+    if(needs_wait)
     {
-        thread_pool.push_immediate_task(vertex_shader_task, &obj, offset, obj.coord_count, &shader_instance);
+        for(std::size_t i = index_begin; i < index_end; ++i)
+        {
+            while(vertex_states[obj->indices[i]].load(std::memory_order_acquire) != vertex_shaded)
+            {
+                std::this_thread::yield();
+            }
+        }
     }
+
+    SWR_STATS_UNCLOCK(obj->stats_pipeline[chunk].vertex_shading);
 }
 
 /**
- * @brief Apply the viewport transformation to a part of a vertex buffer. Meant to be supplied to a thread pool.
+ * Transform from homogeneous clip space to viewport coordinates.
  *
- * @param vb Pointer to the vertex buffer.
- * @param offset Starting offset into the vertex buffer.
- * @param end End offset. Has to be less than vb->size().
- * @param x Viewport x coordinate.
- * @param y Viewport y coordinate.
- * @param width Viewport width.
- * @param height Viewport height.
- * @param z_near Near clipping plane coordinate.
- * @param z_far Far clipping plane coordinate.
+ * \return The smallest viewport depth of the transformed vertices.
  */
-static void transform_to_viewport_coords_task(impl::vertex_buffer* vb, std::size_t offset, std::size_t end, float x, float y, float width, float height, float z_near, float z_far)
+static float transform_to_viewport_coords(impl::vertex_buffer& vb, float x, float y, float width, float height, float z_near, float z_far)
 {
-    for(std::size_t i = offset; i < end; ++i)
+    float min_depth = std::numeric_limits<float>::infinity();
+    for(auto& vertex_it: vb)
     {
-        geom::vertex& v = vb->at(i);
-
         // calculate the normalized device coordinates.
         // w is set to 1/w (see https://www.khronos.org/registry/OpenGL/specs/gl/glspec43.core.pdf, section 15.2.2).
-        v.coords.divide_by_w();
+        vertex_it.coords.divide_by_w();
 
         // normalized device coordinates are in the range [-1,1], which we need to convert to viewport coordinates.
 
         // Note that the y direction needs to be flipped, since viewport y coordinates go from top down, while NDC
         // coordinates go bottom up. The flipping of the Y coordinate also flips the orientation of the primitives.
-        float viewport_x = (1 + v.coords.x) * 0.5f * width + x;
-        float viewport_y = (1 - v.coords.y) * 0.5f * height + y;
+        float viewport_x = (1 + vertex_it.coords.x) * 0.5f * width + x;
+        float viewport_y = (1 - vertex_it.coords.y) * 0.5f * height + y;
 
         // the viewport z coordinates is defined by linearly mapping z from the range [0,1] to [z_near, z_far].
-        float viewport_z = ml::lerp(0.5f * (1.0f + v.coords.z), z_near, z_far);
+        float viewport_z = ml::lerp(0.5f * (1.0f + vertex_it.coords.z), z_near, z_far);
 
         // Then, store the viewport coordinates.
-        v.coords = {viewport_x, viewport_y, viewport_z, v.coords.w};
+        vertex_it.coords = {viewport_x, viewport_y, viewport_z, vertex_it.coords.w};
+        min_depth = std::min(min_depth, viewport_z);
     }
+
+    return min_depth;
 }
 
-static void transform_to_viewport_coords(swr::impl::sdl_render_context::thread_pool_type& thread_pool, impl::vertex_buffer& vb, float x, float y, float width, float height, float z_near, float z_far)
+/** return the number of indices making up a primitive, with respect to the clipping output. */
+static std::size_t get_primitive_index_count(const impl::render_object& obj)
 {
-    auto thread_count = thread_pool.get_thread_count();
-    std::size_t thread_vertex_count = std::max(min_tasks_per_thread, vb.size() / thread_count);
-
-    std::size_t offset = 0;
-    for(; offset < vb.size() - thread_vertex_count; offset += thread_vertex_count)
+    if(obj.mode == vertex_buffer_mode::points || obj.states.poly_mode == polygon_mode::point)
     {
-        thread_pool.push_immediate_task(transform_to_viewport_coords_task, &vb, offset, offset + thread_vertex_count, x, y, width, height, z_near, z_far);
+        return 1;
     }
-
-    // push remaining vertices.
-    if(offset < vb.size())
+    else if(obj.mode == vertex_buffer_mode::lines)
     {
-        thread_pool.push_immediate_task(transform_to_viewport_coords_task, &vb, offset, vb.size(), x, y, width, height, z_near, z_far);
+        return 2;
     }
+
+    return 3;
 }
 
-static void clip_vertex_buffer(swr::impl::render_object* obj)
+/** return the size of the index ranges the render object is split into. the ranges always consist of whole primitives. */
+static std::size_t get_chunk_size(const impl::render_object& obj, std::size_t thread_count)
 {
-    obj->clipped_vertices.clear();
+    const std::size_t primitive_index_count = get_primitive_index_count(obj);
+    const std::size_t chunk_size = std::max(min_tasks_per_thread, obj.indices.size() / thread_count);
+    return ((chunk_size + primitive_index_count - 1) / primitive_index_count) * primitive_index_count;
+}
+
+/**
+ * @brief Clip the primitives inside an index range and apply the viewport transformation to the output. Meant to be supplied to a thread pool.
+ *
+ * @param obj The render object. The vertex shader needs to have been invoked on all vertices referenced by the index range.
+ * @param index_begin Start of the index range. Has to be aligned on a primitive boundary.
+ * @param index_end End of the index range.
+ * @param chunk Index of the range. Selects the output vertex buffer and its smallest viewport depth.
+ */
+static void clip_and_transform_task(impl::render_object* obj, std::size_t index_begin, std::size_t index_end, std::size_t chunk)
+{
+    SWR_TRACE_SCOPE("clip and transform", -1, (index_end - index_begin) / get_primitive_index_count(*obj));
+    SWR_PERF_SCOPE(vertex_processing);
+
+    auto* out_vb = &obj->clipped_vertices[chunk];
 
     // check we have valid drawing and polygon modes.
     assert(obj->mode == vertex_buffer_mode::points || obj->mode == vertex_buffer_mode::lines || obj->mode == vertex_buffer_mode::triangles);
@@ -314,56 +393,71 @@ static void clip_vertex_buffer(swr::impl::render_object* obj)
      * clip the vertex buffer.
      *
      * if we only want to draw a list of points, we already have enough clipping
-     * information from the previous call to invoke_vertex_shader_and_clip_preprocess.
+     * information from the vertex shader task.
      *
      * Clipping pre-assembles the primitives, i.e. it creates triangles.
      */
+    SWR_STATS_CLOCK(obj->stats_pipeline[chunk].clipping);
+
     if(obj->mode == vertex_buffer_mode::points || obj->states.poly_mode == polygon_mode::point)
     {
-        // TODO temporary.
-        geom::vertex v;
-        v.attribs.reserve(obj->attrib_count);
-        v.varyings.reserve(obj->states.shader_info->varying_count);
-
-        // copy the correct points.
-        for(const auto& i: obj->indices)
-        {
-            if(!(obj->vertex_flags[i] & geom::vf_clip_discard))
-            {
-                v.attribs.clear();
-                for(std::size_t j = 0; j < obj->attrib_count; ++j)
-                {
-                    v.attribs.emplace_back(obj->attribs[i * obj->attrib_count + j]);
-                }
-                v.coords = obj->coords[i];
-                v.flags = obj->vertex_flags[i];
-                v.varyings.clear();
-                for(std::size_t j = 0; j < obj->states.shader_info->varying_count; ++j)
-                {
-                    v.varyings.emplace_back(obj->varyings[i * obj->states.shader_info->varying_count + j]);
-                }
-
-                obj->clipped_vertices.emplace_back(v);
-            }
-        }
+        clip_point_buffer(*obj, index_begin, index_end, *out_vb);
     }
     else if(obj->mode == vertex_buffer_mode::lines)
     {
-        clip_line_buffer(*obj, impl::line_list);
+        clip_line_buffer(*obj, index_begin, index_end, impl::line_list, *out_vb);
     }
     else if(obj->mode == vertex_buffer_mode::triangles && obj->states.poly_mode == polygon_mode::line)
     {
-        clip_triangle_buffer(*obj, impl::line_list);
+        clip_triangle_buffer(*obj, index_begin, index_end, impl::line_list, *out_vb);
     }
     else if(obj->states.poly_mode == polygon_mode::fill)
     {
         /* here we necessarily have list_it.Mode == triangles */
-        clip_triangle_buffer(*obj, impl::triangle_list);
+        clip_triangle_buffer(*obj, index_begin, index_end, impl::triangle_list, *out_vb);
+    }
+
+    SWR_STATS_UNCLOCK(obj->stats_pipeline[chunk].clipping);
+
+    // skip the viewport transformation if no clipped vertices were produced.
+    if(out_vb->size() != 0)
+    {
+        SWR_STATS_CLOCK(obj->stats_pipeline[chunk].viewport_transform);
+
+        // perspective divide and viewport transformation.
+        obj->clipped_min_depth[chunk] = transform_to_viewport_coords(
+          *out_vb,
+          obj->states.x, obj->states.y,
+          obj->states.width, obj->states.height,
+          obj->states.z_near, obj->states.z_far);
+
+        SWR_STATS_UNCLOCK(obj->stats_pipeline[chunk].viewport_transform);
     }
 }
 
+/**
+ * @brief Invoke the vertex shader on an index range, clip the primitives and apply the viewport transformation.
+ *
+ * Only valid if the indices inside the range only reference vertices from the same range, which is the
+ * case for sequential indices.
+ */
+static void process_vertex_range_task(impl::render_object* obj, std::size_t index_begin, std::size_t index_end, impl::vertex_shader_instance_container* shader_instance, std::size_t chunk)
+{
+    vertex_shader_task(obj, index_begin, index_end, shader_instance, chunk);
+    clip_and_transform_task(obj, index_begin, index_end, chunk);
+}
+
+/** Invoke the vertex shader on the vertices referenced by an index range, clip the primitives and apply the viewport transformation. */
+static void process_indexed_range_task(impl::render_object* obj, std::size_t index_begin, std::size_t index_end, impl::vertex_shader_instance_container* shader_instance, std::atomic<std::uint32_t>* vertex_states, std::size_t chunk)
+{
+    indexed_vertex_shader_task(obj, index_begin, index_end, shader_instance, vertex_states, chunk);
+    clip_and_transform_task(obj, index_begin, index_end, chunk);
+}
+
 static void process_vertices(impl::render_device_context* context)
 {
+    SWR_TRACE_SCOPE("vertex processing");
+
     // create shaders.
     std::size_t total_shader_size = 0;
     for(const auto& obj: context->render_object_list)
@@ -386,36 +480,74 @@ static void process_vertices(impl::render_device_context* context)
         storage = utils::align(utils::alignment::sse, storage);
     }
 
-    // invoke vertex shaders.
-    for(auto& [obj, shader]: context->program_instances)
+    // allocate the shading states of the vertices of render objects with non-sequential indices.
+    std::size_t vertex_state_count = 0;
+    for(const auto& obj: context->render_object_list)
     {
-        if(obj->attrib_count != 0 && obj->indices.size() != 0)
+        if(!obj.sequential_indices)
         {
-            invoke_vertex_shader_and_clip_preprocess(context->thread_pool, shader, *obj);
+            vertex_state_count += obj.coord_count;
         }
     }
-    context->thread_pool.run_tasks_and_wait();
-
-    // clipping.
-    for(auto& [obj, shader]: context->program_instances)
+    if(vertex_state_count > context->vertex_state_capacity)
     {
-        context->thread_pool.push_task(clip_vertex_buffer, obj);
+        context->vertex_states = std::make_unique<std::atomic<std::uint32_t>[]>(vertex_state_count);
+        context->vertex_state_capacity = vertex_state_count;
     }
-    context->thread_pool.run_tasks_and_wait();
+    std::atomic<std::uint32_t>* vertex_states = context->vertex_states.get();
+
+    /*
+     * split the index buffers into ranges of whole primitives. vertex shading, clipping and the viewport transform
+     * of a range run as a single task. for sequential indices, a range only references its own vertices. otherwise,
+     * the vertices may be shared between ranges, and the tasks claim them through the vertex states.
+     */
+    const auto thread_count = context->thread_pool.get_thread_count();
 
-    // viewport transform.
     for(auto& [obj, shader]: context->program_instances)
     {
-        // skip the rest of the pipeline if no clipped vertices were produced.
-        if(obj->clipped_vertices.size() != 0)
+        obj->clipped_vertices.clear();
+        obj->clipped_min_depth.clear();
+        if(obj->attrib_count == 0 || obj->indices.size() == 0)
+        {
+            continue;
+        }
+
+        // allocate varyings.
+        obj->allocate_varyings(shader.get_varying_count());
+
+        const std::size_t index_count = obj->indices.size();
+        const std::size_t chunk_size = get_chunk_size(*obj, thread_count);
+        obj->clipped_vertices.resize((index_count + chunk_size - 1) / chunk_size);
+        obj->clipped_min_depth.assign(obj->clipped_vertices.size(), std::numeric_limits<float>::infinity());
+#ifdef SWR_ENABLE_STATS
+        obj->stats_pipeline.assign(obj->clipped_vertices.size(), {});
+#endif
+
+        if(!obj->sequential_indices)
+        {
+            // the states are reset before the tasks are pushed, so that they are visible to the workers.
+            for(std::size_t i = 0; i < obj->coord_count; ++i)
+            {
+                vertex_states[i].store(vertex_unshaded, std::memory_order_relaxed);
+            }
+        }
+
+        for(std::size_t i = 0, offset = 0; offset < index_count; ++i, offset += chunk_size)
+        {
+            const std::size_t end = std::min(offset + chunk_size, index_count);
+            if(obj->sequential_indices)
+            {
+                context->thread_pool.push_immediate_task(process_vertex_range_task, obj, offset, end, &shader, i);
+            }
+            else
+            {
+                context->thread_pool.push_immediate_task(process_indexed_range_task, obj, offset, end, &shader, vertex_states, i);
+            }
+        }
+
+        if(!obj->sequential_indices)
         {
-            // perspective divide and viewport transformation.
-            transform_to_viewport_coords(
-              context->thread_pool,
-              obj->clipped_vertices,
-              obj->states.x, obj->states.y,
-              obj->states.width, obj->states.height,
-              obj->states.z_near, obj->states.z_far);
+            vertex_states += obj->coord_count;
         }
     }
     context->thread_pool.run_tasks_and_wait();
@@ -425,10 +557,149 @@ static void process_vertices(impl::render_device_context* context)
     context->program_storage.clear();
 }
 
+/** assemble the primitives of a clipped vertex buffer into a preallocated range. meant to be supplied to a thread pool. */
+static void assemble_primitives_task(impl::render_object* obj, std::size_t chunk, rast::primitive_range* out)
+{
+    SWR_TRACE_SCOPE("assembly", -1, out->capacity);
+    SWR_PERF_SCOPE(assembly);
+
+    SWR_STATS_CLOCK(obj->stats_pipeline[chunk].assembly);
+    impl::render_device_context::assemble_primitives(&obj->states, obj->mode, obj->clipped_vertices[chunk], *out);
+    SWR_STATS_UNCLOCK(obj->stats_pipeline[chunk].assembly);
+}
+
+static void assemble_primitives(impl::render_device_context* context)
+{
+    SWR_TRACE_SCOPE("primitive assembly");
+
+    // calculate the number of primitives and ranges.
+    std::size_t primitive_count = 0;
+    std::size_t range_count = 0;
+    for(auto& it: context->render_object_list)
+    {
+        for(auto& vb: it.clipped_vertices)
+        {
+            if(vb.size() != 0)
+            {
+                primitive_count += impl::render_device_context::get_max_primitive_count(&it.states, it.mode, vb);
+                ++range_count;
+            }
+        }
+    }
+
+    // allocate the primitives and ranges up front, so that the pointers stay valid while assembling.
+    context->assembled_primitives.resize(primitive_count);
+    context->assembly_ranges.clear();
+    context->assembly_ranges.reserve(range_count);
+
+    // assemble each clipped vertex buffer into its own range.
+    rast::primitive* data = context->assembled_primitives.data();
+    for(auto& it: context->render_object_list)
+    {
+        for(std::size_t i = 0; i < it.clipped_vertices.size(); ++i)
+        {
+            const auto& vb = it.clipped_vertices[i];
+            if(vb.size() != 0)
+            {
+                const auto capacity = impl::render_device_context::get_max_primitive_count(&it.states, it.mode, vb);
+                auto& range = context->assembly_ranges.emplace_back(data, capacity);
+                data += capacity;
+
+                context->thread_pool.push_immediate_task(assemble_primitives_task, &it, i, &range);
+            }
+        }
+    }
+    context->thread_pool.run_tasks_and_wait();
+
+    // pass the primitives on to the rasterizer, keeping the submission order.
+    for(auto& range: context->assembly_ranges)
+    {
+        context->rasterizer->add_primitives(range.data, range.size);
+    }
+}
+
 } /* namespace mt */
 
 #endif /* SWR_ENABLE_MULTI_THREADING */
 
+/*
+ * front-to-back sorting.
+ */
+
+/**
+ * Check if a render object is opaque, i.e., if it only writes fragments that are closer than the stored depth.
+ * The image produced by a run of such objects does not depend on their order, up to fragments of equal depth.
+ */
+static bool is_opaque(const impl::render_object& obj)
+{
+    return obj.states.depth_test_enabled
+           && obj.states.write_depth
+           && (obj.states.depth_func == comparison_func::less || obj.states.depth_func == comparison_func::less_equal)
+           && !obj.states.blending_enabled;
+}
+
+/**
+ * check if two opaque render objects can be reordered with respect to each other. the samples passed by an object
+ * depend on the objects drawn before it, so objects counted by different occlusion queries are not reordered.
+ */
+static bool is_same_opaque_run(const impl::render_object& a, const impl::render_object& b)
+{
+    return is_opaque(b)
+           && a.states.draw_target == b.states.draw_target
+           && a.states.depth_func == b.states.depth_func
+           && a.states.active_query == b.states.active_query;
+}
+
+/** return the smallest viewport depth of the clipped vertices of a render object. */
+static float get_min_depth(const impl::render_object& obj)
+{
+    float min_depth = std::numeric_limits<float>::infinity();
+    for(auto depth: obj.clipped_min_depth)
+    {
+        min_depth = std::min(min_depth, depth);
+    }
+    return min_depth;
+}
+
+/**
+ * Sort runs of consecutive opaque render objects front-to-back. The sort is stable, i.e., objects with
+ * the same depth keep their submission order. Other objects are not moved and separate the runs.
+ */
+static void sort_opaque_objects(std::list<impl::render_object>& objects)
+{
+    SWR_TRACE_SCOPE("depth sorting");
+
+    std::list<impl::render_object> run;
+
+    auto it = objects.begin();
+    while(it != objects.end())
+    {
+        // objects counted by an occlusion query keep their order, also with respect to each other.
+        if(!is_opaque(*it) || it->states.active_query != 0)
+        {
+            ++it;
+            continue;
+        }
+
+        auto run_end = std::next(it);
+        while(run_end != objects.end() && is_same_opaque_run(*it, *run_end))
+        {
+            ++run_end;
+        }
+
+        // splicing does not move the objects, so that pointers to them stay valid.
+        if(std::next(it) != run_end)
+        {
+            run.splice(run.end(), objects, it, run_end);
+            run.sort([](const impl::render_object& a, const impl::render_object& b) -> bool
+                     { return get_min_depth(a) < get_min_depth(b); });
+            objects.splice(run_end, run);
+        }
+
+        it = run_end;
+    }
+}
+
 /*
  * Execute the graphics pipeline and output an image into the frame buffer. The function operates on
  * the draw list produced by the drawing functions. For each draw list entry, execute:
@@ -446,49 +717,150 @@ void Present()
     ASSERT_INTERNAL_CONTEXT;
     auto context = impl::global_context;
 
-    // immediately return if there is nothing to do.
+#ifdef SWR_ENABLE_CAPTURE
+    // record the call before the early return, so that replays see the same sequence of frames.
+    impl::capture::global_recorder.present();
+#endif
+
+    // immediately return if there is nothing to do. ended queries have no pending draw calls.
     if(context->render_object_list.size() == 0)
     {
+        impl::update_queries(context);
+
+        // a discard request only applies to this frame.
+        context->rasterizer->discard_depth = false;
         return;
     }
 
+#ifdef SWR_ENABLE_TRACING
+    impl::trace::global_tracer.begin_frame();
+#endif
+
+#ifdef SWR_ENABLE_STATS
+    // start a new frame for the memory peaks.
+    for(auto& it: context->stats_memory.categories)
+    {
+        it.frame_peak = 0;
+    }
+    impl::sample_memory_usage(context);
+#endif
+
 #ifdef SWR_ENABLE_MULTI_THREADING
     mt::process_vertices(context);
 
-    // primitive assembly.
-    for(auto& it: context->render_object_list)
+    // optionally reorder opaque objects front-to-back, so that occluded fragments are rejected early.
+    if(context->sort_opaque_objects)
     {
-        if(it.clipped_vertices.size() != 0)
-        {
-            // Assemble primitives from drawing lists. The primitives are passed on to the triangle rasterizer.
-            context->assemble_primitives(&it.states, it.mode, it.clipped_vertices);
-        }
+        sort_opaque_objects(context->render_object_list);
     }
+
+    // Assemble primitives from drawing lists. The primitives are passed on to the triangle rasterizer.
+    mt::assemble_primitives(context);
 #else
     // process render commands.
     for(auto& it: context->render_object_list)
     {
         st::process_vertices(it);
+    }
 
-        if(it.clipped_vertices.size() != 0)
+    // optionally reorder opaque objects front-to-back, so that occluded fragments are rejected early.
+    if(context->sort_opaque_objects)
+    {
+        sort_opaque_objects(context->render_object_list);
+    }
+
+    for(auto& it: context->render_object_list)
+    {
+        SWR_TRACE_SCOPE("primitive assembly");
+        SWR_PERF_SCOPE(assembly);
+        SWR_STATS_CLOCK(it.stats_pipeline[0].assembly);
+
+        for(auto& vb: it.clipped_vertices)
         {
-            // Assemble primitives from drawing lists. The primitives are passed on to the triangle rasterizer.
-            context->assemble_primitives(&it.states, it.mode, it.clipped_vertices);
+            if(vb.size() != 0)
+            {
+                // Assemble primitives from drawing lists. The primitives are passed on to the triangle rasterizer.
+                context->assemble_primitives(&it.states, it.mode, vb);
+            }
         }
+
+        SWR_STATS_UNCLOCK(it.stats_pipeline[0].assembly);
     }
 #endif
 
+#ifdef SWR_ENABLE_STATS
+    // the vertex processing buffers and the assembled primitives are at their largest.
+    impl::sample_memory_usage(context);
+#endif
+
     // invoke triangle rasterizer.
     context->rasterizer->draw_primitives();
 
+    // add the counted fragments to the occlusion queries.
+    impl::update_queries(context);
+
 #ifdef SWR_ENABLE_STATS
-    // store statistical data.
+    // store statistical data. the vertex processing stages are collected from the render objects.
     context->stats_frag = context->rasterizer->stats_frag;
     context->stats_rast = context->rasterizer->stats_rast;
+    context->stats_pipeline = context->rasterizer->stats_pipeline;
+    context->stats_tiles = context->rasterizer->stats_tiles;
+
+    // the tiles were filled during rasterization, and are empty again. record their largest size.
+    context->stats_memory.categories[static_cast<std::size_t>(stats::memory_category::tile_cache)].sample(context->rasterizer->stats_tile_cache_peak);
+
+    for(const auto& it: context->render_object_list)
+    {
+        for(const auto& stats: it.stats_pipeline)
+        {
+            context->stats_pipeline += stats;
+        }
+    }
+#endif
+
+#ifdef SWR_ENABLE_PERF_COUNTERS
+    // the thread pool is idle, so the counters of all threads can be collected.
+    impl::perf::global_counters.collect();
 #endif
 
     // flush all lists.
     context->render_object_list.clear();
+
+#ifdef SWR_ENABLE_STATS
+    impl::sample_memory_usage(context);
+#endif
+
+#ifdef SWR_ENABLE_TRACING
+    impl::trace::global_tracer.end_frame();
+#endif
+}
+
+void SetVisibilityBuffer(bool enable)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_visibility_buffer, enable);
+
+    if(impl::global_context->im_declaring_primitives)
+    {
+        impl::global_context->last_error = error::invalid_operation;
+        return;
+    }
+
+    impl::global_context->rasterizer->visibility_buffer = enable;
+}
+
+void SetDepthSorting(bool enable)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_depth_sorting, enable);
+
+    if(impl::global_context->im_declaring_primitives)
+    {
+        impl::global_context->last_error = error::invalid_operation;
+        return;
+    }
+
+    impl::global_context->sort_opaque_objects = enable;
 }
 
 /*
@@ -498,6 +870,7 @@ void Present()
 void ClearDepthBuffer()
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::clear_depth_buffer);
 
     if(impl::global_context->im_declaring_primitives)
     {
@@ -508,9 +881,25 @@ void ClearDepthBuffer()
     impl::global_context->clear_depth_buffer();
 }
 
+void DiscardDepthBuffer()
+{
+    ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::discard_depth_buffer);
+
+    if(impl::global_context->im_declaring_primitives)
+    {
+        impl::global_context->last_error = error::invalid_operation;
+        return;
+    }
+
+    // the flag is reset by Present.
+    impl::global_context->rasterizer->discard_depth = true;
+}
+
 void SetClearDepth(float z)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_clear_depth, z);
     impl::global_context->states.set_clear_depth(z);
 }
 
@@ -521,12 +910,14 @@ void SetClearDepth(float z)
 void ClearColorBuffer()
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::clear_color_buffer);
     impl::global_context->clear_color_buffer();
 }
 
 void SetClearColor(float r, float g, float b, float a)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_clear_color, r, g, b, a);
     impl::global_context->states.set_clear_color(r, g, b, a);
 }
 
@@ -537,6 +928,7 @@ void SetClearColor(float r, float g, float b, float a)
 void SetScissorBox(int x, int y, int width, int height)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_scissor_box, x, y, width, height);
     auto context = impl::global_context;
 
     if(width < 0 || height < 0)
@@ -561,6 +953,7 @@ void SetScissorBox(int x, int y, int width, int height)
 void SetViewport(int x, int y, unsigned int width, unsigned int height)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_viewport, x, y, width, height);
     auto context = impl::global_context;
 
     if(context->im_declaring_primitives)
@@ -575,6 +968,7 @@ void SetViewport(int x, int y, unsigned int width, unsigned int height)
 void DepthRange(float zNear, float zFar)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::depth_range, zNear, zFar);
     auto context = impl::global_context;
 
     if(context->im_declaring_primitives)
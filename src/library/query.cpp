@@ -0,0 +1,197 @@
+/**
+ * swr - a software rasterizer
+ *
+ * occlusion queries. the fragments are counted per tile by the rasterizer, so that the worker threads
+ * do not share any counters. the counts are added to the queries after the tiles are processed.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* user headers. */
+#include "swr_internal.h"
+
+namespace swr
+{
+
+/** query ids start at 1, since 0 marks draw calls without an active query. */
+static auto id_to_slot = [](std::uint32_t id) -> std::uint32_t
+{ return id - 1; };
+static auto slot_to_id = [](std::uint32_t slot) -> std::uint32_t
+{ return slot + 1; };
+
+namespace impl
+{
+
+/** return the query object for an id, or nullptr if the id does not refer to a live query. */
+static query_object* get_query(render_device_context* context, std::uint32_t id)
+{
+    auto slot = id_to_slot(id);
+    if(id == 0 || slot >= context->queries.capacity() || context->queries.is_free(slot)
+       || context->queries[slot].state == query_state::released)
+    {
+        return nullptr;
+    }
+    return &context->queries[slot];
+}
+
+void update_queries(render_device_context* context)
+{
+    // the draw calls are tagged by the query id. since a slot is only reused after the draw calls referencing it
+    // were rasterized, the samples always belong to the query that was active when the draw call was issued.
+    auto& samples = context->rasterizer->query_samples;
+    for(std::uint32_t id = 1; id < samples.size(); ++id)
+    {
+        auto slot = id_to_slot(id);
+        if(samples[id] != 0 && slot < context->queries.capacity())
+        {
+            auto& query = context->queries[slot];
+            if(query.state == query_state::active || query.state == query_state::ended)
+            {
+                query.samples += samples[id];
+            }
+        }
+    }
+    samples.clear();
+
+    // all draw calls issued before the queries were ended or released are rasterized now.
+    for(std::size_t slot = 0; slot < context->queries.capacity(); ++slot)
+    {
+        auto& query = context->queries[slot];
+        if(query.state == query_state::ended)
+        {
+            query.state = query_state::available;
+        }
+        else if(query.state == query_state::released)
+        {
+            query = {};
+            context->queries.free(slot);
+        }
+    }
+}
+
+} /* namespace impl */
+
+/*
+ * occlusion query interface.
+ */
+
+uint32_t CreateQuery()
+{
+    ASSERT_INTERNAL_CONTEXT;
+    impl::render_device_context* context = impl::global_context;
+
+    auto slot = context->queries.push({});
+
+    SWR_CAPTURE(impl::capture::opcode::create_query, slot_to_id(slot));
+    return slot_to_id(slot);
+}
+
+void ReleaseQuery(uint32_t id)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::release_query, id);
+    impl::render_device_context* context = impl::global_context;
+
+    auto* query = impl::get_query(context, id);
+    if(!query)
+    {
+        return;
+    }
+
+    // end the query if it is active.
+    if(context->states.active_query == id)
+    {
+        context->states.active_query = 0;
+    }
+
+    // draw calls referencing the query may still be waiting for Present. the slot cannot be reused before they are rasterized.
+    if(query->state == impl::query_state::active || query->state == impl::query_state::ended)
+    {
+        query->state = impl::query_state::released;
+        return;
+    }
+
+    *query = {};
+    context->queries.free(id_to_slot(id));
+}
+
+void BeginQuery(query_target target, uint32_t id)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::begin_query, target, id);
+    impl::render_device_context* context = impl::global_context;
+
+    if(context->im_declaring_primitives || context->states.active_query != 0)
+    {
+        context->last_error = error::invalid_operation;
+        return;
+    }
+
+    auto* query = impl::get_query(context, id);
+    if(!query)
+    {
+        context->last_error = error::invalid_value;
+        return;
+    }
+
+    // the draw calls of the previous round are tagged with the same id, so they need to be rasterized first.
+    if(query->state == impl::query_state::ended)
+    {
+        context->last_error = error::invalid_operation;
+        return;
+    }
+
+    query->target = target;
+    query->state = impl::query_state::active;
+    query->samples = 0;
+
+    context->states.active_query = id;
+}
+
+void EndQuery(query_target target)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::end_query, target);
+    impl::render_device_context* context = impl::global_context;
+
+    if(context->im_declaring_primitives || context->states.active_query == 0)
+    {
+        context->last_error = error::invalid_operation;
+        return;
+    }
+
+    auto* query = impl::get_query(context, context->states.active_query);
+    if(query->target != target)
+    {
+        context->last_error = error::invalid_operation;
+        return;
+    }
+
+    query->state = impl::query_state::ended;
+    context->states.active_query = 0;
+}
+
+bool GetQueryResult(uint32_t id, uint64_t& result)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    impl::render_device_context* context = impl::global_context;
+
+    auto* query = impl::get_query(context, id);
+    if(!query)
+    {
+        context->last_error = error::invalid_value;
+        return false;
+    }
+
+    if(query->state != impl::query_state::available)
+    {
+        return false;
+    }
+
+    result = query->get_result();
+    return true;
+}
+
+} /* namespace swr */
@@ -37,8 +37,10 @@ static_assert(swr::fragment_shader_result::accept == 1, "swr::fragment_shader_re
  *  2) Call the fragment shader.
  *  3) Depth test (note that this cannot be done earlier, since the fragment shader may modify the depth value).
  */
-void sweep_rasterizer::process_fragment(int x, int y, const swr::impl::render_states& states, const swr::program_base* in_shader, float one_over_viewport_z, fragment_info& frag_info, swr::impl::fragment_output& out)
+void sweep_rasterizer::process_fragment(int x, int y, const swr::impl::render_states& states, swr::impl::framebuffer_draw_target* draw_target, const swr::program_base* in_shader, float one_over_viewport_z, fragment_info& frag_info, swr::impl::fragment_output& out)
 {
+    SWR_STATS_INCREMENT(thread_stats->frag.count);
+
     /*
      * Scissor test.
      */
@@ -58,11 +60,46 @@ void sweep_rasterizer::process_fragment(int x, int y, const swr::impl::render_st
         if(x < states.scissor_box.x_min || x >= states.scissor_box.x_max
            || y < y_min || y >= y_max)
         {
+            SWR_STATS_INCREMENT(thread_stats->frag.discard_scissor);
             out.write_flags = 0;
             return;
         }
     }
 
+    /*
+     * Depth-only mode. all color channels are masked and the shader does not affect the depth value, so we skip it.
+     */
+    if(is_depth_only(states))
+    {
+        bool depth_write_mask = true;
+        if(states.depth_test_enabled)
+        {
+            SWR_STATS_CLOCK(thread_stats->pipeline.depth_test);
+
+            draw_target->depth_compare_write(x, y, boost::algorithm::clamp(frag_info.depth_value, 0.f, 1.f), states.depth_func, states.write_depth, depth_write_mask);
+            SWR_STATS_INCREMENT2(thread_stats->frag.discard_depth, !depth_write_mask);
+
+            if(!depth_write_mask && is_counting_overdraw(states))
+            {
+                count_overdraw(x, y, &swr::debug::fragment_counters::depth_failed);
+            }
+
+            SWR_STATS_UNCLOCK(thread_stats->pipeline.depth_test);
+        }
+
+        count_query_samples(states, depth_write_mask);
+
+        out.write_flags = 0;
+        return;
+    }
+
+    if(is_counting_overdraw(states))
+    {
+        count_overdraw(x, y, &swr::debug::fragment_counters::shaded);
+    }
+
+    SWR_STATS_CLOCK(thread_stats->pipeline.fragment_shading);
+
     // initialize write flags.
     uint32_t write_flags = swr::impl::fragment_output::fof_write_color;
 
@@ -91,8 +128,6 @@ void sweep_rasterizer::process_fragment(int x, int y, const swr::impl::render_st
     /*
      * Execute the fragment shader.
      */
-    // FIXME From docs: gl_PointCoord: contains the coordinate of a fragment within a point. currently undefined.
-
     /*
      * set up the output color attachments for the fragment shader. the default color is explicitly unspecified in OpenGL, and we
      * choose {0,0,0,1} for initialization. see e.g. https://stackoverflow.com/questions/29119097/glsl-default-value-for-output-color
@@ -122,9 +157,12 @@ void sweep_rasterizer::process_fragment(int x, int y, const swr::impl::render_st
           z};
     }
 
-    auto accept_fragment = in_shader->fragment_shader(frag_coord, frag_info.front_facing, {0, 0}, frag_info.varyings, depth_value, color);
+    auto accept_fragment = in_shader->fragment_shader(frag_coord, frag_info.front_facing, frag_info.point_coord, frag_info.varyings, depth_value, color);
+    SWR_STATS_UNCLOCK(thread_stats->pipeline.fragment_shading);
+
     if(accept_fragment == swr::discard)
     {
+        SWR_STATS_INCREMENT(thread_stats->frag.discard_shader);
         out.write_flags = 0;
         return;
     }
@@ -135,10 +173,22 @@ void sweep_rasterizer::process_fragment(int x, int y, const swr::impl::render_st
     bool depth_write_mask = true;
     if(states.depth_test_enabled)
     {
+        SWR_STATS_CLOCK(thread_stats->pipeline.depth_test);
+
         depth_value = boost::algorithm::clamp(depth_value, 0.f, 1.f);
-        states.draw_target->depth_compare_write(x, y, depth_value, states.depth_func, states.write_depth, depth_write_mask);
+        draw_target->depth_compare_write(x, y, depth_value, states.depth_func, states.write_depth, depth_write_mask);
+        SWR_STATS_INCREMENT2(thread_stats->frag.discard_depth, !depth_write_mask);
+
+        if(!depth_write_mask && is_counting_overdraw(states))
+        {
+            count_overdraw(x, y, &swr::debug::fragment_counters::depth_failed);
+        }
+
+        SWR_STATS_UNCLOCK(thread_stats->pipeline.depth_test);
     }
 
+    count_query_samples(states, depth_write_mask);
+
     auto to_mask = [](bool b) -> uint32_t
     { return ~(static_cast<std::uint32_t>(b) - 1); };
 
@@ -146,79 +196,60 @@ void sweep_rasterizer::process_fragment(int x, int y, const swr::impl::render_st
     out.write_flags = write_flags & to_mask(depth_write_mask);
 }
 
-/** the same as above, but operates on 2x2 tiles. does not return any value. */
-void sweep_rasterizer::process_fragment_block(int x, int y, const swr::impl::render_states& states, const swr::program_base* in_shader, float one_over_viewport_z[4], fragment_info frag_info[4], swr::impl::fragment_output_block& out)
+std::uint32_t sweep_rasterizer::get_scissor_mask(int x, int y, const swr::impl::render_states& states) const
 {
-    /*
-     * helper lambdas.
-     */
-    auto set_uniform_mask = [](bool mask[4], bool v)
-    {
-        mask[0] = mask[1] = mask[2] = mask[3] = v;
-    };
-    auto apply_mask = [](bool mask[4], const auto additional_mask[4])
-    {
-        mask[0] &= static_cast<bool>(additional_mask[0]);
-        mask[1] &= static_cast<bool>(additional_mask[1]);
-        mask[2] &= static_cast<bool>(additional_mask[2]);
-        mask[3] &= static_cast<bool>(additional_mask[3]);
-    };
-    auto copy_array4 = [](auto to[4], const auto from[4])
-    {
-        to[0] = from[0];
-        to[1] = from[1];
-        to[2] = from[2];
-        to[3] = from[3];
-    };
+    int y_min{states.scissor_box.y_min};
+    int y_max{states.scissor_box.y_max};
 
-    // initialize masks.
-    bool depth_mask[4] = {out.write_color[0], out.write_color[1], out.write_color[2], out.write_color[3]};
-    depth_mask[0] &= states.write_depth;
-    depth_mask[1] &= states.write_depth;
-    depth_mask[2] &= states.write_depth;
-    depth_mask[3] &= states.write_depth;
+    // the default framebuffer needs a flip.
+    if(states.draw_target == framebuffer)
+    {
+        int y_temp = y_min;
+        y_min = states.draw_target->properties.height - y_max;
+        y_max = states.draw_target->properties.height - y_temp;
+    }
 
-    bool write_color[4] = {true, true, true, true};
-    bool write_stencil[4] = {false, false, false, false}; /* unimplemented */
+    auto scissor_check = [y_min, y_max, &states](int _x, int _y) -> std::uint32_t
+    { return _x >= states.scissor_box.x_min && _x < states.scissor_box.x_max && _y >= y_min && _y < y_max; };
+    return scissor_check(x, y)
+           | (scissor_check(x + 1, y) << 1)
+           | (scissor_check(x, y + 1) << 2)
+           | (scissor_check(x + 1, y + 1) << 3);
+}
 
-    /* stencil buffering is currently unimplemented and the stencil mask is default-initialized to false. */
+/** the same as above, but operates on 2x2 tiles. the depth test is left to merge_fragment_blocks. does not return any value. */
+void sweep_rasterizer::process_fragment_block(int x, int y, const swr::impl::render_states& states, const swr::program_base* in_shader, float one_over_viewport_z[4], fragment_info frag_info[4], swr::impl::fragment_output_block& out)
+{
+    /* stencil buffering is currently unimplemented and the stencil mask is default-initialized to zero. */
 
     // block coordinates
     const ml::tvec2<int> coords[4] = {{x, y}, {x + 1, y}, {x, y + 1}, {x + 1, y + 1}};
 
+    SWR_STATS_INCREMENT(thread_stats->frag.quads);
+    SWR_STATS_INCREMENT2(thread_stats->frag.count, get_fragment_count(out.write_color));
+
     /*
      * Scissor test.
      */
     if(states.scissor_test_enabled)
     {
-        int y_min{states.scissor_box.y_min};
-        int y_max{states.scissor_box.y_max};
-
-        // the default framebuffer needs a flip.
-        if(states.draw_target == framebuffer)
-        {
-            int y_temp = y_min;
-            y_min = states.draw_target->properties.height - y_max;
-            y_max = states.draw_target->properties.height - y_temp;
-        }
+        std::uint32_t scissor_mask = get_scissor_mask(x, y, states);
+        SWR_STATS_INCREMENT2(thread_stats->frag.discard_scissor, get_fragment_count(out.write_color & ~scissor_mask));
 
-        auto scissor_check = [y_min, y_max, &states](int _x, int _y) -> bool
-        { return _x >= states.scissor_box.x_min && _x < states.scissor_box.x_max && _y >= y_min && _y < y_max; };
-        bool scissor_mask[4] = {
-          scissor_check(coords[0].x, coords[0].y), scissor_check(coords[1].x, coords[1].y), scissor_check(coords[2].x, coords[2].y), scissor_check(coords[3].x, coords[3].y)};
+        out.write_color &= scissor_mask;
+        out.write_stencil &= scissor_mask;
 
-        if(!(scissor_mask[0] || scissor_mask[1] || scissor_mask[2] || scissor_mask[3]))
+        if(!out.write_color)
         {
-            // the mask only contains 'false'.
-            set_uniform_mask(out.write_color, false);
-            set_uniform_mask(out.write_stencil, false);
-
             return;
         }
+    }
 
-        apply_mask(depth_mask, scissor_mask);
-        apply_mask(write_color, scissor_mask);
-        apply_mask(write_stencil, scissor_mask);
+    // the shader runs on all four lanes. lanes without a fragment only contribute to the derivatives.
+    if(is_counting_overdraw(states))
+    {
+        count_overdraw_block(x, y, out.write_color, &swr::debug::fragment_counters::shaded);
+        count_overdraw_block(x, y, ~out.write_color & 0xf, &swr::debug::fragment_counters::helper_lanes);
     }
 
     /*
@@ -259,8 +290,6 @@ void sweep_rasterizer::process_fragment_block(int x, int y, const swr::impl::ren
     /*
      * Execute the fragment shader.
      */
-    // FIXME From docs: gl_PointCoord: contains the coordinate of a fragment within a point. currently undefined.
-
     /*
      * set up the output color attachments for the fragment shader. the default color is explicitly unspecified in OpenGL, and we
      * choose {0,0,0,1} for initialization. see e.g. https://stackoverflow.com/questions/29119097/glsl-default-value-for-output-color
@@ -292,25 +321,23 @@ void sweep_rasterizer::process_fragment_block(int x, int y, const swr::impl::ren
         frag_coord[3].y = framebuffer->properties.height - frag_coord[3].y;
     }
 
-    swr::fragment_shader_result accept_mask[4] = {
-      in_shader->fragment_shader(frag_coord[0], frag_info[0].front_facing, {0, 0}, frag_info[0].varyings, depth_value[0], color[0]),
-      in_shader->fragment_shader(frag_coord[1], frag_info[1].front_facing, {0, 0}, frag_info[1].varyings, depth_value[1], color[1]),
-      in_shader->fragment_shader(frag_coord[2], frag_info[2].front_facing, {0, 0}, frag_info[2].varyings, depth_value[2], color[2]),
-      in_shader->fragment_shader(frag_coord[3], frag_info[3].front_facing, {0, 0}, frag_info[3].varyings, depth_value[3], color[3])};
+    std::uint32_t accept_mask = in_shader->fragment_shader(frag_coord[0], frag_info[0].front_facing, frag_info[0].point_coord, frag_info[0].varyings, depth_value[0], color[0])
+                                | (in_shader->fragment_shader(frag_coord[1], frag_info[1].front_facing, frag_info[1].point_coord, frag_info[1].varyings, depth_value[1], color[1]) << 1)
+                                | (in_shader->fragment_shader(frag_coord[2], frag_info[2].front_facing, frag_info[2].point_coord, frag_info[2].varyings, depth_value[2], color[2]) << 2)
+                                | (in_shader->fragment_shader(frag_coord[3], frag_info[3].front_facing, frag_info[3].point_coord, frag_info[3].varyings, depth_value[3], color[3]) << 3);
+
+    SWR_STATS_INCREMENT2(thread_stats->frag.discard_shader, get_fragment_count(out.write_color & ~accept_mask));
 
-    if(!(accept_mask[0] || accept_mask[1] || accept_mask[2] || accept_mask[3]))
+    out.write_color &= accept_mask;
+    out.write_stencil &= accept_mask;
+
+    if(!out.write_color)
     {
-        set_uniform_mask(out.write_color, false);
-        set_uniform_mask(out.write_stencil, false);
         return;
     }
 
-    apply_mask(depth_mask, accept_mask);
-    apply_mask(write_color, accept_mask);
-    apply_mask(write_stencil, accept_mask);
-
     /*
-     * Depth test.
+     * Clamp the depth values for the depth test, which is performed on 4x4 blocks in merge_fragment_blocks.
      */
     if(states.depth_test_enabled)
     {
@@ -322,16 +349,105 @@ void sweep_rasterizer::process_fragment_block(int x, int y, const swr::impl::ren
         depth_value[2] = boost::algorithm::clamp(depth_value[2], 0, 1);
         depth_value[3] = boost::algorithm::clamp(depth_value[3], 0, 1);
 #endif /* SWR_USE_SIMD */
+    }
+
+    // copy color and depth into output
+    std::copy(color, color + 4, out.color);
+    std::copy(depth_value, depth_value + 4, out.depth_value);
+}
+
+void sweep_rasterizer::process_depth_block(int x, int y, const swr::impl::render_states& states, const float depth_value[4], swr::impl::fragment_output_block& out)
+{
+    SWR_STATS_INCREMENT(thread_stats->frag.quads);
+    SWR_STATS_INCREMENT2(thread_stats->frag.count, get_fragment_count(out.write_color));
+
+    /*
+     * Scissor test.
+     */
+    if(states.scissor_test_enabled)
+    {
+        std::uint32_t scissor_mask = get_scissor_mask(x, y, states);
+        SWR_STATS_INCREMENT2(thread_stats->frag.discard_scissor, get_fragment_count(out.write_color & ~scissor_mask));
+
+        out.write_color &= scissor_mask;
+        out.write_stencil &= scissor_mask;
+
+        if(!out.write_color)
+        {
+            return;
+        }
+    }
+
+    /*
+     * Clamp the depth values for the depth test. the colors are not written, so they are not set.
+     */
+#ifdef SWR_USE_SIMD
+    _mm_storeu_ps(out.depth_value, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(depth_value), _mm_set_ps1(0.0f)), _mm_set_ps1(1.0f)));
+#else  /* SWR_USE_SIMD */
+    out.depth_value[0] = boost::algorithm::clamp(depth_value[0], 0, 1);
+    out.depth_value[1] = boost::algorithm::clamp(depth_value[1], 0, 1);
+    out.depth_value[2] = boost::algorithm::clamp(depth_value[2], 0, 1);
+    out.depth_value[3] = boost::algorithm::clamp(depth_value[3], 0, 1);
+#endif /* SWR_USE_SIMD */
+}
 
-        states.draw_target->depth_compare_write_block(x, y, depth_value, states.depth_func, states.write_depth, depth_mask);
+void sweep_rasterizer::merge_fragment_blocks(int x, int y, const swr::impl::render_states& states, swr::impl::framebuffer_draw_target* draw_target, swr::impl::fragment_output_block out[4])
+{
+    std::uint32_t write_mask = out[0].write_color | (out[1].write_color << 4) | (out[2].write_color << 8) | (out[3].write_color << 12);
+    if(!write_mask)
+    {
+        return;
+    }
+
+    /*
+     * Depth test.
+     */
+    if(states.depth_test_enabled)
+    {
+        float depth_value[16];
+        for(int q = 0; q < 4; ++q)
+        {
+            std::copy(out[q].depth_value, out[q].depth_value + 4, depth_value + 4 * q);
+        }
+
+        SWR_STATS_CLOCK(thread_stats->pipeline.depth_test);
+        [[maybe_unused]] const std::uint32_t tested_mask = write_mask;
+
+        draw_target->depth_compare_write_block(x, y, depth_value, states.depth_func, states.write_depth, write_mask);
+
+        SWR_STATS_INCREMENT2(thread_stats->frag.discard_depth, get_fragment_count(tested_mask & ~write_mask));
+
+        if(is_counting_overdraw(states))
+        {
+            for(int q = 0; q < 4; ++q)
+            {
+                count_overdraw_block(x + 2 * (q & 1), y + 2 * (q >> 1), (tested_mask & ~write_mask) >> (4 * q), &swr::debug::fragment_counters::depth_failed);
+            }
+        }
+        SWR_STATS_UNCLOCK(thread_stats->pipeline.depth_test);
+    }
+
+    count_query_samples(states, write_mask);
+
+    /*
+     * Merge colors. nothing is written if all color channels are masked.
+     */
+    SWR_STATS_CLOCK(thread_stats->pipeline.merge);
+    SWR_STATS_INCREMENT2(thread_stats->frag.blending, states.blending_enabled ? get_fragment_count(write_mask) : 0);
+
+    const bool merge_colors = states.color_mask != swr::output_merger::color_mask::none;
+    for(int q = 0; q < 4; ++q)
+    {
+        out[q].write_color = (write_mask >> (4 * q)) & 0xf;
+        out[q].write_stencil &= out[q].write_color;
+
+        if(out[q].write_color && merge_colors)
+        {
+            draw_target->merge_color_block(0, x + 2 * (q & 1), y + 2 * (q >> 1), out[q], states.blending_enabled, states.blend_kernels, states.color_mask);
+        }
     }
-    apply_mask(write_color, depth_mask);
-    apply_mask(write_stencil, depth_mask);
 
-    // copy color and masks into output
-    copy_array4(out.color, color);
-    copy_array4(out.write_color, write_color);
-    copy_array4(out.write_stencil, write_stencil);
+    SWR_STATS_UNCLOCK(thread_stats->pipeline.merge);
 }
 
 } /* namespace rast */
\ No newline at end of file
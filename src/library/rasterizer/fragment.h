@@ -30,6 +30,9 @@ struct fragment_info
     /** varyings. */
     boost::container::static_vector<swr::varying, geom::limits::max::varyings>& varyings;
 
+    /** coordinate of the fragment inside a point sprite (within [0,1]^2). zero for lines and triangles. */
+    ml::vec2 point_coord{0, 0};
+
     /** no default constructor. */
     fragment_info() = delete;
 
@@ -37,10 +40,12 @@ struct fragment_info
     fragment_info(
       float depth,
       bool in_front_facing,
-      boost::container::static_vector<swr::varying, geom::limits::max::varyings>& in_varyings)
+      boost::container::static_vector<swr::varying, geom::limits::max::varyings>& in_varyings,
+      ml::vec2 in_point_coord = {0, 0})
     : depth_value{depth}
     , front_facing{in_front_facing}
     , varyings{in_varyings}
+    , point_coord{in_point_coord}
     {
     }
 };
@@ -111,18 +111,12 @@ struct basic_interpolation_data
     }
 
     /**
-     * @brief get interpolated data (varyings, depth values and viewport z values) for a 2x2 block.
+     * @brief get interpolated depth values for a 2x2 block.
      *
-     * @param out_varyings Varyings for the block. Assumed to be empty.
      * @param out_depth Depth values for the block.
-     * @param out_one_over_viewport_z Inverse of viewport z for the block.
      */
-    void get_data_block(boost::container::static_vector<swr::varying, geom::limits::max::varyings> out_varyings[4], float out_depth[4], float out_one_over_viewport_z[4]) const
+    void get_depth_block(float out_depth[4]) const
     {
-        /*
-         * depth.
-         */
-
         auto depth = depth_value;
         depth.setup_block_processing();
 
@@ -140,6 +134,22 @@ struct basic_interpolation_data
         // store value at (x+1,y+1)
         depth.advance_x();
         out_depth[3] = depth.value;
+    }
+
+    /**
+     * @brief get interpolated data (varyings, depth values and viewport z values) for a 2x2 block.
+     *
+     * @param out_varyings Varyings for the block. Assumed to be empty.
+     * @param out_depth Depth values for the block.
+     * @param out_one_over_viewport_z Inverse of viewport z for the block.
+     */
+    void get_data_block(boost::container::static_vector<swr::varying, geom::limits::max::varyings> out_varyings[4], float out_depth[4], float out_one_over_viewport_z[4]) const
+    {
+        /*
+         * depth.
+         */
+
+        get_depth_block(out_depth);
 
         /*
          * viewport z.
@@ -269,6 +279,18 @@ struct line_interpolator : basic_interpolation_data<geom::linear_interpolator_1d
             it.advance_x();
         }
     }
+
+    /** Increment values by multiple steps along the parameter direction. */
+    void advance(int i)
+    {
+        depth_value.value += depth_value.step * i;
+        one_over_viewport_z.value += one_over_viewport_z.step * i;
+
+        for(auto& it: varyings)
+        {
+            it.advance_x(i);
+        }
+    }
 };
 
 /**
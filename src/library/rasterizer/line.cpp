@@ -17,6 +17,9 @@
  * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
  */
 
+/* C++ headers. */
+#include <limits>
+
 /* user headers. */
 #include "../swr_internal.h"
 
@@ -64,6 +67,18 @@ struct line_info
     void setup();
 };
 
+/** integer division rounding towards negative infinity. the divisor needs to be positive. */
+static std::int64_t floor_div(std::int64_t a, std::int64_t b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+/** integer division rounding towards positive infinity. the divisor needs to be positive. */
+static std::int64_t ceil_div(std::int64_t a, std::int64_t b)
+{
+    return -floor_div(-a, b);
+}
+
 /** extract the fractional part of a positive float */
 static float fracf(float f)
 {
@@ -343,11 +358,12 @@ void line_info::setup()
     }
 }
 
-/*
- * note: in_draw_endpoint should be used for correctly drawing line-strips, but is currently unused.
- */
-void sweep_rasterizer::draw_line(const swr::impl::render_states& states, [[maybe_unused]] bool in_draw_endpoint, const geom::vertex& v1, const geom::vertex& v2)
+void sweep_rasterizer::setup_line(std::size_t index, line_bin& bin) const
 {
+    const auto& states = *state_list[lines.state_indices[index]];
+    const geom::vertex& v1 = *lines.vertices[index * 2];
+    const geom::vertex& v2 = *lines.vertices[index * 2 + 1];
+
     line_info info{v1, v2};
 
     // early-out for lines of zero length.
@@ -400,10 +416,6 @@ void sweep_rasterizer::draw_line(const swr::impl::render_states& states, [[maybe
     // initialize gradients along the line.
     rast::line_interpolator attr(*info.v1, *info.v2, v1, states.shader_info->iqs, 1.0f / info.max_absolute_delta);
 
-    // create shader instance.
-    std::vector<std::byte> shader_storage{states.shader_info->shader->size()};
-    swr::program_base* shader = states.shader_info->shader->create_fragment_shader_instance(shader_storage.data(), states.uniforms, states.texture_2d_samplers);
-
     // advance to pixel center and initialize end coordinate.
     if(info.is_x_major)
     {
@@ -424,7 +436,7 @@ void sweep_rasterizer::draw_line(const swr::impl::render_states& states, [[maybe
         error = fix_dv * 2 - fix_dp;
 
         // set final parameter
-        end_p = ml::fixed_t(std::min(info.v2->coords.x + info.offset_v2.x, static_cast<float>(states.draw_target->properties.height)));
+        end_p = ml::fixed_t(std::min(info.v2->coords.x + info.offset_v2.x, static_cast<float>(states.draw_target->properties.width)));
     }
     else
     {
@@ -449,66 +461,215 @@ void sweep_rasterizer::draw_line(const swr::impl::render_states& states, [[maybe
     }
 
     /*
-     * Execute Bresenham's line drawing algorithm.
+     * Walk the line with Bresenham's algorithm and split it into segments of consecutive fragments lying inside
+     * the same tile. Instead of stepping through the fragments, the tile and viewport crossings are computed from
+     * the error term: after n steps starting with the error e, the value was incremented
+     *
+     *     k(n) = ceil((e + 2*(n-1)*dv) / (2*dp))
+     *
+     * times, for n>0. This follows from the error term staying inside (2*dv-2*dp, 2*dv]. The attributes are only
+     * advanced to the segments' starts.
      */
 
-    boost::container::static_vector<swr::varying, geom::limits::max::varyings> temp_varyings;
-    if(info.is_x_major)
+    const int value_limit = info.is_x_major ? states.draw_target->properties.height : states.draw_target->properties.width;
+
+    // raw fixed-point values.
+    const std::int64_t one = ml::unwrap(ml::fixed_t{1});
+    const std::int64_t two_dp = 2 * static_cast<std::int64_t>(ml::unwrap(fix_dp));
+    const std::int64_t two_dv = 2 * static_cast<std::int64_t>(ml::unwrap(fix_dv));
+
+    // number of value increments after a number of steps.
+    auto get_increments = [&error, two_dp, two_dv](std::int64_t steps) -> std::int64_t
     {
-        while(p < end_p)
+        if(steps == 0 || two_dv == 0)
         {
-            attr.get_varyings(temp_varyings);
+            return 0;
+        }
+        return ceil_div(ml::unwrap(error) + (steps - 1) * two_dv, two_dp);
+    };
 
-            // only draw the fragment if it is inside the viewport.
-            if(p >= 0 && v >= 0 && v < states.draw_target->properties.height)
-            {
-                rast::fragment_info info{attr.depth_value.value, true, temp_varyings};
-                swr::impl::fragment_output out;
+    // number of steps until the value was incremented a number of times.
+    auto get_steps = [&error, two_dp, two_dv](std::int64_t increments) -> std::int64_t
+    {
+        if(increments <= 0)
+        {
+            return 0;
+        }
+        if(two_dv == 0)
+        {
+            return std::numeric_limits<std::int64_t>::max();
+        }
+        return floor_div((increments - 1) * two_dp - ml::unwrap(error), two_dv) + 2;
+    };
+
+    // advance the line by a number of steps.
+    auto advance = [&](std::int64_t steps)
+    {
+        const std::int64_t increments = get_increments(steps);
+
+        v += inc_v * static_cast<int>(increments);
+        // the scaled deltas may overflow the fixed-point type, so the new error is computed from the raw values. it is bounded by 2*dv and 2*dp.
+        error = cnl::wrap<ml::fixed_t>(static_cast<decltype(ml::unwrap(error))>(ml::unwrap(error) + steps * two_dv - increments * two_dp));
+        p += ml::fixed_t{static_cast<int>(steps)};
+
+        attr.advance(static_cast<int>(steps));
+    };
+
+    constexpr int tile_size = swr::impl::rasterizer_block_size;
+
+    line_segment segment;
+    segment.primitive_index = index;
+    segment.states = &states;
+    segment.is_x_major = info.is_x_major;
+    segment.inc_v = inc_v;
+    segment.fix_dp = fix_dp;
+    segment.fix_dv = fix_dv;
+
+    while(p < end_p)
+    {
+        const std::int64_t remaining = ceil_div(ml::unwrap(end_p) - ml::unwrap(p), one);
 
-                process_fragment(ml::integral_part(p), ml::integral_part(v), states, shader, attr.one_over_viewport_z.value, info, out);
-                states.draw_target->merge_color(0, ml::integral_part(p), ml::integral_part(v), out, states.blending_enabled, states.blend_src, states.blend_dst);
+        // skip the fragments outside the viewport. the value changes monotonically, so the line does not re-enter the viewport after leaving it.
+        if(p < 0)
+        {
+            advance(std::min(remaining, ceil_div(-ml::unwrap(p), one)));
+            continue;
+        }
+
+        if(v < 0 || v >= value_limit)
+        {
+            std::int64_t increments{0};
+            if(v < 0 && inc_v > 0)
+            {
+                increments = ceil_div(-ml::unwrap(v), one);
+            }
+            else if(v >= value_limit && inc_v < 0)
+            {
+                increments = floor_div(ml::unwrap(v) - value_limit * one, one) + 1;
+            }
+            else
+            {
+                break;
             }
 
-            // update error variable.
-            if(error > 0)
+            const std::int64_t steps = get_steps(increments);
+            if(steps >= remaining)
             {
-                v += inc_v;
-                error -= fix_dp * 2;
+                break;
             }
-            error += fix_dv * 2;
 
-            ++p;
-            attr.advance();
+            advance(steps);
+            continue;
         }
+
+        const int parameter = ml::integral_part(p);
+        const int value = ml::integral_part(v);
+
+        // steps until the parameter reaches the next tile.
+        std::int64_t steps = std::min<std::int64_t>(remaining, (parameter & ~(tile_size - 1)) + tile_size - parameter);
+
+        // steps until the value leaves the tile or the viewport.
+        if(inc_v > 0)
+        {
+            steps = std::min(steps, get_steps(std::min((value & ~(tile_size - 1)) + tile_size, value_limit) - value));
+        }
+        else if(inc_v < 0)
+        {
+            steps = std::min(steps, get_steps(value - (value & ~(tile_size - 1)) + 1));
+        }
+
+        segment.x = info.is_x_major ? parameter : value;
+        segment.y = info.is_x_major ? value : parameter;
+        segment.p = p;
+        segment.v = v;
+        segment.error = error;
+        segment.fragment_count = static_cast<std::uint32_t>(steps);
+        segment.attributes = attr;
+        bin.push_back(segment);
+
+        advance(steps);
     }
-    else
+}
+
+void sweep_rasterizer::process_line_segment(const line_segment& segment, const swr::program_base* shader, swr::impl::framebuffer_draw_target* draw_target)
+{
+    const auto& states = *segment.states;
+
+    ml::fixed_t p = segment.p;
+    ml::fixed_t v = segment.v;
+    ml::fixed_t error = segment.error;
+    rast::line_interpolator attr = segment.attributes;
+
+    boost::container::static_vector<swr::varying, geom::limits::max::varyings> temp_varyings;
+    for(std::uint32_t i = 0; i < segment.fragment_count; ++i)
     {
-        while(p < end_p)
-        {
-            attr.get_varyings(temp_varyings);
+        attr.get_varyings(temp_varyings);
 
-            // only draw the fragment if it is inside the viewport.
-            if(p >= 0 && v >= 0 && v < states.draw_target->properties.width)
-            {
-                rast::fragment_info info{attr.depth_value.value, true, temp_varyings};
-                swr::impl::fragment_output out;
+        // all fragments of the segment are inside the viewport.
+        const int x = segment.is_x_major ? ml::integral_part(p) : ml::integral_part(v);
+        const int y = segment.is_x_major ? ml::integral_part(v) : ml::integral_part(p);
 
-                process_fragment(ml::integral_part(v), ml::integral_part(p), states, shader, attr.one_over_viewport_z.value, info, out);
-                states.draw_target->merge_color(0, ml::integral_part(v), ml::integral_part(p), out, states.blending_enabled, states.blend_src, states.blend_dst);
-            }
+        rast::fragment_info info{attr.depth_value.value, true, temp_varyings};
+        swr::impl::fragment_output out;
 
-            // update error variable.
-            if(error > 0)
-            {
-                v += inc_v;
-                error -= fix_dp * 2;
-            }
-            error += fix_dv * 2;
+        process_fragment(x, y, states, draw_target, shader, attr.one_over_viewport_z.value, info, out);
+
+        SWR_STATS_CLOCK(thread_stats->pipeline.merge);
+        SWR_STATS_INCREMENT2(thread_stats->frag.blending, out.write_flags != 0 && states.blending_enabled);
+        draw_target->merge_color(0, x, y, out, states.blending_enabled, states.blend_kernels, states.color_mask);
+        SWR_STATS_UNCLOCK(thread_stats->pipeline.merge);
 
-            ++p;
-            attr.advance();
+        // update error variable.
+        if(error > 0)
+        {
+            v += segment.inc_v;
+            error -= segment.fix_dp * 2;
         }
+        error += segment.fix_dv * 2;
+
+        ++p;
+        attr.advance();
+    }
+}
+
+void sweep_rasterizer::draw_line(std::size_t index)
+{
+    auto& bin = line_bins[0];
+    bin.clear();
+
+    {
+        SWR_PERF_SCOPE(setup);
+        SWR_STATS_CLOCK(setup_stats[0].pipeline.setup);
+        setup_line(index, bin);
+        SWR_STATS_UNCLOCK(setup_stats[0].pipeline.setup);
     }
+
+    if(bin.size() == 0)
+    {
+        return;
+    }
+
+    const auto& states = *state_list[lines.state_indices[index]];
+
+#ifdef SWR_ENABLE_STATS
+    // sequential drawing collects its statistics in the first slot. the fragment stages are not counted as rasterization.
+    thread_stats = &setup_stats[0];
+    const std::uint64_t fragment_cycles = thread_stats->get_fragment_cycles();
+#endif
+    SWR_PERF_SCOPE(tile_processing);
+    SWR_STATS_CLOCK(setup_stats[0].pipeline.rasterization);
+
+    // consecutive lines drawn with the same states share the shader instance.
+    const swr::program_base* shader = thread_line_shader.get(states);
+    for(auto& segment: bin)
+    {
+        process_line_segment(segment, shader, tiles.get_draw_target(segment.x, segment.y, states.draw_target));
+    }
+
+    SWR_STATS_UNCLOCK(setup_stats[0].pipeline.rasterization);
+#ifdef SWR_ENABLE_STATS
+    setup_stats[0].pipeline.rasterization -= setup_stats[0].get_fragment_cycles() - fragment_cycles;
+#endif
 }
 
 } /* namespace rast */
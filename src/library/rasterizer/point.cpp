@@ -18,56 +18,201 @@
 namespace rast
 {
 
-/*
- * TODO Look up which values to put in dFdx, dFdy.
- */
-
-void sweep_rasterizer::draw_point(const swr::impl::render_states& states, const geom::vertex& v)
+void sweep_rasterizer::setup_point(std::size_t index, point_bin& bin) const
 {
+    const auto& states = *state_list[points.state_indices[index]];
+    const auto* v = points.vertices[index];
+
     /*
-     * a note on the pixel center adjustment:
+     * a point is rasterized as a square of side length point_size centered at the vertex' viewport coordinates.
+     * a fragment is covered if its center lies inside the square, where we include the top and left edges.
+     * for a point size of 1, this produces the same fragment as applying the fill rules to the square.
      *
-     * here we use it to find the correct position for the fragment as an integer (x,y)-coordinate.
-     * by convention, the fragment's coordinate are then adjusted by the pixel center again in process_fragment.
+     * the center is snapped to the same subpixel grid used for triangles.
      */
+    const ml::vec2 center{
+      std::round(v->coords.x * 16.0f) / 16.0f,
+      std::round(v->coords.y * 16.0f) / 16.0f};
+    const float half_size = v->point_size * 0.5f;
+    const ml::vec2 origin{center.x - half_size, center.y - half_size};
+
+    // find the covered pixel rectangle and clip it against the draw target.
+    int x_min = std::max(static_cast<int>(std::ceil(origin.x - 0.5f)), 0);
+    int y_min = std::max(static_cast<int>(std::ceil(origin.y - 0.5f)), 0);
+    int x_max = std::min(static_cast<int>(std::ceil(center.x + half_size - 0.5f)), states.draw_target->properties.width);
+    int y_max = std::min(static_cast<int>(std::ceil(center.y + half_size - 0.5f)), states.draw_target->properties.height);
+
+    if(x_min >= x_max || y_min >= y_max)
+    {
+        return;
+    }
+
+    // split the rectangle along the tile boundaries.
+    constexpr int tile_size = swr::impl::rasterizer_block_size;
+    for(int y = y_min; y < y_max; y = (y & ~(tile_size - 1)) + tile_size)
+    {
+        const int y_end = std::min(y_max, (y & ~(tile_size - 1)) + tile_size);
+
+        for(int x = x_min; x < x_max; x = (x & ~(tile_size - 1)) + tile_size)
+        {
+            const int x_end = std::min(x_max, (x & ~(tile_size - 1)) + tile_size);
+
+            point_block block;
+            block.x = x;
+            block.y = y;
+            block.x_end = x_end;
+            block.y_end = y_end;
+            block.primitive_index = index;
+            block.states = &states;
+            block.vertex = v;
+            block.origin = origin;
+            block.size = v->point_size;
+
+            bin.push_back(block);
+        }
+    }
+}
 
-    const auto coords = v.coords.xy();
-    ml::vec2_fixed<4> adjusted_coords(coords.x, coords.y);
+void sweep_rasterizer::process_point_block(const point_block& block, const swr::program_base* shader, swr::impl::framebuffer_draw_target* draw_target)
+{
+    const auto& states = *block.states;
+    const auto& v = *block.vertex;
 
     /*
-     * A point is rastered as two triangles in a Z pattern, and triangle fill rules are applied.
-     * It is sufficient to get the nearest pixel center and check if it is
-     *
-     *  (i) completely inside the triangles
-     * (ii) if not, check if it is on the top or left edge of the upper triangle.
+     * set up varyings. process_fragment_block restores perspective for smoothly interpolated varyings by
+     * multiplying with the fragment's depth, so we divide by it here. the derivatives are calculated from
+     * the quads.
      */
+    boost::container::static_vector<swr::varying, geom::limits::max::varyings> point_varyings(v.varyings.size());
+    for(size_t i = 0; i < v.varyings.size(); ++i)
+    {
+        point_varyings[i].value = v.varyings[i];
+        if(states.shader_info->iqs[i] == swr::interpolation_qualifier::smooth)
+        {
+            point_varyings[i].value *= v.coords.w;
+        }
+        point_varyings[i].dFdx = ml::vec4::zero();
+        point_varyings[i].dFdy = ml::vec4::zero();
+    }
+
+    const float one_over_size = 1.0f / block.size;
+    const bool depth_only = is_depth_only(states);
+
+    // gl_PointCoord has its origin at the sprite's upper-left corner. it is also evaluated for the quads' helper lanes.
+    auto get_point_coord = [&block, one_over_size](unsigned int x, unsigned int y) -> ml::vec2
+    {
+        return {
+          (static_cast<float>(x) + 0.5f - block.origin.x) * one_over_size,
+          (static_cast<float>(y) + 0.5f - block.origin.y) * one_over_size};
+    };
+
+    // get the fragments of a 2x2 block inside the sprite, with the top-left fragment in bit 0.
+    auto get_fragment_mask = [&block](unsigned int x, unsigned int y) -> std::uint32_t
+    {
+        auto is_inside = [&block](unsigned int frag_x, unsigned int frag_y) -> std::uint32_t
+        { return frag_x >= block.x && frag_x < block.x_end && frag_y >= block.y && frag_y < block.y_end; };
+        return is_inside(x, y)
+               | (is_inside(x + 1, y) << 1)
+               | (is_inside(x, y + 1) << 2)
+               | (is_inside(x + 1, y + 1) << 3);
+    };
+
+    // shade a 2x2 block, if it is at least partially covered.
+    auto process_quad = [&](unsigned int x, unsigned int y, swr::impl::fragment_output_block& out)
+    {
+        out.write_color = get_fragment_mask(x, y);
+        if(!out.write_color)
+        {
+            return;
+        }
+
+        if(depth_only)
+        {
+            SWR_STATS_CLOCK(thread_stats->pipeline.depth_test);
+
+            const float frag_depth[4] = {v.coords.z, v.coords.z, v.coords.z, v.coords.z};
+            process_depth_block(x, y, states, frag_depth, out);
+
+            SWR_STATS_UNCLOCK(thread_stats->pipeline.depth_test);
+            return;
+        }
+
+        SWR_STATS_CLOCK(thread_stats->pipeline.fragment_shading);
+
+        // process_fragment_block modifies the varyings.
+        boost::container::static_vector<swr::varying, geom::limits::max::varyings> temp_varyings[4] = {
+          point_varyings, point_varyings, point_varyings, point_varyings};
+        float one_over_viewport_z[4] = {v.coords.w, v.coords.w, v.coords.w, v.coords.w};
+
+        rast::fragment_info frag_info[4] = {
+          {v.coords.z, true, temp_varyings[0], get_point_coord(x, y)},
+          {v.coords.z, true, temp_varyings[1], get_point_coord(x + 1, y)},
+          {v.coords.z, true, temp_varyings[2], get_point_coord(x, y + 1)},
+          {v.coords.z, true, temp_varyings[3], get_point_coord(x + 1, y + 1)}};
 
-    int x = ml::integral_part(adjusted_coords.x - cnl::wrap<ml::vec2_fixed<4>::type>(FILL_RULE_EDGE_BIAS));
-    int y = ml::integral_part(adjusted_coords.y - cnl::wrap<ml::vec2_fixed<4>::type>(FILL_RULE_EDGE_BIAS));
+        process_fragment_block(x, y, states, shader, one_over_viewport_z, frag_info, out);
 
-    if(x >= 0 && x < states.draw_target->properties.width
-       && y >= 0 && y < states.draw_target->properties.height)
+        SWR_STATS_UNCLOCK(thread_stats->pipeline.fragment_shading);
+    };
+
+    /*
+     * process in 4x4 blocks, each consisting of four 2x2 blocks. the blocks are aligned, so that they do not
+     * leave the tile containing the sprite block.
+     */
+    for(unsigned int y = block.y & ~3u; y < block.y_end; y += 4)
     {
-        // set up attributes and varyings.
-        boost::container::static_vector<swr::varying, geom::limits::max::varyings> temp(v.varyings.size());
-        for(size_t i = 0; i < v.varyings.size(); ++i)
+        for(unsigned int x = block.x & ~3u; x < block.x_end; x += 4)
         {
-            temp[i].value = v.varyings[i];
-            temp[i].dFdx = ml::vec4::zero();    // FIXME see comment above.
-            temp[i].dFdy = ml::vec4::zero();    // FIXME see comment above.
+            swr::impl::fragment_output_block out[4];
+
+            process_quad(x, y, out[0]);
+            process_quad(x + 2, y, out[1]);
+            process_quad(x, y + 2, out[2]);
+            process_quad(x + 2, y + 2, out[3]);
+
+            merge_fragment_blocks(x, y, states, draw_target, out);
         }
+    }
+}
+
+void sweep_rasterizer::draw_point(std::size_t index)
+{
+    auto& bin = point_bins[0];
+    bin.clear();
+
+    {
+        SWR_PERF_SCOPE(setup);
+        SWR_STATS_CLOCK(setup_stats[0].pipeline.setup);
+        setup_point(index, bin);
+        SWR_STATS_UNCLOCK(setup_stats[0].pipeline.setup);
+    }
 
-        // create shader instance.
-        std::vector<std::byte> shader_storage{states.shader_info->shader->size()};
-        swr::program_base* shader = states.shader_info->shader->create_fragment_shader_instance(shader_storage.data(), states.uniforms, states.texture_2d_samplers);
+    if(bin.size() == 0)
+    {
+        return;
+    }
 
-        // draw the point.
-        rast::fragment_info info(v.coords.z, true, temp);
-        swr::impl::fragment_output out;
+    const auto& states = *state_list[points.state_indices[index]];
 
-        process_fragment(x, y, states, shader, v.coords.w, info, out);
-        states.draw_target->merge_color(0, x, y, out, states.blending_enabled, states.blend_src, states.blend_dst);
+#ifdef SWR_ENABLE_STATS
+    // sequential drawing collects its statistics in the first slot. the fragment stages are not counted as rasterization.
+    thread_stats = &setup_stats[0];
+    const std::uint64_t fragment_cycles = thread_stats->get_fragment_cycles();
+#endif
+    SWR_PERF_SCOPE(tile_processing);
+    SWR_STATS_CLOCK(setup_stats[0].pipeline.rasterization);
+
+    // consecutive points drawn with the same states share the shader instance.
+    const swr::program_base* shader = thread_point_shader.get(states);
+    for(auto& block: bin)
+    {
+        process_point_block(block, shader, tiles.get_draw_target(block.x, block.y, states.draw_target));
     }
+
+    SWR_STATS_UNCLOCK(setup_stats[0].pipeline.rasterization);
+#ifdef SWR_ENABLE_STATS
+    setup_stats[0].pipeline.rasterization -= setup_stats[0].get_fragment_cycles() - fragment_cycles;
+#endif
 }
 
 } /* namespace rast */
@@ -9,10 +9,130 @@
  */
 
 #include "swr/stats.h"
+#include "swr/debug.h"
 
 namespace rast
 {
 
+/** a geometric primitive, as produced by primitive assembly. */
+struct primitive
+{
+    enum primitive_type
+    {
+        point,   /** point primitive, consisting of one vertex */
+        line,    /** line primitive, consisting of two vertices */
+        triangle /** triangle primitive, consisting of three vertices */
+    };
+
+    /** the type of primitive to be rasterized */
+    primitive_type type;
+
+    /** whether the primitive is front-facing. only relevant for triangles (otherwise always true). */
+    bool is_front_facing;
+
+    /** the primitive's vertices. points use v[0], lines use v[0] and v[1], and triangles use v[0], v[1] and v[2]. */
+    geom::vertex* v[3];
+
+    /** Points to the active render states (which are stored in the context's draw lists). */
+    const swr::impl::render_states* states{nullptr};
+
+    /**
+     * default constructor. only for compatibility with std containers.
+     *
+     * NOTE: this does not make sense to use on its own and probably leaves the object in an undefined and unusable state.
+     */
+    primitive() = default;
+
+    /** point constructor. */
+    primitive(const swr::impl::render_states* in_states, geom::vertex* vertex)
+    : type(point)
+    , is_front_facing(true)
+    , v{vertex, nullptr, nullptr}
+    , states(in_states)
+    {
+    }
+
+    /** line constructor. */
+    primitive(const swr::impl::render_states* in_states, geom::vertex* v1, geom::vertex* v2)
+    : type(line)
+    , is_front_facing(true)
+    , v{v1, v2, nullptr}
+    , states(in_states)
+    {
+    }
+
+    /** triangle constructor. */
+    primitive(const swr::impl::render_states* in_states, bool in_is_front_facing, geom::vertex* v1, geom::vertex* v2, geom::vertex* v3)
+    : type(triangle)
+    , is_front_facing(in_is_front_facing)
+    , v{v1, v2, v3}
+    , states(in_states)
+    {
+    }
+};
+
+/**
+ * a preallocated range of primitives. the ranges do not overlap, so that different ranges
+ * can be filled concurrently.
+ */
+struct primitive_range
+{
+    /** first primitive of the range. */
+    primitive* data{nullptr};
+
+    /** number of primitives the range can hold. */
+    std::size_t capacity{0};
+
+    /** number of primitives written to the range. */
+    std::size_t size{0};
+
+    /** default constructor. */
+    primitive_range() = default;
+
+    /** initializing constructor. */
+    primitive_range(primitive* in_data, std::size_t in_capacity)
+    : data{in_data}
+    , capacity{in_capacity}
+    {
+    }
+
+    /** append a primitive to the range. */
+    template<typename... Args>
+    void add(Args&&... args)
+    {
+        assert(size < capacity);
+        data[size++] = primitive{std::forward<Args>(args)...};
+    }
+};
+
+#ifdef SWR_ENABLE_STATS
+/**
+ * statistics collected by a unit of work, e.g. by a tile. a slot is only written by the thread processing
+ * the work item, so that the counters need no synchronization. the slots are summed up after drawing.
+ */
+struct stats_slot
+{
+    /** fragment counters. */
+    swr::stats::fragment_data frag;
+
+    /** cycles spent in the pipeline stages. */
+    swr::stats::pipeline_data pipeline;
+
+    /** reset counters to zero. */
+    void reset_counters()
+    {
+        frag.reset_counters();
+        pipeline.reset_counters();
+    }
+
+    /** return the cycles spent in the fragment stages. */
+    std::uint64_t get_fragment_cycles() const
+    {
+        return pipeline.fragment_shading + pipeline.depth_test + pipeline.merge;
+    }
+};
+#endif /* SWR_ENABLE_STATS */
+
 /** abstract rasterizer interface. */
 struct rasterizer
 {
@@ -26,16 +146,43 @@ struct rasterizer
     /** pointer to the default framebuffer. */
     swr::impl::default_framebuffer* framebuffer{nullptr};
 
+    /** whether the default framebuffer's depth values may be discarded after the next call to draw_primitives. */
+    bool discard_depth{false};
+
+    /** whether triangles are shaded deferred using a visibility buffer, if their render states allow it. */
+    bool visibility_buffer{false};
+
+    /** fragments passing the depth test per occlusion query id, summed up by draw_primitives. empty if no query was referenced. */
+    std::vector<std::uint64_t> query_samples;
+
     /*
      * statistics and benchmarking.
      */
 
+    /** per-pixel fragment counters of the default framebuffer, see swr::debug. empty if counting is disabled. */
+    std::vector<swr::debug::fragment_counters> overdraw_counters;
+
+    /** the counter shown by the false-color overlay. */
+    swr::debug::overlay_counter overdraw_overlay{swr::debug::overlay_counter::none};
+
+    /** the count mapped to the top of the overlay's color ramp. */
+    std::uint32_t overdraw_overlay_max{8};
+
 #ifdef SWR_ENABLE_STATS
     /** fragment processing stage statistics. */
     swr::stats::fragment_data stats_frag;
 
     /** rasterizer. */
     swr::stats::rasterizer_data stats_rast;
+
+    /** cycles spent in the rasterization stages. */
+    swr::stats::pipeline_data stats_pipeline;
+
+    /** tile load balance and tile cache statistics. */
+    swr::stats::tile_data stats_tiles;
+
+    /** largest size of the tile cache in bytes, measured whenever it was processed during the last call to draw_primitives. */
+    std::size_t stats_tile_cache_peak{0};
 #endif
 
     /*
@@ -61,27 +208,21 @@ struct rasterizer
     virtual const std::string describe() const = 0;
 
     /**
-     * Add a point which is to be rasterized. The supplied vertices are assumed to
-     * be valid pointers when the actual rasterization takes place.
-     */
-    virtual void add_point(const swr::impl::render_states* s, geom::vertex* v) = 0;
-
-    /**
-     * Add a line which is to be rasterized. The supplied vertices are assumed to
-     * be valid pointers when the actual rasterization takes place.
+     * Add a batch of primitives which are to be rasterized, in the given order. The supplied vertices
+     * are assumed to be valid pointers when the actual rasterization takes place.
      */
-    virtual void add_line(const swr::impl::render_states* s, geom::vertex* v1, geom::vertex* v2) = 0;
+    virtual void add_primitives(const primitive* primitives, std::size_t count) = 0;
 
     /**
-     * Add a triangle which is to be rasterized. The supplied vertices are assumed to
-     * be valid pointers when the actual rasterization takes place.
+     * Draw all primitives. Operations take place with respect to the internal render context.
      */
-    virtual void add_triangle(const swr::impl::render_states* s, bool is_front_facing, geom::vertex* v1, geom::vertex* v2, geom::vertex* v3) = 0;
+    virtual void draw_primitives() = 0;
 
     /**
-     * Draw all primitives. Operations take place with respect to the internal render context.
+     * Return the number of bytes currently held by the rasterizer for a memory category. Only primitives and
+     * tile_cache are held by the rasterizer; zero is returned for the other categories.
      */
-    virtual void draw_primitives() = 0;
+    virtual std::size_t get_memory_usage(swr::stats::memory_category category) const = 0;
 };
 
 } /* namespace rast */
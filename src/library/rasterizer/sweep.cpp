@@ -8,6 +8,10 @@
  * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
  */
 
+/* C++ headers. */
+#include <algorithm>
+#include <atomic>
+
 /* user headers. */
 #include "../swr_internal.h"
 
@@ -18,31 +22,82 @@
 namespace rast
 {
 
+#ifdef SWR_ENABLE_STATS
+thread_local stats_slot* thread_stats = nullptr;
+#endif
+
+thread_local std::uint64_t* thread_query_samples = nullptr;
+
+thread_local fragment_shader_cache thread_point_shader;
+thread_local fragment_shader_cache thread_line_shader;
+
 /*
  * sweep_rasterizer implementation.
  */
 
-void sweep_rasterizer::add_point(const swr::impl::render_states* states, geom::vertex* vertex)
+void sweep_rasterizer::add_primitives(const primitive* primitives, std::size_t count)
 {
-    draw_list.push_back({states, vertex});
-}
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        const auto& it = primitives[i];
+        const auto state_index = get_state_index(it.states);
 
-void sweep_rasterizer::add_line(const swr::impl::render_states* states, geom::vertex* v1, geom::vertex* v2)
-{
-    draw_list.push_back({states, v1, v2});
-}
+        // primitives of the same type are collected into a single draw command.
+        std::size_t list_size = (it.type == primitive::point) ? points.size() : ((it.type == primitive::line) ? lines.size() : triangles.size());
+        if(draw_list.size() == 0 || draw_list.back().type != it.type)
+        {
+            draw_list.emplace_back(it.type, list_size);
+        }
+        ++draw_list.back().end;
 
-void sweep_rasterizer::add_triangle(const swr::impl::render_states* states, bool is_front_facing, geom::vertex* v1, geom::vertex* v2, geom::vertex* v3)
-{
-    draw_list.push_back({states, is_front_facing, v1, v2, v3});
+        if(it.type == primitive::point)
+        {
+            points.vertices.push_back(it.v[0]);
+            points.state_indices.push_back(state_index);
+        }
+        else if(it.type == primitive::line)
+        {
+            lines.vertices.insert(lines.vertices.end(), {it.v[0], it.v[1]});
+            lines.state_indices.push_back(state_index);
+        }
+        else if(it.type == primitive::triangle)
+        {
+            triangles.vertices.insert(triangles.vertices.end(), {it.v[0], it.v[1], it.v[2]});
+            triangles.coords.insert(triangles.coords.end(), {it.v[0]->coords, it.v[1]->coords, it.v[2]->coords});
+            triangles.front_facing.push_back(it.is_front_facing);
+            triangles.state_indices.push_back(state_index);
+        }
+    }
 }
 
 void sweep_rasterizer::draw_primitives()
 {
+    SWR_TRACE_SCOPE("rasterization");
+
 #ifdef SWR_ENABLE_STATS
     stats_frag.reset_counters();
     stats_rast.reset_counters();
+    stats_pipeline.reset_counters();
+    stats_tiles.reset_counters();
+    stats_tile_cache_peak = 0;
+
+#    ifdef SWR_ENABLE_MULTI_THREADING
+    stats_rast.available_threads = thread_pool->get_thread_count();
+#    else
+    stats_rast.available_threads = 1;
+#    endif
 #endif
+    SWR_STATS_CLOCK(stats_tiles.draw_cycles);
+
+    if(!overdraw_counters.empty())
+    {
+        reset_overdraw_counters();
+    }
+
+    // fragments written to the default framebuffer are collected in the tiles' local buffers.
+    tiles.bind_buffers(framebuffer);
+
+    reset_query_counters();
 
 #ifdef SWR_ENABLE_MULTI_THREADING
     if(thread_pool->get_thread_count() > 1)
@@ -56,33 +111,335 @@ void sweep_rasterizer::draw_primitives()
 #else
     draw_primitives_sequentially();
 #endif
+
+    // shade the remaining deferred triangles.
+    shade_visibility_buffers();
+
+    // write the tiles back once.
+    resolve_tiles();
+
+    collect_query_counters();
+
+    if(overdraw_overlay != swr::debug::overlay_counter::none && !overdraw_counters.empty())
+    {
+        draw_overdraw_overlay();
+    }
+
+    SWR_STATS_UNCLOCK(stats_tiles.draw_cycles);
+#ifdef SWR_ENABLE_STATS
+    collect_stats();
+#endif
+}
+
+void sweep_rasterizer::reset_query_counters()
+{
+    std::uint32_t max_query = 0;
+    for(const auto* it: state_list)
+    {
+        max_query = std::max(max_query, it->active_query);
+    }
+    query_count = (max_query != 0) ? max_query + 1 : 0;
+
+    if(query_count != 0)
+    {
+        for(auto& it: tiles.entries)
+        {
+            it.query_samples.assign(query_count, 0);
+        }
+    }
+}
+
+void sweep_rasterizer::collect_query_counters()
+{
+    query_samples.assign(query_count, 0);
+    if(query_count != 0)
+    {
+        for(const auto& it: tiles.entries)
+        {
+            for(std::uint32_t i = 0; i < query_count; ++i)
+            {
+                query_samples[i] += it.query_samples[i];
+            }
+        }
+    }
+}
+
+std::size_t sweep_rasterizer::get_memory_usage(swr::stats::memory_category category) const
+{
+    if(category == swr::stats::memory_category::primitives)
+    {
+        std::size_t bytes = state_list.capacity() * sizeof(const swr::impl::render_states*)
+                            + draw_list.capacity() * sizeof(draw_command)
+                            + points.get_memory_usage() + lines.get_memory_usage() + triangles.get_memory_usage();
+
+        for(const auto& it: triangle_bins)
+        {
+            bytes += it.capacity() * sizeof(triangle_block);
+        }
+        for(const auto& it: line_bins)
+        {
+            bytes += it.capacity() * sizeof(line_segment);
+        }
+        for(const auto& it: point_bins)
+        {
+            bytes += it.capacity() * sizeof(point_block);
+        }
+        return bytes;
+    }
+    else if(category == swr::stats::memory_category::tile_cache)
+    {
+        return tiles.get_memory_usage();
+    }
+
+    return 0;
+}
+
+void sweep_rasterizer::reset_overdraw_counters()
+{
+    overdraw_counters.assign(framebuffer->properties.width * framebuffer->properties.height, {});
+}
+
+void sweep_rasterizer::draw_overdraw_overlay()
+{
+    SWR_TRACE_SCOPE("overdraw overlay");
+
+    if(!framebuffer->is_color_attached())
+    {
+        return;
+    }
+
+    // write pending clears first, so that they do not overwrite the overlay.
+    framebuffer->materialize_color_clears();
+
+    auto counter = &swr::debug::fragment_counters::shaded;
+    if(overdraw_overlay == swr::debug::overlay_counter::depth_failed)
+    {
+        counter = &swr::debug::fragment_counters::depth_failed;
+    }
+    else if(overdraw_overlay == swr::debug::overlay_counter::helper_lanes)
+    {
+        counter = &swr::debug::fragment_counters::helper_lanes;
+    }
+
+    // color ramp from black over blue, green and yellow to red. counts of at least overdraw_overlay_max map to red.
+    const ml::vec4 ramp[] = {{0, 0, 0, 1}, {0, 0, 1, 1}, {0, 1, 0, 1}, {1, 1, 0, 1}, {1, 0, 0, 1}};
+    constexpr int ramp_segments = 4;
+
+    const auto max_count = std::max(overdraw_overlay_max, std::uint32_t{1});
+    const auto& converter = framebuffer->color_buffer.converter;
+    auto get_pixel = [&ramp, max_count, &converter](std::uint32_t count) -> std::uint32_t
+    {
+        float t = static_cast<float>(std::min(count, max_count)) / static_cast<float>(max_count) * ramp_segments;
+        int segment = std::min(static_cast<int>(t), ramp_segments - 1);
+        t -= static_cast<float>(segment);
+        return converter.to_pixel(ml::lerp(t, ramp[segment], ramp[segment + 1]));
+    };
+
+    // colors for small counts are cached, since most pixels are drawn only a few times.
+    std::uint32_t cache[16];
+    for(std::uint32_t i = 0; i < 16; ++i)
+    {
+        cache[i] = get_pixel(i);
+    }
+
+    const auto& info = framebuffer->color_buffer.info;
+    const int width = std::min(info.width, framebuffer->properties.width);
+    const int height = std::min(info.height, framebuffer->properties.height);
+    for(int y = 0; y < height; ++y)
+    {
+        auto* row = reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::uint8_t*>(info.data_ptr) + y * info.pitch);
+        const auto* counters = &overdraw_counters[y * framebuffer->properties.width];
+        for(int x = 0; x < width; ++x)
+        {
+            const auto count = counters[x].*counter;
+            row[x] = (count < 16) ? cache[count] : get_pixel(count);
+        }
+    }
 }
 
+#ifdef SWR_ENABLE_STATS
+
+/** get the bucket of tile_data::primitive_histogram for a primitive count. */
+static std::size_t get_histogram_bucket(std::uint32_t primitive_count)
+{
+    std::size_t bucket = 0;
+    for(; primitive_count != 0 && bucket < swr::stats::tile_histogram_buckets - 1; primitive_count >>= 1)
+    {
+        ++bucket;
+    }
+    return bucket;
+}
+
+void sweep_rasterizer::collect_stats()
+{
+    stats_slot total;
+
+    const auto tile_count = tiles.entries.size();
+    stats_tiles.tiles_x = static_cast<std::uint32_t>(tiles.pitch);
+    stats_tiles.tiles_y = (tiles.pitch != 0) ? static_cast<std::uint32_t>(tile_count / tiles.pitch) : 0;
+    stats_tiles.primitives.resize(tile_count);
+    stats_tiles.cycles.resize(tile_count);
+
+    for(std::size_t i = 0; i < tile_count; ++i)
+    {
+        auto& it = tiles.entries[i];
+
+        total.frag += it.stats.frag;
+        total.pipeline += it.stats.pipeline;
+        it.stats.reset_counters();
+
+        stats_tiles.primitives[i] = it.stats_primitives;
+        stats_tiles.cycles[i] = it.stats_cycles;
+        ++stats_tiles.primitive_histogram[get_histogram_bucket(it.stats_primitives)];
+
+        it.stats_primitives = 0;
+        it.stats_cycles = 0;
+    }
+
+    for(auto& it: setup_stats)
+    {
+        total.frag += it.frag;
+        total.pipeline += it.pipeline;
+        it.reset_counters();
+    }
+
+    total.frag.cycles = total.get_fragment_cycles();
+
+    stats_frag += total.frag;
+    stats_pipeline += total.pipeline;
+
+#    ifdef SWR_ENABLE_MULTI_THREADING
+    // the thread pool is idle, so the counters can be read without synchronizing with the workers.
+    std::scoped_lock lock{worker_mutex};
+
+    stats_tiles.worker_busy_cycles.resize(worker_cycles.size());
+    stats_tiles.worker_idle_cycles.resize(worker_cycles.size());
+    for(std::size_t i = 0; i < worker_cycles.size(); ++i)
+    {
+        const std::uint64_t busy_cycles = *worker_cycles[i].cycles;
+        stats_tiles.worker_busy_cycles[i] = busy_cycles;
+        stats_tiles.worker_idle_cycles[i] = (stats_tiles.draw_cycles > busy_cycles) ? stats_tiles.draw_cycles - busy_cycles : 0;
+        *worker_cycles[i].cycles = 0;
+    }
+#    endif
+}
+
+#    ifdef SWR_ENABLE_MULTI_THREADING
+std::uint64_t sweep_rasterizer::allocate_worker_owner_id()
+{
+    static std::atomic<std::uint64_t> next_id{1};
+    return next_id++;
+}
+
+std::uint64_t& sweep_rasterizer::get_worker_cycles()
+{
+    // the counter of the last rasterizer is cached per thread, so that it is updated without locking. a thread
+    // alternating between rasterizers looks up its existing counter instead of registering again.
+    thread_local std::uint64_t owner_id = 0;
+    thread_local std::uint64_t* cycles = nullptr;
+    if(owner_id != worker_owner_id)
+    {
+        std::scoped_lock lock{worker_mutex};
+
+        const auto thread_id = std::this_thread::get_id();
+        auto it = std::find_if(worker_cycles.begin(), worker_cycles.end(),
+                               [&thread_id](const worker_counter& counter) -> bool
+                               { return counter.thread == thread_id; });
+        if(it == worker_cycles.end())
+        {
+            it = worker_cycles.insert(worker_cycles.end(), {thread_id, std::make_unique<std::uint64_t>(0)});
+        }
+
+        cycles = it->cycles.get();
+        owner_id = worker_owner_id;
+    }
+    return *cycles;
+}
+#    endif /* SWR_ENABLE_MULTI_THREADING */
+
+#endif /* SWR_ENABLE_STATS */
+
 void sweep_rasterizer::draw_primitives_sequentially()
 {
     for(auto& it: draw_list)
     {
-        // draw the primitive.
+        // draw the primitives. deferred triangles need to be shaded before drawing anything else.
         if(it.type == primitive::point)
         {
-            draw_point(*it.states, *it.v[0]);
+            shade_visibility_buffers();
+            for(std::size_t i = it.begin; i < it.end; ++i)
+            {
+                draw_point(i);
+            }
+            thread_point_shader.reset();
         }
         else if(it.type == primitive::line)
         {
-            draw_line(*it.states, true, *it.v[0], *it.v[1]);
+            shade_visibility_buffers();
+            for(std::size_t i = it.begin; i < it.end; ++i)
+            {
+                draw_line(i);
+            }
+            thread_line_shader.reset();
         }
         else if(it.type == primitive::triangle)
         {
-            draw_filled_triangle(*it.states, it.is_front_facing, *it.v[0], *it.v[1], *it.v[2]);
-        }
+            for(std::size_t i = it.begin; i < it.end; ++i)
+            {
+                if(!is_deferred_triangle(i))
+                {
+                    shade_visibility_buffers();
+                }
+
+                draw_filled_triangle(i);
 
-        // process tile cache.
-        process_tile_cache();
+                // process tile cache.
+                process_tile_cache(swr::stats::flush_cause::sequential);
+            }
+        }
     }
-    draw_list.clear();
+    clear_draw_list();
 }
 
 #ifdef SWR_ENABLE_MULTI_THREADING
+
+/** minimum number of primitives set up by a single task. */
+constexpr std::size_t min_primitives_per_task = 16;
+
+/** mark the primitives in [begin,end) that need the tile cache to be processed before drawing them. */
+static void set_flush_flags(
+  const std::vector<const swr::impl::render_states*>& state_list,
+  const std::vector<std::uint32_t>& state_indices,
+  std::size_t begin, std::size_t end,
+  const swr::comparison_func*& last_depth_func,
+  std::vector<std::uint8_t>& flush_tile_cache)
+{
+    // the flags store the cause offset by one, so that zero means no processing is needed.
+    auto to_flag = [](swr::stats::flush_cause cause) -> std::uint8_t
+    { return static_cast<std::uint8_t>(cause) + 1; };
+
+    for(std::size_t i = begin; i < end; ++i)
+    {
+        const auto* states = state_list[state_indices[i]];
+
+        flush_tile_cache[i] = 0;
+        if(states->blending_enabled)
+        {
+            flush_tile_cache[i] = to_flag(swr::stats::flush_cause::blending);
+        }
+        else if(!states->depth_test_enabled)
+        {
+            flush_tile_cache[i] = to_flag(swr::stats::flush_cause::depth_test_disabled);
+        }
+        else if(last_depth_func && (*last_depth_func) != states->depth_func)
+        {
+            flush_tile_cache[i] = to_flag(swr::stats::flush_cause::depth_func_change);
+        }
+
+        last_depth_func = states->depth_test_enabled ? &states->depth_func : nullptr;
+    }
+}
+
 void sweep_rasterizer::draw_primitives_parallel()
 {
     if(!draw_list.size())
@@ -90,51 +447,223 @@ void sweep_rasterizer::draw_primitives_parallel()
         return;
     }
 
+    /*
+     * check if we need to draw the primitives in the queue. this is the case if:
+     *
+     *  *) the depth test is disabled or has changed, or
+     *  *) blending is enabled.
+     *
+     * since the primitive types are binned separately, we also need to execute the
+     * draw calls whenever the primitive type changes.
+     */
+    points.flush_tile_cache.resize(points.size());
+    lines.flush_tile_cache.resize(lines.size());
+    triangles.flush_tile_cache.resize(triangles.size());
+
     const swr::comparison_func* last_depth_func = nullptr;
     for(auto& it: draw_list)
     {
-        /*
-         * check if we need to draw the triangles in the queue. this is the case if:
-         *
-         *  *) the depth test is disabled or has changed, or
-         *  *) blending is enabled.
-         *
-         * since currently only triangles are processed in parallel, we also need
-         * to execute the draw calls before drawing any other primitive.
-         */
-
-        bool process_tiles = (it.type != primitive::triangle)
-                             || it.states->blending_enabled
-                             || !it.states->depth_test_enabled
-                             || (it.states->depth_test_enabled && last_depth_func && (*last_depth_func) != it.states->depth_func);
+        if(it.type == primitive::triangle)
+        {
+            set_flush_flags(state_list, triangles.state_indices, it.begin, it.end, last_depth_func, triangles.flush_tile_cache);
+        }
+        else if(it.type == primitive::line)
+        {
+            set_flush_flags(state_list, lines.state_indices, it.begin, it.end, last_depth_func, lines.flush_tile_cache);
+        }
+        else if(it.type == primitive::point)
+        {
+            set_flush_flags(state_list, points.state_indices, it.begin, it.end, last_depth_func, points.flush_tile_cache);
+        }
+    }
 
-        last_depth_func = it.states->depth_test_enabled ? &it.states->depth_func : nullptr;
+    for(auto& it: draw_list)
+    {
+        // draw commands alternate between primitive types.
+        process_tile_cache(swr::stats::flush_cause::primitive_type_change);
 
-        if(process_tiles)
+        // deferred triangles need to be shaded before drawing anything else.
+        if(it.type != primitive::triangle)
         {
-            process_tile_cache();
+            shade_visibility_buffers();
         }
 
-        // draw the primitive.
-        if(it.type == primitive::point)
+        if(it.type == primitive::triangle)
         {
-            draw_point(*it.states, *it.v[0]);
+            draw_binned_primitives_parallel(it.begin, it.end, triangle_bins, setup_triangles_static, triangles.flush_tile_cache);
         }
         else if(it.type == primitive::line)
         {
-            draw_line(*it.states, true, *it.v[0], *it.v[1]);
+            draw_binned_primitives_parallel(it.begin, it.end, line_bins, setup_lines_static, lines.flush_tile_cache);
         }
-        else if(it.type == primitive::triangle)
+        else if(it.type == primitive::point)
         {
-            draw_filled_triangle(*it.states, it.is_front_facing, *it.v[0], *it.v[1], *it.v[2]);
+            draw_binned_primitives_parallel(it.begin, it.end, point_bins, setup_points_static, points.flush_tile_cache);
         }
     }
 
     // run possibly waiting tasks.
-    process_tile_cache();
+    process_tile_cache(swr::stats::flush_cause::end_of_frame);
     tiles.clear_tiles();
 
-    draw_list.clear();
+    clear_draw_list();
+}
+
+template<typename T>
+void sweep_rasterizer::draw_binned_primitives_parallel(
+  std::size_t begin, std::size_t end,
+  std::vector<std::vector<T>>& primitive_bins,
+  void (*setup_static)(sweep_rasterizer*, std::size_t, std::size_t, std::vector<T>*),
+  const std::vector<std::uint8_t>& flush_tile_cache)
+{
+    /*
+     * split the primitives into consecutive ranges and set up each range in its own task.
+     * every task writes its output to a separate bin.
+     */
+    const std::size_t primitive_count = end - begin;
+    const std::size_t thread_count = thread_pool->get_thread_count();
+    const std::size_t range_size = std::max(min_primitives_per_task, (primitive_count + thread_count - 1) / thread_count);
+    const std::size_t range_count = (primitive_count + range_size - 1) / range_size;
+
+    if(primitive_bins.size() < range_count)
+    {
+        primitive_bins.resize(range_count);
+    }
+
+#ifdef SWR_ENABLE_STATS
+    if(setup_stats.size() < range_count)
+    {
+        setup_stats.resize(range_count);
+    }
+#endif
+
+    for(std::size_t i = 0; i < range_count; ++i)
+    {
+        primitive_bins[i].clear();
+        thread_pool->push_immediate_task(setup_static, this, begin + i * range_size, std::min(begin + (i + 1) * range_size, end), &primitive_bins[i]);
+    }
+    thread_pool->run_tasks_and_wait();
+
+    /*
+     * merge the bins in submission order. the tile cache is processed before the first entry
+     * of each primitive requesting it (or before the first entry following such a primitive,
+     * if the primitive itself did not produce any output).
+     */
+    std::size_t next_primitive = begin;
+    for(std::size_t i = 0; i < range_count; ++i)
+    {
+        for(auto& entry: primitive_bins[i])
+        {
+            // keep the first reason for processing the tile cache.
+            std::uint8_t flush = 0;
+            for(; next_primitive <= entry.primitive_index; ++next_primitive)
+            {
+                flush = flush ? flush : flush_tile_cache[next_primitive];
+            }
+
+            if(flush)
+            {
+                process_tile_cache(static_cast<swr::stats::flush_cause>(flush - 1));
+            }
+
+            bool cache_full{false};
+            if constexpr(std::is_same_v<T, triangle_block>)
+            {
+                // deferred triangles need to be shaded before drawing anything else.
+                if(!entry.deferred)
+                {
+                    shade_visibility_buffers();
+                }
+
+                visibility_pending |= entry.deferred;
+                cache_full = tiles.add_triangle(entry);
+
+                if(cache_full && entry.deferred)
+                {
+                    // a visibility buffer is full. shade all visibility buffers.
+                    shade_visibility_buffers(swr::stats::flush_cause::visibility_full);
+                    cache_full = false;
+                }
+            }
+            else if constexpr(std::is_same_v<T, line_segment>)
+            {
+                cache_full = tiles.add_line(entry);
+            }
+            else
+            {
+                cache_full = tiles.add_point(entry);
+            }
+
+            if(cache_full)
+            {
+                // the cache is full. process all tiles.
+                process_tile_cache(swr::stats::flush_cause::cache_full);
+            }
+        }
+    }
+}
+
+void sweep_rasterizer::setup_triangles_static(sweep_rasterizer* rasterizer, std::size_t begin, std::size_t end, triangle_bin* bin)
+{
+    SWR_TRACE_SCOPE("setup triangles", -1, end - begin);
+    SWR_PERF_SCOPE(setup);
+
+    // each task writes to its own bin and uses the statistics slot of the same index.
+#ifdef SWR_ENABLE_STATS
+    auto& busy_cycles = rasterizer->get_worker_cycles();
+#endif
+    SWR_STATS_CLOCK(busy_cycles);
+    SWR_STATS_CLOCK(rasterizer->setup_stats[bin - rasterizer->triangle_bins.data()].pipeline.setup);
+
+    for(std::size_t i = begin; i < end; ++i)
+    {
+        rasterizer->setup_triangle(i, *bin);
+    }
+
+    SWR_STATS_UNCLOCK(rasterizer->setup_stats[bin - rasterizer->triangle_bins.data()].pipeline.setup);
+    SWR_STATS_UNCLOCK(busy_cycles);
+}
+
+void sweep_rasterizer::setup_lines_static(sweep_rasterizer* rasterizer, std::size_t begin, std::size_t end, line_bin* bin)
+{
+    SWR_TRACE_SCOPE("setup lines", -1, end - begin);
+    SWR_PERF_SCOPE(setup);
+
+    // each task writes to its own bin and uses the statistics slot of the same index.
+#ifdef SWR_ENABLE_STATS
+    auto& busy_cycles = rasterizer->get_worker_cycles();
+#endif
+    SWR_STATS_CLOCK(busy_cycles);
+    SWR_STATS_CLOCK(rasterizer->setup_stats[bin - rasterizer->line_bins.data()].pipeline.setup);
+
+    for(std::size_t i = begin; i < end; ++i)
+    {
+        rasterizer->setup_line(i, *bin);
+    }
+
+    SWR_STATS_UNCLOCK(rasterizer->setup_stats[bin - rasterizer->line_bins.data()].pipeline.setup);
+    SWR_STATS_UNCLOCK(busy_cycles);
+}
+
+void sweep_rasterizer::setup_points_static(sweep_rasterizer* rasterizer, std::size_t begin, std::size_t end, point_bin* bin)
+{
+    SWR_TRACE_SCOPE("setup points", -1, end - begin);
+    SWR_PERF_SCOPE(setup);
+
+    // each task writes to its own bin and uses the statistics slot of the same index.
+#ifdef SWR_ENABLE_STATS
+    auto& busy_cycles = rasterizer->get_worker_cycles();
+#endif
+    SWR_STATS_CLOCK(busy_cycles);
+    SWR_STATS_CLOCK(rasterizer->setup_stats[bin - rasterizer->point_bins.data()].pipeline.setup);
+
+    for(std::size_t i = begin; i < end; ++i)
+    {
+        rasterizer->setup_point(i, *bin);
+    }
+
+    SWR_STATS_UNCLOCK(rasterizer->setup_stats[bin - rasterizer->point_bins.data()].pipeline.setup);
+    SWR_STATS_UNCLOCK(busy_cycles);
 }
 
 #endif /* SWR_ENABLE_MULTI_THREADING */
@@ -145,6 +674,22 @@ void sweep_rasterizer::draw_primitives_parallel()
 
 void sweep_rasterizer::process_tile(tile& in_tile)
 {
+    SWR_TRACE_SCOPE("tile", &in_tile - tiles.entries.data(), in_tile.primitives.size() + in_tile.lines.size() + in_tile.points.size() + (in_tile.visibility.triangles.size() - in_tile.visibility.rasterized_count));
+    SWR_PERF_SCOPE(tile_processing);
+
+    thread_query_samples = in_tile.query_samples.data();
+
+#ifdef SWR_ENABLE_STATS
+    // the fragment stages are measured separately, so their cycles are subtracted from the rasterization cycles below.
+    thread_stats = &in_tile.stats;
+    const std::uint64_t fragment_cycles = in_tile.stats.get_fragment_cycles();
+
+    in_tile.stats_primitives += in_tile.primitives.size() + in_tile.lines.size() + in_tile.points.size() + (in_tile.visibility.triangles.size() - in_tile.visibility.rasterized_count);
+#endif
+    SWR_STATS_CLOCK(in_tile.stats_cycles);
+    SWR_STATS_CLOCK(in_tile.stats.pipeline.rasterization);
+
+    // the tile cache is processed whenever the primitive type changes, so at most one of the lists is non-empty.
     for(auto& it: in_tile.primitives)
     {
         if(it.mode == tile_info::rasterization_mode::block)
@@ -156,13 +701,134 @@ void sweep_rasterizer::process_tile(tile& in_tile)
             process_block_checked(in_tile.x, in_tile.y, it);
         }
     }
+
+    for(auto& it: in_tile.lines)
+    {
+        process_line_segment(it.data, it.shader, it.draw_target);
+    }
+
+    // the render states do not outlive the draw list, so the shader instance is released with the tile.
+    for(auto& it: in_tile.points)
+    {
+        process_point_block(it.data, thread_point_shader.get(*it.data.states), it.draw_target);
+    }
+    thread_point_shader.reset();
+
+    // rasterize new deferred triangles into the visibility buffer. their attributes are restored for shading.
+    auto& visibility = in_tile.visibility;
+    for(; visibility.has_pending_triangles(); ++visibility.rasterized_count)
+    {
+        auto& it = visibility.triangles[visibility.rasterized_count];
+        const triangle_interpolator attributes = it.attributes;
+
+        if(it.mode == tile_info::rasterization_mode::block)
+        {
+            process_block(in_tile.x, in_tile.y, it);
+        }
+        else if(it.mode == tile_info::rasterization_mode::checked)
+        {
+            process_block_checked(in_tile.x, in_tile.y, it);
+        }
+
+        it.attributes = attributes;
+    }
+
+    SWR_STATS_UNCLOCK(in_tile.stats.pipeline.rasterization);
+    SWR_STATS_UNCLOCK(in_tile.stats_cycles);
+#ifdef SWR_ENABLE_STATS
+    in_tile.stats.pipeline.rasterization -= in_tile.stats.get_fragment_cycles() - fragment_cycles;
+#endif
+}
+
+void sweep_rasterizer::shade_visibility_buffers(swr::stats::flush_cause cause)
+{
+    if(!visibility_pending)
+    {
+        return;
+    }
+
+    SWR_TRACE_SCOPE("visibility shading");
+
+    // complete the visibility buffers.
+    process_tile_cache(cause);
+
+    const auto tile_count = tiles.entries.size();
+    for(std::size_t i = 0; i < tile_count; ++i)
+    {
+        if(!tiles.entries[i].visibility.empty())
+        {
+#ifdef SWR_ENABLE_MULTI_THREADING
+            thread_pool->push_task(shade_visibility_buffer_static, this, &tiles.entries[i]);
+#else
+            shade_visibility_buffer(tiles.entries[i]);
+#endif
+        }
+    }
+
+#ifdef SWR_ENABLE_MULTI_THREADING
+    thread_pool->run_tasks_and_wait();
+#endif
+
+    visibility_pending = false;
+}
+
+void sweep_rasterizer::resolve_tiles()
+{
+    SWR_TRACE_SCOPE("resolve tiles");
+
+    const auto tile_count = tiles.entries.size();
+    for(std::size_t i = 0; i < tile_count; ++i)
+    {
+        if(tiles.entries[i].buffer.is_loaded())
+        {
+#ifdef SWR_ENABLE_MULTI_THREADING
+            thread_pool->push_task(resolve_tile_static, this, &tiles.entries[i], discard_depth);
+#else
+            SWR_PERF_SCOPE(resolve);
+            tiles.entries[i].buffer.resolve(discard_depth);
+#endif
+        }
+    }
+
+#ifdef SWR_ENABLE_MULTI_THREADING
+    thread_pool->run_tasks_and_wait();
+#endif
+
+    discard_depth = false;
 }
 
 #ifdef SWR_ENABLE_MULTI_THREADING
 
 void sweep_rasterizer::process_tile_static(sweep_rasterizer* rasterizer, tile* in_tile)
 {
+#ifdef SWR_ENABLE_STATS
+    auto& busy_cycles = rasterizer->get_worker_cycles();
+#endif
+    SWR_STATS_CLOCK(busy_cycles);
     rasterizer->process_tile(*in_tile);
+    SWR_STATS_UNCLOCK(busy_cycles);
+}
+
+void sweep_rasterizer::shade_visibility_buffer_static(sweep_rasterizer* rasterizer, tile* in_tile)
+{
+#ifdef SWR_ENABLE_STATS
+    auto& busy_cycles = rasterizer->get_worker_cycles();
+#endif
+    SWR_STATS_CLOCK(busy_cycles);
+    rasterizer->shade_visibility_buffer(*in_tile);
+    SWR_STATS_UNCLOCK(busy_cycles);
+}
+
+void sweep_rasterizer::resolve_tile_static([[maybe_unused]] sweep_rasterizer* rasterizer, tile* in_tile, bool discard_depth)
+{
+    SWR_TRACE_SCOPE("resolve tile");
+    SWR_PERF_SCOPE(resolve);
+#ifdef SWR_ENABLE_STATS
+    auto& busy_cycles = rasterizer->get_worker_cycles();
+#endif
+    SWR_STATS_CLOCK(busy_cycles);
+    in_tile->buffer.resolve(discard_depth);
+    SWR_STATS_UNCLOCK(busy_cycles);
 }
 
 #endif /* SWR_ENABLE_MULTI_THREADING */
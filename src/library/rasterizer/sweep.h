@@ -8,6 +8,13 @@
  * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
  */
 
+/* C++ headers. */
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/* user headers. */
 #include "geometry/barycentric_coords.h"
 #include "tile_cache.h"
 
@@ -21,128 +28,474 @@ namespace rast
  * of the fixed-point type used. For example, if we use ml::fixed_28_4_t, we have 4 bits of subpixel
  * precision and the fill rule bias is given in 2^(-4)-pixel-units.
  *
- * This bias is used by triangle- and point rasterization code.
+ * This bias is used by the triangle rasterization code.
  */
 constexpr std::uint32_t FILL_RULE_EDGE_BIAS = 1;
 
-/** Sweep rasterizer. */
-class sweep_rasterizer : public rasterizer
+#ifdef SWR_ENABLE_STATS
+/** the statistics slot of the work item currently processed by this thread. set by the tile processing functions. */
+extern thread_local stats_slot* thread_stats;
+#endif /* SWR_ENABLE_STATS */
+
+/** the occlusion query counters of the tile currently processed by this thread, indexed by query id. set by process_tile. */
+extern thread_local std::uint64_t* thread_query_samples;
+
+/** count the fragments in a fragment mask. */
+inline std::uint32_t get_fragment_count(std::uint32_t mask)
 {
-    /** a geometric primitive understood by sweep_rasterizer */
-    struct primitive
+    return static_cast<std::uint32_t>(std::bitset<32>(mask).count());
+}
+
+/**
+ * a fragment shader instance which is re-created whenever the render states change, so that consecutive
+ * primitives drawn with the same states share one instance. the storage is kept for reuse.
+ */
+class fragment_shader_cache
+{
+    /** shader storage. */
+    std::vector<std::byte> storage;
+
+    /** the states the instance was created for. */
+    const swr::impl::render_states* states{nullptr};
+
+    /** the shader instance. */
+    swr::program_base* shader{nullptr};
+
+public:
+    /** constructors. */
+    fragment_shader_cache() = default;
+    fragment_shader_cache(const fragment_shader_cache&) = delete;
+    fragment_shader_cache(fragment_shader_cache&&) = delete;
+
+    /** destructor. */
+    ~fragment_shader_cache()
     {
-        enum primitive_type
+        reset();
+    }
+
+    /** assignment. */
+    fragment_shader_cache& operator=(const fragment_shader_cache&) = delete;
+    fragment_shader_cache& operator=(fragment_shader_cache&&) = delete;
+
+    /** return a shader instance for the given states. */
+    const swr::program_base* get(const swr::impl::render_states& in_states)
+    {
+        if(states != &in_states)
         {
-            point,   /** point primitive, consisting of one vertex */
-            line,    /** line primitive, consisting of two vertices */
-            triangle /** triangle primitive, consisting of three vertices */
-        };
+            reset();
 
-        /** the type of primitive to be rasterized */
-        primitive_type type;
+            storage.resize(in_states.shader_info->shader->size());
+            shader = in_states.shader_info->shader->create_fragment_shader_instance(storage.data(), in_states.uniforms, in_states.texture_2d_samplers);
+            states = &in_states;
+        }
+        return shader;
+    }
 
-        /** whether the primitive is front-facing. only relevant for triangles (otherwise always true). */
-        bool is_front_facing;
+    /** destroy the shader instance. needs to be called before the states are released. */
+    void reset()
+    {
+        if(shader)
+        {
+            shader->~program_base();
+            shader = nullptr;
+        }
+        states = nullptr;
+    }
+};
 
-        /** the primitive's vertices. points use v[0], lines use v[0] and v[1], and triangles use v[0], v[1] and v[2]. */
-        geom::vertex* v[3];
+/** the fragment shader instance used by this thread for shading point sprites. */
+extern thread_local fragment_shader_cache thread_point_shader;
 
-        /** Points to the active render states (which are stored in the context's draw lists). */
-        const swr::impl::render_states* states{nullptr};
+/** the fragment shader instance used by this thread for drawing lines sequentially. */
+extern thread_local fragment_shader_cache thread_line_shader;
+
+/**
+ * Check if primitives drawn with the given states only affect the depth buffer, i.e., if all color channels
+ * are masked and the fragment shader neither writes depth nor discards. In this case, fragment shading and
+ * color merging are skipped and only the depth values are interpolated.
+ */
+inline bool is_depth_only(const swr::impl::render_states& states)
+{
+    return states.color_mask == swr::output_merger::color_mask::none
+           && states.shader_info != nullptr
+           && states.shader_info->is_depth_invariant();
+}
+
+/**
+ * Check if triangles drawn with the given states into the default framebuffer can be shaded deferred. The color of a fragment
+ * may not depend on the framebuffer, and the fragment shader may neither write depth nor discard, so that shading only the last
+ * fragment passing the depth test produces the same image.
+ */
+inline bool is_deferrable(const swr::impl::render_states& states, const swr::impl::default_framebuffer* framebuffer)
+{
+    return states.draw_target == framebuffer
+           && !states.blending_enabled
+           && states.color_mask == swr::output_merger::color_mask::all
+           && states.shader_info != nullptr
+           && states.shader_info->is_depth_invariant();
+}
+
+/** Sweep rasterizer. */
+class sweep_rasterizer : public rasterizer
+{
+    /** points or lines, stored as a structure of arrays. */
+    template<std::size_t N>
+    struct vertex_primitive_list
+    {
+        /** number of vertices per primitive. */
+        constexpr static std::size_t vertex_count = N;
+
+        /** the primitives' vertices, N consecutive entries per primitive. */
+        std::vector<geom::vertex*> vertices;
+
+        /** indices into the render state list, one per primitive. */
+        std::vector<std::uint32_t> state_indices;
 
         /**
-         * default constructor. only for compatibility with std containers.
-         *
-         * NOTE: this does not make sense to use on its own and probably leaves the object in an undefined and unusable state.
+         * the reason for processing the tile cache before drawing the primitive, as swr::stats::flush_cause offset by one,
+         * or zero if the cache does not need to be processed. only used for parallel drawing.
          */
-        primitive() = default;
-
-        /** point constructor. */
-        primitive(const swr::impl::render_states* in_states, geom::vertex* vertex)
-        : type(point)
-        , is_front_facing(true)
-        , v{vertex, nullptr, nullptr}
-        , states(in_states)
+        std::vector<std::uint8_t> flush_tile_cache;
+
+        /** return the primitive count. */
+        std::size_t size() const
+        {
+            return state_indices.size();
+        }
+
+        /** bytes held by the list. */
+        std::size_t get_memory_usage() const
+        {
+            return vertices.capacity() * sizeof(geom::vertex*) + state_indices.capacity() * sizeof(std::uint32_t) + flush_tile_cache.capacity();
+        }
+
+        /** clear the list. */
+        void clear()
+        {
+            vertices.clear();
+            state_indices.clear();
+            flush_tile_cache.clear();
+        }
+    };
+
+    /** triangles, stored as a structure of arrays. */
+    struct triangle_list : vertex_primitive_list<3>
+    {
+        /** packed viewport coordinates, three consecutive entries per triangle. these are copies, so that they may be modified during setup. */
+        std::vector<ml::vec4> coords;
+
+        /** whether the triangle is front-facing. */
+        std::vector<std::uint8_t> front_facing;
+
+        /** bytes held by the list. */
+        std::size_t get_memory_usage() const
         {
+            return vertex_primitive_list<3>::get_memory_usage() + coords.capacity() * sizeof(ml::vec4) + front_facing.capacity();
         }
 
-        /** line constructor. */
-        primitive(const swr::impl::render_states* in_states, geom::vertex* v1, geom::vertex* v2)
-        : type(line)
-        , is_front_facing(true)
-        , v{v1, v2, nullptr}
-        , states(in_states)
+        /** clear the list. */
+        void clear()
         {
+            vertex_primitive_list<3>::clear();
+            coords.clear();
+            front_facing.clear();
         }
+    };
+
+    /** a run of consecutive primitives of the same type, in submission order. */
+    struct draw_command
+    {
+        /** primitive type. selects the list the range refers to. */
+        primitive::primitive_type type;
 
-        /** triangle constructor. */
-        primitive(const swr::impl::render_states* in_states, bool in_is_front_facing, geom::vertex* v1, geom::vertex* v2, geom::vertex* v3)
-        : type(triangle)
-        , is_front_facing(in_is_front_facing)
-        , v{v1, v2, v3}
-        , states(in_states)
+        /** first primitive of the run. */
+        std::size_t begin{0};
+
+        /** one past the last primitive of the run. */
+        std::size_t end{0};
+
+        /** constructors. */
+        draw_command() = default;
+        draw_command(primitive::primitive_type in_type, std::size_t in_begin)
+        : type{in_type}
+        , begin{in_begin}
+        , end{in_begin}
         {
         }
     };
 
-    /** list containing all primitives which are to be rasterized. */
-    std::vector<primitive> draw_list;
+    /** render states referenced by the primitives. consecutive primitives sharing their render states reference the same entry. */
+    std::vector<const swr::impl::render_states*> state_list;
+
+    /** points to be rasterized. */
+    vertex_primitive_list<1> points;
+
+    /** lines to be rasterized. */
+    vertex_primitive_list<2> lines;
+
+    /** triangles to be rasterized. */
+    triangle_list triangles;
+
+    /** draw commands, referencing the primitive lists in submission order. */
+    std::vector<draw_command> draw_list;
+
+    /** get the state index for the render states, adding them to the state list if necessary. */
+    std::uint32_t get_state_index(const swr::impl::render_states* states)
+    {
+        if(state_list.size() == 0 || state_list.back() != states)
+        {
+            state_list.push_back(states);
+        }
+        return static_cast<std::uint32_t>(state_list.size() - 1);
+    }
+
+    /** clear all primitive lists. */
+    void clear_draw_list()
+    {
+        draw_list.clear();
+        state_list.clear();
+        points.clear();
+        lines.clear();
+        triangles.clear();
+    }
 
     /** tile cache. */
     tile_cache tiles;
 
+    /** whether deferred triangles were added to the tiles' visibility buffers since they were last shaded. */
+    bool visibility_pending{false};
+
+    /** whether the triangle at an index of the triangle list is shaded deferred. */
+    bool is_deferred_triangle(std::size_t index) const
+    {
+        return visibility_buffer && is_deferrable(*state_list[triangles.state_indices[index]], framebuffer);
+    }
+
+    /** triangle bins. for parallel drawing, each setup task writes to its own bin. sequential drawing only uses the first bin. */
+    std::vector<triangle_bin> triangle_bins;
+
+    /** line bins. for parallel drawing, each setup task writes to its own bin. sequential drawing only uses the first bin. */
+    std::vector<line_bin> line_bins;
+
+    /** point bins. for parallel drawing, each setup task writes to its own bin. sequential drawing only uses the first bin. */
+    std::vector<point_bin> point_bins;
+
+#ifdef SWR_ENABLE_STATS
+    /** statistics of the setup tasks, one slot per bin. */
+    std::vector<stats_slot> setup_stats;
+
+    /** sum up the statistics slots of the tiles and the setup tasks and reset them. */
+    void collect_stats();
+
+#    ifdef SWR_ENABLE_MULTI_THREADING
+    /** unique id of the rasterizer, identifying it to the worker threads. */
+    std::uint64_t worker_owner_id{allocate_worker_owner_id()};
+
+    /** protects the registration of worker threads. */
+    std::mutex worker_mutex;
+
+    /** busy cycle counter of a worker thread. */
+    struct worker_counter
+    {
+        /** the thread updating the counter. */
+        std::thread::id thread;
+
+        /** busy cycles. the counter is kept alive, since the thread holds a pointer to it. */
+        std::unique_ptr<std::uint64_t> cycles;
+    };
+
+    /** busy cycles of each worker thread executing tasks of this rasterizer. every thread is registered once. */
+    std::vector<worker_counter> worker_cycles;
+
+    /** return a new rasterizer id. */
+    static std::uint64_t allocate_worker_owner_id();
+
+    /** get the calling thread's busy cycle counter, registering the thread on first use. */
+    std::uint64_t& get_worker_cycles();
+#    endif /* SWR_ENABLE_MULTI_THREADING */
+#endif
+
 #ifdef SWR_ENABLE_MULTI_THREADING
     /** thread pool. */
     swr::impl::render_device_context::thread_pool_type* thread_pool{nullptr};
 
-    /** process all tiles stored in the tile cache. */
-    void process_tile_cache()
+    /** process all tiles stored in the tile cache. the cause is recorded if any tile was processed. */
+    void process_tile_cache([[maybe_unused]] swr::stats::flush_cause cause)
     {
+        SWR_TRACE_SCOPE("process tile cache");
+
+#ifdef SWR_ENABLE_STATS
+        // the tiles hold the most memory right before they are processed.
+        stats_tile_cache_peak = std::max(stats_tile_cache_peak, tiles.get_memory_usage());
+#endif
+
         // for each non-empty tile, add a job to the thread pool.
+        [[maybe_unused]] std::uint32_t job_count{0};
         const auto tile_count = tiles.entries.size();
         for(std::size_t i = 0; i < tile_count; ++i)
         {
-            if(tiles.entries[i].primitives.size())
+            if(!tiles.entries[i].empty())
             {
                 thread_pool->push_task(process_tile_static, this, &tiles.entries[i]);
+                ++job_count;
             }
         }
 
+        SWR_STATS_INCREMENT2(stats_rast.jobs, job_count);
+        SWR_STATS_INCREMENT2(stats_tiles.flushes[static_cast<std::size_t>(cause)], job_count != 0);
+
         thread_pool->run_tasks_and_wait();
         tiles.clear_tiles();
     }
 #else  /* SWR_ENABLE_MULTI_THREADING */
-    /** process all tiles stored in the tile cache. */
-    void process_tile_cache()
+    /** process all tiles stored in the tile cache. the cause is recorded if any tile was processed. */
+    void process_tile_cache([[maybe_unused]] swr::stats::flush_cause cause)
     {
+        SWR_TRACE_SCOPE("process tile cache");
+
+#ifdef SWR_ENABLE_STATS
+        // the tiles hold the most memory right before they are processed.
+        stats_tile_cache_peak = std::max(stats_tile_cache_peak, tiles.get_memory_usage());
+#endif
+
         // for each non-empty tile, add a job to the thread pool.
+        [[maybe_unused]] std::uint32_t job_count{0};
         const auto tile_count = tiles.entries.size();
         for(std::size_t i = 0; i < tile_count; ++i)
         {
-            if(tiles.entries[i].primitives.size())
+            if(!tiles.entries[i].empty())
             {
                 process_tile(tiles.entries[i]);
+                ++job_count;
             }
         }
 
+        SWR_STATS_INCREMENT2(stats_rast.jobs, job_count);
+        SWR_STATS_INCREMENT2(stats_tiles.flushes[static_cast<std::size_t>(cause)], job_count != 0);
+
         tiles.clear_tiles();
     }
 #endif /* SWR_ENABLE_MULTI_THREADING */
 
+    /** add the blocks of a bin to the tile cache. the tile cache is processed whenever it is full. */
+    void add_to_tile_cache(const triangle_bin& bin)
+    {
+        for(auto& block: bin)
+        {
+            visibility_pending |= block.deferred;
+            if(tiles.add_triangle(block))
+            {
+                if(block.deferred)
+                {
+                    // a visibility buffer is full. shade all visibility buffers.
+                    shade_visibility_buffers(swr::stats::flush_cause::visibility_full);
+                }
+                else
+                {
+                    // the cache is full. process all tiles.
+                    process_tile_cache(swr::stats::flush_cause::cache_full);
+                }
+            }
+        }
+    }
+
+    /*
+     * per-pixel fragment counters.
+     */
+
+    /** whether fragments drawn with the given states are counted, see swr::debug. only fragments of the default framebuffer are counted. */
+    bool is_counting_overdraw(const swr::impl::render_states& states) const
+    {
+        return !overdraw_counters.empty() && states.draw_target == framebuffer;
+    }
+
+    /** increment a per-pixel counter. each pixel belongs to exactly one tile, so that the counters need no synchronization. */
+    void count_overdraw(int x, int y, std::uint32_t swr::debug::fragment_counters::*counter)
+    {
+        if(x >= 0 && y >= 0 && x < framebuffer->properties.width && y < framebuffer->properties.height)
+        {
+            ++(overdraw_counters[y * framebuffer->properties.width + x].*counter);
+        }
+    }
+
+    /** increment a per-pixel counter for the fragments of a 2x2 block set in mask, with the top-left fragment in bit 0. */
+    void count_overdraw_block(int x, int y, std::uint32_t mask, std::uint32_t swr::debug::fragment_counters::*counter)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            if(mask & (1 << i))
+            {
+                count_overdraw(x + (i & 1), y + (i >> 1), counter);
+            }
+        }
+    }
+
+    /** reset the per-pixel counters and resize them to the default framebuffer. */
+    void reset_overdraw_counters();
+
+    /** replace the default framebuffer's colors by the false-color overlay. */
+    void draw_overdraw_overlay();
+
+    /*
+     * occlusion queries.
+     */
+
+    /** number of occlusion query counters per tile, i.e., one more than the largest query id referenced by the draw list. zero if no query is referenced. */
+    std::uint32_t query_count{0};
+
+    /** add the fragments of a mask to the samples-passed counter of the active occlusion query, if any. */
+    void count_query_samples(const swr::impl::render_states& states, std::uint32_t mask) const
+    {
+        if(states.active_query != 0)
+        {
+            thread_query_samples[states.active_query] += get_fragment_count(mask);
+        }
+    }
+
+    /** size and reset the tiles' occlusion query counters for the queries referenced by the draw list. */
+    void reset_query_counters();
+
+    /** sum up the tiles' occlusion query counters into query_samples. */
+    void collect_query_counters();
+
     /*
      * fragment processing.
      */
 
-    /** generate a color value along with depth- and stencil flags for a single fragment. writes to the depth buffer. */
-    void process_fragment(int x, int y, const swr::impl::render_states& states, const swr::program_base* in_shader, float one_over_viewport_z, fragment_info& info, swr::impl::fragment_output& out);
+    /** generate a color value along with depth- and stencil flags for a single fragment. writes to the depth buffer of draw_target. */
+    void process_fragment(int x, int y, const swr::impl::render_states& states, swr::impl::framebuffer_draw_target* draw_target, const swr::program_base* in_shader, float one_over_viewport_z, fragment_info& info, swr::impl::fragment_output& out);
 
-    /** generate color values along with depth- and stencil masks for a 2x2 block of fragments. writes to the depth buffer. */
+    /** generate color and depth values along with color- and stencil masks for a 2x2 block of fragments. does not perform the depth test. */
     void process_fragment_block(int x, int y, const swr::impl::render_states& states, const swr::program_base* in_shader, float one_over_viewport_z[4], fragment_info info[4], swr::impl::fragment_output_block& out);
 
+    /** generate depth values and masks for a 2x2 block of fragments in depth-only mode. does not perform the depth test. */
+    void process_depth_block(int x, int y, const swr::impl::render_states& states, const float depth_value[4], swr::impl::fragment_output_block& out);
+
+    /** get the scissor test result for a 2x2 block of fragments, with the top-left fragment in bit 0. */
+    std::uint32_t get_scissor_mask(int x, int y, const swr::impl::render_states& states) const;
+
+    /**
+     * depth-test a 4x4 block of fragments and merge the colors of the fragments passing the test into draw_target. the block
+     * is given as four 2x2 blocks in the order top-left, top-right, bottom-left, bottom-right.
+     */
+    void merge_fragment_blocks(int x, int y, const swr::impl::render_states& states, swr::impl::framebuffer_draw_target* draw_target, swr::impl::fragment_output_block out[4]);
+
     /*
      * fragment block processing.
      */
 
+    /** shade a 2x2 block of a triangle. the attributes are taken at the block's upper-left corner. */
+    void shade_fragment_block(unsigned int x, unsigned int y, const tile_info& in_data, const triangle_interpolator& attributes, swr::impl::fragment_output_block& out);
+
+    /**
+     * rasterize a 2x2 block of a triangle. the fragment shader is skipped in depth-only mode and for deferred triangles,
+     * which are shaded after the visibility buffer is complete. the attributes are taken at the block's upper-left corner.
+     */
+    void rasterize_fragment_block(unsigned int x, unsigned int y, const tile_info& in_data, const triangle_interpolator& attributes, swr::impl::fragment_output_block& out);
+
+    /** depth-test a 4x4 block of fragments of a deferred triangle and store the triangle's id for the fragments passing the test. */
+    void merge_visibility_blocks(int x, int y, const tile_info& in_data, swr::impl::fragment_output_block out[4]);
+
     /**
      * Rasterize a complete block of dimension (rasterizer_block_size, rasterizer_block_size), i.e. do not perform additional edge checks.
      */
@@ -154,12 +507,33 @@ class sweep_rasterizer : public rasterizer
      */
     void process_block_checked(unsigned int in_x, unsigned int in_y, tile_info& in_data);
 
+    /** rasterize a line segment using Bresenham's algorithm. */
+    void process_line_segment(const line_segment& segment, const swr::program_base* shader, swr::impl::framebuffer_draw_target* draw_target);
+
+    /** rasterize the part of a point sprite inside a tile. */
+    void process_point_block(const point_block& block, const swr::program_base* shader, swr::impl::framebuffer_draw_target* draw_target);
+
     /** process a tile. */
     void process_tile(tile& in_tile);
 
+    /** shade the visible fragments of the deferred triangles of a tile and clear its visibility buffer. */
+    void shade_visibility_buffer(tile& in_tile);
+
+    /** rasterize all pending deferred triangles and shade the tiles' visibility buffers. the cause is recorded for processing the tile cache. */
+    void shade_visibility_buffers(swr::stats::flush_cause cause = swr::stats::flush_cause::visibility_shading);
+
+    /** write the tile-local buffers back to the default framebuffer. */
+    void resolve_tiles();
+
 #ifdef SWR_ENABLE_MULTI_THREADING
     /** calls rasterizer->process_tile. */
     static void process_tile_static(sweep_rasterizer* rasterizer, tile* in_tile);
+
+    /** calls rasterizer->shade_visibility_buffer. */
+    static void shade_visibility_buffer_static(sweep_rasterizer* rasterizer, tile* in_tile);
+
+    /** write the local buffers of a tile back to the default framebuffer. */
+    static void resolve_tile_static(sweep_rasterizer* rasterizer, tile* in_tile, bool discard_depth);
 #endif
 
     /*
@@ -167,24 +541,42 @@ class sweep_rasterizer : public rasterizer
      */
 
     /**
-     * Draw the triangle (v1,v2,v3) using a sweep algorithm with blocks of size rasterizer_block_size.
-     * The triangle is rasterized regardless of its orientation.
+     * Set up a triangle from the triangle list and append all blocks of size rasterizer_block_size covered by it to a bin.
+     * The triangle is set up regardless of its orientation. Does not modify the rasterizer, so that multiple
+     * triangles may be set up concurrently.
      *
-     * NOTE Depending on the render states, the vertices may be modified.
+     * \param index Index of the triangle in the triangle list. Stored in the blocks.
+     * \param bin The bin to append the blocks to.
+     */
+    void setup_triangle(std::size_t index, triangle_bin& bin) const;
+
+    /** draw a triangle from the triangle list using a sweep algorithm with blocks of size rasterizer_block_size. */
+    void draw_filled_triangle(std::size_t index);
+
+    /**
+     * Set up a line from the line list, split it into segments restricted to a single tile each and append
+     * these segments to a bin. Does not modify the rasterizer, so that multiple lines may be set up concurrently.
      *
-     * \param states Active render states for this triangle.
-     * \param is_front_facing Whether this triangle is front facing. Passed to the fragment shader.
-     * \param v1 First triangle vertex.
-     * \param v2 Second triangle vertex.
-     * \param v3 Third triangle vertex.
+     * \param index Index of the line in the line list. Stored in the segments.
+     * \param bin The bin to append the segments to.
      */
-    void draw_filled_triangle(const swr::impl::render_states& states, bool is_front_facing, geom::vertex& v1, geom::vertex& v2, geom::vertex& v3);
+    void setup_line(std::size_t index, line_bin& bin) const;
+
+    /** draw a line from the line list. */
+    void draw_line(std::size_t index);
 
-    /** draw a line. For line strips, the interior end points should be omitted by setting draw_end_point to false. */
-    void draw_line(const swr::impl::render_states& states, bool draw_end_point, const geom::vertex& v1, const geom::vertex& v2);
+    /**
+     * Set up a point from the point list as a square sprite of the vertex' point size and append
+     * the parts of the sprite inside each tile to a bin. Does not modify the rasterizer, so that multiple
+     * points may be set up concurrently.
+     *
+     * \param index Index of the point in the point list. Stored in the blocks.
+     * \param bin The bin to append the blocks to.
+     */
+    void setup_point(std::size_t index, point_bin& bin) const;
 
-    /** draw a point. */
-    void draw_point(const swr::impl::render_states& states, const geom::vertex& v);
+    /** draw a point from the point list. */
+    void draw_point(std::size_t index);
 
     /** draw the primitives in the list sequentially. */
     void draw_primitives_sequentially();
@@ -192,6 +584,31 @@ class sweep_rasterizer : public rasterizer
 #ifdef SWR_ENABLE_MULTI_THREADING
     /** draw the primitives in the list in parallel. */
     void draw_primitives_parallel();
+
+    /**
+     * set up the primitives in the range [begin,end) of a primitive list in parallel and add them to the tile cache in submission order.
+     *
+     * \param begin First primitive to set up.
+     * \param end One past the last primitive to set up.
+     * \param primitive_bins Bins for the setup tasks. Resized if necessary.
+     * \param setup_static Sets up a range of primitives into a bin. Run on the thread pool.
+     * \param flush_tile_cache The reasons for processing the tile cache before a primitive, see vertex_primitive_list::flush_tile_cache.
+     */
+    template<typename T>
+    void draw_binned_primitives_parallel(
+      std::size_t begin, std::size_t end,
+      std::vector<std::vector<T>>& primitive_bins,
+      void (*setup_static)(sweep_rasterizer*, std::size_t, std::size_t, std::vector<T>*),
+      const std::vector<std::uint8_t>& flush_tile_cache);
+
+    /** set up the triangles in the triangle list range [begin,end). meant to be supplied to the thread pool. */
+    static void setup_triangles_static(sweep_rasterizer* rasterizer, std::size_t begin, std::size_t end, triangle_bin* bin);
+
+    /** set up the lines in the line list range [begin,end). meant to be supplied to the thread pool. */
+    static void setup_lines_static(sweep_rasterizer* rasterizer, std::size_t begin, std::size_t end, line_bin* bin);
+
+    /** set up the points in the point list range [begin,end). meant to be supplied to the thread pool. */
+    static void setup_points_static(sweep_rasterizer* rasterizer, std::size_t begin, std::size_t end, point_bin* bin);
 #endif
 
 public:
@@ -212,6 +629,15 @@ public:
         unsigned int tiles_y = (framebuffer->properties.height >> swr::impl::rasterizer_block_shift) + 1;
 
         tiles.reset(tiles_x, tiles_y);
+
+        // sequential drawing uses the first bin.
+        triangle_bins.resize(1);
+        line_bins.resize(1);
+        point_bins.resize(1);
+
+#ifdef SWR_ENABLE_STATS
+        setup_stats.resize(1);
+#endif
     }
 
     /*
@@ -222,10 +648,9 @@ public:
     {
         return std::string("Sweep Rasterizer");
     }
-    void add_point(const swr::impl::render_states* states, geom::vertex* v) override;
-    void add_line(const swr::impl::render_states* states, geom::vertex* v1, geom::vertex* v2) override;
-    void add_triangle(const swr::impl::render_states* states, bool is_front_facing, geom::vertex* v1, geom::vertex* v2, geom::vertex* v3) override;
+    void add_primitives(const primitive* primitives, std::size_t count) override;
     void draw_primitives() override;
+    std::size_t get_memory_usage(swr::stats::memory_category category) const override;
 };
 
 } /* namespace rast */
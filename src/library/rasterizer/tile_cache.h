@@ -8,10 +8,16 @@
  * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
  */
 
+/* C++ headers. */
+#include <deque>
+
 namespace rast
 {
 
-/** primitive data associated to a tile. currently only implemented for triangles. */
+/* forward declaration. */
+struct tile_visibility;
+
+/** triangle data associated to a tile. */
 class tile_info
 {
     /** shader storage */
@@ -31,6 +37,9 @@ public:
     /** shader. */
     const swr::program_base* shader;
 
+    /** the target the fragments are written to. set when the block is added to a tile. */
+    swr::impl::framebuffer_draw_target* draw_target{nullptr};
+
     /** barycentric coordinates and steps for this block. */
     geom::barycentric_coordinate_block lambdas;
 
@@ -43,6 +52,12 @@ public:
     /** rasterization mode. */
     rasterization_mode mode{rasterization_mode::block};
 
+    /** visibility buffer a deferred triangle is rasterized into. nullptr if the triangle is shaded immediately. */
+    tile_visibility* visibility{nullptr};
+
+    /** the triangle's id in the visibility buffer. */
+    std::uint32_t visibility_id{0};
+
     /** constructors. */
     tile_info() = default;
     tile_info(tile_info&&) = default;
@@ -51,10 +66,13 @@ public:
     : shader_storage{other.shader->size()}
     , states{other.states}
     , shader{other.shader->create_fragment_shader_instance(shader_storage.data(), other.states->uniforms, other.states->texture_2d_samplers)}
+    , draw_target{other.draw_target}
     , lambdas{other.lambdas}
     , front_facing{other.front_facing}
     , attributes{other.attributes}
     , mode{other.mode}
+    , visibility{other.visibility}
+    , visibility_id{other.visibility_id}
     {
     }
 
@@ -86,9 +104,560 @@ public:
     , mode{in_mode}
     {
     }
+
+    /** bytes held by the shader instance. */
+    std::size_t get_memory_usage() const
+    {
+        return shader_storage.capacity();
+    }
+};
+
+/**
+ * a block of a triangle, as produced by triangle setup. the blocks are binned by the
+ * setup threads and only instantiate the fragment shader when added to the tile cache.
+ */
+struct triangle_block
+{
+    /** viewport x coordinate of the block's upper-left corner. */
+    unsigned int x{0};
+
+    /** viewport y coordinate of the block's upper-left corner. */
+    unsigned int y{0};
+
+    /** index of the triangle in the rasterizer's triangle list. */
+    std::size_t primitive_index{0};
+
+    /** render states. points to an entry in the context's draw list. */
+    const swr::impl::render_states* states{nullptr};
+
+    /** barycentric coordinates and steps for this block. */
+    geom::barycentric_coordinate_block lambdas;
+
+    /** attribute interpolators for this block. */
+    triangle_interpolator attributes;
+
+    /** whether this corresponding triangle is front-facing. */
+    bool front_facing{true};
+
+    /** rasterization mode. */
+    tile_info::rasterization_mode mode{tile_info::rasterization_mode::block};
+
+    /** whether the block is shaded deferred, using the tile's visibility buffer. */
+    bool deferred{false};
+
+    /** constructors. */
+    triangle_block() = default;
+    triangle_block(
+      unsigned int in_x, unsigned int in_y,
+      std::size_t in_primitive_index,
+      const swr::impl::render_states* in_states,
+      const geom::barycentric_coordinate_block& in_lambdas,
+      const triangle_interpolator& in_attributes,
+      bool in_front_facing,
+      tile_info::rasterization_mode in_mode,
+      bool in_deferred)
+    : x{in_x}
+    , y{in_y}
+    , primitive_index{in_primitive_index}
+    , states{in_states}
+    , lambdas{in_lambdas}
+    , attributes{in_attributes}
+    , front_facing{in_front_facing}
+    , mode{in_mode}
+    , deferred{in_deferred}
+    {
+    }
+};
+
+/** a list of triangle blocks in submission order. */
+using triangle_bin = std::vector<triangle_block>;
+
+/**
+ * a part of a line restricted to a single tile, as produced by line setup. stores the state of
+ * Bresenham's line drawing algorithm at the segment's first fragment.
+ */
+struct line_segment
+{
+    /** viewport x coordinate of the first fragment. */
+    unsigned int x{0};
+
+    /** viewport y coordinate of the first fragment. */
+    unsigned int y{0};
+
+    /** index of the line in the rasterizer's line list. */
+    std::size_t primitive_index{0};
+
+    /** render states. points to an entry in the context's draw list. */
+    const swr::impl::render_states* states{nullptr};
+
+    /** whether the line is parameterized over the x axis. */
+    bool is_x_major{true};
+
+    /** parameter (x for x-major lines and y for y-major lines) of the first fragment. */
+    ml::fixed_t p;
+
+    /** value (y for x-major lines and x for y-major lines) of the first fragment. */
+    ml::fixed_t v;
+
+    /** error/decision variable at the first fragment. */
+    ml::fixed_t error;
+
+    /** value increment. */
+    ml::fixed_t inc_v;
+
+    /** parameter range. */
+    ml::fixed_t fix_dp;
+
+    /** value range. */
+    ml::fixed_t fix_dv;
+
+    /** number of fragments in this segment. */
+    std::uint32_t fragment_count{0};
+
+    /** attribute interpolators at the first fragment. */
+    line_interpolator attributes;
+};
+
+/** a list of line segments in submission order. */
+using line_bin = std::vector<line_segment>;
+
+/**
+ * a point sprite restricted to a single tile, as produced by point setup. stores the
+ * sprite's pixel rectangle clipped to the tile and the data for gl_PointCoord.
+ */
+struct point_block
+{
+    /** viewport x coordinate of the first fragment. */
+    unsigned int x{0};
+
+    /** viewport y coordinate of the first fragment. */
+    unsigned int y{0};
+
+    /** one past the last viewport x coordinate. */
+    unsigned int x_end{0};
+
+    /** one past the last viewport y coordinate. */
+    unsigned int y_end{0};
+
+    /** index of the point in the rasterizer's point list. */
+    std::size_t primitive_index{0};
+
+    /** render states. points to an entry in the context's draw list. */
+    const swr::impl::render_states* states{nullptr};
+
+    /** the point's vertex. */
+    const geom::vertex* vertex{nullptr};
+
+    /** viewport coordinates of the sprite's upper-left corner. */
+    ml::vec2 origin;
+
+    /** the sprite's size in pixels. */
+    float size{1.0f};
+};
+
+/** a list of point blocks in submission order. */
+using point_bin = std::vector<point_block>;
+
+/** line or point data associated to a tile. */
+template<typename T>
+class shaded_tile_info
+{
+    /** shader storage */
+    std::vector<std::byte> shader_storage;
+
+public:
+    /** shader. */
+    const swr::program_base* shader;
+
+    /** the target the fragments are written to. set when the data is added to a tile. */
+    swr::impl::framebuffer_draw_target* draw_target{nullptr};
+
+    /** the line segment or point block. */
+    T data;
+
+    /** constructors. */
+    shaded_tile_info() = default;
+    shaded_tile_info(shaded_tile_info&&) = default;
+
+    shaded_tile_info(const shaded_tile_info& other)
+    : shader_storage{other.shader->size()}
+    , shader{other.shader->create_fragment_shader_instance(shader_storage.data(), other.data.states->uniforms, other.data.states->texture_2d_samplers)}
+    , draw_target{other.draw_target}
+    , data{other.data}
+    {
+    }
+
+    ~shaded_tile_info()
+    {
+        shader->~program_base();
+    }
+
+    shaded_tile_info& operator=(const shaded_tile_info&) = default;
+    shaded_tile_info& operator=(shaded_tile_info&&) = default;
+
+    /**
+     * initializing constructor.
+     *
+     * NOTE This instantiates the shader.
+     */
+    shaded_tile_info(const T& in_data)
+    : shader_storage{in_data.states->shader_info->shader->size()}
+    , shader{in_data.states->shader_info->shader->create_fragment_shader_instance(shader_storage.data(), in_data.states->uniforms, in_data.states->texture_2d_samplers)}
+    , data{in_data}
+    {
+    }
+
+    /** bytes held by the shader instance. */
+    std::size_t get_memory_usage() const
+    {
+        return shader_storage.capacity();
+    }
+};
+
+/** line data associated to a tile. */
+using line_tile_info = shaded_tile_info<line_segment>;
+
+/** point data associated to a tile. the fragment shader is instantiated by the thread processing the tile. */
+struct point_tile_info
+{
+    /** the target the fragments are written to. set when the data is added to a tile. */
+    swr::impl::framebuffer_draw_target* draw_target{nullptr};
+
+    /** the point block. */
+    point_block data;
+
+    /** constructors. */
+    point_tile_info() = default;
+    point_tile_info(const point_block& in_data)
+    : data{in_data}
+    {
+    }
+};
+
+/**
+ * tile-local copy of a tile of the default framebuffer. the color and depth values are loaded from the framebuffer
+ * on first access and written back by resolve, so that all primitives drawn into the tile during a frame operate on
+ * a small buffer. pending clears of the tile are applied when loading. the buffers use the default framebuffer's layout with a width of rasterizer_block_size, so that
+ * its merging and depth test kernels apply. only the merging and depth test functions are meant to be used.
+ */
+class tile_framebuffer : public swr::impl::default_framebuffer
+{
+    /** number of fragments in a tile. */
+    constexpr static std::size_t fragment_count = swr::impl::rasterizer_block_size * swr::impl::rasterizer_block_size;
+
+    /** the framebuffer the tile belongs to. */
+    swr::impl::default_framebuffer* target{nullptr};
+
+    /** viewport x coordinate of the tile's upper-left corner. */
+    int x{0};
+
+    /** viewport y coordinate of the tile's upper-left corner. */
+    int y{0};
+
+    /** width of the tile, clipped to the target. */
+    int width{0};
+
+    /** height of the tile, clipped to the target. */
+    int height{0};
+
+    /** index of the tile in the target's per-tile clear flags. */
+    std::size_t tile_index{0};
+
+    /** tile-local color values. */
+    std::array<std::uint32_t, fragment_count> color_data;
+
+    /** tile-local depth values. 16-bit values only use the first half of the array. */
+    std::array<std::uint32_t, fragment_count> depth_data;
+
+    /** whether the color values were loaded. */
+    bool color_loaded{false};
+
+    /** whether the depth values were loaded. */
+    bool depth_loaded{false};
+
+    /** whether the depth values were modified. */
+    bool depth_modified{false};
+
+    /** copy a rectangle of values between buffers. the pitches are given in elements. */
+    template<typename T>
+    void copy_rect(T* dest, int dest_pitch, const T* src, int src_pitch) const
+    {
+        for(int row = 0; row < height; ++row)
+        {
+            std::copy(src + row * src_pitch, src + row * src_pitch + width, dest + row * dest_pitch);
+        }
+    }
+
+    /** copy a rectangle of depth values of the target's format between buffers. the pitches are given in elements. */
+    void copy_depth_rect(void* dest, int dest_pitch, const void* src, int src_pitch) const
+    {
+        if(target->depth_buffer.format == swr::depth_format::depth16)
+        {
+            copy_rect(static_cast<std::uint16_t*>(dest), dest_pitch, static_cast<const std::uint16_t*>(src), src_pitch);
+        }
+        else
+        {
+            copy_rect(static_cast<std::uint32_t*>(dest), dest_pitch, static_cast<const std::uint32_t*>(src), src_pitch);
+        }
+    }
+
+    /** load the color values on first access. */
+    void load_color()
+    {
+        if(!color_loaded)
+        {
+            if(target->color_clear_pending[tile_index])
+            {
+                color_data.fill(target->pending_clear_color);
+            }
+            else
+            {
+                copy_rect(color_data.data(), swr::impl::rasterizer_block_size, target->color_buffer.info.data_ptr + y * target->color_buffer.info.width + x, target->color_buffer.info.width);
+            }
+            color_loaded = true;
+        }
+    }
+
+    /** load the depth values on first access. */
+    void load_depth()
+    {
+        if(!depth_loaded)
+        {
+            if(target->depth_clear_pending[tile_index])
+            {
+                depth_data.fill(target->pending_clear_depth);
+            }
+            else
+            {
+                copy_depth_rect(depth_data.data(), swr::impl::rasterizer_block_size, target->depth_buffer.get_value_ptr(x, y), target->depth_buffer.info.width);
+            }
+            depth_loaded = true;
+        }
+    }
+
+public:
+    /** constructors. */
+    tile_framebuffer() = default;
+    tile_framebuffer(const tile_framebuffer&) = default;
+    tile_framebuffer(tile_framebuffer&&) = default;
+
+    tile_framebuffer& operator=(const tile_framebuffer&) = default;
+    tile_framebuffer& operator=(tile_framebuffer&&) = default;
+
+    /** virtual destructor. */
+    virtual ~tile_framebuffer() = default;
+
+    /** return the framebuffer the tile belongs to. */
+    const swr::impl::default_framebuffer* get_target() const
+    {
+        return target;
+    }
+
+    /** whether the tile holds values that were not written back yet. */
+    bool is_loaded() const
+    {
+        return color_loaded || depth_loaded;
+    }
+
+    /** bind the tile at (in_x,in_y) of a framebuffer. discards all tile-local values. */
+    void bind(swr::impl::default_framebuffer* in_target, int in_x, int in_y)
+    {
+        target = in_target;
+        x = in_x;
+        y = in_y;
+        width = std::max(0, std::min<int>(target->properties.width - x, swr::impl::rasterizer_block_size));
+        height = std::max(0, std::min<int>(target->properties.height - y, swr::impl::rasterizer_block_size));
+        tile_index = (width > 0 && height > 0) ? target->get_tile_index(x, y) : 0;
+
+        // the attachments point into this object and need to be set up after copying.
+        color_buffer.attach(swr::impl::rasterizer_block_size, swr::impl::rasterizer_block_size, swr::impl::rasterizer_block_size * sizeof(std::uint32_t), color_data.data());
+        color_buffer.converter = target->color_buffer.converter;
+        depth_buffer.format = target->depth_buffer.format;
+        depth_buffer.info.setup(swr::impl::rasterizer_block_size, swr::impl::rasterizer_block_size, swr::impl::rasterizer_block_size * swr::impl::get_depth_format_size(depth_buffer.format), depth_data.data());
+        properties.reset(swr::impl::rasterizer_block_size, swr::impl::rasterizer_block_size);
+
+        color_loaded = false;
+        depth_loaded = false;
+        depth_modified = false;
+    }
+
+    /**
+     * write the tile-local values back to the framebuffer, which also applies pending clears. the depth values are not
+     * written if discard_depth is set. in this case, or if the depth values were not modified, a pending depth clear stays pending.
+     */
+    void resolve(bool discard_depth)
+    {
+        if(color_loaded)
+        {
+            copy_rect(target->color_buffer.info.data_ptr + y * target->color_buffer.info.width + x, target->color_buffer.info.width, color_data.data(), swr::impl::rasterizer_block_size);
+            target->color_clear_pending[tile_index] = 0;
+        }
+
+        if(depth_modified && !discard_depth)
+        {
+            copy_depth_rect(target->depth_buffer.get_value_ptr(x, y), target->depth_buffer.info.width, depth_data.data(), swr::impl::rasterizer_block_size);
+            target->depth_clear_pending[tile_index] = 0;
+        }
+
+        color_loaded = false;
+        depth_loaded = false;
+        depth_modified = false;
+    }
+
+    /*
+     * framebuffer_draw_target interface. the coordinates are given with respect to the target.
+     */
+
+    virtual void merge_color(uint32_t attachment, int in_x, int in_y, const swr::impl::fragment_output& frag, bool do_blend, const swr::output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask) override
+    {
+        if(attachment == 0 && target->is_color_weakly_attached())
+        {
+            load_color();
+            swr::impl::default_framebuffer::merge_color(attachment, in_x - x, in_y - y, frag, do_blend, blend_kernels, color_mask);
+        }
+    }
+
+    virtual void merge_color_block(uint32_t attachment, int in_x, int in_y, const swr::impl::fragment_output_block& frag, bool do_blend, const swr::output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask) override
+    {
+        if(attachment == 0 && target->is_color_weakly_attached())
+        {
+            load_color();
+            swr::impl::default_framebuffer::merge_color_block(attachment, in_x - x, in_y - y, frag, do_blend, blend_kernels, color_mask);
+        }
+    }
+
+    virtual void depth_compare_write(int in_x, int in_y, float depth_value, swr::comparison_func depth_func, bool write_depth, bool& write_mask) override
+    {
+        if(!target->depth_buffer.info.data_ptr)
+        {
+            // no depth buffer. accept, unless the depth test always fails.
+            write_mask = (depth_func != swr::comparison_func::fail);
+            return;
+        }
+
+        load_depth();
+        depth_modified |= write_depth;
+        swr::impl::default_framebuffer::depth_compare_write(in_x - x, in_y - y, depth_value, depth_func, write_depth, write_mask);
+    }
+
+    virtual void depth_compare_write_block(int in_x, int in_y, const float depth_value[16], swr::comparison_func depth_func, bool write_depth, std::uint32_t& write_mask) override
+    {
+        if(!target->depth_buffer.info.data_ptr)
+        {
+            // no depth buffer. the write mask is left unchanged, unless the depth test always fails.
+            write_mask = (depth_func != swr::comparison_func::fail) ? write_mask : 0;
+            return;
+        }
+
+        load_depth();
+        depth_modified |= write_depth;
+        swr::impl::default_framebuffer::depth_compare_write_block(in_x - x, in_y - y, depth_value, depth_func, write_depth, write_mask);
+    }
+};
+
+/**
+ * visibility buffer of a tile, used for deferred shading. deferred triangles are first rasterized without invoking
+ * the fragment shader, and for each fragment the buffer stores the last triangle that passed the depth test. each
+ * visible fragment is then shaded once, by interpolating the attributes of its triangle for the fragment's 2x2 block.
+ */
+struct tile_visibility
+{
+    /** maximum number of deferred triangles. this bounds the memory held by the shader instances of a tile. */
+    constexpr static std::size_t max_triangle_count = 256;
+
+    /** number of fragments in a tile. */
+    constexpr static std::size_t fragment_count = swr::impl::rasterizer_block_size * swr::impl::rasterizer_block_size;
+
+    /** id of fragments without a visible triangle. */
+    constexpr static std::uint32_t no_triangle = 0;
+
+    /** the visible triangle for each fragment, as an index into triangles offset by one. allocated on first use. */
+    std::vector<std::uint32_t> ids;
+
+    /** the deferred triangles. their attributes are kept at the tile's origin. the deque keeps the shader instances in place. */
+    std::deque<tile_info> triangles;
+
+    /** number of triangles already rasterized into the buffer. */
+    std::size_t rasterized_count{0};
+
+    /** whether the buffer holds no triangles. */
+    bool empty() const
+    {
+        return triangles.empty();
+    }
+
+    /** whether the buffer reached its triangle capacity. */
+    bool full() const
+    {
+        return triangles.size() >= max_triangle_count;
+    }
+
+    /** whether there are triangles that were not rasterized yet. */
+    bool has_pending_triangles() const
+    {
+        return rasterized_count < triangles.size();
+    }
+
+    /** add a deferred triangle. this creates the shader instance. */
+    tile_info& add(const triangle_block& block)
+    {
+        if(ids.empty())
+        {
+            ids.resize(fragment_count, no_triangle);
+        }
+
+        auto& triangle_ref = triangles.emplace_back(block.states, block.lambdas, block.attributes, block.front_facing, block.mode);
+        triangle_ref.visibility = this;
+        triangle_ref.visibility_id = static_cast<std::uint32_t>(triangles.size());
+        return triangle_ref;
+    }
+
+    /** store an id for the fragments of a 4x4 block at viewport coordinates (x,y). bit 4*q+i of the mask refers to fragment i of the q-th 2x2 block. */
+    void write(unsigned int x, unsigned int y, std::uint32_t mask, std::uint32_t id)
+    {
+        // the tiles are aligned on rasterizer_block_size.
+        x &= swr::impl::rasterizer_block_size - 1;
+        y &= swr::impl::rasterizer_block_size - 1;
+
+        for(unsigned int q = 0; q < 4; ++q)
+        {
+            for(unsigned int i = 0; i < 4; ++i)
+            {
+                if(mask & (1 << (4 * q + i)))
+                {
+                    ids[(y + 2 * (q >> 1) + (i >> 1)) * swr::impl::rasterizer_block_size + x + 2 * (q & 1) + (i & 1)] = id;
+                }
+            }
+        }
+    }
+
+    /** get the id of the fragment at tile coordinates (x,y). */
+    std::uint32_t get(unsigned int x, unsigned int y) const
+    {
+        return ids[y * swr::impl::rasterizer_block_size + x];
+    }
+
+    /** bytes allocated by the buffer. the deque's blocks are approximated by the size of its elements. */
+    std::size_t get_memory_usage() const
+    {
+        std::size_t bytes = ids.capacity() * sizeof(std::uint32_t) + triangles.size() * sizeof(tile_info);
+        for(const auto& it: triangles)
+        {
+            bytes += it.get_memory_usage();
+        }
+        return bytes;
+    }
+
+    /** remove all triangles. */
+    void clear()
+    {
+        std::fill(ids.begin(), ids.end(), no_triangle);
+        triangles.clear();
+        rasterized_count = 0;
+    }
 };
 
-/** a tile waiting to be processed. currently only used for triangles. */
+/** a tile waiting to be processed. */
 struct tile
 {
     /** maximum number of primitives for a tile. */
@@ -100,9 +669,35 @@ struct tile
     /** viewport y coordinate of the upper-left corner. */
     unsigned int y{0};
 
-    /** primitives associated to this tile. */
+    /** triangles associated to this tile. */
     boost::container::static_vector<tile_info, max_primitive_count> primitives;
 
+    /** line segments associated to this tile. */
+    boost::container::static_vector<line_tile_info, max_primitive_count> lines;
+
+    /** point sprites associated to this tile. */
+    boost::container::static_vector<point_tile_info, max_primitive_count> points;
+
+    /** tile-local color and depth buffers for the default framebuffer. */
+    tile_framebuffer buffer;
+
+    /** visibility buffer for deferred triangles. */
+    tile_visibility visibility;
+
+    /** samples-passed counters of the occlusion queries, indexed by query id. only written by the thread processing the tile. */
+    std::vector<std::uint64_t> query_samples;
+
+#ifdef SWR_ENABLE_STATS
+    /** statistics collected while processing the tile. */
+    stats_slot stats;
+
+    /** primitives processed by the tile during the current frame. */
+    std::uint32_t stats_primitives{0};
+
+    /** cycles spent processing the tile during the current frame. */
+    std::uint64_t stats_cycles{0};
+#endif
+
     /** constructors. */
     tile() = default;
     tile(const tile&) = default;
@@ -117,6 +712,33 @@ struct tile
     , y{in_y}
     {
     }
+
+    /** whether the tile has any primitives associated to it. */
+    bool empty() const
+    {
+        return primitives.size() == 0 && lines.size() == 0 && points.size() == 0 && !visibility.has_pending_triangles();
+    }
+
+    /** get the target for fragments written to draw_target. writes to the default framebuffer go to the tile-local buffers. */
+    swr::impl::framebuffer_draw_target* get_draw_target(swr::impl::framebuffer_draw_target* draw_target)
+    {
+        return (draw_target == buffer.get_target()) ? &buffer : draw_target;
+    }
+
+    /** bytes allocated by the tile, not including the tile itself. */
+    std::size_t get_memory_usage() const
+    {
+        std::size_t bytes = visibility.get_memory_usage() + query_samples.capacity() * sizeof(std::uint64_t);
+        for(const auto& it: primitives)
+        {
+            bytes += it.get_memory_usage();
+        }
+        for(const auto& it: lines)
+        {
+            bytes += it.get_memory_usage();
+        }
+        return bytes;
+    }
 };
 
 /** tile cache. */
@@ -159,23 +781,67 @@ struct tile_cache
         }
     }
 
+    /** bind the tiles' local buffers to the default framebuffer. */
+    void bind_buffers(swr::impl::default_framebuffer* framebuffer)
+    {
+        for(auto& it: entries)
+        {
+            it.buffer.bind(framebuffer, it.x, it.y);
+        }
+    }
+
+    /** get the target for fragments at (x,y) written to draw_target. writes to the default framebuffer go to the tile-local buffers. */
+    swr::impl::framebuffer_draw_target* get_draw_target(unsigned int x, unsigned int y, swr::impl::framebuffer_draw_target* draw_target)
+    {
+        unsigned int tile_index = (y >> swr::impl::rasterizer_block_shift) * pitch + (x >> swr::impl::rasterizer_block_shift);
+        assert(tile_index < entries.size());
+
+        return entries[tile_index].get_draw_target(draw_target);
+    }
+
+    /** bytes held by the tile cache, including the tiles' shader instances and visibility buffers. */
+    std::size_t get_memory_usage() const
+    {
+        std::size_t bytes = entries.capacity() * sizeof(tile);
+        for(const auto& it: entries)
+        {
+            bytes += it.get_memory_usage();
+        }
+        return bytes;
+    }
+
     /** mark each tile in the cache as clear. */
     void clear_tiles()
     {
         for(auto& it: entries)
         {
             it.primitives.clear();
+            it.lines.clear();
+            it.points.clear();
         }
     }
 
-    /** allocate a new tile. returns true if the cache was full or the added triangle filled the cache. */
-    bool add_triangle(unsigned int in_x, unsigned int in_y, const tile_info& info)
+    /**
+     * allocate a new tile. returns true if the cache was full or the added triangle filled the cache. for deferred
+     * triangles, returns true if the triangle filled the tile's visibility buffer, which then needs to be shaded.
+     */
+    bool add_triangle(const triangle_block& block)
     {
         // find the tile's coordinates.
-        unsigned int tile_index = (in_y >> swr::impl::rasterizer_block_shift) * pitch + (in_x >> swr::impl::rasterizer_block_shift);
+        unsigned int tile_index = (block.y >> swr::impl::rasterizer_block_shift) * pitch + (block.x >> swr::impl::rasterizer_block_shift);
         assert(tile_index < entries.size());
 
         auto& tile = entries[tile_index];
+        if(block.deferred)
+        {
+            // deferred triangles are kept in the visibility buffer until it is shaded. this creates the shader instance.
+            auto& triangle_ref = tile.visibility.add(block);
+            triangle_ref.draw_target = tile.get_draw_target(block.states->draw_target);
+            triangle_ref.attributes.setup_block_processing();
+
+            return tile.visibility.full();
+        }
+
         if(tile.primitives.size() == tile.primitives.max_size())
         {
             // the cache was full.
@@ -183,15 +849,55 @@ struct tile_cache
             return true;
         }
 
-        // add triangle to the primitives list.
-        // NOTE no std::move here, since the copy creates the shader instance
-        auto& triangle_ref = tile.primitives.emplace_back(info);
+        // add triangle to the primitives list. this creates the shader instance.
+        auto& triangle_ref = tile.primitives.emplace_back(block.states, block.lambdas, block.attributes, block.front_facing, block.mode);
+        triangle_ref.draw_target = tile.get_draw_target(block.states->draw_target);
 
         // set up triangle attributes.
         triangle_ref.attributes.setup_block_processing();
 
         return tile.primitives.size() == tile.primitives.max_size();
     }
+
+    /** add a line segment to its tile. returns true if the cache was full or the added segment filled the cache. */
+    bool add_line(const line_segment& segment)
+    {
+        // find the tile's coordinates.
+        unsigned int tile_index = (segment.y >> swr::impl::rasterizer_block_shift) * pitch + (segment.x >> swr::impl::rasterizer_block_shift);
+        assert(tile_index < entries.size());
+
+        auto& tile = entries[tile_index];
+        if(tile.lines.size() == tile.lines.max_size())
+        {
+            // the cache was full.
+            return true;
+        }
+
+        // add the segment to the line list. this creates the shader instance.
+        tile.lines.emplace_back(segment).draw_target = tile.get_draw_target(segment.states->draw_target);
+
+        return tile.lines.size() == tile.lines.max_size();
+    }
+
+    /** add a point block to its tile. returns true if the cache was full or the added block filled the cache. */
+    bool add_point(const point_block& block)
+    {
+        // find the tile's coordinates.
+        unsigned int tile_index = (block.y >> swr::impl::rasterizer_block_shift) * pitch + (block.x >> swr::impl::rasterizer_block_shift);
+        assert(tile_index < entries.size());
+
+        auto& tile = entries[tile_index];
+        if(tile.points.size() == tile.points.max_size())
+        {
+            // the cache was full.
+            return true;
+        }
+
+        // add the block to the point list.
+        tile.points.emplace_back(block).draw_target = tile.get_draw_target(block.states->draw_target);
+
+        return tile.points.size() == tile.points.max_size();
+    }
 };
 
 } /* namespace rast */
\ No newline at end of file
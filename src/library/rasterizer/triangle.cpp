@@ -25,52 +25,139 @@
 namespace rast
 {
 
-void sweep_rasterizer::process_block(unsigned int block_x, unsigned int block_y, tile_info& in_data)
+/** convert a reduced coverage mask (with the top-left fragment in bit 3) to a fragment mask (with the top-left fragment in bit 0). */
+static std::uint32_t to_fragment_mask(int coverage_mask)
 {
-    boost::container::static_vector<swr::varying, geom::limits::max::varyings> temp_varyings[4];
+    return ((coverage_mask & 0x8) >> 3) | ((coverage_mask & 0x4) >> 1) | ((coverage_mask & 0x2) << 1) | ((coverage_mask & 0x1) << 3);
+}
 
-    const bool front_facing = in_data.front_facing;
+void sweep_rasterizer::shade_fragment_block(unsigned int x, unsigned int y, const tile_info& in_data, const triangle_interpolator& attributes, swr::impl::fragment_output_block& out)
+{
+    SWR_STATS_CLOCK(thread_stats->pipeline.fragment_shading);
 
-    const auto end_x = block_x + swr::impl::rasterizer_block_size;
-    const auto end_y = block_y + swr::impl::rasterizer_block_size;
+    boost::container::static_vector<swr::varying, geom::limits::max::varyings> temp_varyings[4];
 
     float frag_depth[4];
     float one_over_viewport_z[4];
 
-    // process block.
-    for(unsigned int y = block_y; y < end_y; y += 2)
+    attributes.get_data_block(temp_varyings, frag_depth, one_over_viewport_z);
+
+    rast::fragment_info frag_info[4] = {
+      {frag_depth[0], in_data.front_facing, temp_varyings[0]},
+      {frag_depth[1], in_data.front_facing, temp_varyings[1]},
+      {frag_depth[2], in_data.front_facing, temp_varyings[2]},
+      {frag_depth[3], in_data.front_facing, temp_varyings[3]}};
+
+    process_fragment_block(x, y, *in_data.states, in_data.shader, one_over_viewport_z, frag_info, out);
+
+    SWR_STATS_UNCLOCK(thread_stats->pipeline.fragment_shading);
+}
+
+void sweep_rasterizer::rasterize_fragment_block(unsigned int x, unsigned int y, const tile_info& in_data, const triangle_interpolator& attributes, swr::impl::fragment_output_block& out)
+{
+    if(in_data.visibility != nullptr || is_depth_only(*in_data.states))
+    {
+        SWR_STATS_CLOCK(thread_stats->pipeline.depth_test);
+
+        float frag_depth[4];
+        attributes.get_depth_block(frag_depth);
+
+        process_depth_block(x, y, *in_data.states, frag_depth, out);
+
+        SWR_STATS_UNCLOCK(thread_stats->pipeline.depth_test);
+        return;
+    }
+
+    shade_fragment_block(x, y, in_data, attributes, out);
+}
+
+void sweep_rasterizer::merge_visibility_blocks(int x, int y, const tile_info& in_data, swr::impl::fragment_output_block out[4])
+{
+    std::uint32_t write_mask = out[0].write_color | (out[1].write_color << 4) | (out[2].write_color << 8) | (out[3].write_color << 12);
+    if(!write_mask)
+    {
+        return;
+    }
+
+    /*
+     * Depth test.
+     */
+    if(in_data.states->depth_test_enabled)
     {
-        for(unsigned int x = block_x; x < end_x; x += 2)
+        float depth_value[16];
+        for(int q = 0; q < 4; ++q)
         {
-            temp_varyings[0].clear();
-            temp_varyings[1].clear();
-            temp_varyings[2].clear();
-            temp_varyings[3].clear();
+            std::copy(out[q].depth_value, out[q].depth_value + 4, depth_value + 4 * q);
+        }
 
-            in_data.attributes.get_data_block(temp_varyings, frag_depth, one_over_viewport_z);
+        SWR_STATS_CLOCK(thread_stats->pipeline.depth_test);
+        [[maybe_unused]] const std::uint32_t tested_mask = write_mask;
 
-            rast::fragment_info frag_info[4] = {
-              {frag_depth[0], front_facing, temp_varyings[0]},
-              {frag_depth[1], front_facing, temp_varyings[1]},
-              {frag_depth[2], front_facing, temp_varyings[2]},
-              {frag_depth[3], front_facing, temp_varyings[3]}};
-            swr::impl::fragment_output_block out;
+        in_data.draw_target->depth_compare_write_block(x, y, depth_value, in_data.states->depth_func, in_data.states->write_depth, write_mask);
 
-            process_fragment_block(x, y, *in_data.states, in_data.shader, one_over_viewport_z, frag_info, out);
-            in_data.states->draw_target->merge_color_block(0, x, y, out, in_data.states->blending_enabled, in_data.states->blend_src, in_data.states->blend_dst);
+        SWR_STATS_INCREMENT2(thread_stats->frag.discard_depth, get_fragment_count(tested_mask & ~write_mask));
 
-            in_data.attributes.advance_x(2);
+        if(is_counting_overdraw(*in_data.states))
+        {
+            for(int q = 0; q < 4; ++q)
+            {
+                count_overdraw_block(x + 2 * (q & 1), y + 2 * (q >> 1), (tested_mask & ~write_mask) >> (4 * q), &swr::debug::fragment_counters::depth_failed);
+            }
         }
-        in_data.attributes.advance_y(2);
+        SWR_STATS_UNCLOCK(thread_stats->pipeline.depth_test);
     }
+
+    // the fragments are counted when passing the depth test, even if a later triangle overwrites them.
+    count_query_samples(*in_data.states, write_mask);
+
+    // the triangle is visible at the fragments passing the test, until it is overwritten by a later triangle.
+    in_data.visibility->write(x, y, write_mask, in_data.visibility_id);
 }
 
-void sweep_rasterizer::process_block_checked(unsigned int block_x, unsigned int block_y, tile_info& in_data)
+void sweep_rasterizer::process_block(unsigned int block_x, unsigned int block_y, tile_info& in_data)
 {
-    boost::container::static_vector<swr::varying, geom::limits::max::varyings> temp_varyings[4];
+    const auto end_x = block_x + swr::impl::rasterizer_block_size;
+    const auto end_y = block_y + swr::impl::rasterizer_block_size;
+
+    /*
+     * process in 4x4 blocks, each consisting of four 2x2 blocks.
+     */
+    for(unsigned int y = block_y; y < end_y; y += 4)
+    {
+        // attributes for the upper and the lower 2x2 blocks.
+        triangle_interpolator& upper_attributes = in_data.attributes;
+        triangle_interpolator lower_attributes = in_data.attributes;
+        lower_attributes.advance_y(2);
+
+        for(unsigned int x = block_x; x < end_x; x += 4)
+        {
+            swr::impl::fragment_output_block out[4];
 
-    const bool front_facing = in_data.front_facing;
+            rasterize_fragment_block(x, y, in_data, upper_attributes, out[0]);
+            upper_attributes.advance_x(2);
+            rasterize_fragment_block(x + 2, y, in_data, upper_attributes, out[1]);
+            upper_attributes.advance_x(2);
+
+            rasterize_fragment_block(x, y + 2, in_data, lower_attributes, out[2]);
+            lower_attributes.advance_x(2);
+            rasterize_fragment_block(x + 2, y + 2, in_data, lower_attributes, out[3]);
+            lower_attributes.advance_x(2);
+
+            if(in_data.visibility != nullptr)
+            {
+                merge_visibility_blocks(x, y, in_data, out);
+            }
+            else
+            {
+                merge_fragment_blocks(x, y, *in_data.states, in_data.draw_target, out);
+            }
+        }
+        in_data.attributes.advance_y(4);
+    }
+}
 
+void sweep_rasterizer::process_block_checked(unsigned int block_x, unsigned int block_y, tile_info& in_data)
+{
     const auto end_x = block_x + swr::impl::rasterizer_block_size;
     const auto end_y = block_y + swr::impl::rasterizer_block_size;
 
@@ -78,65 +165,73 @@ void sweep_rasterizer::process_block_checked(unsigned int block_x, unsigned int
     geom::barycentric_coordinate_block lambdas = in_data.lambdas;
     lambdas.setup(1, 1);
 
-    float frag_depth_block[4];
-    float one_over_viewport_z_block[4];
+    // shade a 2x2 block, if it is at least partially covered.
+    auto process_quad = [this, &in_data](unsigned int x, unsigned int y, geom::barycentric_coordinate_block& quad_lambdas, triangle_interpolator& attributes, swr::impl::fragment_output_block& out)
+    {
+        out.write_color = to_fragment_mask(geom::reduce_coverage_mask(quad_lambdas.get_coverage_mask()));
+        if(out.write_color)
+        {
+            rasterize_fragment_block(x, y, in_data, attributes, out);
+        }
+
+        quad_lambdas.step_x(2);
+        attributes.advance_x(2);
+    };
 
     /*
-     * process in 2x2 blocks.
+     * process in 4x4 blocks, each consisting of four 2x2 blocks.
      */
-    for(unsigned int y = block_y; y < end_y; y += 2)
+    for(unsigned int y = block_y; y < end_y; y += 4)
     {
         geom::barycentric_coordinate_block::fixed_24_8_array_4 row_start[3];
         lambdas.store_position(row_start[0], row_start[1], row_start[2]);
 
-        for(unsigned int x = block_x; x < end_x; x += 2)
+        // barycentric coordinates and attributes for the upper and the lower 2x2 blocks.
+        geom::barycentric_coordinate_block& upper_lambdas = lambdas;
+        geom::barycentric_coordinate_block lower_lambdas = lambdas;
+        lower_lambdas.step_y(2);
+
+        triangle_interpolator& upper_attributes = in_data.attributes;
+        triangle_interpolator lower_attributes = in_data.attributes;
+        lower_attributes.advance_y(2);
+
+        for(unsigned int x = block_x; x < end_x; x += 4)
         {
-            // get reduced coverage mask.
-            int mask = geom::reduce_coverage_mask(lambdas.get_coverage_mask());
+            swr::impl::fragment_output_block out[4];
+
+            process_quad(x, y, upper_lambdas, upper_attributes, out[0]);
+            process_quad(x + 2, y, upper_lambdas, upper_attributes, out[1]);
+            process_quad(x, y + 2, lower_lambdas, lower_attributes, out[2]);
+            process_quad(x + 2, y + 2, lower_lambdas, lower_attributes, out[3]);
 
-            if(mask)
+            if(in_data.visibility != nullptr)
             {
-                temp_varyings[0].clear();
-                temp_varyings[1].clear();
-                temp_varyings[2].clear();
-                temp_varyings[3].clear();
-
-                // the block is at least partially covered.
-                in_data.attributes.get_data_block(temp_varyings, frag_depth_block, one_over_viewport_z_block);
-
-                rast::fragment_info frag_info[4] = {
-                  {frag_depth_block[0], front_facing, temp_varyings[0]},
-                  {frag_depth_block[1], front_facing, temp_varyings[1]},
-                  {frag_depth_block[2], front_facing, temp_varyings[2]},
-                  {frag_depth_block[3], front_facing, temp_varyings[3]}};
-                swr::impl::fragment_output_block out{(mask & 0x8) != 0, (mask & 0x4) != 0, (mask & 0x2) != 0, (mask & 0x1) != 0};
-
-                process_fragment_block(x, y, *in_data.states, in_data.shader, one_over_viewport_z_block, frag_info, out);
-                in_data.states->draw_target->merge_color_block(0, x, y, out, in_data.states->blending_enabled, in_data.states->blend_src, in_data.states->blend_dst);
+                merge_visibility_blocks(x, y, in_data, out);
+            }
+            else
+            {
+                merge_fragment_blocks(x, y, *in_data.states, in_data.draw_target, out);
             }
-
-            lambdas.step_x(2);
-            in_data.attributes.advance_x(2);
         }
 
         lambdas.load_position(row_start[0], row_start[1], row_start[2]);
-        lambdas.step_y(2);
-        in_data.attributes.advance_y(2);
+        lambdas.step_y(4);
+        in_data.attributes.advance_y(4);
     }
 }
 
 /**
- * Apply depth offset to triangle vertices.
+ * Apply depth offset to triangle vertex coordinates.
  *
  * FIXME We do the setup for floating-point depth buffers here, but we probably want the fixed-point version.
  *
  * Ref: https://registry.khronos.org/OpenGL/specs/gl/glspec43.core.pdf, Section 14.6.5.
  */
-static void setup_polygon_offset(const swr::impl::render_states& states, geom::vertex& v1, geom::vertex& v2, geom::vertex& v3, float inv_area)
+static void setup_polygon_offset(const swr::impl::render_states& states, ml::vec4& v1_coords, ml::vec4& v2_coords, ml::vec4& v3_coords, float inv_area)
 {
     ml::vec3 edges[2] = {
-      (v2.coords - v1.coords).xyz(),
-      (v3.coords - v1.coords).xyz()};    // edges in window coordinates
+      (v2_coords - v1_coords).xyz(),
+      (v3_coords - v1_coords).xyz()};    // edges in window coordinates
     ml::vec2 dz = ml::vec2{
                     edges[1].z * edges[0].y - edges[0].z * edges[1].y,
                     -edges[1].z * edges[0].x + edges[0].z * edges[1].x}
@@ -174,10 +269,10 @@ static void setup_polygon_offset(const swr::impl::render_states& states, geom::v
     // get the maximum exponent in the range of the z values spanned by the primitive
 #ifdef __GNUC__
     float_integer r{
-      std::max({fabsf(v1.coords.z), fabsf(v2.coords.z), fabsf(v3.coords.z)})};
+      std::max({fabsf(v1_coords.z), fabsf(v2_coords.z), fabsf(v3_coords.z)})};
 #else
     float_integer r{
-      std::max({std::fabsf(v1.coords.z), std::fabsf(v2.coords.z), std::fabsf(v3.coords.z)})};
+      std::max({std::fabsf(v1_coords.z), std::fabsf(v2_coords.z), std::fabsf(v3_coords.z)})};
 #endif
     r.i &= 0xff << 23;
 
@@ -189,17 +284,40 @@ static void setup_polygon_offset(const swr::impl::render_states& states, geom::v
 
     float o = m * states.polygon_offset_factor + r.f * states.polygon_offset_units;    // Eq. (14.13)
 
-    v1.coords.z = boost::algorithm::clamp(v1.coords.z + o, 0.0f, 1.0f);
-    v2.coords.z = boost::algorithm::clamp(v2.coords.z + o, 0.0f, 1.0f);
-    v3.coords.z = boost::algorithm::clamp(v3.coords.z + o, 0.0f, 1.0f);
+    v1_coords.z = boost::algorithm::clamp(v1_coords.z + o, 0.0f, 1.0f);
+    v2_coords.z = boost::algorithm::clamp(v2_coords.z + o, 0.0f, 1.0f);
+    v3_coords.z = boost::algorithm::clamp(v3_coords.z + o, 0.0f, 1.0f);
 }
 
-void sweep_rasterizer::draw_filled_triangle(const swr::impl::render_states& states, bool is_front_facing, geom::vertex& v1, geom::vertex& v2, geom::vertex& v3)
+void sweep_rasterizer::setup_triangle(std::size_t index, triangle_bin& bin) const
 {
+    const auto& states = *state_list[triangles.state_indices[index]];
+    const bool is_front_facing = triangles.front_facing[index] != 0;
+
+    // in depth-only mode, a triangle without depth test has no effect.
+    const bool depth_only = is_depth_only(states);
+    if(depth_only && !states.depth_test_enabled)
+    {
+        return;
+    }
+
+    // deferred triangles are rasterized into the visibility buffer and shaded later.
+    const bool deferred = is_deferred_triangle(index);
+
+    // the vertices are only needed for their varyings.
+    const geom::vertex& v1 = *triangles.vertices[index * 3];
+    const geom::vertex& v2 = *triangles.vertices[index * 3 + 1];
+    const geom::vertex& v3 = *triangles.vertices[index * 3 + 2];
+
+    // copy the coordinates, since they may be modified by the polygon offset.
+    ml::vec4 v1_coords = triangles.coords[index * 3];
+    ml::vec4 v2_coords = triangles.coords[index * 3 + 1];
+    ml::vec4 v3_coords = triangles.coords[index * 3 + 2];
+
     // calculate the (signed) parallelogram area spanned by the difference vectors.
-    auto v1_xy = v1.coords.xy();
-    auto v2_xy = v2.coords.xy();
-    auto v3_xy = v3.coords.xy();
+    auto v1_xy = v1_coords.xy();
+    auto v2_xy = v2_coords.xy();
+    auto v3_xy = v3_coords.xy();
 
     auto area = (v2_xy - v1_xy).area(v3_xy - v1_xy);
 
@@ -221,12 +339,16 @@ void sweep_rasterizer::draw_filled_triangle(const swr::impl::render_states& stat
      * (instead of checking that all of them have the same sign).
      */
     const geom::vertex *v1_cw{nullptr}, *v2_cw{nullptr};
+    const ml::vec4 *v1_cw_coords{nullptr}, *v2_cw_coords{nullptr};
 
     if(area > 0)
     {
         // keep vertex order.
         v1_cw = &v1;
         v2_cw = &v2;
+
+        v1_cw_coords = &v1_coords;
+        v2_cw_coords = &v2_coords;
     }
     else /* area < 0, since we already checked for area==0 */
     {
@@ -236,6 +358,9 @@ void sweep_rasterizer::draw_filled_triangle(const swr::impl::render_states& stat
 
         v1_cw = &v2;
         v2_cw = &v1;
+
+        v1_cw_coords = &v2_coords;
+        v2_cw_coords = &v1_coords;
     }
 
     float inv_area = 1.0f / area;
@@ -309,28 +434,20 @@ void sweep_rasterizer::draw_filled_triangle(const swr::impl::render_states& stat
      */
     if(states.polygon_offset_fill_enabled)
     {
-        /*
-         * FIXME This potentially gets applied multiple times per vertex ?!
-         *
-         *       A solution would be make a copy of the (z-)coordinate(s) somewhere in the pipeline.
-         *
-         *       Check: The vertices are only passed through to the interpolator and then written,
-         *              which means the coordinates could be copied.
-         */
-
-        setup_polygon_offset(states, v1, v2, v3, inv_area);
+        // the offset is applied to the triangle's copy of the coordinates.
+        setup_polygon_offset(states, v1_coords, v2_coords, v3_coords, inv_area);
     }
 
     /*
      * Loop through blocks of size (rasterizer_block_size,rasterizer_block_size), starting and ending on an aligned value.
      */
 
-    auto v1x = ml::truncate_unchecked(v1.coords.x);
-    auto v1y = ml::truncate_unchecked(v1.coords.y);
-    auto v2x = ml::truncate_unchecked(v2.coords.x);
-    auto v2y = ml::truncate_unchecked(v2.coords.y);
-    auto v3x = ml::truncate_unchecked(v3.coords.x);
-    auto v3y = ml::truncate_unchecked(v3.coords.y);
+    auto v1x = ml::truncate_unchecked(v1_coords.x);
+    auto v1y = ml::truncate_unchecked(v1_coords.y);
+    auto v2x = ml::truncate_unchecked(v2_coords.x);
+    auto v2y = ml::truncate_unchecked(v2_coords.y);
+    auto v3x = ml::truncate_unchecked(v3_coords.x);
+    auto v3y = ml::truncate_unchecked(v3_coords.y);
 
     // take scissor box into account.
     int start_x{0}, start_y{0}, end_x{0}, end_y{0};
@@ -378,13 +495,21 @@ void sweep_rasterizer::draw_filled_triangle(const swr::impl::render_states& stat
 
     /*
      * Set up an interpolator for the triangle attributes, i.e., depth value, viewport z coordinate and shader varyings.
+     * the varyings are not interpolated in depth-only mode.
      */
+    const boost::container::static_vector<ml::vec4, geom::limits::max::varyings> no_varyings;
+    const boost::container::static_vector<swr::interpolation_qualifier, geom::limits::max::varyings> no_iqs;
+
     const ml::vec2 screen_coords{static_cast<float>(start_x) + 0.5f, static_cast<float>(start_y) + 0.5f};
     rast::triangle_interpolator attributes{
       screen_coords,
-      v1_cw->coords, v2_cw->coords, v3.coords,
-      v1_cw->varyings, v2_cw->varyings, v3.varyings, v1.varyings,
-      states.shader_info->iqs, inv_area};
+      *v1_cw_coords, *v2_cw_coords, v3_coords,
+      depth_only ? no_varyings : v1_cw->varyings,
+      depth_only ? no_varyings : v2_cw->varyings,
+      depth_only ? no_varyings : v3.varyings,
+      depth_only ? no_varyings : v1.varyings,
+      depth_only ? no_iqs : states.shader_info->iqs,
+      inv_area};
 
     for(auto y = start_y; y < end_y; y += swr::impl::rasterizer_block_size)
     {
@@ -419,12 +544,8 @@ void sweep_rasterizer::draw_filled_triangle(const swr::impl::render_states& stat
             // a mask of 0xf corresponds to block processing, otherwise we need to do further checks.
             auto mode = static_cast<tile_info::rasterization_mode>(static_cast<int>(mask != 0xf));
 
-            // add the triangle to the tile cache.
-            if(tiles.add_triangle(x, y, {&states, lambdas_box, attributes_row, is_front_facing, mode}))
-            {
-                // the cache is full. process all tiles.
-                process_tile_cache();
-            }
+            // add the block to the bin.
+            bin.emplace_back(x, y, index, &states, lambdas_box, attributes_row, is_front_facing, mode, deferred);
 
             lambdas_box.step_x(swr::impl::rasterizer_block_size);
             attributes_row.advance_x(swr::impl::rasterizer_block_size);
@@ -439,4 +560,85 @@ void sweep_rasterizer::draw_filled_triangle(const swr::impl::render_states& stat
     }
 }
 
+void sweep_rasterizer::draw_filled_triangle(std::size_t index)
+{
+    auto& bin = triangle_bins[0];
+    bin.clear();
+
+    {
+        SWR_PERF_SCOPE(setup);
+        SWR_STATS_CLOCK(setup_stats[0].pipeline.setup);
+        setup_triangle(index, bin);
+        SWR_STATS_UNCLOCK(setup_stats[0].pipeline.setup);
+    }
+
+    add_to_tile_cache(bin);
+}
+
+/*
+ * deferred shading.
+ */
+
+void sweep_rasterizer::shade_visibility_buffer(tile& in_tile)
+{
+    auto& visibility = in_tile.visibility;
+    if(visibility.empty())
+    {
+        return;
+    }
+
+    SWR_TRACE_SCOPE("shade tile", &in_tile - tiles.entries.data(), visibility.triangles.size());
+    SWR_PERF_SCOPE(visibility_shading);
+
+#ifdef SWR_ENABLE_STATS
+    thread_stats = &in_tile.stats;
+#endif
+    SWR_STATS_CLOCK(in_tile.stats_cycles);
+
+    /*
+     * shade each 2x2 block once per visible triangle. the whole block is shaded, so that the derivatives
+     * match the ones of immediate shading. only the fragments the triangle is visible at are written.
+     */
+    for(unsigned int y = 0; y < swr::impl::rasterizer_block_size; y += 2)
+    {
+        for(unsigned int x = 0; x < swr::impl::rasterizer_block_size; x += 2)
+        {
+            const std::uint32_t ids[4] = {visibility.get(x, y), visibility.get(x + 1, y), visibility.get(x, y + 1), visibility.get(x + 1, y + 1)};
+
+            std::uint32_t remaining = (ids[0] != tile_visibility::no_triangle)
+                                      | ((ids[1] != tile_visibility::no_triangle) << 1)
+                                      | ((ids[2] != tile_visibility::no_triangle) << 2)
+                                      | ((ids[3] != tile_visibility::no_triangle) << 3);
+            while(remaining)
+            {
+                // collect the fragments of the first remaining triangle.
+                const std::uint32_t id = ids[(remaining & 1) ? 0 : ((remaining & 2) ? 1 : ((remaining & 4) ? 2 : 3))];
+                const std::uint32_t mask = (ids[0] == id) | ((ids[1] == id) << 1) | ((ids[2] == id) << 2) | ((ids[3] == id) << 3);
+                remaining &= ~mask;
+
+                const tile_info& triangle = visibility.triangles[id - 1];
+
+                // the attributes are stored at the tile's origin.
+                triangle_interpolator attributes = triangle.attributes;
+                attributes.advance_y(y);
+                attributes.advance_x(x);
+
+                swr::impl::fragment_output_block out{mask};
+                shade_fragment_block(in_tile.x + x, in_tile.y + y, triangle, attributes, out);
+
+                if(out.write_color)
+                {
+                    SWR_STATS_CLOCK(in_tile.stats.pipeline.merge);
+                    triangle.draw_target->merge_color_block(0, in_tile.x + x, in_tile.y + y, out, false, triangle.states->blend_kernels, triangle.states->color_mask);
+                    SWR_STATS_UNCLOCK(in_tile.stats.pipeline.merge);
+                }
+            }
+        }
+    }
+
+    visibility.clear();
+
+    SWR_STATS_UNCLOCK(in_tile.stats_cycles);
+}
+
 } /* namespace rast */
\ No newline at end of file
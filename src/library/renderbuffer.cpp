@@ -8,6 +8,9 @@
  * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
  */
 
+/* C++ headers. */
+#include <cmath>
+
 /* user headers. */
 #include "swr_internal.h"
 
@@ -19,7 +22,6 @@ namespace impl
 
 /*
  * helper lambdas.
- * FIXME these are duplicated in fragment.cpp
  */
 
 static auto to_uint32_mask = [](bool b) -> std::uint32_t
@@ -27,19 +29,507 @@ static auto to_uint32_mask = [](bool b) -> std::uint32_t
     return ~(static_cast<std::uint32_t>(b) - 1);
 };
 
-static auto set_uniform_mask = [](bool mask[4], bool v)
+/*
+ * depth comparisons.
+ */
+
+/** integer type used to store depth32 values. */
+using depth_storage_type = std::decay_t<decltype(ml::unwrap(std::declval<ml::fixed_32_t>()))>;
+
+/** scalar depth comparison, specialized for a comparison function. */
+template<comparison_func F, typename T>
+static bool depth_compare(T new_depth_value, T old_depth_value)
+{
+    if constexpr(F == comparison_func::pass)
+    {
+        return true;
+    }
+    else if constexpr(F == comparison_func::fail)
+    {
+        return false;
+    }
+    else if constexpr(F == comparison_func::equal)
+    {
+        return new_depth_value == old_depth_value;
+    }
+    else if constexpr(F == comparison_func::not_equal)
+    {
+        return new_depth_value != old_depth_value;
+    }
+    else if constexpr(F == comparison_func::less)
+    {
+        return new_depth_value < old_depth_value;
+    }
+    else if constexpr(F == comparison_func::less_equal)
+    {
+        return new_depth_value <= old_depth_value;
+    }
+    else if constexpr(F == comparison_func::greater)
+    {
+        return new_depth_value > old_depth_value;
+    }
+    else
+    {
+        static_assert(F == comparison_func::greater_equal, "unknown comparison function");
+        return new_depth_value >= old_depth_value;
+    }
+}
+
+#ifdef SWR_USE_SIMD
+
+/**
+ * SSE depth comparison of four values, specialized for a comparison function. the values are expected to be
+ * biased by the depth format's compare_bias, so that they can be compared as signed integers. returns a lane mask.
+ */
+template<comparison_func F>
+static __m128i depth_compare(__m128i new_depth_value, __m128i old_depth_value)
+{
+    if constexpr(F == comparison_func::pass)
+    {
+        return _mm_set1_epi32(-1);
+    }
+    else if constexpr(F == comparison_func::fail)
+    {
+        return _mm_setzero_si128();
+    }
+    else if constexpr(F == comparison_func::equal)
+    {
+        return _mm_cmpeq_epi32(new_depth_value, old_depth_value);
+    }
+    else if constexpr(F == comparison_func::not_equal)
+    {
+        return _mm_andnot_si128(_mm_cmpeq_epi32(new_depth_value, old_depth_value), _mm_set1_epi32(-1));
+    }
+    else if constexpr(F == comparison_func::less)
+    {
+        return _mm_cmplt_epi32(new_depth_value, old_depth_value);
+    }
+    else if constexpr(F == comparison_func::less_equal)
+    {
+        return _mm_andnot_si128(_mm_cmpgt_epi32(new_depth_value, old_depth_value), _mm_set1_epi32(-1));
+    }
+    else if constexpr(F == comparison_func::greater)
+    {
+        return _mm_cmpgt_epi32(new_depth_value, old_depth_value);
+    }
+    else
+    {
+        static_assert(F == comparison_func::greater_equal, "unknown comparison function");
+        return _mm_andnot_si128(_mm_cmplt_epi32(new_depth_value, old_depth_value), _mm_set1_epi32(-1));
+    }
+}
+
+/** load the values of a quad into 32-bit lanes. 16-bit values are zero-extended. */
+template<typename T>
+static __m128i load_depth_quad(const T* upper_row, const T* lower_row)
+{
+    if constexpr(sizeof(T) == sizeof(std::uint16_t))
+    {
+        std::uint32_t upper, lower;
+        std::memcpy(&upper, upper_row, sizeof(upper));
+        std::memcpy(&lower, lower_row, sizeof(lower));
+        return _mm_cvtepu16_epi32(_mm_unpacklo_epi32(_mm_cvtsi32_si128(upper), _mm_cvtsi32_si128(lower)));
+    }
+    else
+    {
+        static_assert(sizeof(T) == sizeof(std::uint32_t), "unsupported depth storage type");
+        return _mm_unpacklo_epi64(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(upper_row)),
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(lower_row)));
+    }
+}
+
+/** store 32-bit lanes to the values of a quad. 16-bit values are narrowed, so the lanes need to be in the value range. */
+template<typename T>
+static void store_depth_quad(T* upper_row, T* lower_row, __m128i values)
+{
+    if constexpr(sizeof(T) == sizeof(std::uint16_t))
+    {
+        const __m128i packed = _mm_packus_epi32(values, values);
+        const std::uint32_t upper = _mm_cvtsi128_si32(packed);
+        const std::uint32_t lower = _mm_cvtsi128_si32(_mm_srli_si128(packed, 4));
+        std::memcpy(upper_row, &upper, sizeof(upper));
+        std::memcpy(lower_row, &lower, sizeof(lower));
+    }
+    else
+    {
+        static_assert(sizeof(T) == sizeof(std::uint32_t), "unsupported depth storage type");
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(upper_row), values);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(lower_row), _mm_unpackhi_epi64(values, values));
+    }
+}
+
+#endif /* SWR_USE_SIMD */
+
+/*
+ * depth formats. each format defines the storage type of its values and the conversion of depth values in [0,1].
+ */
+
+template<depth_format D>
+struct depth_format_traits;
+
+/** unsigned normalized depth values with the given number of bits. */
+template<typename T, int Bits>
+struct unorm_depth_format_traits
+{
+    /** storage type of a depth value. */
+    using storage_type = T;
+
+    /** the values are non-negative and fit into a signed 32-bit integer, so they can be compared without a bias. */
+    static constexpr std::uint32_t compare_bias = 0;
+
+    /** scale mapping [0,1] to the storage range. */
+    static constexpr float scale = static_cast<float>((std::uint32_t{1} << Bits) - 1);
+
+    /** convert a depth value in [0,1]. rounds to nearest, like the SSE conversion. */
+    static storage_type encode(float z)
+    {
+        return static_cast<storage_type>(std::lrint(z * scale));
+    }
+
+#ifdef SWR_USE_SIMD
+    /** convert four depth values in [0,1] into 32-bit lanes. */
+    static __m128i encode_quad(const float z[4])
+    {
+        return _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(z), _mm_set1_ps(scale)));
+    }
+#endif /* SWR_USE_SIMD */
+};
+
+template<>
+struct depth_format_traits<depth_format::depth16> : unorm_depth_format_traits<std::uint16_t, 16>
+{
+};
+
+template<>
+struct depth_format_traits<depth_format::depth24> : unorm_depth_format_traits<std::uint32_t, 24>
 {
-    mask[0] = mask[1] = mask[2] = mask[3] = v;
 };
 
-static auto apply_mask = [](bool mask[4], const auto additional_mask[4])
+template<>
+struct depth_format_traits<depth_format::depth32>
 {
-    mask[0] &= static_cast<bool>(additional_mask[0]);
-    mask[1] &= static_cast<bool>(additional_mask[1]);
-    mask[2] &= static_cast<bool>(additional_mask[2]);
-    mask[3] &= static_cast<bool>(additional_mask[3]);
+    /** storage type of a depth value. */
+    using storage_type = depth_storage_type;
+
+    /** bias applied to the depth values before comparing them as signed integers. */
+    static constexpr std::uint32_t compare_bias = std::is_signed_v<storage_type> ? 0 : 0x80000000;
+
+    /** convert a depth value in [0,1]. */
+    static storage_type encode(float z)
+    {
+        return ml::unwrap(ml::fixed_32_t{z});
+    }
+
+#ifdef SWR_USE_SIMD
+    /** convert four depth values in [0,1] into 32-bit lanes. */
+    static __m128i encode_quad(const float z[4])
+    {
+        return _mm_set_epi32(encode(z[3]), encode(z[2]), encode(z[1]), encode(z[0]));
+    }
+#endif /* SWR_USE_SIMD */
 };
 
+/** convert a depth value in [0,1] to a clear value for a depth buffer. 16-bit values are replicated to fill 32 bits. */
+static std::uint32_t get_depth_clear_value(depth_format format, float z)
+{
+    switch(format)
+    {
+    case depth_format::depth16:
+    {
+        const std::uint32_t value = depth_format_traits<depth_format::depth16>::encode(z);
+        return (value << 16) | value;
+    }
+    case depth_format::depth24:
+        return depth_format_traits<depth_format::depth24>::encode(z);
+    case depth_format::depth32:
+        return static_cast<std::uint32_t>(depth_format_traits<depth_format::depth32>::encode(z));
+    }
+
+    return 0;
+}
+
+/*
+ * depth test kernels.
+ */
+
+/**
+ * depth test for a 4x4 block, specialized for a depth format and a comparison function. quad_rows[q][0] and quad_rows[q][1]
+ * are the offsets of the upper and the lower row of quad q inside the depth buffer, measured in values.
+ * see framebuffer_draw_target::depth_compare_write_block.
+ */
+template<depth_format D, comparison_func F>
+static void depth_compare_write_quads(void* data_ptr, const std::size_t quad_rows[4][2], const float depth_value[16], bool write_depth, std::uint32_t& write_mask)
+{
+    using traits = depth_format_traits<D>;
+    auto* depth_ptr = static_cast<typename traits::storage_type*>(data_ptr);
+
+    std::uint32_t depth_mask = 0;
+
+    for(std::uint32_t q = 0; q < 4; ++q)
+    {
+        const std::uint32_t quad_mask = (write_mask >> (4 * q)) & 0xf;
+        if(!quad_mask)
+        {
+            continue;
+        }
+
+#ifdef SWR_USE_SIMD
+        const __m128i bias = _mm_set1_epi32(traits::compare_bias);
+        const __m128i lane_bits = _mm_set_epi32(8, 4, 2, 1);
+        const __m128i lane_mask = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(quad_mask), lane_bits), lane_bits);
+
+        __m128i new_depth = traits::encode_quad(&depth_value[4 * q]);
+        __m128i old_depth = load_depth_quad(depth_ptr + quad_rows[q][0], depth_ptr + quad_rows[q][1]);
+
+        __m128i pass_mask = _mm_and_si128(depth_compare<F>(_mm_xor_si128(new_depth, bias), _mm_xor_si128(old_depth, bias)), lane_mask);
+        depth_mask |= static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(pass_mask))) << (4 * q);
+
+        if(write_depth)
+        {
+            store_depth_quad(depth_ptr + quad_rows[q][0], depth_ptr + quad_rows[q][1], _mm_blendv_epi8(old_depth, new_depth, pass_mask));
+        }
+#else  /* SWR_USE_SIMD */
+        for(std::uint32_t i = 0; i < 4; ++i)
+        {
+            auto* depth_buffer_ptr = depth_ptr + quad_rows[q][i >> 1] + (i & 1);
+            auto new_depth_value = traits::encode(depth_value[4 * q + i]);
+
+            if((quad_mask & (1 << i)) && depth_compare<F>(new_depth_value, *depth_buffer_ptr))
+            {
+                depth_mask |= 1 << (4 * q + i);
+
+                if(write_depth)
+                {
+                    *depth_buffer_ptr = new_depth_value;
+                }
+            }
+        }
+#endif /* SWR_USE_SIMD */
+    }
+
+    write_mask = depth_mask;
+}
+
+/** select the depth test kernel for a comparison function. */
+template<depth_format D>
+static void depth_compare_write_quads(comparison_func depth_func, void* data_ptr, const std::size_t quad_rows[4][2], const float depth_value[16], bool write_depth, std::uint32_t& write_mask)
+{
+    switch(depth_func)
+    {
+    case comparison_func::pass:
+        depth_compare_write_quads<D, comparison_func::pass>(data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    case comparison_func::fail:
+        write_mask = 0;
+        break;
+    case comparison_func::equal:
+        depth_compare_write_quads<D, comparison_func::equal>(data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    case comparison_func::not_equal:
+        depth_compare_write_quads<D, comparison_func::not_equal>(data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    case comparison_func::less:
+        depth_compare_write_quads<D, comparison_func::less>(data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    case comparison_func::less_equal:
+        depth_compare_write_quads<D, comparison_func::less_equal>(data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    case comparison_func::greater:
+        depth_compare_write_quads<D, comparison_func::greater>(data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    case comparison_func::greater_equal:
+        depth_compare_write_quads<D, comparison_func::greater_equal>(data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    }
+}
+
+/** select the depth test kernel for the format of a depth buffer and a comparison function. */
+static void depth_compare_write_quads(attachment_depth& depth_buffer, comparison_func depth_func, const std::size_t quad_rows[4][2], const float depth_value[16], bool write_depth, std::uint32_t& write_mask)
+{
+    switch(depth_buffer.format)
+    {
+    case depth_format::depth16:
+        depth_compare_write_quads<depth_format::depth16>(depth_func, depth_buffer.info.data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    case depth_format::depth24:
+        depth_compare_write_quads<depth_format::depth24>(depth_func, depth_buffer.info.data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    case depth_format::depth32:
+        depth_compare_write_quads<depth_format::depth32>(depth_func, depth_buffer.info.data_ptr, quad_rows, depth_value, write_depth, write_mask);
+        break;
+    }
+}
+
+/** depth test for a single fragment, specialized for a depth format. returns whether the test passed. */
+template<depth_format D>
+static bool depth_compare_write(comparison_func depth_func, typename depth_format_traits<D>::storage_type* depth_buffer_ptr, float depth_value, bool write_depth)
+{
+    using storage_type = typename depth_format_traits<D>::storage_type;
+    const storage_type new_depth_value = depth_format_traits<D>::encode(depth_value);
+
+    bool pass{false};
+    switch(depth_func)
+    {
+    case comparison_func::pass:
+        pass = true;
+        break;
+    case comparison_func::fail:
+        pass = false;
+        break;
+    case comparison_func::equal:
+        pass = depth_compare<comparison_func::equal>(new_depth_value, *depth_buffer_ptr);
+        break;
+    case comparison_func::not_equal:
+        pass = depth_compare<comparison_func::not_equal>(new_depth_value, *depth_buffer_ptr);
+        break;
+    case comparison_func::less:
+        pass = depth_compare<comparison_func::less>(new_depth_value, *depth_buffer_ptr);
+        break;
+    case comparison_func::less_equal:
+        pass = depth_compare<comparison_func::less_equal>(new_depth_value, *depth_buffer_ptr);
+        break;
+    case comparison_func::greater:
+        pass = depth_compare<comparison_func::greater>(new_depth_value, *depth_buffer_ptr);
+        break;
+    case comparison_func::greater_equal:
+        pass = depth_compare<comparison_func::greater_equal>(new_depth_value, *depth_buffer_ptr);
+        break;
+    }
+
+    // write depth value.
+    uint32_t depth_write_mask = to_uint32_mask(write_depth && pass);
+    *depth_buffer_ptr = static_cast<storage_type>((*depth_buffer_ptr & ~depth_write_mask) | (new_depth_value & depth_write_mask));
+
+    return pass;
+}
+
+/** depth test for the value at the given offset of a depth buffer, measured in values. returns whether the test passed. */
+static bool depth_compare_write(attachment_depth& depth_buffer, std::size_t offset, comparison_func depth_func, float depth_value, bool write_depth)
+{
+    switch(depth_buffer.format)
+    {
+    case depth_format::depth16:
+        return depth_compare_write<depth_format::depth16>(depth_func, depth_buffer.get_data_ptr<std::uint16_t>() + offset, depth_value, write_depth);
+    case depth_format::depth24:
+        return depth_compare_write<depth_format::depth24>(depth_func, depth_buffer.get_data_ptr<std::uint32_t>() + offset, depth_value, write_depth);
+    case depth_format::depth32:
+        return depth_compare_write<depth_format::depth32>(depth_func, depth_buffer.get_data_ptr<depth_storage_type>() + offset, depth_value, write_depth);
+    }
+
+    return false;
+}
+
+/*
+ * color write masks.
+ */
+
+/** get the bits of a pixel written under a color mask. */
+static std::uint32_t get_pixel_write_mask(const pixel_format_converter& converter, std::uint32_t color_mask)
+{
+    return ((color_mask & output_merger::color_mask::red) ? converter.red_mask : 0)
+           | ((color_mask & output_merger::color_mask::green) ? converter.green_mask : 0)
+           | ((color_mask & output_merger::color_mask::blue) ? converter.blue_mask : 0)
+           | ((color_mask & output_merger::color_mask::alpha) ? converter.alpha_mask : 0);
+}
+
+/** replace the channels of a color that are not written under a color mask by the ones of the destination. */
+static ml::vec4 apply_color_mask(const ml::vec4& color, const ml::vec4& dest, std::uint32_t color_mask)
+{
+    return {
+      (color_mask & output_merger::color_mask::red) ? color.x : dest.x,
+      (color_mask & output_merger::color_mask::green) ? color.y : dest.y,
+      (color_mask & output_merger::color_mask::blue) ? color.z : dest.z,
+      (color_mask & output_merger::color_mask::alpha) ? color.w : dest.w};
+}
+
+/*
+ * color conversion kernels.
+ */
+
+#ifdef SWR_USE_SIMD
+
+/** byte shuffle converting packed 8-bit red, green, blue and alpha values to the byte order of a named pixel format. */
+template<pixel_format F>
+static __m128i pixel_shuffle_mask()
+{
+    if constexpr(F == pixel_format::argb8888)
+    {
+        return _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    }
+    else if constexpr(F == pixel_format::bgra8888)
+    {
+        return _mm_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    }
+    else
+    {
+        static_assert(F == pixel_format::rgba8888, "unsupported pixel format");
+        return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    }
+}
+
+/** clamp four colors to [0,1] and convert them to pixels of a named pixel format. produces the same values as pixel_format_converter::to_pixel. */
+template<pixel_format F>
+static __m128i to_pixels(const ml::vec4 color[4])
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set_ps1(1.0f);
+    const __m128 max_per_channel = _mm_set_ps1(255.0f);
+
+    auto to_channels = [&zero, &one, &max_per_channel](const ml::vec4& c) -> __m128i
+    {
+        __m128 v = _mm_loadu_ps(reinterpret_cast<const float*>(&c.data));
+        return _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(v, zero), one), max_per_channel));
+    };
+
+    // pack the channels into bytes, ordered red, green, blue, alpha for each pixel.
+    __m128i rgba = _mm_packus_epi16(
+      _mm_packs_epi32(to_channels(color[0]), to_channels(color[1])),
+      _mm_packs_epi32(to_channels(color[2]), to_channels(color[3])));
+
+    return _mm_shuffle_epi8(rgba, pixel_shuffle_mask<F>());
+}
+
+/**
+ * convert, blend and store a 2x2 block of colors into a color buffer of a named pixel format. the two rows of the block are read and written at once.
+ * only the bits in pixel_mask are written. since the channels of named pixel formats are whole bytes, the mask can be applied by a byte blend.
+ */
+template<pixel_format F>
+static void merge_color_block(attachment_color_buffer& color_buffer, int x, int y, const fragment_output_block& frag, output_merger::pixel_blend_func blend_kernel, std::uint32_t pixel_mask)
+{
+    std::uint32_t* row_ptrs[2] = {
+      color_buffer.info.data_ptr + y * color_buffer.info.width + x,
+      color_buffer.info.data_ptr + (y + 1) * color_buffer.info.width + x};
+
+    __m128i write_color = to_pixels<F>(frag.color);
+    __m128i color_buffer_values = _mm_unpacklo_epi64(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row_ptrs[0])),
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row_ptrs[1])));
+
+    if(blend_kernel)
+    {
+        DECLARE_ALIGNED_ARRAY4(uint32_t, src);
+        DECLARE_ALIGNED_ARRAY4(uint32_t, dest);
+        _mm_store_si128(reinterpret_cast<__m128i*>(src), write_color);
+        _mm_store_si128(reinterpret_cast<__m128i*>(dest), color_buffer_values);
+
+        blend_kernel(src, dest, src);
+        write_color = _mm_load_si128(reinterpret_cast<const __m128i*>(src));
+    }
+
+    // write color.
+    const __m128i lane_bits = _mm_set_epi32(8, 4, 2, 1);
+    const __m128i write_mask = _mm_and_si128(
+      _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(frag.write_color), lane_bits), lane_bits),
+      _mm_set1_epi32(static_cast<int>(pixel_mask)));
+    __m128i result = _mm_blendv_epi8(color_buffer_values, write_color, write_mask);
+
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(row_ptrs[0]), result);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(row_ptrs[1]), _mm_unpackhi_epi64(result, result));
+}
+
+#endif /* SWR_USE_SIMD */
+
 /*
  * attachment_texture.
  */
@@ -115,16 +605,174 @@ static void scissor_clear_buffer_morton(T clear_value, attachment_info<T>& info,
 
 #endif
 
+/*
+ * lazy clears.
+ */
+
+/**
+ * fill a rectangle of 16-bit or 32-bit values. uses non-temporal stores, since the values are not read again soon.
+ * the pitch is given in elements. 16-bit values need to be replicated to fill 32 bits.
+ */
+template<typename T>
+static void fill_rect_non_temporal(T* ptr, int pitch, int width, int height, std::uint32_t value)
+{
+    const T element = static_cast<T>(value);
+
+#ifdef SWR_USE_SIMD
+    const __m128i values = _mm_set1_epi32(value);
+    constexpr int elements_per_store = sizeof(__m128i) / sizeof(T);
+#endif /* SWR_USE_SIMD */
+
+    for(int y = 0; y < height; ++y)
+    {
+        T* row_ptr = ptr + y * pitch;
+        int x = 0;
+
+#ifdef SWR_USE_SIMD
+        // non-temporal stores need 16-byte alignment.
+        for(; x < width && (reinterpret_cast<std::uintptr_t>(row_ptr + x) & 15) != 0; ++x)
+        {
+            row_ptr[x] = element;
+        }
+
+        for(; x + elements_per_store <= width; x += elements_per_store)
+        {
+            _mm_stream_si128(reinterpret_cast<__m128i*>(row_ptr + x), values);
+        }
+#endif /* SWR_USE_SIMD */
+
+        for(; x < width; ++x)
+        {
+            row_ptr[x] = element;
+        }
+    }
+
+#ifdef SWR_USE_SIMD
+    _mm_sfence();
+#endif /* SWR_USE_SIMD */
+}
+
+/** write a pending clear value to a tile of a buffer of the given dimensions, stored in row-major order, and reset the tile's flag. */
+template<typename T>
+static void materialize_tile_clear(T* data_ptr, int buffer_width, int buffer_height, int tiles_x, std::vector<std::uint8_t>& clear_pending, std::size_t tile_index, std::uint32_t value)
+{
+    const int x = static_cast<int>(tile_index % tiles_x) << rasterizer_block_shift;
+    const int y = static_cast<int>(tile_index / tiles_x) << rasterizer_block_shift;
+    const int width = std::min(static_cast<int>(rasterizer_block_size), buffer_width - x);
+    const int height = std::min(static_cast<int>(rasterizer_block_size), buffer_height - y);
+
+    fill_rect_non_temporal(data_ptr + y * buffer_width + x, buffer_width, width, height, value);
+    clear_pending[tile_index] = 0;
+}
+
+/** write a pending clear value to a tile of a color buffer and reset the tile's flag. */
+static void materialize_tile_clear(attachment_color_buffer& color_buffer, int tiles_x, std::vector<std::uint8_t>& clear_pending, std::size_t tile_index, std::uint32_t value)
+{
+    materialize_tile_clear(color_buffer.info.data_ptr, color_buffer.info.width, color_buffer.info.height, tiles_x, clear_pending, tile_index, value);
+}
+
+/** write a pending clear value, given in the buffer's format, to a tile of a depth buffer and reset the tile's flag. */
+static void materialize_tile_clear(attachment_depth& depth_buffer, int tiles_x, std::vector<std::uint8_t>& clear_pending, std::size_t tile_index, std::uint32_t value)
+{
+    if(depth_buffer.format == depth_format::depth16)
+    {
+        materialize_tile_clear(depth_buffer.get_data_ptr<std::uint16_t>(), depth_buffer.info.width, depth_buffer.info.height, tiles_x, clear_pending, tile_index, value);
+    }
+    else
+    {
+        materialize_tile_clear(depth_buffer.get_data_ptr<std::uint32_t>(), depth_buffer.info.width, depth_buffer.info.height, tiles_x, clear_pending, tile_index, value);
+    }
+}
+
+/** write the pending clear values of all tiles intersecting the rectangle [x_min,x_max)x[y_min,y_max). */
+template<typename A>
+static void materialize_tile_clears(A& attachment, int tiles_x, std::vector<std::uint8_t>& clear_pending, std::uint32_t value, int x_min, int x_max, int y_min, int y_max)
+{
+    if(x_min >= x_max || y_min >= y_max)
+    {
+        return;
+    }
+
+    for(int tile_y = y_min >> rasterizer_block_shift; tile_y <= ((y_max - 1) >> rasterizer_block_shift); ++tile_y)
+    {
+        for(int tile_x = x_min >> rasterizer_block_shift; tile_x <= ((x_max - 1) >> rasterizer_block_shift); ++tile_x)
+        {
+            const std::size_t tile_index = tile_y * tiles_x + tile_x;
+            if(clear_pending[tile_index])
+            {
+                materialize_tile_clear(attachment, tiles_x, clear_pending, tile_index, value);
+            }
+        }
+    }
+}
+
 /*
  * default framebuffer.
  */
 
+void default_framebuffer::reset_tile_clears()
+{
+    tiles_x = upper_align_on_block_size(properties.width) >> rasterizer_block_shift;
+    const int tiles_y = upper_align_on_block_size(properties.height) >> rasterizer_block_shift;
+
+    color_clear_pending.assign(tiles_x * tiles_y, 0);
+    depth_clear_pending.assign(tiles_x * tiles_y, 0);
+}
+
+std::size_t default_framebuffer::get_tile_index(int x, int y) const
+{
+    return (y >> rasterizer_block_shift) * tiles_x + (x >> rasterizer_block_shift);
+}
+
+void default_framebuffer::materialize_color_clears()
+{
+    if(!color_buffer.info.data_ptr)
+    {
+        return;
+    }
+
+    for(std::size_t i = 0; i < color_clear_pending.size(); ++i)
+    {
+        if(color_clear_pending[i])
+        {
+            materialize_tile_clear(color_buffer, tiles_x, color_clear_pending, i, pending_clear_color);
+        }
+    }
+}
+
+void default_framebuffer::materialize_color_clear(int x, int y)
+{
+    // tile-local buffers do not track clears.
+    if(!color_clear_pending.empty())
+    {
+        const auto tile_index = get_tile_index(x, y);
+        if(color_clear_pending[tile_index])
+        {
+            materialize_tile_clear(color_buffer, tiles_x, color_clear_pending, tile_index, pending_clear_color);
+        }
+    }
+}
+
+void default_framebuffer::materialize_depth_clear(int x, int y)
+{
+    // tile-local buffers do not track clears.
+    if(!depth_clear_pending.empty())
+    {
+        const auto tile_index = get_tile_index(x, y);
+        if(depth_clear_pending[tile_index])
+        {
+            materialize_tile_clear(depth_buffer, tiles_x, depth_clear_pending, tile_index, pending_clear_depth);
+        }
+    }
+}
+
 void default_framebuffer::clear_color(uint32_t attachment, ml::vec4 clear_color)
 {
     if(attachment == 0)
     {
-        auto& info = color_buffer.info;
-        utils::memset32(info.data_ptr, color_buffer.converter.to_pixel(clear_color), info.pitch * info.height);
+        // the tiles are filled on first access.
+        pending_clear_color = color_buffer.converter.to_pixel(clear_color);
+        std::fill(color_clear_pending.begin(), color_clear_pending.end(), 1);
     }
 }
 
@@ -139,6 +787,9 @@ void default_framebuffer::clear_color(uint32_t attachment, ml::vec4 clear_color,
         int y_min = std::min(std::max(color_buffer.info.height - rect.y_max, 0), color_buffer.info.height);
         int y_max = std::max(0, std::min(color_buffer.info.height - rect.y_min, color_buffer.info.height));
 
+        // tiles with pending clears need to be filled before partially overwriting them.
+        materialize_tile_clears(color_buffer, tiles_x, color_clear_pending, pending_clear_color, x_min, x_max, y_min, y_max);
+
         const auto row_size = (x_max - x_min) * sizeof(uint32_t);
 
         auto ptr = reinterpret_cast<uint8_t*>(color_buffer.info.data_ptr) + y_min * color_buffer.info.pitch + x_min * sizeof(uint32_t);
@@ -150,39 +801,47 @@ void default_framebuffer::clear_color(uint32_t attachment, ml::vec4 clear_color,
     }
 }
 
-void default_framebuffer::clear_depth(ml::fixed_32_t clear_depth)
+void default_framebuffer::clear_depth(float clear_depth)
 {
-    auto& info = depth_buffer.info;
-    if(info.data_ptr)
+    if(depth_buffer.info.data_ptr)
     {
-        utils::memset32(reinterpret_cast<uint32_t*>(info.data_ptr), ml::unwrap(clear_depth), info.pitch * info.height);
+        // the tiles are filled on first access.
+        pending_clear_depth = get_depth_clear_value(depth_buffer.format, clear_depth);
+        std::fill(depth_clear_pending.begin(), depth_clear_pending.end(), 1);
     }
 }
 
-void default_framebuffer::clear_depth(ml::fixed_32_t clear_depth, const utils::rect& rect)
+void default_framebuffer::clear_depth(float clear_depth, const utils::rect& rect)
 {
+    const auto clear_value = get_depth_clear_value(depth_buffer.format, clear_depth);
+
     int x_min = std::min(std::max(0, rect.x_min), depth_buffer.info.width);
     int x_max = std::max(0, std::min(rect.x_max, depth_buffer.info.width));
     int y_min = std::min(std::max(depth_buffer.info.height - rect.y_max, 0), depth_buffer.info.height);
     int y_max = std::max(0, std::min(depth_buffer.info.height - rect.y_min, depth_buffer.info.height));
 
-    const auto row_size = (x_max - x_min) * sizeof(ml::fixed_32_t);
+    // tiles with pending clears need to be filled before partially overwriting them.
+    materialize_tile_clears(depth_buffer, tiles_x, depth_clear_pending, pending_clear_depth, x_min, x_max, y_min, y_max);
+
+    const auto row_size = (x_max - x_min) * get_depth_format_size(depth_buffer.format);
 
-    auto ptr = reinterpret_cast<uint8_t*>(depth_buffer.info.data_ptr) + y_min * depth_buffer.info.pitch + x_min * sizeof(ml::fixed_32_t);
+    auto ptr = static_cast<uint8_t*>(depth_buffer.get_value_ptr(x_min, y_min));
     for(int y = y_min; y < y_max; ++y)
     {
-        utils::memset32(ptr, *reinterpret_cast<uint32_t*>(&clear_depth), row_size);
+        utils::memset32(ptr, clear_value, row_size);
         ptr += depth_buffer.info.pitch;
     }
 }
 
-void default_framebuffer::merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, blend_func blend_src, blend_func blend_dst)
+void default_framebuffer::merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask)
 {
     if(attachment != 0)
     {
         return;
     }
 
+    materialize_color_clear(x, y);
+
     if(frag.write_flags & fragment_output::fof_write_color)
     {
         // convert color to output format.
@@ -190,30 +849,65 @@ void default_framebuffer::merge_color(uint32_t attachment, int x, int y, const f
 
         // alpha blending.
         uint32_t* color_buffer_ptr = color_buffer.info.data_ptr + y * color_buffer.info.width + x;
-        if(do_blend)
+        auto blend_kernel = blend_kernels.get_pixel_kernel(color_buffer.converter.get_name());
+        if(do_blend && blend_kernel)
         {
-            write_color = swr::output_merger::blend(color_buffer.converter, blend_src, blend_dst, write_color, *color_buffer_ptr);
+            write_color = swr::output_merger::blend(blend_kernel, write_color, *color_buffer_ptr);
         }
 
         // write color.
-        *color_buffer_ptr = write_color;
+        const uint32_t pixel_mask = get_pixel_write_mask(color_buffer.converter, color_mask);
+        *color_buffer_ptr = (*color_buffer_ptr & ~pixel_mask) | (write_color & pixel_mask);
     }
 }
 
-void default_framebuffer::merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, blend_func blend_src, blend_func blend_dst)
+void default_framebuffer::merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask)
 {
     if(attachment != 0)
     {
         return;
     }
 
+    materialize_color_clear(x, y);
+
+    // the kernel was selected when the blend functions were set. unnamed pixel formats do not support blending.
+    auto blend_kernel = do_blend ? blend_kernels.get_pixel_kernel(color_buffer.converter.get_name()) : nullptr;
+
+    // bits of each pixel written under the color mask.
+    const uint32_t pixel_mask = get_pixel_write_mask(color_buffer.converter, color_mask);
+
+#ifdef SWR_USE_SIMD
+    // use the conversion kernels for named pixel formats.
+    if(frag.write_color)
+    {
+        switch(color_buffer.converter.get_name())
+        {
+        case pixel_format::argb8888:
+            impl::merge_color_block<pixel_format::argb8888>(color_buffer, x, y, frag, blend_kernel, pixel_mask);
+            return;
+        case pixel_format::bgra8888:
+            impl::merge_color_block<pixel_format::bgra8888>(color_buffer, x, y, frag, blend_kernel, pixel_mask);
+            return;
+        case pixel_format::rgba8888:
+            impl::merge_color_block<pixel_format::rgba8888>(color_buffer, x, y, frag, blend_kernel, pixel_mask);
+            return;
+        default:
+            break;
+        }
+    }
+#endif /* SWR_USE_SIMD */
+
     // generate write mask.
-    uint32_t color_write_mask[4] = {to_uint32_mask(frag.write_color[0]), to_uint32_mask(frag.write_color[1]), to_uint32_mask(frag.write_color[2]), to_uint32_mask(frag.write_color[3])};
+    uint32_t color_write_mask[4] = {
+      to_uint32_mask(frag.write_color & 0x1) & pixel_mask,
+      to_uint32_mask(frag.write_color & 0x2) & pixel_mask,
+      to_uint32_mask(frag.write_color & 0x4) & pixel_mask,
+      to_uint32_mask(frag.write_color & 0x8) & pixel_mask};
 
     // block coordinates
     const ml::tvec2<int> coords[4] = {{x, y}, {x + 1, y}, {x, y + 1}, {x + 1, y + 1}};
 
-    if(frag.write_color[0] || frag.write_color[1] || frag.write_color[2] || frag.write_color[3])
+    if(frag.write_color)
     {
         // convert color to output format.
         DECLARE_ALIGNED_ARRAY4(uint32_t, write_color) = {
@@ -232,10 +926,9 @@ void default_framebuffer::merge_color_block(uint32_t attachment, int x, int y, c
         DECLARE_ALIGNED_ARRAY4(uint32_t, color_buffer_values) = {
           *color_buffer_ptr[0], *color_buffer_ptr[1], *color_buffer_ptr[2], *color_buffer_ptr[3]};
 
-        if(do_blend)
+        if(blend_kernel)
         {
-            // note: when compiling with SSE/SIMD enabled, make sure that src/dest/out are aligned on 16-byte boundaries.
-            swr::output_merger::blend_block(color_buffer.converter, blend_src, blend_dst, write_color, color_buffer_values, write_color);
+            blend_kernel(write_color, color_buffer_values, write_color);
         }
 
         // write color.
@@ -255,7 +948,7 @@ void default_framebuffer::depth_compare_write(int x, int y, float depth_value, c
         return;
     }
 
-    write_mask = write_depth;
+    write_mask = true;
 
     // if no depth buffer was created, accept.
     if(!depth_buffer.info.data_ptr)
@@ -263,101 +956,39 @@ void default_framebuffer::depth_compare_write(int x, int y, float depth_value, c
         return;
     }
 
-    // read and compare depth buffer.
-    ml::fixed_32_t* depth_buffer_ptr = depth_buffer.info.data_ptr + y * depth_buffer.info.width + x;
-    ml::fixed_32_t old_depth_value = *depth_buffer_ptr;
-    ml::fixed_32_t new_depth_value{depth_value};
-
-    // basic comparisons for depth test.
-    bool depth_compare[] = {
-      true,                               /* pass */
-      false,                              /* fail */
-      new_depth_value == old_depth_value, /* equal */
-      false,                              /* not_equal */
-      new_depth_value < old_depth_value,  /* less */
-      false,                              /* less_equal */
-      false,                              /* greater */
-      false                               /* greater_equal */
-    };
-
-    // compound comparisons for depth test.
-    depth_compare[static_cast<std::uint32_t>(swr::comparison_func::not_equal)] = !depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)];
-    depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less_equal)] = depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less)] || depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)];
-    depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater)] = !depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less_equal)];
-    depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater_equal)] = depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater)] || depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)];
+    materialize_depth_clear(x, y);
 
-    // generate write mask for this fragment.
-    write_mask &= depth_compare[static_cast<std::uint32_t>(depth_func)];
-
-    // write depth value.
-    uint32_t depth_write_mask = to_uint32_mask(write_depth && write_mask);
-    *depth_buffer_ptr = ml::wrap((ml::unwrap(*depth_buffer_ptr) & ~depth_write_mask) | (ml::unwrap(new_depth_value) & depth_write_mask));
+    // read and compare depth buffer.
+    write_mask = impl::depth_compare_write(depth_buffer, y * depth_buffer.info.width + x, depth_func, depth_value, write_depth);
 }
 
-void default_framebuffer::depth_compare_write_block(int x, int y, float depth_value[4], comparison_func depth_func, bool write_depth, bool write_mask[4])
+void default_framebuffer::depth_compare_write_block(int x, int y, const float depth_value[16], comparison_func depth_func, bool write_depth, std::uint32_t& write_mask)
 {
-    // discard fragment if depth testing is always failing.
+    // discard fragments if depth testing is always failing.
     if(depth_func == swr::comparison_func::fail)
     {
-        set_uniform_mask(write_mask, false);
+        write_mask = 0;
         return;
     }
 
     // if no depth buffer was created, accept.
     if(!depth_buffer.info.data_ptr)
     {
-        // the write mask is initialized with "accept all".
         return;
     }
 
-    // block coordinates
-    const ml::tvec2<int> coords[4] = {{x, y}, {x + 1, y}, {x, y + 1}, {x + 1, y + 1}};
+    materialize_depth_clear(x, y);
 
-    // read and compare depth buffer.
-    ml::fixed_32_t* depth_buffer_ptr[4] = {
-      depth_buffer.info.data_ptr + coords[0].y * depth_buffer.info.width + coords[0].x,
-      depth_buffer.info.data_ptr + coords[1].y * depth_buffer.info.width + coords[1].x,
-      depth_buffer.info.data_ptr + coords[2].y * depth_buffer.info.width + coords[2].x,
-      depth_buffer.info.data_ptr + coords[3].y * depth_buffer.info.width + coords[3].x};
-
-    ml::fixed_32_t old_depth_value[4] = {*depth_buffer_ptr[0], *depth_buffer_ptr[1], *depth_buffer_ptr[2], *depth_buffer_ptr[3]};
-    ml::fixed_32_t new_depth_value[4] = {depth_value[0], depth_value[1], depth_value[2], depth_value[3]};
-
-    // basic comparisons for depth test.
-    bool depth_compare[][4] = {
-      {true, true, true, true},                                                                                                                                                 /* pass */
-      {false, false, false, false},                                                                                                                                             /* fail */
-      {new_depth_value[0] == old_depth_value[0], new_depth_value[1] == old_depth_value[1], new_depth_value[2] == old_depth_value[2], new_depth_value[3] == old_depth_value[3]}, /* equal */
-      {false, false, false, false},                                                                                                                                             /* not_equal */
-      {new_depth_value[0] < old_depth_value[0], new_depth_value[1] < old_depth_value[1], new_depth_value[2] < old_depth_value[2], new_depth_value[3] < old_depth_value[3]},     /* less */
-      {false, false, false, false},                                                                                                                                             /* less -<equal */
-      {false, false, false, false},                                                                                                                                             /* greater */
-      {false, false, false, false}                                                                                                                                              /* greater_equal */
-    };
+    // offsets of the rows of the 2x2 quads.
+    const std::size_t width = depth_buffer.info.width;
+    const std::size_t block_offset = y * width + x;
+    const std::size_t quad_rows[4][2] = {
+      {block_offset, block_offset + width},
+      {block_offset + 2, block_offset + width + 2},
+      {block_offset + 2 * width, block_offset + 3 * width},
+      {block_offset + 2 * width + 2, block_offset + 3 * width + 2}};
 
-    // compound comparisons for depth test.
-    for(int k = 0; k < 4; ++k)
-    {
-        depth_compare[static_cast<std::uint32_t>(swr::comparison_func::not_equal)][k] = !depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)][k];
-        depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less_equal)][k] = depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less)][k] || depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)][k];
-        depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater)][k] = !depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less_equal)][k];
-        depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater_equal)][k] = depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater)][k] || depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)][k];
-    }
-
-    bool depth_mask[4] = {
-      depth_compare[static_cast<std::uint32_t>(depth_func)][0],
-      depth_compare[static_cast<std::uint32_t>(depth_func)][1],
-      depth_compare[static_cast<std::uint32_t>(depth_func)][2],
-      depth_compare[static_cast<std::uint32_t>(depth_func)][3]};
-    apply_mask(write_mask, depth_mask);
-
-    // write depth.
-    uint32_t depth_write_mask[4] = {to_uint32_mask(write_mask[0] && write_depth), to_uint32_mask(write_mask[1] && write_depth), to_uint32_mask(write_mask[2] && write_depth), to_uint32_mask(write_mask[3] && write_depth)};
-
-    *(depth_buffer_ptr[0]) = ml::wrap((ml::unwrap(*(depth_buffer_ptr[0])) & ~depth_write_mask[0]) | (ml::unwrap(new_depth_value[0]) & depth_write_mask[0]));
-    *(depth_buffer_ptr[1]) = ml::wrap((ml::unwrap(*(depth_buffer_ptr[1])) & ~depth_write_mask[1]) | (ml::unwrap(new_depth_value[1]) & depth_write_mask[1]));
-    *(depth_buffer_ptr[2]) = ml::wrap((ml::unwrap(*(depth_buffer_ptr[2])) & ~depth_write_mask[2]) | (ml::unwrap(new_depth_value[2]) & depth_write_mask[2]));
-    *(depth_buffer_ptr[3]) = ml::wrap((ml::unwrap(*(depth_buffer_ptr[3])) & ~depth_write_mask[3]) | (ml::unwrap(new_depth_value[3]) & depth_write_mask[3]));
+    depth_compare_write_quads(depth_buffer, depth_func, quad_rows, depth_value, write_depth, write_mask);
 }
 
 /*
@@ -431,19 +1062,21 @@ void framebuffer_object::clear_color(uint32_t attachment, ml::vec4 clear_color,
     }
 }
 
-void framebuffer_object::clear_depth(ml::fixed_32_t clear_depth)
+void framebuffer_object::clear_depth(float clear_depth)
 {
     if(depth_attachment)
     {
         auto& info = depth_attachment->info;
-        utils::memset32(reinterpret_cast<uint32_t*>(info.data_ptr), ml::unwrap(clear_depth), info.pitch * info.height);
+        utils::memset32(info.data_ptr, get_depth_clear_value(depth_attachment->format, clear_depth), info.pitch * info.height);
     }
 }
 
-void framebuffer_object::clear_depth(ml::fixed_32_t clear_depth, const utils::rect& rect)
+void framebuffer_object::clear_depth(float clear_depth, const utils::rect& rect)
 {
     if(depth_attachment)
     {
+        const auto clear_value = get_depth_clear_value(depth_attachment->format, clear_depth);
+
 #ifdef SWR_USE_MORTON_CODES
         auto& info = depth_attachment->info;
 
@@ -456,7 +1089,14 @@ void framebuffer_object::clear_depth(ml::fixed_32_t clear_depth, const utils::re
         {
             for(int y = y_min; y < y_max; ++y)
             {
-                *(info.data_ptr + libmorton::morton2D_32_encode(x, y)) = clear_depth;
+                if(depth_attachment->format == depth_format::depth16)
+                {
+                    *(depth_attachment->get_data_ptr<std::uint16_t>() + libmorton::morton2D_32_encode(x, y)) = static_cast<std::uint16_t>(clear_value);
+                }
+                else
+                {
+                    *(depth_attachment->get_data_ptr<std::uint32_t>() + libmorton::morton2D_32_encode(x, y)) = clear_value;
+                }
             }
         }
 #else
@@ -467,19 +1107,19 @@ void framebuffer_object::clear_depth(ml::fixed_32_t clear_depth, const utils::re
         int y_min = std::min(std::max(rect.y_min, 0), info.height);
         int y_max = std::max(0, std::min(rect.y_max, info.height));
 
-        const auto row_size = (x_max - x_min) * sizeof(ml::fixed_32_t);
+        const auto row_size = (x_max - x_min) * get_depth_format_size(depth_attachment->format);
 
-        auto ptr = reinterpret_cast<uint8_t*>(info.data_ptr) + y_min * info.pitch + x_min * sizeof(ml::fixed_32_t);
+        auto ptr = static_cast<uint8_t*>(depth_attachment->get_value_ptr(x_min, y_min));
         for(int y = y_min; y < y_max; ++y)
         {
-            utils::memset32(ptr, *reinterpret_cast<uint32_t*>(&clear_depth), row_size);
+            utils::memset32(ptr, clear_value, row_size);
             ptr += info.pitch;
         }
 #endif /* SWR_USE_MORTON_CODES */
     }
 }
 
-void framebuffer_object::merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, blend_func blend_src, blend_func blend_dst)
+void framebuffer_object::merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask)
 {
     if(attachment > color_attachments.size() || !color_attachments[attachment])
     {
@@ -501,22 +1141,22 @@ void framebuffer_object::merge_color(uint32_t attachment, int x, int y, const fr
 #endif
         if(do_blend)
         {
-            write_color = swr::output_merger::blend(blend_src, blend_dst, write_color, *color_buffer_ptr);
+            write_color = swr::output_merger::blend(blend_kernels.colors, write_color, *color_buffer_ptr);
         }
 
         // write color.
-        *color_buffer_ptr = write_color;
+        *color_buffer_ptr = apply_color_mask(write_color, *color_buffer_ptr, color_mask);
     }
 }
 
-void framebuffer_object::merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, blend_func blend_src, blend_func blend_dst)
+void framebuffer_object::merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask)
 {
     if(attachment > color_attachments.size() || !color_attachments[attachment])
     {
         return;
     }
 
-    if(frag.write_color[0] || frag.write_color[1] || frag.write_color[2] || frag.write_color[3])
+    if(frag.write_color)
     {
         // convert color to output format.
         ml::vec4 write_color[4] = {
@@ -551,7 +1191,15 @@ void framebuffer_object::merge_color_block(uint32_t attachment, int x, int y, co
 
         if(do_blend)
         {
-            swr::output_merger::blend_block(blend_src, blend_dst, write_color, color_buffer_values, write_color);
+            blend_kernels.colors(write_color, color_buffer_values, write_color);
+        }
+
+        if(color_mask != output_merger::color_mask::all)
+        {
+            for(int i = 0; i < 4; ++i)
+            {
+                write_color[i] = apply_color_mask(write_color[i], color_buffer_values[i], color_mask);
+            }
         }
 
         // write color.
@@ -561,16 +1209,15 @@ void framebuffer_object::merge_color_block(uint32_t attachment, int x, int y, co
         write_target = write_source;                             \
     }
 
-        CONDITIONAL_WRITE(frag.write_color[0], *(color_buffer_ptrs[0]), write_color[0]);
-        CONDITIONAL_WRITE(frag.write_color[1], *(color_buffer_ptrs[1]), write_color[1]);
-        CONDITIONAL_WRITE(frag.write_color[2], *(color_buffer_ptrs[2]), write_color[2]);
-        CONDITIONAL_WRITE(frag.write_color[3], *(color_buffer_ptrs[3]), write_color[3]);
+        CONDITIONAL_WRITE(frag.write_color & 1, *(color_buffer_ptrs[0]), write_color[0]);
+        CONDITIONAL_WRITE(frag.write_color & 2, *(color_buffer_ptrs[1]), write_color[1]);
+        CONDITIONAL_WRITE(frag.write_color & 4, *(color_buffer_ptrs[2]), write_color[2]);
+        CONDITIONAL_WRITE(frag.write_color & 8, *(color_buffer_ptrs[3]), write_color[3]);
 
 #undef CONDITIONAL_WRITE
     }
 }
 
-// FIXME this is almost exactly the same as default_framebuffer::depth_compare_write.
 void framebuffer_object::depth_compare_write(int x, int y, float depth_value, comparison_func depth_func, bool write_depth, bool& write_mask)
 {
     // discard fragment if depth testing is always failing.
@@ -590,109 +1237,51 @@ void framebuffer_object::depth_compare_write(int x, int y, float depth_value, co
 
     // read and compare depth buffer.
 #ifdef SWR_USE_MORTON_CODES
-    ml::fixed_32_t* depth_buffer_ptr = depth_attachment->info.data_ptr + libmorton::morton2D_32_encode(x, y);
+    const std::size_t offset = libmorton::morton2D_32_encode(x, y);
 #else
-    ml::fixed_32_t* depth_buffer_ptr = depth_attachment->info.data_ptr + y * depth_attachment->info.width + x;
+    const std::size_t offset = y * depth_attachment->info.width + x;
 #endif
-    ml::fixed_32_t old_depth_value = *depth_buffer_ptr;
-    ml::fixed_32_t new_depth_value{depth_value};
-
-    // basic comparisons for depth test.
-    bool depth_compare[] = {
-      true,                               /* pass */
-      false,                              /* fail */
-      new_depth_value == old_depth_value, /* equal */
-      false,                              /* not_equal */
-      new_depth_value < old_depth_value,  /* less */
-      false,                              /* less_equal */
-      false,                              /* greater */
-      false                               /* greater_equal */
-    };
-
-    // compound comparisons for depth test.
-    depth_compare[static_cast<std::uint32_t>(swr::comparison_func::not_equal)] = !depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)];
-    depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less_equal)] = depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less)] || depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)];
-    depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater)] = !depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less_equal)];
-    depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater_equal)] = depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater)] || depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)];
-
-    // generate write mask for this fragment.
-    write_mask &= depth_compare[static_cast<std::uint32_t>(depth_func)];
-
-    // write depth value.
-    uint32_t depth_write_mask = to_uint32_mask(write_depth && write_mask);
-    *depth_buffer_ptr = ml::wrap((ml::unwrap(*depth_buffer_ptr) & ~depth_write_mask) | (ml::unwrap(new_depth_value) & depth_write_mask));
+    write_mask = impl::depth_compare_write(*depth_attachment, offset, depth_func, depth_value, write_depth);
 }
 
-// FIXME this is almost exactly the same as default_framebuffer::depth_compare_write_block.
-void framebuffer_object::depth_compare_write_block(int x, int y, float depth_value[4], comparison_func depth_func, bool write_depth, bool write_mask[4])
+void framebuffer_object::depth_compare_write_block(int x, int y, const float depth_value[16], comparison_func depth_func, bool write_depth, std::uint32_t& write_mask)
 {
-    // discard fragment if depth testing is always failing.
+    // discard fragments if depth testing is always failing.
     if(depth_func == swr::comparison_func::fail)
     {
-        set_uniform_mask(write_mask, false);
+        write_mask = 0;
         return;
     }
 
     // if no depth buffer was created, accept.
     if(!depth_attachment || !depth_attachment->info.data_ptr)
     {
-        // the write mask is initialized with "accept all".
         return;
     }
 
-    // block coordinates
-    const ml::tvec2<int> coords[4] = {{x, y}, {x + 1, y}, {x, y + 1}, {x + 1, y + 1}};
-
-    // read and compare depth buffer.
+    // offsets of the rows of the 2x2 quads. with morton codes, the values of a quad are stored consecutively.
 #ifdef SWR_USE_MORTON_CODES
-    ml::fixed_32_t* depth_buffer_ptr[4] = {
-      depth_attachment->info.data_ptr + libmorton::morton2D_32_encode(coords[0].x, coords[0].y),
-      depth_attachment->info.data_ptr + libmorton::morton2D_32_encode(coords[1].x, coords[1].y),
-      depth_attachment->info.data_ptr + libmorton::morton2D_32_encode(coords[2].x, coords[2].y),
-      depth_attachment->info.data_ptr + libmorton::morton2D_32_encode(coords[3].x, coords[3].y)};
+    const std::size_t quad_offsets[4] = {
+      libmorton::morton2D_32_encode(x, y),
+      libmorton::morton2D_32_encode(x + 2, y),
+      libmorton::morton2D_32_encode(x, y + 2),
+      libmorton::morton2D_32_encode(x + 2, y + 2)};
+    const std::size_t quad_rows[4][2] = {
+      {quad_offsets[0], quad_offsets[0] + 2},
+      {quad_offsets[1], quad_offsets[1] + 2},
+      {quad_offsets[2], quad_offsets[2] + 2},
+      {quad_offsets[3], quad_offsets[3] + 2}};
 #else
-    ml::fixed_32_t* depth_buffer_ptr[4] = {
-      depth_attachment->info.data_ptr + coords[0].y * depth_attachment->info.width + coords[0].x,
-      depth_attachment->info.data_ptr + coords[1].y * depth_attachment->info.width + coords[1].x,
-      depth_attachment->info.data_ptr + coords[2].y * depth_attachment->info.width + coords[2].x,
-      depth_attachment->info.data_ptr + coords[3].y * depth_attachment->info.width + coords[3].x};
+    const std::size_t width = depth_attachment->info.width;
+    const std::size_t block_offset = y * width + x;
+    const std::size_t quad_rows[4][2] = {
+      {block_offset, block_offset + width},
+      {block_offset + 2, block_offset + width + 2},
+      {block_offset + 2 * width, block_offset + 3 * width},
+      {block_offset + 2 * width + 2, block_offset + 3 * width + 2}};
 #endif
 
-    ml::fixed_32_t old_depth_value[4] = {*depth_buffer_ptr[0], *depth_buffer_ptr[1], *depth_buffer_ptr[2], *depth_buffer_ptr[3]};
-    ml::fixed_32_t new_depth_value[4] = {depth_value[0], depth_value[1], depth_value[2], depth_value[3]};
-
-    // basic comparisons for depth test.
-    bool depth_compare[][4] = {
-      {true, true, true, true},                                                                                                                                                 /* pass */
-      {false, false, false, false},                                                                                                                                             /* fail */
-      {new_depth_value[0] == old_depth_value[0], new_depth_value[1] == old_depth_value[1], new_depth_value[2] == old_depth_value[2], new_depth_value[3] == old_depth_value[3]}, /* equal */
-      {false, false, false, false},                                                                                                                                             /* not_equal */
-      {new_depth_value[0] < old_depth_value[0], new_depth_value[1] < old_depth_value[1], new_depth_value[2] < old_depth_value[2], new_depth_value[3] < old_depth_value[3]},     /* less */
-      {false, false, false, false},                                                                                                                                             /* less -<equal */
-      {false, false, false, false},                                                                                                                                             /* greater */
-      {false, false, false, false}                                                                                                                                              /* greater_equal */
-    };
-
-    // compound comparisons for depth test.
-    for(int k = 0; k < 4; ++k)
-    {
-        depth_compare[static_cast<std::uint32_t>(swr::comparison_func::not_equal)][k] = !depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)][k];
-        depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less_equal)][k] = depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less)][k] || depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)][k];
-        depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater)][k] = !depth_compare[static_cast<std::uint32_t>(swr::comparison_func::less_equal)][k];
-        depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater_equal)][k] = depth_compare[static_cast<std::uint32_t>(swr::comparison_func::greater)][k] || depth_compare[static_cast<std::uint32_t>(swr::comparison_func::equal)][k];
-    }
-
-    bool depth_mask[4] = {
-      depth_compare[static_cast<std::uint32_t>(depth_func)][0], depth_compare[static_cast<std::uint32_t>(depth_func)][1], depth_compare[static_cast<std::uint32_t>(depth_func)][2], depth_compare[static_cast<std::uint32_t>(depth_func)][3]};
-    apply_mask(write_mask, depth_mask);
-
-    // write depth.
-    uint32_t depth_write_mask[4] = {to_uint32_mask(write_mask[0] && write_depth), to_uint32_mask(write_mask[1] && write_depth), to_uint32_mask(write_mask[2] && write_depth), to_uint32_mask(write_mask[3] && write_depth)};
-
-    *(depth_buffer_ptr[0]) = ml::wrap((ml::unwrap(*(depth_buffer_ptr[0])) & ~depth_write_mask[0]) | (ml::unwrap(new_depth_value[0]) & depth_write_mask[0]));
-    *(depth_buffer_ptr[1]) = ml::wrap((ml::unwrap(*(depth_buffer_ptr[1])) & ~depth_write_mask[1]) | (ml::unwrap(new_depth_value[1]) & depth_write_mask[1]));
-    *(depth_buffer_ptr[2]) = ml::wrap((ml::unwrap(*(depth_buffer_ptr[2])) & ~depth_write_mask[2]) | (ml::unwrap(new_depth_value[2]) & depth_write_mask[2]));
-    *(depth_buffer_ptr[3]) = ml::wrap((ml::unwrap(*(depth_buffer_ptr[3])) & ~depth_write_mask[3]) | (ml::unwrap(new_depth_value[3]) & depth_write_mask[3]));
+    depth_compare_write_quads(*depth_attachment, depth_func, quad_rows, depth_value, write_depth, write_mask);
 }
 
 } /* namespace impl */
@@ -720,12 +1309,14 @@ uint32_t CreateFramebufferObject()
     auto* new_fbo = &context->framebuffer_objects[slot];
     new_fbo->reset(slot);
 
+    SWR_CAPTURE(impl::capture::opcode::create_framebuffer_object, slot_to_id(slot));
     return slot_to_id(slot);
 }
 
 void ReleaseFramebufferObject(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::release_framebuffer_object, id);
     impl::render_device_context* context = impl::global_context;
 
     if(id == default_framebuffer_id)
@@ -752,6 +1343,7 @@ void ReleaseFramebufferObject(uint32_t id)
 void BindFramebufferObject(framebuffer_target target, uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::bind_framebuffer_object, target, id);
     impl::render_device_context* context = impl::global_context;
 
     if(id == default_framebuffer_id)
@@ -792,6 +1384,7 @@ void BindFramebufferObject(framebuffer_target target, uint32_t id)
 void FramebufferTexture(uint32_t id, framebuffer_attachment attachment, uint32_t attachment_id, uint32_t level)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::framebuffer_texture, id, attachment, attachment_id, level);
     impl::render_device_context* context = impl::global_context;
 
     if(id == default_framebuffer_id)
@@ -833,20 +1426,22 @@ void FramebufferTexture(uint32_t id, framebuffer_attachment attachment, uint32_t
     }
 }
 
-uint32_t CreateDepthRenderbuffer(uint32_t width, uint32_t height)
+uint32_t CreateDepthRenderbuffer(uint32_t width, uint32_t height, depth_format format)
 {
     ASSERT_INTERNAL_CONTEXT;
     impl::render_device_context* context = impl::global_context;
 
     auto slot = context->depth_attachments.push({});
-    context->depth_attachments[slot].allocate(width, height);
+    context->depth_attachments[slot].allocate(width, height, format);
 
+    SWR_CAPTURE(impl::capture::opcode::create_depth_renderbuffer, static_cast<uint32_t>(slot), width, height, format);
     return slot;
 }
 
 void ReleaseDepthRenderbuffer(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::release_depth_renderbuffer, id);
     impl::render_device_context* context = impl::global_context;
 
     if(id < context->depth_attachments.size() && !context->depth_attachments.is_free(id))
@@ -858,6 +1453,7 @@ void ReleaseDepthRenderbuffer(uint32_t id)
 void FramebufferRenderbuffer(uint32_t id, framebuffer_attachment attachment, uint32_t attachment_id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::framebuffer_renderbuffer, id, attachment, attachment_id);
     impl::render_device_context* context = impl::global_context;
 
     if(id == default_framebuffer_id)
@@ -34,32 +34,36 @@ struct fragment_output
     fragment_output() = default;
 };
 
-/** output after fragment processing, before merging. contains color and depth values, along with write masks for 2x2 blocks. */
+/**
+ * output after fragment processing, before merging. contains color and depth values, along with write masks for 2x2 blocks.
+ *
+ * bit i of the masks refers to fragment i of the block, where the fragments are ordered top-left, top-right, bottom-left, bottom-right.
+ */
 struct fragment_output_block
 {
     /** 2x2 block of colors produced by the fragment shader. */
     ml::vec4 color[4];
 
+    /** 2x2 block of depth values, clamped to [0,1] if the depth test is enabled. */
+    float depth_value[4] = {0, 0, 0, 0};
+
     /*
      * masks.
      */
 
     /** whether the color values should be written to the color buffer. */
-    bool write_color[4] = {true, true, true, true};
+    std::uint32_t write_color{0xf};
 
     /** whether the stencil values should be written to the stencil buffer (currently unused). */
-    bool write_stencil[4] = {false, false, false, false}; /* currently unused */
+    std::uint32_t write_stencil{0}; /* currently unused */
 
     /** default constructor. */
     fragment_output_block() = default;
 
     /** initialize color mask. */
-    fragment_output_block(bool mask0, bool mask1, bool mask2, bool mask3)
+    explicit fragment_output_block(std::uint32_t in_write_color)
+    : write_color{in_write_color}
     {
-        write_color[0] = mask0;
-        write_color[1] = mask1;
-        write_color[2] = mask2;
-        write_color[3] = mask3;
     }
 };
 
@@ -105,14 +109,26 @@ struct attachment_info
     }
 };
 
-/** A fixed-point depth buffer attachment. */
+/** size of a depth value of the given format, in bytes. */
+constexpr int get_depth_format_size(depth_format format)
+{
+    return (format == depth_format::depth16) ? 2 : 4;
+}
+
+/**
+ * A depth buffer attachment. depth16 and depth24 values are stored as unsigned normalized integers in
+ * 16-bit and 32-bit storage, respectively, and depth32 values are stored as ml::fixed_32_t.
+ */
 struct attachment_depth
 {
-    /** attachment info. */
-    attachment_info<ml::fixed_32_t> info;
+    /** format of the stored depth values. */
+    depth_format format{depth_format::depth32};
+
+    /** attachment info. the pitch is measured in bytes. */
+    attachment_info<void> info;
 
     /** The depth buffer data. */
-    std::vector<ml::fixed_32_t> data;
+    std::vector<std::uint32_t> data;
 
     /** free resources. */
     void reset()
@@ -124,10 +140,27 @@ struct attachment_depth
     }
 
     /** allocate the buffer. */
-    void allocate(int in_width, int in_height)
+    void allocate(int in_width, int in_height, depth_format in_format = depth_format::depth32)
     {
         assert(in_width > 0 && in_height > 0);
-        info.setup(in_width, in_height, in_width * sizeof(ml::fixed_32_t), utils::align_vector(utils::alignment::sse, in_width * in_height, data));
+
+        format = in_format;
+        const int value_size = get_depth_format_size(format);
+        const std::size_t word_count = (static_cast<std::size_t>(in_width) * in_height * value_size + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t);
+        info.setup(in_width, in_height, in_width * value_size, utils::align_vector(utils::alignment::sse, word_count, data));
+    }
+
+    /** return the data pointer, interpreted as pointing to values of the format's storage type T. */
+    template<typename T>
+    T* get_data_ptr() const
+    {
+        return static_cast<T*>(info.data_ptr);
+    }
+
+    /** return a pointer to the value at (x,y) for buffers stored in row-major order. */
+    void* get_value_ptr(int x, int y) const
+    {
+        return static_cast<std::uint8_t*>(info.data_ptr) + y * info.pitch + x * get_depth_format_size(format);
     }
 };
 
@@ -261,17 +294,17 @@ struct framebuffer_draw_target
     /** clear part of a color attachment. fails silently if the attachment is not available or if the supplied rectangle was invalid. */
     virtual void clear_color(uint32_t attachment, ml::vec4 clear_color, const utils::rect& rect) = 0;
 
-    /** clear the depth attachment. fails silently if the attachment is not available. */
-    virtual void clear_depth(ml::fixed_32_t clear_depth) = 0;
+    /** clear the depth attachment to a value in [0,1]. fails silently if the attachment is not available. */
+    virtual void clear_depth(float clear_depth) = 0;
 
-    /** clear the depth attachment. fails silently if the attachment is not available of if the supplied rectangle was invalid. */
-    virtual void clear_depth(ml::fixed_32_t clear_depth, const utils::rect& rect) = 0;
+    /** clear the depth attachment to a value in [0,1]. fails silently if the attachment is not available of if the supplied rectangle was invalid. */
+    virtual void clear_depth(float clear_depth, const utils::rect& rect) = 0;
 
-    /** merge a color value while respecting blend modes, if requested. silently fails for invalid attachments. */
-    virtual void merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, blend_func src, blend_func dst) = 0;
+    /** merge a color value while respecting blend modes, if requested. only the channels in color_mask are written. silently fails for invalid attachments. */
+    virtual void merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask) = 0;
 
-    /** merge a 2x2 block of color values while respecting blend modes, if requested. silently fails for invalid attachments. */
-    virtual void merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, blend_func src, blend_func dst) = 0;
+    /** merge a 2x2 block of color values while respecting blend modes, if requested. only the channels in color_mask are written. silently fails for invalid attachments. */
+    virtual void merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask) = 0;
 
     /**
      * if a depth buffer is available, perform a depth comparison and (also depending on write_mask) possibly write a new value to the depth buffer.
@@ -280,11 +313,14 @@ struct framebuffer_draw_target
     virtual void depth_compare_write(int x, int y, float depth_value, comparison_func depth_func, bool write_depth, bool& write_mask) = 0;
 
     /**
-     * if a depth buffer is available, perform a depth comparison and (also depending on write_mask) possibly write new values to the depth buffer.
-     * if a depth test failed, correpsonding entry in write_mask is set to false, and true otherwise. sets all write_mask entries
-     * to true if no depth buffer was available.
+     * if a depth buffer is available, perform the depth comparisons for the fragments of a 4x4 block set in write_mask and possibly write new
+     * values to the depth buffer. fragments failing the depth test are removed from write_mask. write_mask is left unchanged if no depth buffer
+     * was available.
+     *
+     * the block consists of four 2x2 quads, ordered top-left, top-right, bottom-left, bottom-right. bit 4*q+i of write_mask and
+     * entry 4*q+i of depth_value refer to fragment i of quad q, where the fragments are ordered as in fragment_output_block.
      */
-    virtual void depth_compare_write_block(int x, int y, float depth_value[4], comparison_func depth_func, bool write_depth, bool write_mask[4]) = 0;
+    virtual void depth_compare_write_block(int x, int y, const float depth_value[16], comparison_func depth_func, bool write_depth, std::uint32_t& write_mask) = 0;
 };
 
 /** default framebuffer. */
@@ -298,6 +334,27 @@ struct default_framebuffer : public framebuffer_draw_target
 
     // TODO add stencil attachment.
 
+    /*
+     * lazy clears. clearing the whole framebuffer only records the clear value for each tile of size
+     * (rasterizer_block_size, rasterizer_block_size). the value is written when the rasterizer first
+     * accesses a tile, or by materialize_color_clears for tiles that were not drawn to.
+     */
+
+    /** pending color clear value, in the color buffer's pixel format. */
+    std::uint32_t pending_clear_color{0};
+
+    /** pending depth clear value, in the depth buffer's format. 16-bit values are replicated to fill 32 bits. */
+    std::uint32_t pending_clear_depth{0};
+
+    /** number of tiles in x direction. */
+    int tiles_x{0};
+
+    /** per-tile flags for pending color clears. */
+    std::vector<std::uint8_t> color_clear_pending;
+
+    /** per-tile flags for pending depth clears. */
+    std::vector<std::uint8_t> depth_clear_pending;
+
     /** default constructor. */
     default_framebuffer() = default;
 
@@ -310,12 +367,12 @@ struct default_framebuffer : public framebuffer_draw_target
 
     virtual void clear_color(uint32_t attachment, ml::vec4 clear_color) override;
     virtual void clear_color(uint32_t attachment, ml::vec4 clear_color, const utils::rect& rect) override;
-    virtual void clear_depth(ml::fixed_32_t clear_depth) override;
-    virtual void clear_depth(ml::fixed_32_t clear_depth, const utils::rect& rect) override;
-    virtual void merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, blend_func src, blend_func dst) override;
-    virtual void merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, blend_func src, blend_func dst) override;
+    virtual void clear_depth(float clear_depth) override;
+    virtual void clear_depth(float clear_depth, const utils::rect& rect) override;
+    virtual void merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask) override;
+    virtual void merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask) override;
     virtual void depth_compare_write(int x, int y, float depth_value, comparison_func depth_func, bool write_depth, bool& write_mask) override;
-    virtual void depth_compare_write_block(int x, int y, float depth_value[4], comparison_func depth_func, bool write_depth, bool write_mask[4]) override;
+    virtual void depth_compare_write_block(int x, int y, const float depth_value[16], comparison_func depth_func, bool write_depth, std::uint32_t& write_mask) override;
 
     /*
      * default_framebuffer interface.
@@ -327,18 +384,35 @@ struct default_framebuffer : public framebuffer_draw_target
         properties.reset();
         color_buffer.reset();
         depth_buffer.reset();
+        reset_tile_clears();
     }
 
     /** set up the default framebuffer. */
-    void setup(int width, int height, int pitch, pixel_format pixel_format, std::uint32_t* data)
+    void setup(int width, int height, int pitch, pixel_format pixel_format, std::uint32_t* data, depth_format depth_buffer_format = depth_format::depth32)
     {
         reset();
         color_buffer.attach(width, height, pitch, data);
         color_buffer.converter.set_pixel_format(pixel_format_descriptor::named_format(pixel_format));
-        depth_buffer.allocate(width, height);
+        depth_buffer.allocate(width, height, depth_buffer_format);
         properties.reset(width, height);
+        reset_tile_clears();
     }
 
+    /** resize the per-tile clear flags to the framebuffer's dimensions and mark all tiles as not cleared. */
+    void reset_tile_clears();
+
+    /** get the index of the tile containing the pixel (x,y). */
+    std::size_t get_tile_index(int x, int y) const;
+
+    /** write the pending color clears of all tiles to the color buffer. */
+    void materialize_color_clears();
+
+    /** write a pending color clear of the tile containing (x,y) to the color buffer. */
+    void materialize_color_clear(int x, int y);
+
+    /** write a pending depth clear of the tile containing (x,y) to the depth buffer. */
+    void materialize_depth_clear(int x, int y);
+
     /** update the color attachment's format. */
     void set_color_pixel_format(pixel_format name)
     {
@@ -433,17 +507,43 @@ public:
 
     virtual void clear_color(uint32_t attachment, ml::vec4 clear_color) override;
     virtual void clear_color(uint32_t attachment, ml::vec4 clear_color, const utils::rect& rect) override;
-    virtual void clear_depth(ml::fixed_32_t clear_depth) override;
-    virtual void clear_depth(ml::fixed_32_t clear_depth, const utils::rect& rect) override;
-    virtual void merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, blend_func src, blend_func dst) override;
-    virtual void merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, blend_func src, blend_func dst) override;
+    virtual void clear_depth(float clear_depth) override;
+    virtual void clear_depth(float clear_depth, const utils::rect& rect) override;
+    virtual void merge_color(uint32_t attachment, int x, int y, const fragment_output& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask) override;
+    virtual void merge_color_block(uint32_t attachment, int x, int y, const fragment_output_block& frag, bool do_blend, const output_merger::blend_kernels& blend_kernels, std::uint32_t color_mask) override;
     virtual void depth_compare_write(int x, int y, float depth_value, comparison_func depth_func, bool write_depth, bool& write_mask) override;
-    virtual void depth_compare_write_block(int x, int y, float depth_value[4], comparison_func depth_func, bool write_depth, bool write_mask[4]) override;
+    virtual void depth_compare_write_block(int x, int y, const float depth_value[16], comparison_func depth_func, bool write_depth, std::uint32_t& write_mask) override;
 
     /*
      * framebuffer_object interface.
      */
 
+    /** bytes held by the object, including the object itself. the attached textures and renderbuffers are owned by the context. */
+    std::size_t get_memory_usage() const
+    {
+        std::size_t bytes = sizeof(framebuffer_object);
+        for(const auto& it: color_attachments)
+        {
+            if(it)
+            {
+                bytes += sizeof(attachment_texture);
+            }
+        }
+        return bytes;
+    }
+
+    /** return the color attachment at an index, or nullptr if nothing is attached. */
+    const attachment_texture* get_color_attachment(std::size_t index) const
+    {
+        return (index < max_color_attachments) ? color_attachments[index].get() : nullptr;
+    }
+
+    /** return the depth attachment, or nullptr if nothing is attached. */
+    const attachment_depth* get_depth_attachment() const
+    {
+        return depth_attachment;
+    }
+
     /** reset. */
     void reset(int in_id = 0)
     {
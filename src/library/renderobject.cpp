@@ -8,6 +8,9 @@
  * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
  */
 
+/* C++ headers. */
+#include <algorithm>
+
 /* user headers. */
 #include "swr_internal.h"
 
@@ -23,10 +26,7 @@ namespace impl
 static void copy_attributes(
   render_object& obj,
   const boost::container::static_vector<int, geom::limits::max::attributes>& active_vabs,
-  const utils::slot_map<vertex_attribute_buffer>& vertex_attribute_buffers,
-  std::function<uint32_t(uint32_t)> transform_fn =
-    [](uint32_t i) -> uint32_t
-  { return i; })
+  const utils::slot_map<vertex_attribute_buffer>& vertex_attribute_buffers)
 {
     if(active_vabs.size() == 0)
     {
@@ -53,7 +53,7 @@ static void copy_attributes(
                 continue;
             }
 
-            attribs[slot] = vertex_attribute_buffers[id].data[transform_fn(i)];
+            attribs[slot] = vertex_attribute_buffers[id].data[i];
         }
 
         attribs += attrib_stride;
@@ -77,15 +77,14 @@ render_object* render_device_context::create_render_object(std::size_t vertex_co
 
 render_object* render_device_context::create_indexed_render_object(const index_buffer& index_buffer, vertex_buffer_mode mode)
 {
+    // the vertices are copied once and referenced by the indices, so that shared vertices are only shaded once.
+    const std::size_t vertex_count = index_buffer.empty() ? 0 : *std::max_element(index_buffer.begin(), index_buffer.end()) + 1;
+
     // create and initialize new object.
-    render_object_list.emplace_back(index_buffer.size(), mode, states);
+    render_object_list.emplace_back(index_buffer, vertex_count, mode, states);
     auto& new_object = render_object_list.back();
 
-    copy_attributes(new_object, active_vabs, vertex_attribute_buffers,
-                    [&index_buffer](uint32_t i) -> uint32_t
-                    {
-                        return index_buffer[i];
-                    });
+    copy_attributes(new_object, active_vabs, vertex_attribute_buffers);
 
     return &new_object;
 }
@@ -54,20 +54,37 @@ public:
     /** Buffer holding all vertex flags. */
     std::vector<uint32_t> vertex_flags;
 
+    /** Point sizes, as written by the vertex shader (or taken from the render states). */
+    std::vector<float> point_sizes;
+
     /** Aligned pointer into the varying storage. */
     ml::vec4* varyings{nullptr};
 
     /** Indices into the vertex buffer. */
     index_buffer indices;
 
+    /** Whether the indices are the consecutive numbers 0, 1, ..., coord_count-1. */
+    bool sequential_indices{false};
+
     /** Drawing mode. */
     vertex_buffer_mode mode{vertex_buffer_mode::points};
 
     /** Active render states for this object. */
     render_states states;
 
-    /** Ordered vertices after clipping. */
-    vertex_buffer clipped_vertices;
+    /**
+     * Ordered vertices after clipping. The index buffer is split into consecutive ranges of whole primitives,
+     * which are processed independently, and each range writes its output into its own vertex buffer.
+     */
+    std::vector<vertex_buffer> clipped_vertices;
+
+    /** The smallest viewport depth inside each clipped vertex buffer. Used to sort opaque objects front-to-back. */
+    std::vector<float> clipped_min_depth;
+
+#ifdef SWR_ENABLE_STATS
+    /** Cycles spent in the vertex processing stages and in primitive assembly, one entry per clipped vertex buffer. */
+    std::vector<swr::stats::pipeline_data> stats_pipeline;
+#endif
 
     /** Constructors */
     render_object()
@@ -76,11 +93,13 @@ public:
 
     /** Initialize the object with vertices in sequential order. */
     render_object(std::size_t count, vertex_buffer_mode in_mode, const render_states& in_states)
-    : mode{in_mode}
+    : sequential_indices{true}
+    , mode{in_mode}
     , states{in_states}
     {
         allocate_coords(count);
         vertex_flags.resize(count);
+        point_sizes.resize(count);
 
         // populate index buffer with consecutive numbers.
         indices.reserve(count);
@@ -90,14 +109,15 @@ public:
         }
     }
 
-    /** Initialize the object with vertices and indices. */
-    render_object(const index_buffer& in_indices, vertex_buffer_mode in_mode, const render_states& in_states)
+    /** Initialize the object with count vertices, referenced by the indices. */
+    render_object(const index_buffer& in_indices, std::size_t count, vertex_buffer_mode in_mode, const render_states& in_states)
     : indices{in_indices}
     , mode{in_mode}
     , states{in_states}
     {
-        allocate_coords(in_indices.size());
-        vertex_flags.resize(in_indices.size());
+        allocate_coords(count);
+        vertex_flags.resize(count);
+        point_sizes.resize(count);
     }
 
     /**
@@ -131,6 +151,29 @@ public:
     {
         allocate_buffer(coord_count * count, varying_storage, &varyings);
     }
+
+    /** Bytes held by the object, including the object itself. */
+    std::size_t get_memory_usage() const
+    {
+        std::size_t bytes = sizeof(render_object)
+                            + attrib_storage.capacity() + coord_storage.capacity() + varying_storage.capacity()
+                            + vertex_flags.capacity() * sizeof(uint32_t)
+                            + point_sizes.capacity() * sizeof(float)
+                            + indices.capacity() * sizeof(uint32_t)
+                            + clipped_vertices.capacity() * sizeof(vertex_buffer)
+                            + clipped_min_depth.capacity() * sizeof(float);
+
+        for(const auto& it: clipped_vertices)
+        {
+            bytes += it.capacity() * sizeof(geom::vertex);
+        }
+
+#ifdef SWR_ENABLE_STATS
+        bytes += stats_pipeline.capacity() * sizeof(swr::stats::pipeline_data);
+#endif
+
+        return bytes;
+    }
 };
 
 } /* namespace impl */
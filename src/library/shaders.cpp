@@ -39,6 +39,10 @@ void create_default_shader(render_device_context* context)
     default_shader->pre_link(pi.iqs);
     pi.varying_count = pi.iqs.size();
     pi.flags |= swr::impl::program_flags::prelinked;
+    if(default_shader->is_depth_invariant())
+    {
+        pi.flags |= swr::impl::program_flags::depth_invariant;
+    }
 
     // the default shader needs to be at position 0.
     if(context->programs.size() > default_shader_index)
@@ -63,7 +67,7 @@ void create_default_shader(render_device_context* context)
  * Public Interface
  */
 
-uint32_t RegisterShader(const program_base* in_shader)
+uint32_t RegisterShader(const program_base* in_shader, const char* key)
 {
     ASSERT_INTERNAL_CONTEXT;
 
@@ -73,6 +77,10 @@ uint32_t RegisterShader(const program_base* in_shader)
     }
 
     swr::impl::program_info pi{in_shader};
+    if(key)
+    {
+        pi.key = key;
+    }
 
     // pre-link the shader and initialize varying count.
     //
@@ -82,14 +90,24 @@ uint32_t RegisterShader(const program_base* in_shader)
     pi.varying_count = pi.iqs.size();
 
     pi.flags |= swr::impl::program_flags::prelinked;
+    if(in_shader->is_depth_invariant())
+    {
+        pi.flags |= swr::impl::program_flags::depth_invariant;
+    }
 
     // Register shader.
-    return impl::global_context->programs.push(std::move(pi));
+    uint32_t id = impl::global_context->programs.push(std::move(pi));
+
+    // shaders are recorded by their key, since neither their code nor their data can be serialized.
+    SWR_CAPTURE(impl::capture::opcode::register_shader, id, impl::global_context->programs[id].key);
+
+    return id;
 }
 
 void UnregisterShader(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::unregister_shader, id);
 
     // check for invalid values. the default shader cannot be unregistered.
     if(id == impl::default_shader_index)
@@ -107,6 +125,7 @@ void UnregisterShader(uint32_t id)
 bool BindShader(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::bind_shader, id);
 
     if(id < impl::global_context->programs.size())
     {
@@ -126,6 +145,7 @@ bool BindShader(uint32_t id)
 void BindUniform(uint32_t id, int value)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::bind_uniform_int, id, value);
 
     if(id < geom::limits::max::uniform_locations)
     {
@@ -143,6 +163,7 @@ void BindUniform(uint32_t id, int value)
 void BindUniform(uint32_t id, float value)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::bind_uniform_float, id, value);
 
     if(id < geom::limits::max::uniform_locations)
     {
@@ -160,6 +181,7 @@ void BindUniform(uint32_t id, float value)
 void BindUniform(uint32_t id, ml::mat4x4 value)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::bind_uniform_mat4x4, id, value);
 
     if(id < geom::limits::max::uniform_locations)
     {
@@ -177,6 +199,7 @@ void BindUniform(uint32_t id, ml::mat4x4 value)
 void BindUniform(uint32_t id, ml::vec4 value)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::bind_uniform_vec4, id, value);
 
     if(id < geom::limits::max::uniform_locations)
     {
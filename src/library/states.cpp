@@ -21,6 +21,7 @@ namespace swr
 void SetState(state s, bool enable)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_state, s, enable);
     impl::render_device_context* context = impl::global_context;
 
     if(s == state::blend)
@@ -43,6 +44,10 @@ void SetState(state s, bool enable)
     {
         context->states.polygon_offset_fill_enabled = enable;
     }
+    else if(s == state::program_point_size)
+    {
+        context->states.program_point_size_enabled = enable;
+    }
     else if(s == state::scissor_test)
     {
         context->states.scissor_test_enabled = enable;
@@ -74,6 +79,10 @@ bool GetState(state s)
     {
         return context->states.polygon_offset_fill_enabled;
     }
+    else if(s == state::program_point_size)
+    {
+        return context->states.program_point_size_enabled;
+    }
     else if(s == state::scissor_test)
     {
         return context->states.scissor_test_enabled;
@@ -89,6 +98,7 @@ bool GetState(state s)
 void SetBlendFunc(blend_func sfactor, blend_func dfactor)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_blend_func, sfactor, dfactor);
     auto* context = impl::global_context;
 
     if(context->im_declaring_primitives)
@@ -99,6 +109,7 @@ void SetBlendFunc(blend_func sfactor, blend_func dfactor)
 
     context->states.blend_src = sfactor;
     context->states.blend_dst = dfactor;
+    context->states.blend_kernels.select(sfactor, dfactor);
 }
 
 blend_func GetSourceBlendFunc()
@@ -113,6 +124,39 @@ blend_func GetDestinationBlendFunc()
     return impl::global_context->states.blend_dst;
 }
 
+/*
+ * color write mask.
+ */
+
+void SetColorMask(bool red, bool green, bool blue, bool alpha)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_color_mask, red, green, blue, alpha);
+    auto* context = impl::global_context;
+
+    if(context->im_declaring_primitives)
+    {
+        context->last_error = error::invalid_operation;
+        return;
+    }
+
+    context->states.color_mask = (red ? output_merger::color_mask::red : 0)
+                                 | (green ? output_merger::color_mask::green : 0)
+                                 | (blue ? output_merger::color_mask::blue : 0)
+                                 | (alpha ? output_merger::color_mask::alpha : 0);
+}
+
+void GetColorMask(bool& red, bool& green, bool& blue, bool& alpha)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    const auto color_mask = impl::global_context->states.color_mask;
+
+    red = (color_mask & output_merger::color_mask::red) != 0;
+    green = (color_mask & output_merger::color_mask::green) != 0;
+    blue = (color_mask & output_merger::color_mask::blue) != 0;
+    alpha = (color_mask & output_merger::color_mask::alpha) != 0;
+}
+
 /*
  * depth test.
  */
@@ -120,6 +164,7 @@ blend_func GetDestinationBlendFunc()
 void SetDepthTest(comparison_func func)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_depth_test, func);
     impl::global_context->states.depth_func = func;
 }
 
@@ -136,6 +181,7 @@ comparison_func GetDepthTest()
 void SetFrontFace(front_face_orientation ffo)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_front_face, ffo);
     impl::global_context->states.front_face = ffo;
 }
 
@@ -148,6 +194,7 @@ front_face_orientation GetFrontFace()
 void SetCullMode(cull_face_direction cfd)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_cull_mode, cfd);
     impl::global_context->states.cull_mode = cfd;
 }
 
@@ -164,6 +211,7 @@ cull_face_direction GetCullMode()
 void SetPolygonMode(polygon_mode Mode)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_polygon_mode, Mode);
     impl::global_context->states.poly_mode = Mode;
 }
 
@@ -180,8 +228,33 @@ polygon_mode GetPolygonMode()
 void PolygonOffset(float factor, float units)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::polygon_offset, factor, units);
     impl::global_context->states.polygon_offset_factor = factor;
     impl::global_context->states.polygon_offset_units = units;
 }
 
+/*
+ * points.
+ */
+
+void SetPointSize(float size)
+{
+    ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_point_size, size);
+
+    if(!(size > 0))
+    {
+        impl::global_context->last_error = error::invalid_value;
+        return;
+    }
+
+    impl::global_context->states.point_size = std::min(size, geom::limits::max::point_size);
+}
+
+float GetPointSize()
+{
+    ASSERT_INTERNAL_CONTEXT;
+    return impl::global_context->states.point_size;
+}
+
 } /* namespace swr */
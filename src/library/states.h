@@ -22,7 +22,7 @@ struct render_states
 {
     /* buffers. */
     ml::vec4 clear_color{ml::vec4::zero()};
-    ml::fixed_32_t clear_depth{1};
+    float clear_depth{1};
 
     /* viewport transform. */
     int x{0}, y{0};
@@ -49,10 +49,18 @@ struct render_states
     float polygon_offset_factor{0.0f};
     float polygon_offset_units{0.0f};
 
+    /* points. */
+    bool program_point_size_enabled{false};
+    float point_size{1.0f};
+
     /* blending */
     bool blending_enabled{false};
     blend_func blend_src{blend_func::one};
     blend_func blend_dst{blend_func::zero};
+    output_merger::blend_kernels blend_kernels; /* selected from blend_src and blend_dst. */
+
+    /* color write mask. */
+    std::uint32_t color_mask{output_merger::color_mask::all};
 
     /* texture units. */
     boost::container::static_vector<struct texture_2d*, geom::limits::max::texture_units> texture_2d_units; /* the context owns the textures. */
@@ -66,6 +74,9 @@ struct render_states
     /* framebuffer. this needs to be always valid for the drawing functions. */
     struct framebuffer_draw_target* draw_target{nullptr};
 
+    /* occlusion query. the id of the query counting the fragments, or 0 if no query is active. */
+    std::uint32_t active_query{0};
+
     /** default constructor. */
     render_states() = default;
 
@@ -109,9 +120,15 @@ struct render_states
         polygon_offset_factor = 0.0f;
         polygon_offset_units = 0.0f;
 
+        program_point_size_enabled = false;
+        point_size = 1.0f;
+
         blending_enabled = false;
         blend_src = blend_func::one;
         blend_dst = blend_func::zero;
+        blend_kernels.select(blend_src, blend_dst);
+
+        color_mask = output_merger::color_mask::all;
 
         texture_2d_units.clear();
         texture_2d_units.shrink_to_fit();
@@ -126,6 +143,8 @@ struct render_states
         uniforms.shrink_to_fit();
 
         draw_target = default_draw_target;
+
+        active_query = 0;
     }
 
     /** set the clear color. */
@@ -24,6 +24,14 @@ void get_fragment_data([[maybe_unused]] fragment_data& data)
 #endif
 }
 
+void get_pipeline_data([[maybe_unused]] pipeline_data& data)
+{
+    ASSERT_INTERNAL_CONTEXT;
+#ifdef SWR_ENABLE_STATS
+    data = impl::global_context->stats_pipeline;
+#endif
+}
+
 void get_rasterizer_data([[maybe_unused]] rasterizer_data& data)
 {
     ASSERT_INTERNAL_CONTEXT;
@@ -32,5 +40,13 @@ void get_rasterizer_data([[maybe_unused]] rasterizer_data& data)
 #endif
 }
 
+void get_tile_data([[maybe_unused]] tile_data& data)
+{
+    ASSERT_INTERNAL_CONTEXT;
+#ifdef SWR_ENABLE_STATS
+    data = impl::global_context->stats_tiles;
+#endif
+}
+
 }    // namespace stats
 }    // namespace swr
\ No newline at end of file
@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <boost/container/static_vector.hpp>
 
 /*
@@ -31,14 +33,18 @@
 
 #include "swr/swr.h"
 #include "swr/shaders.h"
+#include "swr/stats.h"
 
 #include "geometry/all.h"
 
 #include "../common/utils.h"
 
-#include "states.h"
+#include "trace.h"
+#include "perf.h"
+#include "capture.h"
 #include "pixelformat.h"
 #include "output_merger.h"
+#include "states.h"
 #include "textures.h"
 #include "renderbuffer.h"
 #include "rasterizer/rasterizer.h"
@@ -395,12 +395,14 @@ uint32_t CreateTexture()
 
 #undef CHECK
 
+    SWR_CAPTURE(impl::capture::opcode::create_texture, static_cast<uint32_t>(slot));
     return slot;
 }
 
 void ReleaseTexture(uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::release_texture, id);
     impl::render_device_context* context = impl::global_context;
 
     if(id < context->texture_2d_storage.size())
@@ -428,6 +430,7 @@ void ReleaseTexture(uint32_t id)
 void ActiveTexture(uint32_t unit)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::active_texture, unit);
     impl::render_device_context* context = impl::global_context;
 
     if(unit >= geom::limits::max::texture_units)
@@ -452,6 +455,7 @@ void ActiveTexture(uint32_t unit)
 void BindTexture(texture_target target, uint32_t id)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::bind_texture, target, id);
     impl::render_device_context* context = impl::global_context;
 
     if(target != texture_target::texture_2d)
@@ -466,6 +470,7 @@ void BindTexture(texture_target target, uint32_t id)
 void AllocateImage(uint32_t texture_id, size_t width, size_t height)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::allocate_image, texture_id, static_cast<std::uint64_t>(width), static_cast<std::uint64_t>(height));
     impl::render_device_context* context = impl::global_context;
 
     if(texture_id == impl::default_tex_id)
@@ -487,6 +492,7 @@ void AllocateImage(uint32_t texture_id, size_t width, size_t height)
 void SetImage(uint32_t texture_id, uint32_t level, size_t width, size_t height, pixel_format format, const std::vector<uint8_t>& data)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_image, texture_id, level, static_cast<std::uint64_t>(width), static_cast<std::uint64_t>(height), format, data);
     impl::render_device_context* context = impl::global_context;
 
     if(texture_id == impl::default_tex_id)
@@ -508,6 +514,7 @@ void SetImage(uint32_t texture_id, uint32_t level, size_t width, size_t height,
 void SetSubImage(uint32_t texture_id, uint32_t level, size_t offset_x, size_t offset_y, size_t width, size_t height, pixel_format format, const std::vector<uint8_t>& data)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_sub_image, texture_id, level, static_cast<std::uint64_t>(offset_x), static_cast<std::uint64_t>(offset_y), static_cast<std::uint64_t>(width), static_cast<std::uint64_t>(height), format, data);
     impl::render_device_context* context = impl::global_context;
 
     if(texture_id == impl::default_tex_id)
@@ -528,6 +535,8 @@ void SetSubImage(uint32_t texture_id, uint32_t level, size_t offset_x, size_t of
 
 void SetTextureWrapMode(uint32_t id, wrap_mode s, wrap_mode t)
 {
+    SWR_CAPTURE(impl::capture::opcode::set_texture_wrap_mode, id, s, t);
+
     if(impl::bind_texture_pointer(texture_target::texture_2d, id))
     {
         ASSERT_INTERNAL_CONTEXT;
@@ -548,6 +557,9 @@ void SetTextureWrapMode(uint32_t id, wrap_mode s, wrap_mode t)
 
 void GetTextureWrapMode(uint32_t id, wrap_mode* s, wrap_mode* t)
 {
+    // the query binds the texture, which is recorded as such.
+    SWR_CAPTURE(impl::capture::opcode::bind_texture, texture_target::texture_2d, id);
+
     if(impl::bind_texture_pointer(texture_target::texture_2d, id))
     {
         ASSERT_INTERNAL_CONTEXT;
@@ -568,6 +580,7 @@ void GetTextureWrapMode(uint32_t id, wrap_mode* s, wrap_mode* t)
 void SetTextureMinificationFilter(texture_filter filter)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_texture_min_filter, filter);
     impl::render_device_context* context = impl::global_context;
     auto texture_2d = context->states.texture_2d_units[context->states.texture_2d_active_unit];
 
@@ -584,6 +597,7 @@ void SetTextureMinificationFilter(texture_filter filter)
 void SetTextureMagnificationFilter(texture_filter filter)
 {
     ASSERT_INTERNAL_CONTEXT;
+    SWR_CAPTURE(impl::capture::opcode::set_texture_mag_filter, filter);
     impl::render_device_context* context = impl::global_context;
     auto texture_2d = context->states.texture_2d_units[context->states.texture_2d_active_unit];
 
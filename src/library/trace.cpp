@@ -0,0 +1,224 @@
+/**
+ * swr - a software rasterizer
+ *
+ * trace event recording and export to the Chrome trace event format.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers. */
+#include <fstream>
+
+/* format library */
+#include "fmt/format.h"
+
+/* user headers. */
+#include "swr_internal.h"
+
+#include "swr/trace.h"
+
+namespace swr
+{
+
+#ifdef SWR_ENABLE_TRACING
+
+namespace impl
+{
+
+namespace trace
+{
+
+tracer global_tracer;
+
+thread_buffer* tracer::get_thread_buffer()
+{
+    // the buffer is looked up once per thread. afterwards, events are recorded without locking.
+    thread_local thread_buffer* buffer = nullptr;
+    if(buffer == nullptr)
+    {
+        std::scoped_lock lock{buffer_mutex};
+
+        buffer = buffers.emplace_back(std::make_unique<thread_buffer>()).get();
+        buffer->thread_id = static_cast<std::uint32_t>(buffers.size() - 1);
+        buffer->events.reserve(1024);
+    }
+    return buffer;
+}
+
+void tracer::capture(const char* in_path, std::uint32_t in_first_frame, std::uint32_t in_frame_count)
+{
+    clear();
+
+    path = in_path;
+    first_frame = in_first_frame;
+    frame_count = in_frame_count;
+    frame = 0;
+    pending = true;
+    active = false;
+
+    origin = std::chrono::steady_clock::now();
+}
+
+void tracer::begin_frame()
+{
+    if(pending && frame == first_frame)
+    {
+        active = true;
+    }
+
+    if(active)
+    {
+        frame_begin = now();
+    }
+}
+
+void tracer::end_frame()
+{
+    if(active)
+    {
+        frames.push_back({frame, frame_begin, now()});
+    }
+
+    ++frame;
+    if(pending && frame >= first_frame + frame_count)
+    {
+        finish();
+    }
+}
+
+bool tracer::finish()
+{
+    if(!pending)
+    {
+        return false;
+    }
+
+    active = false;
+    pending = false;
+
+    bool result = write();
+    clear();
+
+    return result;
+}
+
+bool tracer::write() const
+{
+    std::ofstream out{path};
+    if(!out)
+    {
+        return false;
+    }
+
+    // times are given in microseconds.
+    auto to_us = [](std::int64_t ns) -> double
+    { return static_cast<double>(ns) * 1e-3; };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    const char* separator = "";
+    for(const auto& it: buffers)
+    {
+        out << separator << fmt::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{0},"args":{{"name":"thread {0}"}}}})", it->thread_id);
+        separator = ",";
+
+        for(const auto& e: it->events)
+        {
+            out << fmt::format(R"(,{{"name":"{}","cat":"swr","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{)", e.name, it->thread_id, to_us(e.begin), to_us(e.end - e.begin));
+
+            const char* arg_separator = "";
+            if(e.tile >= 0)
+            {
+                out << fmt::format(R"("tile":{})", e.tile);
+                arg_separator = ",";
+            }
+            if(e.primitives >= 0)
+            {
+                out << arg_separator << fmt::format(R"("primitives":{})", e.primitives);
+            }
+
+            out << "}}";
+        }
+    }
+
+    // frames are shown on a separate track, following the threads.
+    const auto frame_track = buffers.size();
+    out << separator << fmt::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":"frames"}}}})", frame_track);
+
+    for(const auto& it: frames)
+    {
+        out << fmt::format(R"(,{{"name":"frame","cat":"swr","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f},"args":{{"frame":{}}}}})", frame_track, to_us(it.begin), to_us(it.end - it.begin), it.frame);
+    }
+
+    // counter samples are shown as counter tracks of the process.
+    for(const auto& it: counters)
+    {
+        out << fmt::format(R"(,{{"name":"{}","cat":"swr","ph":"C","pid":0,"ts":{:.3f},"args":{{)", it.name, to_us(it.time));
+
+        const char* arg_separator = "";
+        for(const auto& [name, value]: it.values)
+        {
+            out << arg_separator << fmt::format(R"("{}":{})", name, value);
+            arg_separator = ",";
+        }
+
+        out << "}}";
+    }
+
+    out << "]}\n";
+    return static_cast<bool>(out);
+}
+
+void tracer::clear()
+{
+    // the buffers are only cleared, since their threads keep pointers to them.
+    for(auto& it: buffers)
+    {
+        it->events.clear();
+    }
+    frames.clear();
+    counters.clear();
+}
+
+} /* namespace trace */
+
+} /* namespace impl */
+
+#endif /* SWR_ENABLE_TRACING */
+
+/*
+ * tracing interface.
+ */
+
+namespace trace
+{
+
+bool capture_frames([[maybe_unused]] const char* path, [[maybe_unused]] uint32_t first_frame, [[maybe_unused]] uint32_t frame_count)
+{
+#ifdef SWR_ENABLE_TRACING
+    if(path == nullptr || frame_count == 0)
+    {
+        return false;
+    }
+
+    impl::trace::global_tracer.capture(path, first_frame, frame_count);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool stop_capture()
+{
+#ifdef SWR_ENABLE_TRACING
+    return impl::trace::global_tracer.finish();
+#else
+    return false;
+#endif
+}
+
+} /* namespace trace */
+
+} /* namespace swr */
@@ -0,0 +1,220 @@
+/**
+ * swr - a software rasterizer
+ *
+ * trace event recording. the events are written to per-thread buffers, so that recording needs
+ * no synchronization. the buffers are only read between frames, when the thread pool is idle.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+#pragma once
+
+/** record an event for the remaining scope if tracing is enabled. the arguments are passed on to swr::impl::trace::scope. */
+#ifdef SWR_ENABLE_TRACING
+#    define SWR_TRACE_CONCAT_IMPL(a, b) a##b
+#    define SWR_TRACE_CONCAT(a, b)      SWR_TRACE_CONCAT_IMPL(a, b)
+#    define SWR_TRACE_SCOPE(...)        swr::impl::trace::scope SWR_TRACE_CONCAT(trace_scope_, __LINE__)(__VA_ARGS__)
+#else
+#    define SWR_TRACE_SCOPE(...)
+#endif
+
+#ifdef SWR_ENABLE_TRACING
+
+/* C++ headers. */
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace swr
+{
+
+namespace impl
+{
+
+namespace trace
+{
+
+/** a recorded event. */
+struct event
+{
+    /** event name. has to be a string literal. */
+    const char* name{nullptr};
+
+    /** start time, in nanoseconds since the capture started. */
+    std::int64_t begin{0};
+
+    /** end time, in nanoseconds since the capture started. */
+    std::int64_t end{0};
+
+    /** tile index, or -1 if the event does not refer to a tile. */
+    std::int64_t tile{-1};
+
+    /** primitive count, or -1 if the event does not process primitives. */
+    std::int64_t primitives{-1};
+};
+
+/** the events recorded by a single thread. */
+struct thread_buffer
+{
+    /** sequential thread id, in order of the first recorded event. */
+    std::uint32_t thread_id{0};
+
+    /** recorded events. */
+    std::vector<event> events;
+};
+
+/** a recorded frame. */
+struct frame_event
+{
+    /** frame number, counted from the start of the capture request. */
+    std::uint32_t frame{0};
+
+    /** start time, in nanoseconds since the capture started. */
+    std::int64_t begin{0};
+
+    /** end time, in nanoseconds since the capture started. */
+    std::int64_t end{0};
+};
+
+/** a sample of related counters, shown as a counter track. */
+struct counter_event
+{
+    /** track name. has to be a string literal. */
+    const char* name{nullptr};
+
+    /** sample time, in nanoseconds since the capture started. */
+    std::int64_t time{0};
+
+    /** counter names and values. the names have to be string literals. */
+    std::vector<std::pair<const char*, std::uint64_t>> values;
+};
+
+/** trace event recorder. frames are started and ended by Present, i.e., on the thread calling Present. */
+struct tracer
+{
+    /** whether events are recorded. only modified between frames. */
+    bool active{false};
+
+    /** whether a capture was requested and has not finished yet. */
+    bool pending{false};
+
+    /** output file. */
+    std::string path;
+
+    /** first frame to record. */
+    std::uint32_t first_frame{0};
+
+    /** number of frames to record. */
+    std::uint32_t frame_count{0};
+
+    /** current frame, counted from the capture request. */
+    std::uint32_t frame{0};
+
+    /** start time of the current frame. */
+    std::int64_t frame_begin{0};
+
+    /** start of the capture. the event times are relative to it. */
+    std::chrono::steady_clock::time_point origin;
+
+    /** recorded frames. */
+    std::vector<frame_event> frames;
+
+    /** recorded counter samples. */
+    std::vector<counter_event> counters;
+
+    /** protects the registration of new thread buffers. */
+    std::mutex buffer_mutex;
+
+    /** per-thread event buffers. the buffers are kept alive, since threads may hold pointers to them. */
+    std::vector<std::unique_ptr<thread_buffer>> buffers;
+
+    /** return the current time, relative to the start of the capture. */
+    std::int64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    /** get the calling thread's event buffer, registering it on first use. */
+    thread_buffer* get_thread_buffer();
+
+    /** request a capture. discards all recorded events. */
+    void capture(const char* in_path, std::uint32_t in_first_frame, std::uint32_t in_frame_count);
+
+    /** start a frame. activates recording if the frame is inside the requested range. */
+    void begin_frame();
+
+    /** end a frame. writes the events if the frame is the last one of the requested range. */
+    void end_frame();
+
+    /** record a counter sample at the start of the current frame. only called between frames. */
+    void add_counters(const char* name, std::vector<std::pair<const char*, std::uint64_t>> values)
+    {
+        if(active)
+        {
+            counters.push_back({name, frame_begin, std::move(values)});
+        }
+    }
+
+    /** stop recording and write the events to the output file. */
+    bool finish();
+
+    /** write all recorded events to the output file in the Chrome trace event format. */
+    bool write() const;
+
+    /** discard all recorded events. */
+    void clear();
+};
+
+/** global tracer. */
+extern tracer global_tracer;
+
+/** record an event for the lifetime of the object, if recording is active. */
+class scope
+{
+    /** the event. */
+    event data;
+
+    /** whether recording was active when the scope was entered. */
+    bool recording{false};
+
+public:
+    /** start the event. */
+    scope(const char* name, std::int64_t tile = -1, std::int64_t primitives = -1)
+    : recording{global_tracer.active}
+    {
+        if(recording)
+        {
+            data.name = name;
+            data.tile = tile;
+            data.primitives = primitives;
+            data.begin = global_tracer.now();
+        }
+    }
+
+    /** end the event and store it in the thread's buffer. */
+    ~scope()
+    {
+        if(recording)
+        {
+            data.end = global_tracer.now();
+            global_tracer.get_thread_buffer()->events.push_back(data);
+        }
+    }
+
+    /** no copies. */
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+};
+
+} /* namespace trace */
+
+} /* namespace impl */
+
+} /* namespace swr */
+
+#endif /* SWR_ENABLE_TRACING */
@@ -33,30 +33,31 @@ BOOST_AUTO_TEST_SUITE(clipping)
 BOOST_AUTO_TEST_CASE(empty_input)
 {
     swr::impl::render_object obj;
+    swr::impl::vertex_buffer clipped_vertices;
 
     /*
      * test empty input for line clipping.
      */
-    swr::impl::clip_line_buffer(obj, swr::impl::clip_output::point_list);
-    BOOST_TEST(obj.clipped_vertices.size() == 0);
+    swr::impl::clip_line_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::point_list, clipped_vertices);
+    BOOST_TEST(clipped_vertices.size() == 0);
 
-    swr::impl::clip_line_buffer(obj, swr::impl::clip_output::line_list);
-    BOOST_TEST(obj.clipped_vertices.size() == 0);
+    swr::impl::clip_line_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::line_list, clipped_vertices);
+    BOOST_TEST(clipped_vertices.size() == 0);
 
-    swr::impl::clip_line_buffer(obj, swr::impl::clip_output::triangle_list);
-    BOOST_TEST(obj.clipped_vertices.size() == 0);
+    swr::impl::clip_line_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::triangle_list, clipped_vertices);
+    BOOST_TEST(clipped_vertices.size() == 0);
 
     /*
      * test empty input for triangle clipping.
      */
-    swr::impl::clip_triangle_buffer(obj, swr::impl::clip_output::point_list);
-    BOOST_TEST(obj.clipped_vertices.size() == 0);
+    swr::impl::clip_triangle_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::point_list, clipped_vertices);
+    BOOST_TEST(clipped_vertices.size() == 0);
 
-    swr::impl::clip_triangle_buffer(obj, swr::impl::clip_output::line_list);
-    BOOST_TEST(obj.clipped_vertices.size() == 0);
+    swr::impl::clip_triangle_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::line_list, clipped_vertices);
+    BOOST_TEST(clipped_vertices.size() == 0);
 
-    swr::impl::clip_triangle_buffer(obj, swr::impl::clip_output::triangle_list);
-    BOOST_TEST(obj.clipped_vertices.size() == 0);
+    swr::impl::clip_triangle_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::triangle_list, clipped_vertices);
+    BOOST_TEST(clipped_vertices.size() == 0);
 }
 
 /* get bits of float type. note: in C++20, one should use std::bit_cast. */
@@ -95,6 +96,8 @@ BOOST_AUTO_TEST_CASE(line_clip_preserve)
     swr::impl::program_info info;
     obj.states.shader_info = &info;
 
+    swr::impl::vertex_buffer clipped_vertices;
+
     // input data.
     ml::vec4 coords[COORD_COUNT] = {
       ml::vec4{0, 0, 0, 1}, ml::vec4{1, 0, 0, 1},
@@ -112,17 +115,33 @@ BOOST_AUTO_TEST_CASE(line_clip_preserve)
 
     // clip lines.
     BOOST_REQUIRE((INDEX_COUNT & 1) == 0);
-    swr::impl::clip_line_buffer(obj, swr::impl::clip_output::line_list);
-    BOOST_TEST(obj.clipped_vertices.size() == COORD_COUNT);
+    swr::impl::clip_line_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::line_list, clipped_vertices);
+    BOOST_TEST(clipped_vertices.size() == COORD_COUNT);
 
-    BOOST_REQUIRE(obj.clipped_vertices.size() == COORD_COUNT);
+    BOOST_REQUIRE(clipped_vertices.size() == COORD_COUNT);
     for(size_t i = 0; i < COORD_COUNT; ++i)
     {
         // compare bits.
-        BOOST_TEST(get_bits(coords[i].x) == get_bits(obj.clipped_vertices[i].coords.x));
-        BOOST_TEST(get_bits(coords[i].y) == get_bits(obj.clipped_vertices[i].coords.y));
-        BOOST_TEST(get_bits(coords[i].z) == get_bits(obj.clipped_vertices[i].coords.z));
-        BOOST_TEST(get_bits(coords[i].w) == get_bits(obj.clipped_vertices[i].coords.w));
+        BOOST_TEST(get_bits(coords[i].x) == get_bits(clipped_vertices[i].coords.x));
+        BOOST_TEST(get_bits(coords[i].y) == get_bits(clipped_vertices[i].coords.y));
+        BOOST_TEST(get_bits(coords[i].z) == get_bits(clipped_vertices[i].coords.z));
+        BOOST_TEST(get_bits(coords[i].w) == get_bits(clipped_vertices[i].coords.w));
+    }
+
+    /*
+     * clipping the index buffer in separate ranges has to produce the same output.
+     */
+    swr::impl::vertex_buffer clipped_ranges;
+    swr::impl::clip_line_buffer(obj, 0, 6, swr::impl::clip_output::line_list, clipped_ranges);
+    swr::impl::clip_line_buffer(obj, 6, INDEX_COUNT, swr::impl::clip_output::line_list, clipped_ranges);
+
+    BOOST_REQUIRE(clipped_ranges.size() == COORD_COUNT);
+    for(size_t i = 0; i < COORD_COUNT; ++i)
+    {
+        BOOST_TEST(get_bits(clipped_vertices[i].coords.x) == get_bits(clipped_ranges[i].coords.x));
+        BOOST_TEST(get_bits(clipped_vertices[i].coords.y) == get_bits(clipped_ranges[i].coords.y));
+        BOOST_TEST(get_bits(clipped_vertices[i].coords.z) == get_bits(clipped_ranges[i].coords.z));
+        BOOST_TEST(get_bits(clipped_vertices[i].coords.w) == get_bits(clipped_ranges[i].coords.w));
     }
 
     /*
@@ -159,19 +178,19 @@ BOOST_AUTO_TEST_CASE(line_clip_preserve)
         obj.coords[0] = points[0];
         obj.coords[1] = points[1];
 
-        obj.clipped_vertices.clear();
-        swr::impl::clip_line_buffer(obj, swr::impl::clip_output::line_list);
-        BOOST_TEST(obj.clipped_vertices.size() == 2);
+        clipped_vertices.clear();
+        swr::impl::clip_line_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::line_list, clipped_vertices);
+        BOOST_TEST(clipped_vertices.size() == 2);
 
-        BOOST_TEST(get_bits(points[0].x) == get_bits(obj.clipped_vertices[0].coords.x));
-        BOOST_TEST(get_bits(points[0].y) == get_bits(obj.clipped_vertices[0].coords.y));
-        BOOST_TEST(get_bits(points[0].z) == get_bits(obj.clipped_vertices[0].coords.z));
-        BOOST_TEST(get_bits(points[0].w) == get_bits(obj.clipped_vertices[0].coords.w));
+        BOOST_TEST(get_bits(points[0].x) == get_bits(clipped_vertices[0].coords.x));
+        BOOST_TEST(get_bits(points[0].y) == get_bits(clipped_vertices[0].coords.y));
+        BOOST_TEST(get_bits(points[0].z) == get_bits(clipped_vertices[0].coords.z));
+        BOOST_TEST(get_bits(points[0].w) == get_bits(clipped_vertices[0].coords.w));
 
-        BOOST_TEST(get_bits(points[1].x) == get_bits(obj.clipped_vertices[1].coords.x));
-        BOOST_TEST(get_bits(points[1].y) == get_bits(obj.clipped_vertices[1].coords.y));
-        BOOST_TEST(get_bits(points[1].z) == get_bits(obj.clipped_vertices[1].coords.z));
-        BOOST_TEST(get_bits(points[1].w) == get_bits(obj.clipped_vertices[1].coords.w));
+        BOOST_TEST(get_bits(points[1].x) == get_bits(clipped_vertices[1].coords.x));
+        BOOST_TEST(get_bits(points[1].y) == get_bits(clipped_vertices[1].coords.y));
+        BOOST_TEST(get_bits(points[1].z) == get_bits(clipped_vertices[1].coords.z));
+        BOOST_TEST(get_bits(points[1].w) == get_bits(clipped_vertices[1].coords.w));
     }
 }
 
@@ -242,8 +261,7 @@ BOOST_AUTO_TEST_CASE(line_clip)
         }
 
         out1.clear();
-        swr::impl::clip_line_buffer(obj, swr::impl::clip_output::line_list);
-        out1 = obj.clipped_vertices;
+        swr::impl::clip_line_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::line_list, out1);
 
         obj.coords[0] = v2;
         obj.coords[1] = v1;
@@ -261,8 +279,7 @@ BOOST_AUTO_TEST_CASE(line_clip)
         }
 
         out2.clear();
-        swr::impl::clip_line_buffer(obj, swr::impl::clip_output::line_list);
-        out2 = obj.clipped_vertices;
+        swr::impl::clip_line_buffer(obj, 0, obj.indices.size(), swr::impl::clip_output::line_list, out2);
 
         if(v1_inside || v2_inside)
         {
@@ -0,0 +1,423 @@
+/**
+ * swr - a software rasterizer
+ *
+ * test depth comparisons and color merging of the default framebuffer.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* boost test framework. */
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_ALTERNATIVE_INIT_API
+#define BOOST_TEST_MODULE framebuffer tests
+#include <boost/test/unit_test.hpp>
+
+/* user headers. */
+#include "swr_internal.h"
+
+/*
+ * helpers.
+ */
+
+/** get the position of fragment i of quad q inside a 4x4 block. */
+static ml::tvec2<int> fragment_position(int q, int i)
+{
+    return {2 * (q & 1) + (i & 1), 2 * (q >> 1) + (i >> 1)};
+}
+
+/** reference implementation of the depth comparison. */
+static bool reference_compare(swr::comparison_func func, float new_value, float old_value)
+{
+    switch(func)
+    {
+    case swr::comparison_func::pass: return true;
+    case swr::comparison_func::fail: return false;
+    case swr::comparison_func::equal: return new_value == old_value;
+    case swr::comparison_func::not_equal: return new_value != old_value;
+    case swr::comparison_func::less: return new_value < old_value;
+    case swr::comparison_func::less_equal: return new_value <= old_value;
+    case swr::comparison_func::greater: return new_value > old_value;
+    case swr::comparison_func::greater_equal: return new_value >= old_value;
+    }
+    return false;
+}
+
+/*
+ * tests.
+ */
+
+BOOST_AUTO_TEST_SUITE(depth_test)
+
+BOOST_AUTO_TEST_CASE(block_compare)
+{
+    const swr::comparison_func funcs[] = {
+      swr::comparison_func::pass, swr::comparison_func::fail,
+      swr::comparison_func::equal, swr::comparison_func::not_equal,
+      swr::comparison_func::less, swr::comparison_func::less_equal,
+      swr::comparison_func::greater, swr::comparison_func::greater_equal};
+
+    // the new depth values are below, at and above the buffer contents, in a pattern that differs for every quad.
+    float depth_value[16];
+    for(int k = 0; k < 16; ++k)
+    {
+        depth_value[k] = 0.25f * static_cast<float>((k + k / 4) % 3 + 1);
+    }
+
+    for(auto func: funcs)
+    {
+        swr::impl::default_framebuffer fb;
+        fb.setup(16, 16, 0, swr::pixel_format::argb8888, nullptr);
+        fb.clear_depth(0.5f);
+
+        // leave out fragment 1 of quad 2.
+        const std::uint32_t input_mask = 0xffff & ~(1 << 9);
+        std::uint32_t write_mask = input_mask;
+        fb.depth_compare_write_block(4, 8, depth_value, func, true, write_mask);
+
+        for(int q = 0; q < 4; ++q)
+        {
+            for(int i = 0; i < 4; ++i)
+            {
+                const int k = 4 * q + i;
+                const bool expected = ((input_mask >> k) & 1) && reference_compare(func, depth_value[k], 0.5f);
+                BOOST_CHECK_EQUAL(((write_mask >> k) & 1) != 0, expected);
+
+                // passing fragments write their depth.
+                auto pos = fragment_position(q, i);
+                ml::fixed_32_t stored = fb.depth_buffer.get_data_ptr<ml::fixed_32_t>()[(8 + pos.y) * fb.depth_buffer.info.width + 4 + pos.x];
+                BOOST_CHECK(stored == (expected ? ml::fixed_32_t{depth_value[k]} : ml::fixed_32_t{0.5f}));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(block_no_depth_write)
+{
+    swr::impl::default_framebuffer fb;
+    fb.setup(16, 16, 0, swr::pixel_format::argb8888, nullptr);
+    fb.clear_depth(0.5f);
+
+    float depth_value[16];
+    std::fill_n(depth_value, 16, 0.25f);
+
+    std::uint32_t write_mask = 0xffff;
+    fb.depth_compare_write_block(0, 0, depth_value, swr::comparison_func::less, false, write_mask);
+
+    // all fragments pass, but the depth buffer is unchanged.
+    BOOST_CHECK_EQUAL(write_mask, 0xffff);
+    for(int y = 0; y < 4; ++y)
+    {
+        for(int x = 0; x < 4; ++x)
+        {
+            BOOST_CHECK(fb.depth_buffer.get_data_ptr<ml::fixed_32_t>()[y * fb.depth_buffer.info.width + x] == ml::fixed_32_t{0.5f});
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(unorm_formats)
+{
+    // (format, largest value) pairs.
+    const std::pair<swr::depth_format, std::uint32_t> formats[] = {
+      {swr::depth_format::depth16, 0xffff},
+      {swr::depth_format::depth24, 0xffffff}};
+
+    // the depth values are below, at and above the cleared value.
+    float depth_value[16];
+    for(int k = 0; k < 16; ++k)
+    {
+        depth_value[k] = 0.25f * static_cast<float>((k + k / 4) % 3 + 1);
+    }
+
+    for(auto [format, max_value]: formats)
+    {
+        auto read_depth = [format = format](const swr::impl::attachment_depth& depth_buffer, int x, int y) -> std::uint32_t
+        {
+            const int offset = y * depth_buffer.info.width + x;
+            return (format == swr::depth_format::depth16) ? depth_buffer.get_data_ptr<std::uint16_t>()[offset] : depth_buffer.get_data_ptr<std::uint32_t>()[offset];
+        };
+        auto encode = [max_value = max_value](float z) -> std::uint32_t
+        {
+            return static_cast<std::uint32_t>(z * static_cast<float>(max_value) + 0.5f);
+        };
+
+        swr::impl::default_framebuffer fb;
+        fb.setup(16, 16, 0, swr::pixel_format::argb8888, nullptr, format);
+        fb.clear_depth(0.5f);
+
+        std::uint32_t write_mask = 0xffff;
+        fb.depth_compare_write_block(4, 8, depth_value, swr::comparison_func::less_equal, true, write_mask);
+
+        for(int q = 0; q < 4; ++q)
+        {
+            for(int i = 0; i < 4; ++i)
+            {
+                const int k = 4 * q + i;
+                const bool expected = depth_value[k] <= 0.5f;
+                BOOST_CHECK_EQUAL(((write_mask >> k) & 1) != 0, expected);
+
+                auto pos = fragment_position(q, i);
+                BOOST_CHECK_EQUAL(read_depth(fb.depth_buffer, 4 + pos.x, 8 + pos.y), encode(expected ? depth_value[k] : 0.5f));
+            }
+        }
+
+        // single fragments, including the largest value.
+        bool pass = false;
+        fb.depth_compare_write(0, 0, 1.0f, swr::comparison_func::greater, true, pass);
+        BOOST_CHECK(pass);
+        BOOST_CHECK_EQUAL(read_depth(fb.depth_buffer, 0, 0), max_value);
+
+        fb.depth_compare_write(0, 0, 0.75f, swr::comparison_func::greater, true, pass);
+        BOOST_CHECK(!pass);
+        BOOST_CHECK_EQUAL(read_depth(fb.depth_buffer, 0, 0), max_value);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+BOOST_AUTO_TEST_SUITE(color_merge)
+
+BOOST_AUTO_TEST_CASE(block_conversion)
+{
+    const swr::pixel_format formats[] = {swr::pixel_format::argb8888, swr::pixel_format::bgra8888, swr::pixel_format::rgba8888};
+
+    // colors outside of [0,1] get clamped.
+    swr::impl::fragment_output_block frag{0xf & ~0x4};
+    frag.color[0] = {1.0f, 0.5f, 0.25f, 0.0f};
+    frag.color[1] = {-1.0f, 2.0f, 0.1f, 0.9f};
+    frag.color[2] = {0.3f, 0.3f, 0.3f, 0.3f};
+    frag.color[3] = {0.0f, 0.75f, 1.0f, 1.0f};
+
+    for(auto format: formats)
+    {
+        std::vector<std::uint32_t> buffer(16 * 16, 0x12345678);
+
+        swr::impl::default_framebuffer fb;
+        fb.setup(16, 16, 16 * sizeof(std::uint32_t), format, buffer.data());
+        fb.merge_color_block(0, 6, 2, frag, false, swr::output_merger::blend_kernels{}, swr::output_merger::color_mask::all);
+
+        const auto& converter = fb.color_buffer.converter;
+        BOOST_CHECK_EQUAL(buffer[2 * 16 + 6], converter.to_pixel(ml::clamp_to_unit_interval(frag.color[0])));
+        BOOST_CHECK_EQUAL(buffer[2 * 16 + 7], converter.to_pixel(ml::clamp_to_unit_interval(frag.color[1])));
+        BOOST_CHECK_EQUAL(buffer[3 * 16 + 6], 0x12345678);
+        BOOST_CHECK_EQUAL(buffer[3 * 16 + 7], converter.to_pixel(ml::clamp_to_unit_interval(frag.color[3])));
+
+        // neighboring pixels are untouched.
+        BOOST_CHECK_EQUAL(buffer[2 * 16 + 5], 0x12345678);
+        BOOST_CHECK_EQUAL(buffer[2 * 16 + 8], 0x12345678);
+        BOOST_CHECK_EQUAL(buffer[4 * 16 + 6], 0x12345678);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(color_mask)
+{
+    const swr::pixel_format formats[] = {swr::pixel_format::argb8888, swr::pixel_format::bgra8888, swr::pixel_format::rgba8888};
+
+    swr::impl::fragment_output_block frag{0xf};
+    for(auto& c: frag.color)
+    {
+        c = {1.0f, 1.0f, 1.0f, 1.0f};
+    }
+
+    for(auto format: formats)
+    {
+        std::vector<std::uint32_t> buffer(16 * 16, 0);
+
+        swr::impl::default_framebuffer fb;
+        fb.setup(16, 16, 16 * sizeof(std::uint32_t), format, buffer.data());
+
+        const auto& converter = fb.color_buffer.converter;
+        const std::uint32_t mask = swr::output_merger::color_mask::red | swr::output_merger::color_mask::alpha;
+
+        // block and single-fragment paths write the unmasked channels only.
+        fb.merge_color_block(0, 0, 0, frag, false, swr::output_merger::blend_kernels{}, mask);
+        BOOST_CHECK_EQUAL(buffer[0], converter.red_mask | converter.alpha_mask);
+        BOOST_CHECK_EQUAL(buffer[16 + 1], converter.red_mask | converter.alpha_mask);
+
+        swr::impl::fragment_output single;
+        single.color = {1.0f, 1.0f, 1.0f, 1.0f};
+        single.write_flags = swr::impl::fragment_output::fof_write_color;
+        fb.merge_color(0, 4, 0, single, false, swr::output_merger::blend_kernels{}, swr::output_merger::color_mask::blue);
+        BOOST_CHECK_EQUAL(buffer[4], converter.blue_mask);
+
+        // nothing is written if all channels are masked.
+        fb.merge_color_block(0, 8, 0, frag, false, swr::output_merger::blend_kernels{}, swr::output_merger::color_mask::none);
+        BOOST_CHECK_EQUAL(buffer[8], 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(blend_kernels)
+{
+    const swr::blend_func funcs[] = {swr::blend_func::zero, swr::blend_func::one, swr::blend_func::src_alpha, swr::blend_func::src_color, swr::blend_func::one_minus_src_alpha};
+    const swr::pixel_format formats[] = {swr::pixel_format::argb8888, swr::pixel_format::bgra8888, swr::pixel_format::rgba8888};
+
+    const std::uint32_t src[4] = {0x80ff4010, 0x12345678, 0xffffffff, 0x00000000};
+    const std::uint32_t dest[4] = {0x11223344, 0xfedcba98, 0x80808080, 0xffffffff};
+
+    // reference blend factor for a channel.
+    auto factor = [](swr::blend_func f, float src_channel, float src_alpha) -> float
+    {
+        switch(f)
+        {
+        case swr::blend_func::zero: return 0.0f;
+        case swr::blend_func::one: return 1.0f;
+        case swr::blend_func::src_alpha: return src_alpha;
+        case swr::blend_func::src_color: return src_channel;
+        case swr::blend_func::one_minus_src_alpha: return 1.0f - src_alpha;
+        }
+        return 0.0f;
+    };
+
+    swr::output_merger::blend_kernels kernels;
+    for(auto blend_src: funcs)
+    {
+        for(auto blend_dst: funcs)
+        {
+            kernels.select(blend_src, blend_dst);
+
+            for(auto format: formats)
+            {
+                const auto alpha_shift = swr::pixel_format_descriptor::named_format(format).alpha_shift;
+
+                std::uint32_t out[4];
+                kernels.get_pixel_kernel(format)(src, dest, out);
+
+                for(int i = 0; i < 4; ++i)
+                {
+                    const float src_alpha = ((src[i] >> alpha_shift) & 0xff) / 255.0f;
+                    for(int shift = 0; shift < 32; shift += 8)
+                    {
+                        const float s = (src[i] >> shift) & 0xff;
+                        const float d = (dest[i] >> shift) & 0xff;
+                        const float expected = std::min(255.0f, s * factor(blend_src, s / 255.0f, src_alpha) + d * factor(blend_dst, s / 255.0f, src_alpha));
+
+                        // the kernels round to the nearest integer.
+                        BOOST_CHECK_LE(std::abs(static_cast<float>((out[i] >> shift) & 0xff) - expected), 0.5f + 1e-3f);
+                    }
+                }
+            }
+
+            // floating-point kernel.
+            const ml::vec4 color_src[4] = {{0.5f, 0.25f, 1.0f, 0.5f}, {0, 0, 0, 0}, {1, 1, 1, 1}, {0.1f, 0.2f, 0.3f, 0.4f}};
+            const ml::vec4 color_dest[4] = {{1.0f, 1.0f, 0.0f, 0.2f}, {1, 1, 1, 1}, {0, 0, 0, 0}, {0.4f, 0.3f, 0.2f, 0.1f}};
+            ml::vec4 color_out[4];
+            kernels.colors(color_src, color_dest, color_out);
+
+            for(int i = 0; i < 4; ++i)
+            {
+                const float s[4] = {color_src[i].r, color_src[i].g, color_src[i].b, color_src[i].a};
+                const float d[4] = {color_dest[i].r, color_dest[i].g, color_dest[i].b, color_dest[i].a};
+                const float out[4] = {color_out[i].r, color_out[i].g, color_out[i].b, color_out[i].a};
+
+                for(int c = 0; c < 4; ++c)
+                {
+                    const float expected = s[c] * factor(blend_src, s[c], s[3]) + d[c] * factor(blend_dst, s[c], s[3]);
+                    BOOST_CHECK_SMALL(out[c] - expected, 1e-5f);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+BOOST_AUTO_TEST_SUITE(lazy_clears)
+
+BOOST_AUTO_TEST_CASE(color_clear)
+{
+    // use dimensions that are not multiples of the tile size.
+    const int width = 40, height = 20;
+    std::vector<std::uint32_t> buffer(width * height, 0x12345678);
+
+    swr::impl::default_framebuffer fb;
+    fb.setup(width, height, width * sizeof(std::uint32_t), swr::pixel_format::argb8888, buffer.data());
+
+    // a full clear only marks the tiles.
+    fb.clear_color(0, ml::vec4{1.0f, 0.0f, 0.0f, 1.0f});
+    BOOST_CHECK(std::all_of(buffer.begin(), buffer.end(), [](std::uint32_t c)
+                            { return c == 0x12345678; }));
+
+    // a scissored clear fills the tiles it touches first. the rectangle's y axis points upwards.
+    fb.clear_color(0, ml::vec4{0.0f, 0.0f, 1.0f, 1.0f}, utils::rect{2, 4, height - 4, height - 2});
+    BOOST_CHECK_EQUAL(buffer[2 * width + 2], 0xff0000ff);
+    BOOST_CHECK_EQUAL(buffer[0], 0xffff0000);
+    BOOST_CHECK_EQUAL(buffer[15 * width + 15], 0xffff0000);
+    BOOST_CHECK_EQUAL(buffer[16], 0x12345678);
+
+    // the remaining tiles are filled on readback.
+    fb.materialize_color_clears();
+    BOOST_CHECK_EQUAL(buffer[2 * width + 2], 0xff0000ff);
+    BOOST_CHECK_EQUAL(buffer[16], 0xffff0000);
+    BOOST_CHECK_EQUAL(buffer[(height - 1) * width + width - 1], 0xffff0000);
+    BOOST_CHECK(std::count(buffer.begin(), buffer.end(), 0xffff0000) == width * height - 4);
+}
+
+BOOST_AUTO_TEST_CASE(depth_clear)
+{
+    // use dimensions that are not multiples of the tile size.
+    const int tile_size = swr::impl::rasterizer_block_size;
+    const int width = 40, height = 40;
+    swr::impl::default_framebuffer fb;
+    fb.setup(width, height, 0, swr::pixel_format::argb8888, nullptr);
+
+    auto* data = fb.depth_buffer.get_data_ptr<std::uint32_t>();
+    std::fill_n(data, width * height, 0x12345678);
+    auto read_depth = [&fb, width](int x, int y) -> ml::fixed_32_t
+    {
+        return fb.depth_buffer.get_data_ptr<ml::fixed_32_t>()[y * width + x];
+    };
+
+    // a full clear only marks the tiles.
+    fb.clear_depth(0.75f);
+    BOOST_CHECK(std::all_of(fb.depth_clear_pending.begin(), fb.depth_clear_pending.end(), [](std::uint8_t pending)
+                            { return pending != 0; }));
+    BOOST_CHECK(std::all_of(data, data + width * height, [](std::uint32_t d)
+                            { return d == 0x12345678; }));
+
+    // materializing fills a single tile.
+    fb.materialize_depth_clear(5, 5);
+    BOOST_CHECK_EQUAL(fb.depth_clear_pending[fb.get_tile_index(5, 5)], 0);
+    BOOST_CHECK(read_depth(0, 0) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK(read_depth(tile_size - 1, tile_size - 1) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK_EQUAL(data[tile_size], 0x12345678);
+    BOOST_CHECK_EQUAL(data[tile_size * width], 0x12345678);
+
+    // a scissored clear fills the tiles it touches first. the rectangle's y axis points upwards.
+    const int x_min = 2 * tile_size - 2, x_max = 2 * tile_size + 4;
+    fb.clear_depth(0.25f, utils::rect{x_min, x_max, height - 4, height - 2});
+    BOOST_CHECK_EQUAL(fb.depth_clear_pending[fb.get_tile_index(x_min, 2)], 0);
+    BOOST_CHECK_EQUAL(fb.depth_clear_pending[fb.get_tile_index(x_max, 2)], 0);
+    BOOST_CHECK(read_depth(x_min, 2) == ml::fixed_32_t{0.25f});
+    BOOST_CHECK(read_depth(x_max - 1, 3) == ml::fixed_32_t{0.25f});
+    BOOST_CHECK(read_depth(x_min - 1, 2) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK(read_depth(x_max, 2) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK(read_depth(x_min, 4) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK(read_depth(tile_size, tile_size - 1) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK(read_depth(width - 1, tile_size - 1) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK_EQUAL(data[tile_size * width], 0x12345678);
+
+    // depth tests fill the tile they access before comparing.
+    bool pass = false;
+    fb.depth_compare_write(5, height - 5, 0.5f, swr::comparison_func::less, true, pass);
+    BOOST_CHECK(pass);
+    BOOST_CHECK_EQUAL(fb.depth_clear_pending[fb.get_tile_index(5, height - 5)], 0);
+    BOOST_CHECK(read_depth(5, height - 5) == ml::fixed_32_t{0.5f});
+    BOOST_CHECK(read_depth(6, height - 5) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK(read_depth(0, height - 1) == ml::fixed_32_t{0.75f});
+
+    float depth_value[16];
+    std::fill_n(depth_value, 16, 0.875f);
+    std::uint32_t write_mask = 0xffff;
+    fb.depth_compare_write_block(tile_size, tile_size, depth_value, swr::comparison_func::less, true, write_mask);
+    BOOST_CHECK_EQUAL(write_mask, 0);
+    BOOST_CHECK_EQUAL(fb.depth_clear_pending[fb.get_tile_index(tile_size, tile_size)], 0);
+    BOOST_CHECK(read_depth(tile_size + 1, tile_size + 1) == ml::fixed_32_t{0.75f});
+    BOOST_CHECK(read_depth(2 * tile_size - 1, 2 * tile_size - 1) == ml::fixed_32_t{0.75f});
+
+    // the tiles which were not accessed keep their pending clears.
+    BOOST_CHECK_EQUAL(fb.depth_clear_pending[fb.get_tile_index(width - 1, height - 1)], 1);
+    BOOST_CHECK_EQUAL(data[(height - 1) * width + width - 1], 0x12345678);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,1536 @@
+/**
+ * swr - a software rasterizer
+ *
+ * render into an offscreen context and check the framebuffer contents and the query results.
+ *
+ * \author Felix Lubbe
+ * \copyright Copyright (c) 2021-Present.
+ * \license Distributed under the MIT software license (see accompanying LICENSE.txt).
+ */
+
+/* C++ headers */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <set>
+#include <utility>
+
+/* boost test framework. */
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_ALTERNATIVE_INIT_API
+#define BOOST_TEST_MODULE rendering tests
+#include <boost/test/unit_test.hpp>
+
+/* boost headers. */
+#include <boost/property_tree/json_parser.hpp>
+
+/* user headers. */
+#include "swr_internal.h"
+#include "rasterizer/interpolators.h"
+#include "rasterizer/fragment.h"
+#include "rasterizer/sweep.h"
+
+#include "swr/trace.h"
+#include "swr/capture.h"
+#include "swr/debug.h"
+
+/*
+ * helpers.
+ */
+
+/** framebuffer width. */
+constexpr int width = 64;
+
+/** framebuffer height. */
+constexpr int height = 64;
+
+/** number of pixels covered by a rectangle spanning [-0.5,0.5]x[-0.5,0.5] in normalized device coordinates. */
+constexpr std::uint64_t half_rect_pixels = (width / 2) * (height / 2);
+
+/**
+ * write a constant color to all fragments.
+ *
+ * vertex shader input:
+ *   attribute 0: position in normalized device coordinates
+ *
+ * uniforms:
+ *   location 0: color [vec4]
+ */
+template<bool DepthInvariant>
+class flat_color : public swr::program<flat_color<DepthInvariant>>
+{
+public:
+    bool is_depth_invariant() const override
+    {
+        return DepthInvariant;
+    }
+
+    void vertex_shader(
+      [[maybe_unused]] int gl_VertexID,
+      [[maybe_unused]] int gl_InstanceID,
+      const ml::vec4* attribs,
+      ml::vec4& gl_Position,
+      [[maybe_unused]] float& gl_PointSize,
+      [[maybe_unused]] float* gl_ClipDistance,
+      [[maybe_unused]] ml::vec4* varyings) const override
+    {
+        gl_Position = attribs[0];
+    }
+
+    swr::fragment_shader_result fragment_shader(
+      [[maybe_unused]] const ml::vec4& gl_FragCoord,
+      [[maybe_unused]] bool gl_FrontFacing,
+      [[maybe_unused]] const ml::vec2& gl_PointCoord,
+      [[maybe_unused]] const boost::container::static_vector<swr::varying, geom::limits::max::varyings>& varyings,
+      [[maybe_unused]] float& gl_FragDepth,
+      ml::vec4& gl_FragColor) const override
+    {
+        gl_FragColor = (*this->uniforms)[0].v4;
+        return swr::accept;
+    }
+};
+
+/**
+ * interpolate vertex colors.
+ *
+ * vertex shader input:
+ *   attribute 0: position in normalized device coordinates
+ *   attribute 1: color
+ *
+ * varyings:
+ *   location 0: color
+ */
+class vertex_color : public swr::program<vertex_color>
+{
+public:
+    void pre_link(boost::container::static_vector<swr::interpolation_qualifier, geom::limits::max::varyings>& iqs) const override
+    {
+        iqs = {swr::interpolation_qualifier::smooth};
+    }
+
+    bool is_depth_invariant() const override
+    {
+        return true;
+    }
+
+    void vertex_shader(
+      [[maybe_unused]] int gl_VertexID,
+      [[maybe_unused]] int gl_InstanceID,
+      const ml::vec4* attribs,
+      ml::vec4& gl_Position,
+      [[maybe_unused]] float& gl_PointSize,
+      [[maybe_unused]] float* gl_ClipDistance,
+      ml::vec4* varyings) const override
+    {
+        gl_Position = attribs[0];
+        varyings[0] = attribs[1];
+    }
+
+    swr::fragment_shader_result fragment_shader(
+      [[maybe_unused]] const ml::vec4& gl_FragCoord,
+      [[maybe_unused]] bool gl_FrontFacing,
+      [[maybe_unused]] const ml::vec2& gl_PointCoord,
+      const boost::container::static_vector<swr::varying, geom::limits::max::varyings>& varyings,
+      [[maybe_unused]] float& gl_FragDepth,
+      ml::vec4& gl_FragColor) const override
+    {
+        gl_FragColor = varyings[0];
+        return swr::accept;
+    }
+};
+
+/**
+ * interpolate vertex colors and count the vertex shader invocations.
+ *
+ * vertex shader input:
+ *   attribute 0: position in normalized device coordinates
+ *   attribute 1: color
+ *
+ * varyings:
+ *   location 0: color
+ */
+class counting_vertex_color : public swr::program<counting_vertex_color>
+{
+public:
+    /** invocation counter. the shader instances are copies of the program, so the counter is shared through a pointer. */
+    std::atomic<std::uint32_t>* invocations{nullptr};
+
+    void pre_link(boost::container::static_vector<swr::interpolation_qualifier, geom::limits::max::varyings>& iqs) const override
+    {
+        iqs = {swr::interpolation_qualifier::smooth};
+    }
+
+    void vertex_shader(
+      [[maybe_unused]] int gl_VertexID,
+      [[maybe_unused]] int gl_InstanceID,
+      const ml::vec4* attribs,
+      ml::vec4& gl_Position,
+      [[maybe_unused]] float& gl_PointSize,
+      [[maybe_unused]] float* gl_ClipDistance,
+      ml::vec4* varyings) const override
+    {
+        invocations->fetch_add(1, std::memory_order_relaxed);
+
+        gl_Position = attribs[0];
+        varyings[0] = attribs[1];
+    }
+
+    swr::fragment_shader_result fragment_shader(
+      [[maybe_unused]] const ml::vec4& gl_FragCoord,
+      [[maybe_unused]] bool gl_FrontFacing,
+      [[maybe_unused]] const ml::vec2& gl_PointCoord,
+      const boost::container::static_vector<swr::varying, geom::limits::max::varyings>& varyings,
+      [[maybe_unused]] float& gl_FragDepth,
+      ml::vec4& gl_FragColor) const override
+    {
+        gl_FragColor = varyings[0];
+        return swr::accept;
+    }
+};
+
+/**
+ * write a constant color to the right half of point sprites.
+ *
+ * vertex shader input:
+ *   attribute 0: position in normalized device coordinates
+ */
+class right_half_sprite : public swr::program<right_half_sprite>
+{
+public:
+    void vertex_shader(
+      [[maybe_unused]] int gl_VertexID,
+      [[maybe_unused]] int gl_InstanceID,
+      const ml::vec4* attribs,
+      ml::vec4& gl_Position,
+      [[maybe_unused]] float& gl_PointSize,
+      [[maybe_unused]] float* gl_ClipDistance,
+      [[maybe_unused]] ml::vec4* varyings) const override
+    {
+        gl_Position = attribs[0];
+    }
+
+    swr::fragment_shader_result fragment_shader(
+      [[maybe_unused]] const ml::vec4& gl_FragCoord,
+      [[maybe_unused]] bool gl_FrontFacing,
+      const ml::vec2& gl_PointCoord,
+      [[maybe_unused]] const boost::container::static_vector<swr::varying, geom::limits::max::varyings>& varyings,
+      [[maybe_unused]] float& gl_FragDepth,
+      ml::vec4& gl_FragColor) const override
+    {
+        if(gl_PointCoord.x < 0.5f)
+        {
+            return swr::discard;
+        }
+
+        gl_FragColor = ml::vec4::one();
+        return swr::accept;
+    }
+};
+
+/** an offscreen context with cleared buffers and registered shaders. the context is current for the lifetime of the object. */
+struct offscreen_context
+{
+    /** the context. */
+    swr::context_handle context{nullptr};
+
+    /** flat color shader. */
+    flat_color<false> shader;
+
+    /** flat color shader, declared as depth-invariant. */
+    flat_color<true> depth_invariant_shader;
+
+    /** vertex color shader. */
+    vertex_color color_shader;
+
+    /** shader id. */
+    std::uint32_t shader_id{0};
+
+    /** depth-invariant shader id. */
+    std::uint32_t depth_invariant_shader_id{0};
+
+    /** vertex color shader id. */
+    std::uint32_t color_shader_id{0};
+
+    /** create the context and make it current. */
+    offscreen_context(std::uint32_t thread_hint = 1)
+    {
+        context = swr::CreateOffscreenContext(width, height, thread_hint);
+        BOOST_REQUIRE(context != nullptr);
+        BOOST_REQUIRE(swr::MakeContextCurrent(context));
+
+        // the keys let captures resolve the shaders on replay.
+        shader_id = swr::RegisterShader(&shader, "flat_color");
+        depth_invariant_shader_id = swr::RegisterShader(&depth_invariant_shader, "flat_color_depth_invariant");
+        color_shader_id = swr::RegisterShader(&color_shader, "vertex_color");
+        BOOST_REQUIRE(swr::BindShader(shader_id));
+
+        swr::SetClearColor(0, 0, 0, 0);
+        swr::SetClearDepth(1.0f);
+        swr::ClearColorBuffer();
+        swr::ClearDepthBuffer();
+
+        swr::SetState(swr::state::depth_test, true);
+        swr::SetDepthTest(swr::comparison_func::less);
+    }
+
+    /** release the context. */
+    ~offscreen_context()
+    {
+        swr::MakeContextCurrent(nullptr);
+        swr::DestroyContext(context);
+    }
+};
+
+/** draw a rectangle given in normalized device coordinates at depth z, using the bound shader. */
+static void draw_rect(float x0, float y0, float x1, float y1, float z, const ml::vec4& color)
+{
+    const std::vector<ml::vec4> vertices = {
+      {x0, y0, z, 1}, {x1, y0, z, 1}, {x1, y1, z, 1},
+      {x0, y0, z, 1}, {x1, y1, z, 1}, {x0, y1, z, 1}};
+
+    // the attributes are copied by the draw call.
+    auto id = swr::CreateAttributeBuffer(vertices);
+    swr::EnableAttributeBuffer(id, 0);
+    swr::BindUniform(0, color);
+    swr::DrawElements(vertices.size(), swr::vertex_buffer_mode::triangles);
+    swr::DisableAttributeBuffer(id);
+    swr::DeleteAttributeBuffer(id);
+}
+
+/** draw a rectangle given in normalized device coordinates at depth z, with a color for each corner. uses the vertex color shader. */
+static void draw_color_rect(float x0, float y0, float x1, float y1, float z, const std::array<ml::vec4, 4>& colors)
+{
+    const std::vector<ml::vec4> vertices = {
+      {x0, y0, z, 1}, {x1, y0, z, 1}, {x1, y1, z, 1},
+      {x0, y0, z, 1}, {x1, y1, z, 1}, {x0, y1, z, 1}};
+    const std::vector<ml::vec4> vertex_colors = {
+      colors[0], colors[1], colors[2],
+      colors[0], colors[2], colors[3]};
+
+    auto position_id = swr::CreateAttributeBuffer(vertices);
+    auto color_id = swr::CreateAttributeBuffer(vertex_colors);
+    swr::EnableAttributeBuffer(position_id, 0);
+    swr::EnableAttributeBuffer(color_id, 1);
+    swr::DrawElements(vertices.size(), swr::vertex_buffer_mode::triangles);
+    swr::DisableAttributeBuffer(color_id);
+    swr::DisableAttributeBuffer(position_id);
+    swr::DeleteAttributeBuffer(color_id);
+    swr::DeleteAttributeBuffer(position_id);
+}
+
+/** draw a rectangle given in pixel coordinates, with the y axis pointing down. */
+static void draw_pixel_rect(int x0, int y0, int x1, int y1, float z, const ml::vec4& color)
+{
+    draw_rect(2.0f * x0 / width - 1.0f, 1.0f - 2.0f * y0 / height, 2.0f * x1 / width - 1.0f, 1.0f - 2.0f * y1 / height, z, color);
+}
+
+/** copy the default color buffer. */
+static std::vector<std::uint32_t> read_color_buffer()
+{
+    auto& framebuffer = swr::impl::global_context->framebuffer;
+    framebuffer.materialize_color_clears();
+
+    std::vector<std::uint32_t> pixels;
+    pixels.reserve(width * height);
+    for(int y = 0; y < height; ++y)
+    {
+        auto* row = reinterpret_cast<const std::uint32_t*>(reinterpret_cast<const std::uint8_t*>(framebuffer.color_buffer.info.data_ptr) + y * framebuffer.color_buffer.info.pitch);
+        pixels.insert(pixels.end(), row, row + width);
+    }
+    return pixels;
+}
+
+/** check that two color buffers differ by at most one unit in each channel. */
+static void check_color_buffers(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b)
+{
+    BOOST_REQUIRE_EQUAL(a.size(), b.size());
+    for(std::size_t i = 0; i < a.size(); ++i)
+    {
+        for(int shift = 0; shift < 32; shift += 8)
+        {
+            const int channel_a = (a[i] >> shift) & 0xff;
+            const int channel_b = (b[i] >> shift) & 0xff;
+            BOOST_TEST_INFO("pixel (" << (i % width) << "," << (i / width) << ")");
+            BOOST_CHECK_LE(std::abs(channel_a - channel_b), 1);
+        }
+    }
+}
+
+/** count the pixels of the default color buffer which differ from the (zero) clear color. */
+static std::uint64_t count_colored_pixels()
+{
+    auto pixels = read_color_buffer();
+    return std::count_if(pixels.begin(), pixels.end(),
+                         [](std::uint32_t p) -> bool
+                         { return p != 0; });
+}
+
+/*
+ * occlusion queries.
+ */
+
+BOOST_AUTO_TEST_SUITE(queries)
+
+BOOST_AUTO_TEST_CASE(samples_passed)
+{
+    offscreen_context ctx;
+
+    auto query = swr::CreateQuery();
+    BOOST_REQUIRE(query != 0);
+
+    swr::BeginQuery(swr::query_target::samples_passed, query);
+    draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f, {1, 0, 0, 1});
+    swr::EndQuery(swr::query_target::samples_passed);
+
+    // the draw calls are rasterized by Present.
+    std::uint64_t result = 0;
+    BOOST_CHECK(!swr::GetQueryResult(query, result));
+
+    swr::Present();
+    BOOST_REQUIRE(swr::GetQueryResult(query, result));
+    BOOST_CHECK_EQUAL(result, half_rect_pixels);
+    BOOST_CHECK_EQUAL(count_colored_pixels(), half_rect_pixels);
+
+    // fragments failing the depth test are not counted.
+    swr::BeginQuery(swr::query_target::samples_passed, query);
+    draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, 0.5f, {0, 1, 0, 1});
+    swr::EndQuery(swr::query_target::samples_passed);
+    swr::Present();
+
+    BOOST_REQUIRE(swr::GetQueryResult(query, result));
+    BOOST_CHECK_EQUAL(result, 0);
+
+    swr::ReleaseQuery(query);
+    BOOST_CHECK(swr::GetLastError() == swr::error::none);
+}
+
+BOOST_AUTO_TEST_CASE(any_samples_passed)
+{
+    offscreen_context ctx;
+
+    auto query = swr::CreateQuery();
+    swr::BeginQuery(swr::query_target::any_samples_passed, query);
+    draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f, {1, 0, 0, 1});
+    swr::EndQuery(swr::query_target::any_samples_passed);
+    swr::Present();
+
+    std::uint64_t result = 0;
+    BOOST_REQUIRE(swr::GetQueryResult(query, result));
+    BOOST_CHECK_EQUAL(result, 1);
+
+    swr::ReleaseQuery(query);
+}
+
+BOOST_AUTO_TEST_CASE(lifecycle)
+{
+    offscreen_context ctx;
+
+    // an ended query cannot be restarted before its result is available.
+    auto query = swr::CreateQuery();
+    swr::BeginQuery(swr::query_target::samples_passed, query);
+    draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f, {1, 0, 0, 1});
+    swr::EndQuery(swr::query_target::samples_passed);
+
+    swr::BeginQuery(swr::query_target::samples_passed, query);
+    BOOST_CHECK(swr::GetLastError() == swr::error::invalid_operation);
+
+    // the released slot is not reused before Present, so the new query does not receive the old samples.
+    swr::ReleaseQuery(query);
+    auto new_query = swr::CreateQuery();
+    BOOST_CHECK_NE(new_query, query);
+
+    swr::BeginQuery(swr::query_target::samples_passed, new_query);
+    BOOST_CHECK(swr::GetLastError() == swr::error::none);
+    swr::EndQuery(swr::query_target::samples_passed);
+    swr::Present();
+
+    std::uint64_t result = 0;
+    BOOST_REQUIRE(swr::GetQueryResult(new_query, result));
+    BOOST_CHECK_EQUAL(result, 0);
+
+    // the released query is not valid anymore.
+    BOOST_CHECK(!swr::GetQueryResult(query, result));
+    BOOST_CHECK(swr::GetLastError() == swr::error::invalid_value);
+
+    // a query can be restarted once its result is available.
+    swr::BeginQuery(swr::query_target::samples_passed, new_query);
+    draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, -0.5f, {0, 1, 0, 1});
+    swr::EndQuery(swr::query_target::samples_passed);
+    BOOST_CHECK(swr::GetLastError() == swr::error::none);
+    swr::Present();
+
+    BOOST_REQUIRE(swr::GetQueryResult(new_query, result));
+    BOOST_CHECK_EQUAL(result, half_rect_pixels);
+
+    swr::ReleaseQuery(new_query);
+}
+
+BOOST_AUTO_TEST_CASE(depth_sorting)
+{
+    offscreen_context ctx;
+    swr::SetDepthSorting(true);
+
+    // the far rectangle is counted before the near one is drawn. sorting must not move the near rectangle in front of it.
+    auto query = swr::CreateQuery();
+    swr::BeginQuery(swr::query_target::samples_passed, query);
+    draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, 0.5f, {1, 0, 0, 1});
+    swr::EndQuery(swr::query_target::samples_passed);
+
+    draw_rect(-1.0f, -1.0f, 1.0f, 1.0f, -0.5f, {0, 1, 0, 1});
+    swr::Present();
+
+    std::uint64_t result = 0;
+    BOOST_REQUIRE(swr::GetQueryResult(query, result));
+    BOOST_CHECK_EQUAL(result, half_rect_pixels);
+    BOOST_CHECK_EQUAL(count_colored_pixels(), width * height);
+
+    swr::ReleaseQuery(query);
+    swr::SetDepthSorting(false);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+/*
+ * deferred shading through the visibility buffer.
+ */
+
+BOOST_AUTO_TEST_SUITE(visibility_buffer)
+
+/** draw overlapping rectangles at scattered depths. more rectangles than a visibility buffer holds are drawn into each tile. */
+static void draw_layers()
+{
+    constexpr int layer_count = 300;
+    static_assert(static_cast<std::size_t>(2 * layer_count) > rast::tile_visibility::max_triangle_count, "the visibility buffers need to overflow.");
+
+    for(int i = 0; i < layer_count; ++i)
+    {
+        const float offset = 0.05f * static_cast<float>(i % 8);
+        const float z = 0.9f - 1.8f * static_cast<float>((i * 37) % layer_count) / layer_count;
+        const float t = static_cast<float>(i) / layer_count;
+
+        draw_color_rect(-0.9f + offset, -0.9f + offset, 0.5f + offset, 0.5f + offset, z,
+                        {ml::vec4{t, 0, 1 - t, 1}, ml::vec4{0, t, 1, 1}, ml::vec4{1, 1 - t, 0, 1}, ml::vec4{t, t, t, 1}});
+    }
+}
+
+BOOST_AUTO_TEST_CASE(compare_immediate)
+{
+    std::vector<std::uint32_t> immediate, deferred;
+
+    for(bool use_visibility_buffer: {false, true})
+    {
+        offscreen_context ctx;
+        BOOST_REQUIRE(swr::BindShader(ctx.color_shader_id));
+        swr::SetVisibilityBuffer(use_visibility_buffer);
+
+        draw_layers();
+        swr::Present();
+        BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+        (use_visibility_buffer ? deferred : immediate) = read_color_buffer();
+    }
+
+    BOOST_CHECK_GT(std::count_if(immediate.begin(), immediate.end(),
+                                 [](std::uint32_t p) -> bool
+                                 { return p != 0; }),
+                   0);
+    check_color_buffers(immediate, deferred);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+/*
+ * depth-only rendering.
+ */
+
+BOOST_AUTO_TEST_SUITE(depth_only)
+
+/** copy the default depth buffer, after writing the pending clears. */
+static std::vector<std::uint32_t> read_depth_buffer()
+{
+    auto& framebuffer = swr::impl::global_context->framebuffer;
+    for(int y = 0; y < height; ++y)
+    {
+        for(int x = 0; x < width; ++x)
+        {
+            framebuffer.materialize_depth_clear(x, y);
+        }
+    }
+    return framebuffer.depth_buffer.data;
+}
+
+/** draw rectangles at constant depths, and a rectangle whose depth varies along the x axis. */
+static void draw_depth_layers()
+{
+    draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f, {1, 1, 1, 1});
+    draw_rect(-0.8f, -0.2f, 0.3f, 0.9f, -0.3f, {1, 1, 1, 1});
+
+    const std::vector<ml::vec4> vertices = {
+      {-0.9f, -0.9f, -0.8f, 1}, {0.9f, -0.9f, 0.8f, 1}, {0.9f, 0.9f, 0.8f, 1},
+      {-0.9f, -0.9f, -0.8f, 1}, {0.9f, 0.9f, 0.8f, 1}, {-0.9f, 0.9f, -0.8f, 1}};
+
+    auto id = swr::CreateAttributeBuffer(vertices);
+    swr::EnableAttributeBuffer(id, 0);
+    swr::DrawElements(vertices.size(), swr::vertex_buffer_mode::triangles);
+    swr::DisableAttributeBuffer(id);
+    swr::DeleteAttributeBuffer(id);
+}
+
+BOOST_AUTO_TEST_CASE(color_mask)
+{
+    offscreen_context ctx;
+
+    bool red, green, blue, alpha;
+    swr::GetColorMask(red, green, blue, alpha);
+    BOOST_CHECK(red && green && blue && alpha);
+
+    swr::SetColorMask(false, true, false, true);
+    swr::GetColorMask(red, green, blue, alpha);
+    BOOST_CHECK(!red && green && !blue && alpha);
+}
+
+BOOST_AUTO_TEST_CASE(compare_shaded)
+{
+    // the depth-invariant shader takes the depth-only path, the other shader is shaded with all channels masked.
+    std::vector<std::uint32_t> shaded, depth_only;
+
+    for(bool use_depth_invariant_shader: {false, true})
+    {
+        offscreen_context ctx;
+        BOOST_REQUIRE(swr::BindShader(use_depth_invariant_shader ? ctx.depth_invariant_shader_id : ctx.shader_id));
+        swr::SetColorMask(false, false, false, false);
+
+        draw_depth_layers();
+        swr::Present();
+        BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+        BOOST_CHECK_EQUAL(count_colored_pixels(), 0);
+        (use_depth_invariant_shader ? depth_only : shaded) = read_depth_buffer();
+    }
+
+    BOOST_CHECK(std::any_of(depth_only.begin(), depth_only.end(),
+                            [&depth_only](std::uint32_t z) -> bool
+                            { return z != depth_only[0]; }));
+    BOOST_CHECK(shaded == depth_only);
+}
+
+BOOST_AUTO_TEST_CASE(prepass)
+{
+    offscreen_context ctx;
+
+    // lay down the depth of a rectangle in front without writing colors.
+    BOOST_REQUIRE(swr::BindShader(ctx.depth_invariant_shader_id));
+    swr::SetColorMask(false, false, false, false);
+    draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f, {1, 1, 1, 1});
+    swr::Present();
+    BOOST_CHECK_EQUAL(count_colored_pixels(), 0);
+
+    // a rectangle behind it is only visible outside the rectangle in front.
+    BOOST_REQUIRE(swr::BindShader(ctx.shader_id));
+    swr::SetColorMask(true, true, true, true);
+    draw_rect(-1.0f, -1.0f, 1.0f, 1.0f, 0.5f, {1, 0, 0, 1});
+    swr::Present();
+    BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+    BOOST_CHECK_EQUAL(count_colored_pixels(), width * height - half_rect_pixels);
+}
+
+BOOST_AUTO_TEST_CASE(discard)
+{
+    offscreen_context ctx;
+    const auto cleared = read_depth_buffer();
+
+    // the depth values are not written back if they are discarded.
+    swr::DiscardDepthBuffer();
+    draw_depth_layers();
+    swr::Present();
+    BOOST_CHECK(swr::GetLastError() == swr::error::none);
+    BOOST_CHECK_GT(count_colored_pixels(), 0);
+    BOOST_CHECK(read_depth_buffer() == cleared);
+
+    // a frame without draw calls drops the request, too.
+    swr::DiscardDepthBuffer();
+    swr::Present();
+
+    // without discarding, the depth values are resolved.
+    draw_depth_layers();
+    swr::Present();
+    BOOST_CHECK(read_depth_buffer() != cleared);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+/*
+ * primitive ordering.
+ */
+
+BOOST_AUTO_TEST_SUITE(ordering)
+
+/** draw overlapping triangles at the same depth, each with its own color, split into several render objects. uses the vertex color shader. */
+static void draw_overlapping_triangles(std::size_t object_count, std::size_t triangles_per_object)
+{
+    // linear congruential generator, so that the triangles are the same for each call.
+    std::uint32_t seed = 12345;
+    auto random = [&seed]() -> float
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1 << 24);
+    };
+
+    for(std::size_t i = 0; i < object_count; ++i)
+    {
+        std::vector<ml::vec4> vertices;
+        std::vector<ml::vec4> vertex_colors;
+        for(std::size_t j = 0; j < triangles_per_object; ++j)
+        {
+            const ml::vec4 color{random(), random(), random(), 1.0f};
+            for(int k = 0; k < 3; ++k)
+            {
+                vertices.emplace_back(2.0f * random() - 1.0f, 2.0f * random() - 1.0f, 0.5f, 1.0f);
+                vertex_colors.emplace_back(color);
+            }
+        }
+
+        auto position_id = swr::CreateAttributeBuffer(vertices);
+        auto color_id = swr::CreateAttributeBuffer(vertex_colors);
+        swr::EnableAttributeBuffer(position_id, 0);
+        swr::EnableAttributeBuffer(color_id, 1);
+        swr::DrawElements(vertices.size(), swr::vertex_buffer_mode::triangles);
+        swr::DisableAttributeBuffer(color_id);
+        swr::DisableAttributeBuffer(position_id);
+        swr::DeleteAttributeBuffer(color_id);
+        swr::DeleteAttributeBuffer(position_id);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(depth_equal)
+{
+    // with the depth test set to less, the first triangle drawn at a pixel wins, so the submission order has to be kept.
+    const std::vector<std::pair<std::size_t, std::size_t>> configurations = {{1, 500}, {8, 60}, {64, 4}};
+
+    for(const auto& [object_count, triangles_per_object]: configurations)
+    {
+        std::vector<std::vector<std::uint32_t>> images;
+        for(std::uint32_t thread_hint: {1, 4})
+        {
+            offscreen_context ctx{thread_hint};
+            BOOST_REQUIRE(swr::BindShader(ctx.color_shader_id));
+
+            draw_overlapping_triangles(object_count, triangles_per_object);
+            swr::Present();
+            BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+            images.emplace_back(read_color_buffer());
+        }
+
+        BOOST_TEST_INFO(object_count << " objects with " << triangles_per_object << " triangles");
+        BOOST_CHECK(images[0] == images[1]);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+/*
+ * indexed drawing.
+ */
+
+BOOST_AUTO_TEST_SUITE(indexed)
+
+BOOST_AUTO_TEST_CASE(shared_vertices)
+{
+    // a grid of quads. the inner vertices are shared by six triangles, which are split into several index ranges when drawing with multiple threads.
+    constexpr int grid_size = 8;
+
+    std::vector<ml::vec4> vertices;
+    std::vector<ml::vec4> vertex_colors;
+    for(int y = 0; y <= grid_size; ++y)
+    {
+        for(int x = 0; x <= grid_size; ++x)
+        {
+            vertices.emplace_back(-0.9f + 1.8f * x / grid_size, -0.9f + 1.8f * y / grid_size, 0.0f, 1.0f);
+            vertex_colors.emplace_back(static_cast<float>(x) / grid_size, static_cast<float>(y) / grid_size, static_cast<float>((x + y) % 2), 1.0f);
+        }
+    }
+
+    std::vector<std::uint32_t> indices;
+    for(int y = 0; y < grid_size; ++y)
+    {
+        for(int x = 0; x < grid_size; ++x)
+        {
+            const std::uint32_t i = y * (grid_size + 1) + x;
+            indices.insert(indices.end(), {i, i + 1, i + grid_size + 2, i, i + grid_size + 2, i + grid_size + 1});
+        }
+    }
+
+    std::vector<std::vector<std::uint32_t>> images;
+    for(std::uint32_t thread_hint: {1, 4})
+    {
+        std::atomic<std::uint32_t> invocations{0};
+        counting_vertex_color counting_shader;
+        counting_shader.invocations = &invocations;
+
+        offscreen_context ctx{thread_hint};
+
+        auto counting_shader_id = swr::RegisterShader(&counting_shader);
+        BOOST_REQUIRE(counting_shader_id != 0);
+        BOOST_REQUIRE(swr::BindShader(counting_shader_id));
+
+        auto position_id = swr::CreateAttributeBuffer(vertices);
+        auto color_id = swr::CreateAttributeBuffer(vertex_colors);
+        auto index_id = swr::CreateIndexBuffer(indices);
+        swr::EnableAttributeBuffer(position_id, 0);
+        swr::EnableAttributeBuffer(color_id, 1);
+        swr::DrawIndexedElements(index_id, swr::vertex_buffer_mode::triangles);
+        swr::DisableAttributeBuffer(color_id);
+        swr::DisableAttributeBuffer(position_id);
+
+        swr::Present();
+        BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+        // each vertex is shaded exactly once.
+        BOOST_TEST_INFO("threads " << thread_hint);
+        BOOST_CHECK_EQUAL(invocations.load(), vertices.size());
+
+        images.emplace_back(read_color_buffer());
+
+        swr::DeleteIndexBuffer(index_id);
+        swr::DeleteAttributeBuffer(color_id);
+        swr::DeleteAttributeBuffer(position_id);
+        swr::BindShader(0);
+        swr::UnregisterShader(counting_shader_id);
+    }
+
+    BOOST_CHECK(images[0] == images[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+/*
+ * point sprites.
+ */
+
+BOOST_AUTO_TEST_SUITE(points)
+
+/** draw points given in viewport coordinates, using the bound shader. */
+static void draw_points(const std::vector<ml::vec2>& positions)
+{
+    std::vector<ml::vec4> vertices;
+    for(const auto& it: positions)
+    {
+        vertices.emplace_back(it.x * 2.0f / width - 1.0f, it.y * 2.0f / height - 1.0f, 0.0f, 1.0f);
+    }
+
+    auto id = swr::CreateAttributeBuffer(vertices);
+    swr::EnableAttributeBuffer(id, 0);
+    swr::BindUniform(0, ml::vec4::one());
+    swr::DrawElements(vertices.size(), swr::vertex_buffer_mode::points);
+    swr::DisableAttributeBuffer(id);
+    swr::DeleteAttributeBuffer(id);
+}
+
+BOOST_AUTO_TEST_CASE(coverage)
+{
+    // sprites centered on pixel corners and on pixel centers, crossing the tile boundaries at the framebuffer's center.
+    const std::vector<std::pair<ml::vec2, float>> sprites = {
+      {{32.0f, 32.0f}, 8.0f},
+      {{32.5f, 32.5f}, 5.0f},
+      {{32.0f, 32.0f}, 1.0f},
+      {{32.5f, 32.5f}, 1.0f},
+      {{20.0f, 40.0f}, 24.0f}};
+
+    for(std::uint32_t thread_hint: {1, 4})
+    {
+        for(const auto& [position, size]: sprites)
+        {
+            offscreen_context ctx{thread_hint};
+            swr::SetPointSize(size);
+
+            draw_points({position});
+            swr::Present();
+            BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+            BOOST_TEST_INFO("size " << size << ", threads " << thread_hint);
+            BOOST_CHECK_EQUAL(count_colored_pixels(), static_cast<std::uint64_t>(size * size));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(clipped)
+{
+    offscreen_context ctx;
+    swr::SetPointSize(8.0f);
+
+    // a quarter of the sprite lies inside the framebuffer.
+    draw_points({{0.0f, 0.0f}});
+    swr::Present();
+    BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+    BOOST_CHECK_EQUAL(count_colored_pixels(), 16);
+}
+
+BOOST_AUTO_TEST_CASE(point_coord)
+{
+    offscreen_context ctx;
+
+    right_half_sprite sprite_shader;
+    auto sprite_shader_id = swr::RegisterShader(&sprite_shader);
+    BOOST_REQUIRE(sprite_shader_id != 0);
+    BOOST_REQUIRE(swr::BindShader(sprite_shader_id));
+
+    // the right halves of the sprites are drawn.
+    swr::SetPointSize(8.0f);
+    draw_points({{16.0f, 16.0f}, {40.0f, 44.0f}});
+    swr::Present();
+    BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+    BOOST_CHECK_EQUAL(count_colored_pixels(), 2 * 32);
+
+    swr::BindShader(0);
+    swr::UnregisterShader(sprite_shader_id);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+/*
+ * lines.
+ */
+
+BOOST_AUTO_TEST_SUITE(lines)
+
+/** the viewport extends the framebuffer by this amount on each side, so that lines can leave the framebuffer without being clipped. */
+constexpr int viewport_border = 32;
+
+/** draw a line between the centers of two pixels, using the bound shader. the viewport needs to be extended by viewport_border. */
+static void draw_line(int x0, int y0, int x1, int y1)
+{
+    const float viewport_scale = 0.5f * (width + 2 * viewport_border);
+    auto to_ndc = [viewport_scale](int x, int y) -> ml::vec4
+    {
+        return {(x + viewport_border + 0.5f) / viewport_scale - 1.0f, 1.0f - (y + viewport_border + 0.5f) / viewport_scale, 0.0f, 1.0f};
+    };
+    const std::vector<ml::vec4> vertices = {to_ndc(x0, y0), to_ndc(x1, y1)};
+
+    auto id = swr::CreateAttributeBuffer(vertices);
+    swr::EnableAttributeBuffer(id, 0);
+    swr::BindUniform(0, ml::vec4::one());
+    swr::DrawElements(vertices.size(), swr::vertex_buffer_mode::lines);
+    swr::DisableAttributeBuffer(id);
+    swr::DeleteAttributeBuffer(id);
+}
+
+/**
+ * walk a line between the centers of two pixels fragment by fragment, and return the covered pixels inside the framebuffer.
+ * the start pixel is drawn and the end pixel is not. lines are walked in the direction of increasing parameter, and for
+ * lines running the other way, the walk starts next to the end pixel at the value set up by the diamond exit rule.
+ */
+static std::vector<bool> reference_line(int x0, int y0, int x1, int y1)
+{
+    const int dx = x1 - x0;
+    const int dy = y1 - y0;
+    const bool is_x_major = std::abs(dy) <= std::abs(dx);
+
+    const int delta_p = is_x_major ? dx : dy;
+    const int delta_v = is_x_major ? dy : dx;
+    const float slope = static_cast<float>(delta_v) / static_cast<float>(delta_p);
+
+    const int start_p = is_x_major ? x0 : y0;
+    const int start_v = is_x_major ? y0 : x0;
+    const int end_p = is_x_major ? x1 : y1;
+    const int end_v = is_x_major ? y1 : x1;
+
+    int p, v, inc_v;
+    if(delta_p > 0)
+    {
+        p = start_p;
+        v = is_x_major ? start_v : static_cast<int>(std::floor(start_v + 0.5f - 0.5f * slope));
+        inc_v = (delta_v > 0) - (delta_v < 0);
+    }
+    else
+    {
+        p = end_p + 1;
+        v = static_cast<int>(std::floor(end_v + 0.5f + 0.5f * slope));
+        inc_v = (delta_v < 0) - (delta_v > 0);
+    }
+
+    const int dp = std::abs(delta_p);
+    const int dv = std::abs(delta_v);
+    int error = 2 * dv - dp;
+
+    std::vector<bool> pixels(width * height, false);
+    for(int i = 0; i < dp; ++i)
+    {
+        const int x = is_x_major ? p : v;
+        const int y = is_x_major ? v : p;
+        if(x >= 0 && x < width && y >= 0 && y < height)
+        {
+            pixels[y * width + x] = true;
+        }
+
+        if(error > 0)
+        {
+            v += inc_v;
+            error -= 2 * dp;
+        }
+        error += 2 * dv;
+        ++p;
+    }
+    return pixels;
+}
+
+BOOST_AUTO_TEST_CASE(octants)
+{
+    // lines in all octants, crossing the tile boundaries at the framebuffer's center and the framebuffer's edges.
+    const std::vector<std::array<int, 4>> lines = {
+      {5, 3, 60, 20}, {60, 20, 5, 3}, {5, 40, 60, 20}, {60, 3, 5, 40},
+      {10, 2, 30, 61}, {30, 61, 10, 2}, {50, 1, 20, 62}, {20, 62, 50, 1},
+      {-20, 10, 80, 50}, {80, 50, -20, 10}, {10, -25, 40, 90}, {40, 90, 10, -25},
+      {-30, -30, 90, 90}, {90, -30, -30, 90}, {-10, 31, 70, 31}, {31, 70, 31, -10},
+      {-20, 60, 80, 90}, {90, 40, 20, -30}, {31, 31, 33, 32}, {33, 30, 30, 33}};
+
+    for(std::uint32_t thread_hint: {1, 4})
+    {
+        for(const auto& [x0, y0, x1, y1]: lines)
+        {
+            offscreen_context ctx{thread_hint};
+            swr::SetViewport(-viewport_border, -viewport_border, width + 2 * viewport_border, height + 2 * viewport_border);
+
+            draw_line(x0, y0, x1, y1);
+            swr::Present();
+            BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+            const auto pixels = read_color_buffer();
+            const auto expected = reference_line(x0, y0, x1, y1);
+            for(std::size_t i = 0; i < pixels.size(); ++i)
+            {
+                BOOST_TEST_INFO("line (" << x0 << "," << y0 << ")-(" << x1 << "," << y1 << "), threads " << thread_hint << ", pixel (" << (i % width) << "," << (i / width) << ")");
+                BOOST_CHECK_EQUAL(pixels[i] != 0, expected[i]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+/*
+ * overdraw counters.
+ */
+
+BOOST_AUTO_TEST_SUITE(overdraw)
+
+BOOST_AUTO_TEST_CASE(overlapping_quads)
+{
+    // two squares with even pixel borders, so that only the 2x2 blocks on their diagonals are partially covered.
+    constexpr int a0 = 8, a1 = 40;
+    constexpr int b0 = 24, b1 = 56;
+
+    for(std::uint32_t thread_hint: {1, 4})
+    {
+        offscreen_context ctx{thread_hint};
+
+        std::vector<swr::debug::fragment_counters> counters;
+        std::uint32_t counters_width = 0, counters_height = 0;
+        BOOST_CHECK(!swr::debug::get_overdraw_counters(counters, counters_width, counters_height));
+
+        swr::debug::set_overdraw_counting(true);
+
+        // the second quad is drawn behind the first one.
+        draw_pixel_rect(a0, a0, a1, a1, 0.0f, {1, 0, 0, 1});
+        draw_pixel_rect(b0, b0, b1, b1, 0.5f, {0, 1, 0, 1});
+        swr::Present();
+        BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+        BOOST_REQUIRE(swr::debug::get_overdraw_counters(counters, counters_width, counters_height));
+        BOOST_REQUIRE_EQUAL(counters_width, static_cast<std::uint32_t>(width));
+        BOOST_REQUIRE_EQUAL(counters_height, static_cast<std::uint32_t>(height));
+        BOOST_REQUIRE_EQUAL(counters.size(), static_cast<std::size_t>(width * height));
+
+        for(int y = 0; y < height; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                const std::uint32_t in_a = (x >= a0 && x < a1 && y >= a0 && y < a1) ? 1 : 0;
+                const std::uint32_t in_b = (x >= b0 && x < b1 && y >= b0 && y < b1) ? 1 : 0;
+
+                // both diagonals lie on x=y. each of the two triangles of a quad covers a part of the 2x2 blocks
+                // on the diagonal and shades the remaining lanes as helper lanes.
+                const bool on_diagonal = (x / 2) == (y / 2);
+
+                const auto& c = counters[y * width + x];
+                BOOST_TEST_INFO("threads " << thread_hint << ", pixel (" << x << "," << y << ")");
+                BOOST_CHECK_EQUAL(c.shaded, in_a + in_b);
+                BOOST_CHECK_EQUAL(c.depth_failed, in_a * in_b);
+                BOOST_CHECK_EQUAL(c.helper_lanes, on_diagonal ? in_a + in_b : 0);
+            }
+        }
+
+        // the counters describe the last frame.
+        swr::ClearColorBuffer();
+        swr::ClearDepthBuffer();
+        draw_pixel_rect(b0, b0, b1, b1, 0.5f, {0, 1, 0, 1});
+        swr::Present();
+        BOOST_REQUIRE(swr::debug::get_overdraw_counters(counters, counters_width, counters_height));
+        BOOST_CHECK_EQUAL(counters[(a0 + 1) * width + a0].shaded, 0u);
+        BOOST_CHECK_EQUAL(counters[(b0 + 1) * width + b0].shaded, 1u);
+        BOOST_CHECK_EQUAL(counters[(b0 + 1) * width + b0].depth_failed, 0u);
+
+        swr::debug::set_overdraw_counting(false);
+        BOOST_CHECK(!swr::debug::get_overdraw_counters(counters, counters_width, counters_height));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+/*
+ * memory usage.
+ */
+
+#ifdef SWR_ENABLE_STATS
+
+BOOST_AUTO_TEST_SUITE(memory_usage)
+
+BOOST_AUTO_TEST_CASE(growth)
+{
+    using swr::stats::memory_category;
+
+    offscreen_context ctx;
+
+    swr::stats::memory_data before;
+    swr::stats::get_memory_data(before);
+
+    const std::size_t texture_size = 64;
+    auto texture_id = swr::CreateTexture();
+    swr::AllocateImage(texture_id, texture_size, texture_size);
+
+    const std::vector<ml::vec4> vertices(1024, ml::vec4::one());
+    auto buffer_id = swr::CreateAttributeBuffer(vertices);
+    BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+    swr::stats::memory_data after;
+    swr::stats::get_memory_data(after);
+
+    // the sizes are based on the containers' capacities, so they grow at least by the allocated data.
+    BOOST_CHECK_GE(after[memory_category::textures].current, before[memory_category::textures].current + texture_size * texture_size * sizeof(ml::vec4));
+    BOOST_CHECK_GE(after[memory_category::vertex_buffers].current, before[memory_category::vertex_buffers].current + vertices.size() * sizeof(ml::vec4));
+    BOOST_CHECK_GE(after.get_current_total(), before.get_current_total() + (texture_size * texture_size + vertices.size()) * sizeof(ml::vec4));
+
+    for(const auto& it: after.categories)
+    {
+        BOOST_CHECK_GE(it.peak, it.current);
+    }
+
+    swr::DeleteAttributeBuffer(buffer_id);
+    swr::ReleaseTexture(texture_id);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+#endif /* SWR_ENABLE_STATS */
+
+/*
+ * tile statistics.
+ */
+
+#ifdef SWR_ENABLE_STATS
+
+BOOST_AUTO_TEST_SUITE(tile_statistics)
+
+/** draw a point at the center of a pixel, using the bound shader. */
+static void draw_pixel_point(int x, int y, const ml::vec4& color)
+{
+    const std::vector<ml::vec4> vertices = {{2.0f * (x + 0.5f) / width - 1.0f, 1.0f - 2.0f * (y + 0.5f) / height, 0, 1}};
+
+    auto id = swr::CreateAttributeBuffer(vertices);
+    swr::EnableAttributeBuffer(id, 0);
+    swr::BindUniform(0, color);
+    swr::DrawElements(vertices.size(), swr::vertex_buffer_mode::points);
+    swr::DisableAttributeBuffer(id);
+    swr::DeleteAttributeBuffer(id);
+}
+
+/** draw rectangles covering a single tile each, i.e., each rectangle adds two primitives to one tile. */
+static void draw_tile_rect(int tile_x, int tile_y, int count)
+{
+    constexpr int tile_size = swr::impl::rasterizer_block_size;
+    for(int i = 0; i < count; ++i)
+    {
+        draw_pixel_rect(tile_x * tile_size, tile_y * tile_size, (tile_x + 1) * tile_size, (tile_y + 1) * tile_size, 0.5f, ml::vec4::one());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(primitive_counts)
+{
+    for(std::uint32_t thread_hint: {1, 4})
+    {
+        offscreen_context ctx{thread_hint};
+
+        draw_tile_rect(0, 0, 1);
+        draw_tile_rect(1, 1, 2);
+        draw_tile_rect(3, 2, 8);
+        swr::Present();
+        BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+        swr::stats::tile_data data;
+        swr::stats::get_tile_data(data);
+
+        // the tile cache has an extra row and column of tiles.
+        BOOST_TEST_INFO("threads " << thread_hint);
+        BOOST_CHECK_EQUAL(data.tiles_x, static_cast<std::uint32_t>(width / swr::impl::rasterizer_block_size + 1));
+        BOOST_CHECK_EQUAL(data.tiles_y, static_cast<std::uint32_t>(height / swr::impl::rasterizer_block_size + 1));
+        BOOST_REQUIRE_EQUAL(data.primitives.size(), static_cast<std::size_t>(data.tiles_x * data.tiles_y));
+        BOOST_REQUIRE_EQUAL(data.cycles.size(), data.primitives.size());
+
+        std::vector<std::uint32_t> expected(data.primitives.size(), 0);
+        expected[0] = 2;
+        expected[1 * data.tiles_x + 1] = 4;
+        expected[2 * data.tiles_x + 3] = 16;
+        BOOST_CHECK(data.primitives == expected);
+
+        // bucket i>0 counts the tiles with [2^(i-1), 2^i) primitives.
+        std::array<std::uint32_t, swr::stats::tile_histogram_buckets> expected_histogram{};
+        expected_histogram[0] = data.tiles_x * data.tiles_y - 3;
+        expected_histogram[2] = 1;
+        expected_histogram[3] = 1;
+        expected_histogram[5] = 1;
+        BOOST_CHECK(data.primitive_histogram == expected_histogram);
+
+        // the counters describe the last frame.
+        draw_tile_rect(1, 1, 1);
+        swr::Present();
+        swr::stats::get_tile_data(data);
+
+        std::fill(expected.begin(), expected.end(), 0);
+        expected[1 * data.tiles_x + 1] = 2;
+        BOOST_CHECK(data.primitives == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(flush_causes)
+{
+    using swr::stats::flush_cause;
+
+    for(std::uint32_t thread_hint: {1, 4})
+    {
+        offscreen_context ctx{thread_hint};
+
+        auto get_flushes = [](auto&& draw) -> std::array<std::uint32_t, static_cast<std::size_t>(flush_cause::count)>
+        {
+            swr::ClearDepthBuffer();
+            draw();
+            swr::Present();
+            BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+            swr::stats::tile_data data;
+            swr::stats::get_tile_data(data);
+            return data.flushes;
+        };
+
+        auto expect = [](std::initializer_list<std::pair<flush_cause, std::uint32_t>> counts) -> std::array<std::uint32_t, static_cast<std::size_t>(flush_cause::count)>
+        {
+            std::array<std::uint32_t, static_cast<std::size_t>(flush_cause::count)> flushes{};
+            for(const auto& [cause, count]: counts)
+            {
+                flushes[static_cast<std::size_t>(cause)] = count;
+            }
+            return flushes;
+        };
+
+        const auto end_of_frame = get_flushes(
+          []()
+          { draw_tile_rect(0, 0, 2); });
+
+        // the second triangle with blending finds the first one in the cache.
+        const auto blending = get_flushes(
+          []()
+          {
+              draw_tile_rect(0, 0, 1);
+              swr::SetState(swr::state::blend, true);
+              draw_tile_rect(0, 0, 1);
+              swr::SetState(swr::state::blend, false);
+          });
+
+        // only the first triangle drawn with the new depth function processes the cache.
+        const auto depth_func_change = get_flushes(
+          []()
+          {
+              draw_tile_rect(0, 0, 1);
+              swr::SetDepthTest(swr::comparison_func::less_equal);
+              draw_tile_rect(0, 0, 1);
+              swr::SetDepthTest(swr::comparison_func::less);
+          });
+
+        const auto primitive_type_change = get_flushes(
+          []()
+          {
+              draw_tile_rect(0, 0, 1);
+              draw_pixel_point(8, 8, ml::vec4::one());
+          });
+
+        // the thread count is known after the first frame.
+        swr::stats::rasterizer_data rasterizer;
+        swr::stats::get_rasterizer_data(rasterizer);
+
+        BOOST_TEST_INFO("threads " << rasterizer.available_threads);
+        if(rasterizer.available_threads > 1)
+        {
+            BOOST_CHECK(end_of_frame == expect({{flush_cause::end_of_frame, 1}}));
+            BOOST_CHECK(blending == expect({{flush_cause::blending, 2}, {flush_cause::end_of_frame, 1}}));
+            BOOST_CHECK(depth_func_change == expect({{flush_cause::depth_func_change, 1}, {flush_cause::end_of_frame, 1}}));
+            BOOST_CHECK(primitive_type_change == expect({{flush_cause::primitive_type_change, 1}, {flush_cause::end_of_frame, 1}}));
+        }
+        else
+        {
+            // the sequential rasterizer processes the cache after each triangle and draws points directly.
+            BOOST_CHECK(end_of_frame == expect({{flush_cause::sequential, 4}}));
+            BOOST_CHECK(blending == expect({{flush_cause::sequential, 4}}));
+            BOOST_CHECK(depth_func_change == expect({{flush_cause::sequential, 4}}));
+            BOOST_CHECK(primitive_type_change == expect({{flush_cause::sequential, 2}}));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+#endif /* SWR_ENABLE_STATS */
+
+/*
+ * trace capture.
+ */
+
+#ifdef SWR_ENABLE_TRACING
+
+BOOST_AUTO_TEST_SUITE(tracing)
+
+BOOST_AUTO_TEST_CASE(capture_frames)
+{
+    offscreen_context ctx{4};
+
+    const char* path = "swr_test_trace.json";
+    std::remove(path);
+
+    // skip two frames and record the next three. the file is written after the last recorded frame.
+    BOOST_REQUIRE(swr::trace::capture_frames(path, 2, 3));
+    for(int i = 0; i < 6; ++i)
+    {
+        swr::ClearColorBuffer();
+        swr::ClearDepthBuffer();
+        draw_rect(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f, ml::vec4::one());
+        swr::Present();
+        BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+        // the capture is written when its last frame ends.
+        BOOST_CHECK_EQUAL(static_cast<bool>(std::ifstream{path}), i >= 4);
+    }
+    BOOST_CHECK(!swr::trace::stop_capture());
+
+    boost::property_tree::ptree trace;
+    BOOST_REQUIRE_NO_THROW(boost::property_tree::read_json(path, trace));
+
+    std::set<std::uint32_t> frames;
+    std::set<std::string> stages;
+    for(const auto& [key, event]: trace.get_child("traceEvents"))
+    {
+        const auto name = event.get<std::string>("name");
+        const auto phase = event.get<std::string>("ph");
+        if(phase != "X")
+        {
+            continue;
+        }
+
+        BOOST_CHECK_GE(event.get<double>("dur"), 0.0);
+        if(name == "frame")
+        {
+            frames.insert(event.get<std::uint32_t>("args.frame"));
+        }
+        else
+        {
+            stages.insert(name);
+        }
+    }
+
+    BOOST_CHECK(frames == std::set<std::uint32_t>({2, 3, 4}));
+    BOOST_CHECK(stages.count("vertex processing") != 0);
+    BOOST_CHECK(stages.count("primitive assembly") != 0);
+
+    std::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+#endif /* SWR_ENABLE_TRACING */
+
+/*
+ * api capture.
+ */
+
+#ifdef SWR_ENABLE_CAPTURE
+
+BOOST_AUTO_TEST_SUITE(capture)
+
+/** draw the scene recorded by the capture tests. */
+static void draw_capture_scene(const offscreen_context& ctx)
+{
+    swr::SetClearColor(0.25f, 0.5f, 0.75f, 1.0f);
+    swr::ClearColorBuffer();
+    swr::ClearDepthBuffer();
+
+    BOOST_REQUIRE(swr::BindShader(ctx.color_shader_id));
+    draw_color_rect(-0.9f, -0.9f, 0.4f, 0.4f, 0.5f, {ml::vec4{1, 0, 0, 1}, ml::vec4{0, 1, 0, 1}, ml::vec4{0, 0, 1, 1}, ml::vec4{1, 1, 0, 1}});
+
+    BOOST_REQUIRE(swr::BindShader(ctx.shader_id));
+    draw_rect(-0.4f, -0.4f, 0.9f, 0.9f, 0.0f, {0, 1, 1, 1});
+
+    swr::SetDepthTest(swr::comparison_func::greater);
+    draw_rect(-0.6f, -0.6f, 0.6f, 0.6f, 0.75f, {1, 0, 1, 1});
+
+    swr::Present();
+}
+
+/** look up the shaders of an offscreen context by the keys they were registered with. */
+static swr::capture::shader_resolver make_resolver(const offscreen_context& ctx)
+{
+    return [&ctx](const std::string& key) -> const swr::program_base*
+    {
+        if(key == "flat_color")
+        {
+            return &ctx.shader;
+        }
+        if(key == "flat_color_depth_invariant")
+        {
+            return &ctx.depth_invariant_shader;
+        }
+        if(key == "vertex_color")
+        {
+            return &ctx.color_shader;
+        }
+        return nullptr;
+    };
+}
+
+/** append a call to the recorded stream. */
+template<typename... Args>
+static void append_command(std::vector<std::byte>& commands, swr::impl::capture::opcode op, Args... args)
+{
+    commands.push_back(static_cast<std::byte>(op));
+    (
+      [&commands](auto arg)
+      {
+          const auto* bytes = reinterpret_cast<const std::byte*>(&arg);
+          commands.insert(commands.end(), bytes, bytes + sizeof(arg));
+      }(args),
+      ...);
+}
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    const char* path = "swr_test_capture.bin";
+    std::remove(path);
+
+    std::vector<std::uint32_t> recorded;
+    {
+        offscreen_context ctx{4};
+
+        // the capture ends after one frame and writes the file.
+        BOOST_REQUIRE(swr::capture::begin_capture(path, 1));
+        draw_capture_scene(ctx);
+        BOOST_CHECK(!swr::capture::end_capture());
+        BOOST_CHECK(swr::GetLastError() == swr::error::none);
+
+        recorded = read_color_buffer();
+    }
+
+    swr::capture::capture_data data;
+    BOOST_REQUIRE(swr::capture::load_capture(path, data));
+    BOOST_CHECK_EQUAL(data.width, static_cast<std::uint32_t>(width));
+    BOOST_CHECK_EQUAL(data.height, static_cast<std::uint32_t>(height));
+    BOOST_CHECK_EQUAL(data.frame_count, 1u);
+
+    {
+        offscreen_context ctx{4};
+
+        std::uint32_t presented = 0;
+        BOOST_REQUIRE(swr::capture::replay_capture(
+          data, make_resolver(ctx),
+          [&presented](std::uint32_t)
+          { ++presented; }));
+        BOOST_CHECK_EQUAL(presented, 1u);
+
+        BOOST_CHECK(read_color_buffer() == recorded);
+    }
+
+    std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_streams)
+{
+    using swr::impl::capture::opcode;
+
+    const char* path = "swr_test_capture.bin";
+    std::remove(path);
+
+    {
+        offscreen_context ctx;
+        BOOST_REQUIRE(swr::capture::begin_capture(path, 1));
+        draw_capture_scene(ctx);
+    }
+
+    swr::capture::capture_data data;
+    BOOST_REQUIRE(swr::capture::load_capture(path, data));
+    std::remove(path);
+
+    // the unmodified stream replays.
+    {
+        offscreen_context ctx;
+        BOOST_CHECK(swr::capture::replay_capture(data, make_resolver(ctx)));
+    }
+
+    // an unknown shader key.
+    {
+        offscreen_context ctx;
+        BOOST_CHECK(!swr::capture::replay_capture(
+          data, [](const std::string&) -> const swr::program_base*
+          { return nullptr; }));
+    }
+
+    auto check_rejected = [&data](const std::vector<std::byte>& suffix)
+    {
+        auto modified = data;
+        modified.commands.insert(modified.commands.end(), suffix.begin(), suffix.end());
+
+        offscreen_context ctx;
+        BOOST_CHECK(!swr::capture::replay_capture(modified, make_resolver(ctx)));
+    };
+
+    // an opcode that was never recorded.
+    check_rejected({std::byte{0xff}});
+
+    // a truncated call.
+    {
+        std::vector<std::byte> commands;
+        append_command(commands, opcode::delete_attribute_buffer, std::uint32_t{0});
+        commands.pop_back();
+        check_rejected(commands);
+    }
+
+    // an id that the capture did not create.
+    {
+        std::vector<std::byte> commands;
+        append_command(commands, opcode::delete_attribute_buffer, std::uint32_t{1234});
+        check_rejected(commands);
+    }
+
+    // an out-of-range enumeration value.
+    {
+        std::vector<std::byte> commands;
+        append_command(commands, opcode::set_depth_test, static_cast<swr::comparison_func>(0xff));
+        check_rejected(commands);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
+
+#endif /* SWR_ENABLE_CAPTURE */